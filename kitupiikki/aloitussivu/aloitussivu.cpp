@@ -87,7 +87,7 @@ void AloitusSivu::siirrySivulle()
 {
     if( !sivulla )
     {
-        connect( kp(), &Kirjanpito::kirjanpitoaMuokattu, this, &AloitusSivu::siirrySivulle);
+        connect( kp(), &Kirjanpito::kirjanpitoMuuttui, this, &AloitusSivu::kirjanpitoMuuttui);
         sivulla = true;
     }
 
@@ -123,11 +123,19 @@ void AloitusSivu::siirrySivulle()
 
 bool AloitusSivu::poistuSivulta(int /* minne */)
 {
-    disconnect( kp(), &Kirjanpito::kirjanpitoaMuokattu, this, &AloitusSivu::siirrySivulle);
+    disconnect( kp(), &Kirjanpito::kirjanpitoMuuttui, this, &AloitusSivu::kirjanpitoMuuttui);
     sivulla = false;
     return true;
 }
 
+void AloitusSivu::kirjanpitoMuuttui(const KirjanpidonMuutos &muutos)
+{
+    // Tilikauden saldoihin vaikuttavat kaikki sen loppuun mennessä kirjatut viennit
+    Tilikausi kausi = kp()->tilikaudet()->tilikausiIndeksilla( ui->tilikausiCombo->currentIndex() );
+    if( muutos.koskeeJaksoa( QDate(), kausi.paattyy() ))
+        siirrySivulle();
+}
+
 void AloitusSivu::kirjanpitoVaihtui()
 {
     bool avoinna = kp()->asetukset()->onko("Nimi");
@@ -288,14 +296,9 @@ void AloitusSivu::varmuuskopioi()
         QMessageBox::critical(this, tr("Virhe"), tr("Tiedostoa ei saa kopioida itsensä päälle!"));
         return;
     }
+    // Pääikkuna kopioi kirjanpidon taustalla ja ilmoittaa valmistumisesta
     if( !tiedostoon.isEmpty() )
-    {
-        QFile kirjanpito( kp()->tiedostopolku());
-        if( kirjanpito.copy(tiedostoon) )
-            QMessageBox::information(this, kp()->asetukset()->asetus("Nimi"), tr("Kirjanpidon varmuuskopiointi onnistui."));
-        else
-            QMessageBox::critical(this, tr("Virhe"), tr("Tiedoston varmuuskopiointi epäonnistui."));
-    }
+        emit varmuuskopioiTiedostoon(tiedostoon);
 }
 
 void AloitusSivu::muistiinpanot()
@@ -27,6 +27,7 @@
 #include <QNetworkReply>
 
 #include "db/tilikausi.h"
+#include "db/kirjanpidonmuutos.h"
 #include "kitupiikkisivu.h"
 
 #include "ui_aloitus.h"
@@ -50,6 +51,11 @@ public slots:
     void siirrySivulle() override;
     void kirjanpitoVaihtui();
 
+    /**
+     * @brief Päivittää sivun, jos muutos vaikuttaa valitun tilikauden lukuihin
+     */
+    void kirjanpitoMuuttui(const KirjanpidonMuutos& muutos);
+
     void linkki(const QUrl& linkki);
 
     void uusiTietokanta();
@@ -75,6 +81,7 @@ public slots:
 signals:
     void selaus(int tilinumero, Tilikausi tilikausi);
     void ktpkasky(QString kasky);
+    void varmuuskopioiTiedostoon(const QString& tiedosto);
 
 protected:
     QString vinkit();
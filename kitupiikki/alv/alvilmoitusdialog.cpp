@@ -98,13 +98,14 @@ bool AlvIlmoitusDialog::alvIlmoitus(QDate alkupvm, QDate loppupvm)
 
     EhdotusModel ehdotus;
     QSqlQuery query( *kp()->tietokanta() );
+    QString viennit = kp()->osiot()->taulu("vienti", alkupvm, loppupvm);
 
     // 1) Bruttojen oikaisut
     // Korjattu 6.3.2018 #81 since 0.6
 
-    query.exec(  QString("select alvkoodi,alvprosentti,sum(debetsnt) as debetit, sum(kreditsnt) as kreditit, tili from vienti where pvm between \"%3\" and \"%4\" and (alvkoodi=%1 or alvkoodi=%2) group by alvkoodi,tili,alvprosentti")
+    query.exec(  QString("select alvkoodi,alvprosentti,sum(debetsnt) as debetit, sum(kreditsnt) as kreditit, tili from %5 where pvm between \"%3\" and \"%4\" and (alvkoodi=%1 or alvkoodi=%2) group by alvkoodi,tili,alvprosentti")
                  .arg(AlvKoodi::MYYNNIT_BRUTTO).arg(AlvKoodi::OSTOT_BRUTTO)
-                 .arg(alkupvm.toString(Qt::ISODate)).arg(loppupvm.toString(Qt::ISODate)));
+                 .arg(alkupvm.toString(Qt::ISODate)).arg(loppupvm.toString(Qt::ISODate)).arg(viennit));
 
     while( query.next() && query.value("alvprosentti").toInt())
     {
@@ -179,9 +180,10 @@ bool AlvIlmoitusDialog::alvIlmoitus(QDate alkupvm, QDate loppupvm)
 
     // 1B) Voittomarginaaliverotus
     MarginaaliLaskelma marginaali(alkupvm, loppupvm);
-    query.exec( QString("select tili, alvprosentti, sum(kreditsnt) as plus, sum(debetsnt) as minus from vienti "
+    query.exec( QString("select tili, alvprosentti, sum(kreditsnt) as plus, sum(debetsnt) as minus from %4 "
                         "where alvkoodi=%1 and pvm between \"%2\" and \"%3\" group by tili,alvprosentti")
-                .arg(AlvKoodi::MYYNNIT_MARGINAALI).arg(alkupvm.toString(Qt::ISODate)).arg(loppupvm.toString(Qt::ISODate)));
+                .arg(AlvKoodi::MYYNNIT_MARGINAALI).arg(alkupvm.toString(Qt::ISODate)).arg(loppupvm.toString(Qt::ISODate))
+                .arg(viennit));
 
     while( query.next())
     {
@@ -219,9 +221,10 @@ bool AlvIlmoitusDialog::alvIlmoitus(QDate alkupvm, QDate loppupvm)
 
 
     // 2) Nettokirjausten koonti
-    query.exec( QString("select alvprosentti, sum(debetsnt) as debetit, sum(kreditsnt) as kreditit from vienti where pvm between \"%1\" and \"%2\" and (alvkoodi=%3 or alvkoodi=%4) group by alvprosentti")
+    query.exec( QString("select alvprosentti, sum(debetsnt) as debetit, sum(kreditsnt) as kreditit from %5 where pvm between \"%1\" and \"%2\" and (alvkoodi=%3 or alvkoodi=%4) group by alvprosentti")
                 .arg(alkupvm.toString(Qt::ISODate)).arg(loppupvm.toString(Qt::ISODate))
-                .arg(AlvKoodi::ALVKIRJAUS + AlvKoodi::MYYNNIT_NETTO).arg(AlvKoodi::ALVKIRJAUS + AlvKoodi::MAKSUPERUSTEINEN_MYYNTI) );
+                .arg(AlvKoodi::ALVKIRJAUS + AlvKoodi::MYYNNIT_NETTO).arg(AlvKoodi::ALVKIRJAUS + AlvKoodi::MAKSUPERUSTEINEN_MYYNTI)
+                .arg(viennit) );
 
     while( query.next())
     {
@@ -232,8 +235,8 @@ bool AlvIlmoitusDialog::alvIlmoitus(QDate alkupvm, QDate loppupvm)
 
 
     // Muut kirjaukset tauluihin
-    query.exec( QString("select alvkoodi, sum(debetsnt) as debetit, sum(kreditsnt) as kreditit from vienti where pvm between \"%1\" and \"%2\" group by alvkoodi")
-                .arg(alkupvm.toString(Qt::ISODate)).arg(loppupvm.toString(Qt::ISODate)) );
+    query.exec( QString("select alvkoodi, sum(debetsnt) as debetit, sum(kreditsnt) as kreditit from %3 where pvm between \"%1\" and \"%2\" group by alvkoodi")
+                .arg(alkupvm.toString(Qt::ISODate)).arg(loppupvm.toString(Qt::ISODate)).arg(viennit) );
 
     QMap<int,qlonglong> kooditaulu;
 
@@ -398,15 +401,17 @@ bool AlvIlmoitusDialog::alvIlmoitus(QDate alkupvm, QDate loppupvm)
 
 
         QSqlQuery kysely;
+        QString laskelmanViennit = kp()->osiot()->taulu("vienti", laskelmaMista, loppupvm);
         // Liikevaihtoon ei lasketa verotonta myyntiä eikä palveluiden yhteisömyyntiä
         kysely.exec(  QString("SELECT SUM(kreditsnt), SUM(debetsnt) "
-                                   "FROM vienti, tili WHERE "
+                                   "FROM %3, tili WHERE "
                                    "pvm BETWEEN \"%1\" AND \"%2\" "
                                    "AND vienti.tili=tili.id AND "
                                    "tili.tyyppi = \"CL\" AND vienti.alvkoodi > 0 AND vienti.alvkoodi <> 13 AND "
                                    "vienti.alvkoodi <> 15")
                            .arg(laskelmaMista.toString(Qt::ISODate))
-                           .arg(loppupvm.toString(Qt::ISODate)));
+                           .arg(loppupvm.toString(Qt::ISODate))
+                           .arg(laskelmanViennit));
         if( kysely.next())
             liikevaihto += kysely.value(0).toLongLong() - kysely.value(1).toLongLong();
 
@@ -414,22 +419,24 @@ bool AlvIlmoitusDialog::alvIlmoitus(QDate alkupvm, QDate loppupvm)
         liikevaihto -= bruttoveroayhtSnt;
 
         kysely.exec(  QString("SELECT SUM(kreditsnt), SUM(debetsnt) "
-                                   "FROM vienti WHERE "
+                                   "FROM %3 WHERE "
                                    "pvm BETWEEN \"%1\" AND \"%2\" "
                                    "AND (alvkoodi = 111 OR alvkoodi = 127 OR alvkoodi = 118) ")
                            .arg(laskelmaMista.toString(Qt::ISODate))
-                           .arg(loppupvm.toString(Qt::ISODate)) );
+                           .arg(loppupvm.toString(Qt::ISODate))
+                           .arg(laskelmanViennit) );
 
         if( kysely.next())
             vero += kysely.value(0).toLongLong() - kysely.value(1).toLongLong();
 
         // Verosta vähennetään vielä vähennetyt
         kysely.exec(  QString("SELECT SUM(kreditsnt), SUM(debetsnt) "
-                                   "FROM vienti WHERE "
+                                   "FROM %3 WHERE "
                                    "pvm BETWEEN \"%1\" AND \"%2\" "
                                    "AND alvkoodi > 200 AND alvkoodi < 300 ")
                            .arg(laskelmaMista.toString(Qt::ISODate))
-                           .arg(loppupvm.toString(Qt::ISODate)) );
+                           .arg(loppupvm.toString(Qt::ISODate))
+                           .arg(laskelmanViennit) );
 
         if( kysely.next())
             vero -= kysely.value(1).toLongLong() - kysely.value(0).toLongLong();
@@ -584,11 +591,12 @@ void AlvIlmoitusDialog::luku(const QString &nimike, qlonglong senttia, bool viiv
 bool AlvIlmoitusDialog::maksuperusteisenTilitys(const QDate &paivayksesta, const QDate &tilityspvm)
 {
     // Hakee kaikki sanottua vanhemmat erät ja jos niillä saldoa, niin lävähtävät maksuun
-    QSqlQuery kysely( QString("SELECT id, alvkoodi, alvprosentti FROM vienti WHERE (tili=%1 OR tili=%2) "
+    QSqlQuery kysely( QString("SELECT id, alvkoodi, alvprosentti FROM %4 WHERE (tili=%1 OR tili=%2) "
                               "AND pvm <='%3'")
                       .arg( kp()->tilit()->tiliTyypilla(TiliLaji::KOHDENTAMATONALVVELKA).id() )
                       .arg( kp()->tilit()->tiliTyypilla(TiliLaji::KOHDENTAMATONALVSAATAVA).id())
-                      .arg( paivayksesta.toString(Qt::ISODate)));
+                      .arg( paivayksesta.toString(Qt::ISODate))
+                      .arg( kp()->osiot()->taulu("vienti", QDate(), paivayksesta)));
 
     EhdotusModel ehdotus;
 
@@ -54,7 +54,8 @@ MarginaaliLaskelma::MarginaaliLaskelma(const QDate &alkaa, const QDate &loppuu)
 
     // 1) Haetaan alijäämät
     QMap<int,qlonglong> alijaamat;
-    query.exec( QString("select json from tosite where laji=0 and pvm=\"%1\"").arg(alkaa.addDays(-1).toString(Qt::ISODate)) );
+    query.exec( QString("select json from %2 where laji=0 and pvm=\"%1\"").arg(alkaa.addDays(-1).toString(Qt::ISODate))
+                .arg( kp()->osiot()->taulu("tosite", alkaa.addDays(-1), alkaa.addDays(-1))) );
     while( query.next() )
     {
         JsonKentta json( query.value("json").toByteArray() );
@@ -70,10 +71,12 @@ MarginaaliLaskelma::MarginaaliLaskelma(const QDate &alkaa, const QDate &loppuu)
 
     // 2) Haetaan myynnit
     QMap<int,qlonglong> myynnit;
+    QString viennit = kp()->osiot()->taulu("vienti", alkaa, loppuu);
 
-    query.exec( QString("select alvprosentti, sum(kreditsnt) as plus, sum(debetsnt) as minus from vienti "
+    query.exec( QString("select alvprosentti, sum(kreditsnt) as plus, sum(debetsnt) as minus from %4 "
                         "where alvkoodi=%1 and pvm between \"%2\" and \"%3\" group by alvprosentti ")
-                .arg(AlvKoodi::MYYNNIT_MARGINAALI).arg(alkaa.toString(Qt::ISODate)).arg(loppuu.toString(Qt::ISODate)));
+                .arg(AlvKoodi::MYYNNIT_MARGINAALI).arg(alkaa.toString(Qt::ISODate)).arg(loppuu.toString(Qt::ISODate))
+                .arg(viennit));
     while( query.next())
     {
         kannat.insert( query.value("alvprosentti").toInt());
@@ -83,9 +86,10 @@ MarginaaliLaskelma::MarginaaliLaskelma(const QDate &alkaa, const QDate &loppuu)
     // 3) Haetaan ostot
     QMap<int,qlonglong> ostot;
 
-    query.exec( QString("select alvprosentti, sum(kreditsnt) as minus, sum(debetsnt) as plus from vienti "
+    query.exec( QString("select alvprosentti, sum(kreditsnt) as minus, sum(debetsnt) as plus from %4 "
                         "where alvkoodi=%1 and pvm between \"%2\" and \"%3\" group by alvprosentti ")
-                .arg(AlvKoodi::OSTOT_MARGINAALI ).arg(alkaa.toString(Qt::ISODate)).arg(loppuu.toString(Qt::ISODate)));
+                .arg(AlvKoodi::OSTOT_MARGINAALI ).arg(alkaa.toString(Qt::ISODate)).arg(loppuu.toString(Qt::ISODate))
+                .arg(viennit));
     while( query.next())
     {
         kannat.insert( query.value("alvprosentti").toInt());
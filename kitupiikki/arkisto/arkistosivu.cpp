@@ -29,6 +29,7 @@
 
 #include "arkistosivu.h"
 #include "db/kirjanpito.h"
+#include "db/saldotaulu.h"
 #include "ui_lisaatilikausidlg.h"
 #include "ui_lukitsetilikausi.h"
 #include "ui_muokkaatilikausi.h"
@@ -362,6 +363,15 @@ void ArkistoSivu::muokkaa()
             kp()->tilikaudet()->muokkaaViimeinenTilikausi( dlgUi.paattyyDate->date() );
         else if( dlgUi.peruLukko->isChecked())
         {
+            // Erotetun kauden tiedosto on liitetty vain luku -tilassa
+            if( kp()->osiot()->onkoOsioitu(kausi))
+            {
+                QMessageBox::critical(this, tr("Tilikauden lukitsemisen peruminen"),
+                                      tr("Tilikauden aineisto on erotettu omaan tiedostoonsa, "
+                                         "eikä sen lukitusta voi enää perua."));
+                return;
+            }
+
             if( QMessageBox::warning(this, tr("Tilikauden lukitsemisen peruminen"),
                                      tr("Oletko varma, että haluat perua tilikauden lukitsemisen?\n\n"
                                         "Kaikki tilinpäätökseen liittyvät toimet on tehtävä uudelleen ja tilinpäätös on mahdollisesti "
@@ -375,6 +385,7 @@ void ArkistoSivu::muokkaa()
             json->unset("Vahvistettu");
             kp()->tilikaudet()->tallennaJSON();
             kp()->asetukset()->aseta("TilitPaatetty", kausi.alkaa().addDays(-1));
+            SaldoTaulu::poistaKuvat( *kp()->tietokanta(), kausi.alkaa());
 
         }
     }
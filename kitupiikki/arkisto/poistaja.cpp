@@ -76,7 +76,7 @@ bool Poistaja::sumupoistaja(Tilikausi kausi)
 
     for( int i=0; i < kp()->tilit()->rowCount(QModelIndex()); i++)
     {
-        Tili tili = kp()->tilit()->tiliIndeksilla(i);
+        const Tili tili = kp()->tilit()->tiliIndeksilla(i);
         if( !tili.onko(TiliLaji::POISTETTAVA))
             continue;
 
@@ -22,6 +22,7 @@
 
 #include "tilinpaattaja.h"
 #include "db/kirjanpito.h"
+#include "db/saldotaulu.h"
 #include "tilinpaatoseditori/tilinpaatoseditori.h"
 
 #include "ui_tilinpaattaja.h"
@@ -135,6 +136,8 @@ void TilinPaattaja::lukitse()
 
     // Lukitaan tilikausi!
     kp()->asetukset()->aseta("TilitPaatetty", tilikausi.paattyy());
+    // Saldokyselyt lasketaan jatkossa tilinpäätöksen saldoista
+    SaldoTaulu::tallennaKuva( *kp()->tietokanta(), tilikausi.paattyy());
     // Laaditaan arkisto
     arkistosivu->teeArkisto(tilikausi);
 
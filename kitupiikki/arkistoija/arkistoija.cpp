@@ -102,9 +102,14 @@ void Arkistoija::arkistoiTositteet()
 
     QMap<QString,int> tositeLista;
 
-    QSqlQuery kysely( QString("SELECT id,tiliote, tunniste, laji FROM tosite WHERE pvm BETWEEN \"%1\" AND \"%2\" ")
+    // Arkistoitava kausi voi olla jo erotettu omaan osioonsa
+    QString tositteet = kp()->osiot()->taulu("tosite", tilikausi_.alkaa(), tilikausi_.paattyy());
+    QString viennit = kp()->osiot()->taulu("vienti", tilikausi_.alkaa(), tilikausi_.paattyy());
+
+    QSqlQuery kysely( QString("SELECT id,tiliote, tunniste, laji FROM %3 WHERE pvm BETWEEN \"%1\" AND \"%2\" ")
                       .arg(tilikausi_.alkaa().toString(Qt::ISODate))
-                      .arg(tilikausi_.paattyy().toString(Qt::ISODate)));
+                      .arg(tilikausi_.paattyy().toString(Qt::ISODate))
+                      .arg(tositteet));
 
 
 
@@ -140,10 +145,11 @@ void Arkistoija::arkistoiTositteet()
     }
     // Sitten lisätään vielä vientien mukaan, jotta kaikki varmasti mukana
 
-    kysely.exec(QString("SELECT tosite.id, tosite.tunniste, tosite.laji, tosite.pvm, eraid FROM vienti,tosite WHERE vienti.tosite=tosite.id "
+    kysely.exec(QString("SELECT tosite.id, tosite.tunniste, tosite.laji, tosite.pvm, eraid FROM %3,%4 WHERE vienti.tosite=tosite.id "
                 "AND vienti.pvm BETWEEN '%1' AND '%2'")
                 .arg(tilikausi_.alkaa().toString(Qt::ISODate))
-                .arg(tilikausi_.paattyy().toString(Qt::ISODate)));
+                .arg(tilikausi_.paattyy().toString(Qt::ISODate))
+                .arg(viennit).arg(tositteet));
 
     while( kysely.next())
     {
@@ -157,8 +163,10 @@ void Arkistoija::arkistoiTositteet()
         int taseEra = kysely.value("eraid").toInt();
         if( taseEra)
         {
-            QSqlQuery eraKysely(QString("SELECT tosite.id, tosite.tunniste, tosite.laji, tosite.pvm FROM vienti,tosite WHERE vienti.tosite=tosite.id "
-                        "AND vienti.id=%1").arg(taseEra)  );
+            QSqlQuery eraKysely(QString("SELECT tosite.id, tosite.tunniste, tosite.laji, tosite.pvm FROM %2,%3 WHERE vienti.tosite=tosite.id "
+                        "AND vienti.id=%1").arg(taseEra)
+                                        .arg(kp()->osiot()->taulu("vienti"))
+                                        .arg(kp()->osiot()->taulu("tosite")) );
             while( eraKysely.next())
             {
                 QString eratunnus = QString("%1%2/%3").arg( kp()->tositelajit()->tositelaji( eraKysely.value("tosite.laji").toInt() ).tunnus() )
@@ -281,10 +289,12 @@ void Arkistoija::arkistoiTositteet()
                     continue;
 
                 // Mahdollisen tase-erän seuranta
-                QSqlQuery eraKysely(QString("SELECT tosite.id, tosite.tunniste, tosite.laji, tosite.pvm, vienti.pvm, vienti.selite, vienti.debetsnt, vienti.kreditsnt FROM vienti,tosite WHERE vienti.tosite=tosite.id "
+                QSqlQuery eraKysely(QString("SELECT tosite.id, tosite.tunniste, tosite.laji, tosite.pvm, vienti.pvm, vienti.selite, vienti.debetsnt, vienti.kreditsnt FROM %3,%4 WHERE vienti.tosite=tosite.id "
                             "AND vienti.eraid=%1 AND vienti.pvm <= '%2' ORDER BY vienti.pvm")
                                     .arg( index.data(VientiModel::IdRooli).toInt() )
-                                    .arg( tilikausi_.paattyy().toString(Qt::ISODate))  );
+                                    .arg( tilikausi_.paattyy().toString(Qt::ISODate))
+                                    .arg( kp()->osiot()->taulu("vienti", QDate(), tilikausi_.paattyy()))
+                                    .arg( kp()->osiot()->taulu("tosite", QDate(), tilikausi_.paattyy())) );
 
                 qlonglong eraSaldo = 0;
 
@@ -355,7 +365,7 @@ void Arkistoija::arkistoiTositteet()
                 int eranid = index.data(VientiModel::EraIdRooli).toInt();
                 if( eranid )
                 {
-                    QSqlQuery kohdennusKysely(QString("SELECT tosite FROM vienti WHERE id=%1").arg(eranid));
+                    QSqlQuery kohdennusKysely(QString("SELECT tosite FROM %2 WHERE id=%1").arg(eranid).arg(kp()->osiot()->taulu("vienti")));
                     if( kohdennusKysely.next())
                         eranid = kohdennusKysely.value("tosite").toInt();
                 }
@@ -20,6 +20,7 @@
 #include <QDate>
 #include <QString>
 #include <QVariant>
+#include <QSet>
 
 #include <QMessageBox>
 #include <QSqlError>
@@ -60,6 +61,7 @@ void AsetusModel::aseta(const QString &avain, const QString &arvo)
     {
         asetukset_[avain] = arvo;
         muokatut_[avain] = nykyinen;
+        paivitaKuva(avain);
     }
     else
     {
@@ -76,14 +78,16 @@ void AsetusModel::poista(const QString &avain)
         QSqlQuery query(*tietokanta_);
         query.exec( QString("DELETE from asetus WHERE avain=\"%1\"").arg(avain));
         asetukset_.remove(avain);
+        paivitaKuva(avain);
     }
 }
 
 QDate AsetusModel::pvm(const QString &avain, const QDate oletus) const
 {
-    if( !asetukset_.contains(avain) )
+    auto iter = asetukset_.constFind(avain);
+    if( iter == asetukset_.constEnd() )
         return oletus;
-    return QDate::fromString( asetus(avain), Qt::ISODate );
+    return QDate::fromString( iter.value(), Qt::ISODate );
 }
 
 void AsetusModel::aseta(const QString& avain, const QDate &pvm)
@@ -93,10 +97,12 @@ void AsetusModel::aseta(const QString& avain, const QDate &pvm)
 
 bool AsetusModel::onko(const QString &avain) const
 {
-    if( !asetukset_.contains(avain)   ||  asetus(avain).isEmpty() || asetus(avain) == "0" || asetus(avain) == "EI")
+    auto iter = asetukset_.constFind(avain);
+    if( iter == asetukset_.constEnd() )
         return false;
-    else
-        return true;
+
+    const QString& arvo = iter.value();
+    return !( arvo.isEmpty() || arvo == "0" || arvo == "EI");
 }
 
 void AsetusModel::aseta(const QString &avain, bool totuusarvo)
@@ -146,8 +152,9 @@ void AsetusModel::aseta(const QString &avain, const QStringList &arvo)
 
 int AsetusModel::luku(const QString &avain, int oletusarvo) const
 {
-    if( asetukset_.contains(avain))
-        return asetukset_.value(avain).toInt();
+    auto iter = asetukset_.constFind(avain);
+    if( iter != asetukset_.constEnd())
+        return iter.value().toInt();
     else
         return oletusarvo;
 }
@@ -212,5 +219,31 @@ void AsetusModel::lataa()
         if( query.value(2).toDateTime().isValid())
             muokatut_[ query.value(0).toString()] = query.value(2).toDateTime();
     }
+    paivitaKuva();
+}
 
+void AsetusModel::tyhjenna()
+{
+    asetukset_.clear();
+    paivitaKuva();
+}
+
+void AsetusModel::paivitaKuva(const QString &avain)
+{
+    static const QSet<QString> kuvanAvaimet = { "AlvVelvollinen", "Samaansarjaan", "NaytaEdistyneet",
+                                                "AlvIlmoitus", "TilitPaatetty", "MaksuAlvAlkaa",
+                                                "MaksuAlvLoppuu", "AlvKausi" };
+    if( !avain.isEmpty() && !kuvanAvaimet.contains(avain))
+        return;
+
+    Asetuskuva kuva;
+    kuva.alvVelvollinen = onko("AlvVelvollinen");
+    kuva.samaanSarjaan = onko("Samaansarjaan");
+    kuva.naytaEdistyneet = onko("NaytaEdistyneet");
+    kuva.alvIlmoitus = pvm("AlvIlmoitus");
+    kuva.tilitPaatetty = pvm("TilitPaatetty");
+    kuva.maksuAlvAlkaa = pvm("MaksuAlvAlkaa");
+    kuva.maksuAlvLoppuu = pvm("MaksuAlvLoppuu");
+    kuva.alvKausi = luku("AlvKausi");
+    kuva_ = kuva;
 }
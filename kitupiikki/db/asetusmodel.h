@@ -22,6 +22,26 @@
 #include <QHash>
 #include <QSqlDatabase>
 #include <QDateTime>
+#include <QDate>
+
+/**
+ * @brief Usein luettujen asetusten valmiiksi tulkitut arvot
+ *
+ * AsetusModel päivittää kuvan, kun jotain näistä asetuksista muutetaan,
+ * joten arvoja voi lukea riveittäin toistuvissa silmukoissa ilman
+ * merkkijonohakua ja tulkintaa.
+ */
+struct Asetuskuva
+{
+    bool alvVelvollinen = false;
+    bool samaanSarjaan = false;
+    bool naytaEdistyneet = false;
+    QDate alvIlmoitus;
+    QDate tilitPaatetty;
+    QDate maksuAlvAlkaa;
+    QDate maksuAlvLoppuu;
+    int alvKausi = 0;
+};
 
 /**
  * @brief Asetusten käsittely
@@ -31,6 +51,8 @@
  *
  * Tyhjä arvo (tai nolla) tarkoittaa, että kyseinen asetus poistetaan
  *
+ * Yleisimmät asetukset saa valmiiksi tulkittuina kuva()-funktiolla.
+ *
  */
 class AsetusModel : public QObject
 {
@@ -88,14 +110,26 @@ public:
     void tilikarttaMoodiin(bool onko);
 
     void lataa();
-    void tyhjenna() { asetukset_.clear(); }
+    void tyhjenna();
+
+    /**
+     * @brief Yleisimmät asetukset valmiiksi tulkittuina
+     */
+    const Asetuskuva& kuva() const { return kuva_; }
 
 signals:
 
 
 
 protected:
+    /**
+     * @brief Päivittää asetuskuvan, jos avain kuuluu siihen
+     * @param avain Muuttunut avain, tyhjä päivittää aina
+     */
+    void paivitaKuva(const QString& avain = QString());
+
     QHash<QString,QString> asetukset_;
+    Asetuskuva kuva_;
     QHash<QString,QDateTime> muokatut_;
 
     QSqlDatabase *tietokanta_;
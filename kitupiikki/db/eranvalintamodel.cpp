@@ -87,12 +87,33 @@ void EranValintaModel::lataa(const Tili& tili, bool kaikki, QDate paivalle)
 
     QSqlQuery query( *(kp()->tietokanta()) ) ;
 
+    if( !paivalle.isValid())
+    {
+        // Nykyiset saldot ovat valmiina erätaulussa
+        query.exec(QString("SELECT era.id, era.pvm, selite, era.debetsnt, era.kreditsnt, era.tosite "
+                           "FROM era JOIN vienti ON vienti.id=era.id "
+                           "WHERE era.tili=%1 %2 ORDER BY era.pvm")
+                   .arg(tili.id())
+                   .arg( kaikki ? QString() : QString("AND era.debetsnt <> era.kreditsnt")));
+
+        while( query.next())
+        {
+            TaseEra era;
+            era.eraId = query.value(0).toInt();
+            era.pvm = query.value(1).toDate();
+            era.selite = query.value(2).toString();
+            era.saldoSnt = query.value(3).toLongLong() - query.value(4).toLongLong();
+            era.tositeId = query.value(5).toInt();
+            erat_.append(era);
+        }
+        endResetModel();
+        return;
+    }
+
     // avaimena eraid, arvona saldo (debet - kredit)
     QHash<int, qlonglong > saldot;
 
-    QString pvmehto;
-    if( paivalle.isValid())
-        pvmehto = QString("and pvm <= \"%1\" ").arg(paivalle.toString(Qt::ISODate));
+    QString pvmehto = QString("and pvm <= \"%1\" ").arg(paivalle.toString(Qt::ISODate));
 
     query.exec(QString("SELECT eraid, sum(debetsnt) as debetit, sum(kreditsnt) as kreditit from vienti "
                        "where tili=%1 and eraid is not null %2 group by eraid").arg(tili.id()).arg(pvmehto));
@@ -130,27 +151,18 @@ TaseEra::TaseEra(int id)
 {
     eraId = id;
 
-    // Jos id annetaan rakentajaan, hakee halutun erän tiedot
+    // Jos id annetaan rakentajaan, hakee halutun erän tiedot erätaulusta
     if(id)
     {
-        QSqlQuery query( *( kp()->tietokanta() ));
-        query.exec(QString("SELECT sum(debetsnt),sum(kreditsnt) from vienti "
-                           "where eraid=%1").arg(id ));
-        if( query.next() )
+        MitattuKysely& query = kp()->kysely("TaseEra");
+        query.bindValue(":era", id);
+        if( query.exec() && query.next() )
         {
-            saldoSnt = query.value(0).toLongLong();
-            saldoSnt -= query.value(1).toLongLong();
+            saldoSnt = query.value(0).toLongLong() - query.value(1).toLongLong();
+            pvm = query.value(2).toDate();
+            selite = query.value(3).toString();
+            tositeId = query.value(4).toInt();
         }
-
-        query.exec(QString("SELECT pvm, selite, tosite from vienti "
-                   "where id=%1").arg( id ));
-        if( query.next())
-        {
-            pvm = query.value("pvm").toDate();
-            selite = query.value("selite").toString();
-            tositeId = query.value("tosite").toInt();
-        }
-
     }
 }
 
@@ -158,8 +170,9 @@ QString TaseEra::tositteenTunniste()
 {
     if(eraId)
     {
-        QSqlQuery query(QString("select tositelaji.tunnus, tosite.tunniste from tositelaji,tosite WHERE tosite.id=%1 and tosite.laji=tositelaji.id").arg(tositeId));
-        if( query.next())
+        MitattuKysely& query = kp()->kysely("TositteenTunniste");
+        query.bindValue(":tosite", tositeId);
+        if( query.exec() && query.next())
         {
             return QString("%1%2/%3").arg( query.value(0).toString() )
                     .arg( query.value(1).toInt())
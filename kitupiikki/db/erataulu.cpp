@@ -0,0 +1,160 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "erataulu.h"
+#include "kirjanpito.h"
+
+#include <QSqlQuery>
+#include <QStringList>
+
+bool EraTaulu::alusta(QSqlDatabase &tietokanta)
+{
+    bool uusi = !tietokanta.tables().contains("era");
+
+    QSqlQuery kysely(tietokanta);
+
+    // Erän otsikkotiedot (tili, pvm, tosite) tulevat viennistä, jolla id = eraid.
+    // Jos erän avaava vienti poistetaan eikä erällä ole enää saldoa, erä poistuu.
+    QStringList luonti;
+    luonti << "CREATE TABLE IF NOT EXISTS era ("
+              "id        INTEGER PRIMARY KEY,"
+              "tili      INTEGER,"
+              "pvm       DATE,"
+              "tosite    INTEGER,"
+              "debetsnt  BIGINT  NOT NULL DEFAULT 0,"
+              "kreditsnt BIGINT  NOT NULL DEFAULT 0 )"
+
+           << "CREATE INDEX IF NOT EXISTS era_tili_index ON era(tili, pvm)"
+
+           << "CREATE TRIGGER IF NOT EXISTS era_vienti_lisays AFTER INSERT ON vienti "
+              "WHEN NEW.eraid IS NOT NULL "
+              "BEGIN "
+              "INSERT OR IGNORE INTO era(id) VALUES (NEW.eraid); "
+              "UPDATE era SET debetsnt = debetsnt + IFNULL(NEW.debetsnt,0), "
+              "kreditsnt = kreditsnt + IFNULL(NEW.kreditsnt,0) "
+              "WHERE id = NEW.eraid; "
+              "UPDATE era SET tili = NEW.tili, pvm = NEW.pvm, tosite = NEW.tosite "
+              "WHERE id = NEW.id AND NEW.eraid = NEW.id; "
+              "END"
+
+           << "CREATE TRIGGER IF NOT EXISTS era_vienti_poisto AFTER DELETE ON vienti "
+              "WHEN OLD.eraid IS NOT NULL "
+              "BEGIN "
+              "UPDATE era SET debetsnt = debetsnt - IFNULL(OLD.debetsnt,0), "
+              "kreditsnt = kreditsnt - IFNULL(OLD.kreditsnt,0) "
+              "WHERE id = OLD.eraid; "
+              "UPDATE era SET tili = NULL, pvm = NULL, tosite = NULL "
+              "WHERE id = OLD.id; "
+              "DELETE FROM era WHERE id = OLD.eraid AND tili IS NULL "
+              "AND debetsnt = 0 AND kreditsnt = 0; "
+              "END"
+
+           << "CREATE TRIGGER IF NOT EXISTS era_vienti_muutos "
+              "AFTER UPDATE OF eraid, tili, pvm, tosite, debetsnt, kreditsnt ON vienti "
+              "WHEN OLD.eraid IS NOT NULL OR NEW.eraid IS NOT NULL "
+              "BEGIN "
+              "UPDATE era SET debetsnt = debetsnt - IFNULL(OLD.debetsnt,0), "
+              "kreditsnt = kreditsnt - IFNULL(OLD.kreditsnt,0) "
+              "WHERE id = OLD.eraid; "
+              "UPDATE era SET tili = NULL, pvm = NULL, tosite = NULL "
+              "WHERE id = OLD.id AND OLD.eraid = OLD.id; "
+              "INSERT OR IGNORE INTO era(id) SELECT NEW.eraid WHERE NEW.eraid IS NOT NULL; "
+              "UPDATE era SET debetsnt = debetsnt + IFNULL(NEW.debetsnt,0), "
+              "kreditsnt = kreditsnt + IFNULL(NEW.kreditsnt,0) "
+              "WHERE id = NEW.eraid; "
+              "UPDATE era SET tili = NEW.tili, pvm = NEW.pvm, tosite = NEW.tosite "
+              "WHERE id = NEW.id AND NEW.eraid = NEW.id; "
+              "DELETE FROM era WHERE id = OLD.eraid AND tili IS NULL "
+              "AND debetsnt = 0 AND kreditsnt = 0; "
+              "END";
+
+    for( const QString& lause : luonti)
+    {
+        if( !kysely.exec(lause) )
+        {
+            kp()->lokiin(kysely);
+            return false;
+        }
+    }
+
+    if( uusi )
+        return rakenna(tietokanta);
+    return true;
+}
+
+bool EraTaulu::rakenna(QSqlDatabase &tietokanta)
+{
+    // Erissä ovat mukana myös päätettyjen kausien osiot
+    QString viennit = kp()->osiot()->taulu("vienti");
+
+    tietokanta.transaction();
+    QSqlQuery kysely(tietokanta);
+
+    if( !kysely.exec("DELETE FROM era") ||
+        !kysely.exec(QString("INSERT INTO era(id, debetsnt, kreditsnt) "
+                     "SELECT eraid, SUM(IFNULL(debetsnt,0)), SUM(IFNULL(kreditsnt,0)) "
+                     "FROM %1 WHERE eraid IS NOT NULL GROUP BY eraid").arg(viennit)) ||
+        !kysely.exec(QString("UPDATE era SET "
+                     "tili = (SELECT tili FROM %1 WHERE vienti.id = era.id AND vienti.eraid = era.id), "
+                     "pvm = (SELECT pvm FROM %1 WHERE vienti.id = era.id AND vienti.eraid = era.id), "
+                     "tosite = (SELECT tosite FROM %1 WHERE vienti.id = era.id AND vienti.eraid = era.id)").arg(viennit)) ||
+        !kysely.exec("DELETE FROM era WHERE tili IS NULL AND debetsnt = 0 AND kreditsnt = 0"))
+    {
+        kp()->lokiin(kysely);
+        tietokanta.rollback();
+        return false;
+    }
+
+    return tietokanta.commit();
+}
+
+int EraTaulu::tarkasta(QSqlDatabase &tietokanta)
+{
+    QString viennit = kp()->osiot()->taulu("vienti");
+    QString vienneista = QString("SELECT eraid, SUM(IFNULL(debetsnt,0)), SUM(IFNULL(kreditsnt,0)) "
+                       "FROM %1 WHERE eraid IS NOT NULL GROUP BY eraid "
+                       "HAVING SUM(IFNULL(debetsnt,0)) <> 0 OR SUM(IFNULL(kreditsnt,0)) <> 0").arg(viennit);
+    QString erista("SELECT id, debetsnt, kreditsnt FROM era "
+                   "WHERE debetsnt <> 0 OR kreditsnt <> 0");
+
+    QSqlQuery kysely(tietokanta);
+    if( !kysely.exec(QString("SELECT COUNT(*) FROM (%1 EXCEPT %2) ").arg(vienneista).arg(erista)) || !kysely.next())
+    {
+        kp()->lokiin(kysely);
+        return -1;
+    }
+    int virheita = kysely.value(0).toInt();
+
+    if( !kysely.exec(QString("SELECT COUNT(*) FROM (%2 EXCEPT %1) ").arg(vienneista).arg(erista)) || !kysely.next())
+    {
+        kp()->lokiin(kysely);
+        return -1;
+    }
+    virheita += kysely.value(0).toInt();
+
+    // Avaavan viennin tiedot
+    if( !kysely.exec(QString("SELECT COUNT(*) FROM %1 LEFT OUTER JOIN era ON era.id=vienti.id "
+                     "WHERE vienti.eraid = vienti.id AND "
+                     "(era.id IS NULL OR era.tili IS NOT vienti.tili OR era.pvm IS NOT vienti.pvm "
+                     "OR era.tosite IS NOT vienti.tosite)").arg(viennit)) || !kysely.next())
+    {
+        kp()->lokiin(kysely);
+        return -1;
+    }
+
+    return virheita + kysely.value(0).toInt();
+}
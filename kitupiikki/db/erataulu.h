@@ -0,0 +1,62 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ERATAULU_H
+#define ERATAULU_H
+
+#include <QSqlDatabase>
+
+/**
+ * @brief Tase-erien saldojen taulu
+ *
+ * Taulussa era on jokaiselle tase-erälle (vienti.eraid) erän viennien
+ * debet- ja kreditsummat sekä erän avaavan viennin tili, päivämäärä ja
+ * tosite. Erän id on sen avaavan viennin id.
+ *
+ * Taulua ylläpidetään SaldoTaulun tapaan vienti-taulun triggereillä
+ * aina, kun tase-erään kuuluva vienti tallennetaan tai poistetaan.
+ *
+ */
+class EraTaulu
+{
+public:
+    /**
+     * @brief Luo erätaulun ja triggerit, ellei niitä vielä ole
+     *
+     * Jos taulu luodaan, lasketaan erät olemassa olevista vienneistä.
+     *
+     * @param tietokanta
+     * @return tosi, jos onnistui
+     */
+    static bool alusta(QSqlDatabase &tietokanta);
+
+    /**
+     * @brief Laskee erätaulun kokonaan uudelleen vienneistä
+     * @param tietokanta
+     * @return tosi, jos onnistui
+     */
+    static bool rakenna(QSqlDatabase &tietokanta);
+
+    /**
+     * @brief Vertaa erätaulua vienteihin
+     * @param tietokanta
+     * @return Virheellisten erien määrä, -1 jos tarkastus epäonnistui
+     */
+    static int tarkasta(QSqlDatabase &tietokanta);
+};
+
+#endif // ERATAULU_H
@@ -0,0 +1,192 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "hakuindeksi.h"
+#include "kirjanpito.h"
+
+#include <QSqlQuery>
+#include <QStringList>
+#include <QRegularExpression>
+
+bool HakuIndeksi::kaytossa__ = false;
+
+bool HakuIndeksi::alusta(QSqlDatabase &tietokanta)
+{
+    kaytossa__ = false;
+    QSqlQuery kysely(tietokanta);
+
+    // Kaikissa SQLite-käännöksissä ei ole FTS5:tä. Silloin aiemmin luodun
+    // indeksin triggerit poistetaan, koska ne estäisivät tositteiden ja
+    // vientien tallentamisen ("no such module: fts5").
+    if( !kysely.exec("CREATE VIRTUAL TABLE temp.hakusana_koe USING fts5(teksti)"))
+    {
+        for( const QString& triggeri : QStringList() << "tosite_lisays" << "tosite_muutos" << "tosite_poisto"
+                                                      << "vienti_lisays" << "vienti_muutos" << "vienti_poisto")
+        {
+            if( !kysely.exec( QString("DROP TRIGGER IF EXISTS hakusana_%1").arg(triggeri)))
+                kp()->lokiin(kysely);
+        }
+        return false;
+    }
+    kysely.exec("DROP TABLE temp.hakusana_koe");
+
+    // Indeksi täytetään, kun se luodaan tai kun sitä ei ole päivitetty
+    // triggereiden puuttuessa
+    bool uusi = !tietokanta.tables().contains("hakusana") ||
+            !kysely.exec("SELECT COUNT(*) FROM sqlite_master WHERE type='trigger' "
+                         "AND name LIKE 'hakusana\\_%' ESCAPE '\\'") ||
+            !kysely.next() || kysely.value(0).toInt() < 6;
+
+    // Triggerit sisältävät puolipisteitä, joten niitä ei voi
+    // pitää luo.sql:ssä
+    QStringList luonti;
+    luonti << "CREATE VIRTUAL TABLE IF NOT EXISTS hakusana USING fts5("
+              "otsikko, kommentti, selite, asiakas, viite, tosite UNINDEXED, "
+              "prefix='2 3')"
+
+           << "CREATE TRIGGER IF NOT EXISTS hakusana_tosite_lisays AFTER INSERT ON tosite "
+              "BEGIN "
+              "INSERT INTO hakusana(rowid, otsikko, kommentti, tosite) "
+              "VALUES (-NEW.id, NEW.otsikko, NEW.kommentti, NEW.id); "
+              "END"
+
+           << "CREATE TRIGGER IF NOT EXISTS hakusana_tosite_muutos AFTER UPDATE OF otsikko, kommentti ON tosite "
+              "BEGIN "
+              "DELETE FROM hakusana WHERE rowid = -OLD.id; "
+              "INSERT INTO hakusana(rowid, otsikko, kommentti, tosite) "
+              "VALUES (-NEW.id, NEW.otsikko, NEW.kommentti, NEW.id); "
+              "END"
+
+           << "CREATE TRIGGER IF NOT EXISTS hakusana_tosite_poisto AFTER DELETE ON tosite "
+              "BEGIN "
+              "DELETE FROM hakusana WHERE rowid = -OLD.id; "
+              "END"
+
+           // Vienneistä indeksoidaan vain ne, joilla on haettavaa tekstiä
+           << "CREATE TRIGGER IF NOT EXISTS hakusana_vienti_lisays AFTER INSERT ON vienti "
+              "WHEN COALESCE(NEW.selite, NEW.asiakas, NEW.viite) IS NOT NULL "
+              "BEGIN "
+              "INSERT INTO hakusana(rowid, selite, asiakas, viite, tosite) "
+              "VALUES (NEW.id, NEW.selite, NEW.asiakas, NEW.viite, NEW.tosite); "
+              "END"
+
+           << "CREATE TRIGGER IF NOT EXISTS hakusana_vienti_muutos "
+              "AFTER UPDATE OF selite, asiakas, viite, tosite ON vienti "
+              "BEGIN "
+              "DELETE FROM hakusana WHERE rowid = OLD.id; "
+              "INSERT INTO hakusana(rowid, selite, asiakas, viite, tosite) "
+              "SELECT NEW.id, NEW.selite, NEW.asiakas, NEW.viite, NEW.tosite "
+              "WHERE COALESCE(NEW.selite, NEW.asiakas, NEW.viite) IS NOT NULL; "
+              "END"
+
+           << "CREATE TRIGGER IF NOT EXISTS hakusana_vienti_poisto AFTER DELETE ON vienti "
+              "BEGIN "
+              "DELETE FROM hakusana WHERE rowid = OLD.id; "
+              "END";
+
+    for( const QString& lause : luonti)
+    {
+        if( !kysely.exec(lause) )
+        {
+            kp()->lokiin(kysely);
+            return false;
+        }
+    }
+    kaytossa__ = true;
+
+    if( uusi )
+        return rakenna(tietokanta);
+    return true;
+}
+
+bool HakuIndeksi::rakenna(QSqlDatabase &tietokanta)
+{
+    // Indeksiin otetaan myös päätettyjen kausien osiot
+    tietokanta.transaction();
+    QSqlQuery kysely(tietokanta);
+
+    if( !kysely.exec("DELETE FROM hakusana") ||
+        !kysely.exec(QString("INSERT INTO hakusana(rowid, otsikko, kommentti, tosite) "
+                             "SELECT -id, otsikko, kommentti, id FROM %1")
+                     .arg( kp()->osiot()->taulu("tosite"))) ||
+        !kysely.exec(QString("INSERT INTO hakusana(rowid, selite, asiakas, viite, tosite) "
+                             "SELECT id, selite, asiakas, viite, tosite FROM %1 "
+                             "WHERE COALESCE(selite, asiakas, viite) IS NOT NULL")
+                     .arg( kp()->osiot()->taulu("vienti"))))
+    {
+        kp()->lokiin(kysely);
+        tietokanta.rollback();
+        return false;
+    }
+    return tietokanta.commit();
+}
+
+QString HakuIndeksi::lauseke(const QString &teksti, const QString &sarake, bool alussa)
+{
+    // Sanat lainausmerkkeihin, jotta FTS5:n operaattoreita ei tulkita
+    QStringList sanat = teksti.split( QRegularExpression("\\s+"), QString::SkipEmptyParts);
+    if( sanat.isEmpty())
+        return QString();
+    for( QString& sana : sanat)
+        sana.replace('"', "\"\"");
+
+    // Sarakkeen alusta haettaessa sanat ovat yksi fraasi
+    QString haku = alussa ? QString("^ \"%1\"*").arg( sanat.join(' '))
+                          : QString("\"%1\"*").arg( sanat.join("\"* \""));
+    if( !sarake.isEmpty())
+        haku = QString("%1 : %2").arg(sarake).arg(haku);
+    return haku;
+}
+
+QList<HakuIndeksi::Osuma> HakuIndeksi::hae(QSqlDatabase &tietokanta, const QString &teksti, int enintaan)
+{
+    QList<Osuma> osumat;
+    QString haku = lauseke(teksti);
+    if( !kaytossa() || haku.isEmpty())
+        return osumat;
+
+    // Kullekin tositteelle otetaan sen osuvin rivi
+    QSqlQuery kysely(tietokanta);
+    kysely.prepare(QString("SELECT haku.tosite, tosite.pvm, tosite.otsikko, haku.osuma FROM "
+                           "(SELECT tosite, MIN(sija) AS sija, osuma FROM "
+                           "(SELECT tosite, rank AS sija, snippet(hakusana, -1, '', '', '…', 8) AS osuma "
+                           "FROM hakusana WHERE hakusana MATCH :haku ORDER BY rank LIMIT %1) "
+                           "GROUP BY tosite) AS haku "
+                           "JOIN %2 ON tosite.id = haku.tosite "
+                           "ORDER BY haku.sija LIMIT %3")
+                   .arg( enintaan * 4)
+                   .arg( kp()->osiot()->taulu("tosite"))
+                   .arg( enintaan ));
+    kysely.bindValue(":haku", haku);
+
+    if( !kysely.exec())
+    {
+        kp()->lokiin(kysely);
+        return osumat;
+    }
+
+    while( kysely.next())
+    {
+        Osuma osuma;
+        osuma.tosite = kysely.value(0).toInt();
+        osuma.pvm = kysely.value(1).toDate();
+        osuma.otsikko = kysely.value(2).toString();
+        osuma.osuma = kysely.value(3).toString();
+        osumat.append(osuma);
+    }
+    return osumat;
+}
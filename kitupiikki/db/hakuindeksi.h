@@ -0,0 +1,88 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HAKUINDEKSI_H
+#define HAKUINDEKSI_H
+
+#include <QDate>
+#include <QList>
+#include <QSqlDatabase>
+
+/**
+ * @brief Tositteiden ja vientien tekstihaun FTS5-indeksi
+ *
+ * Virtuaalitauluun hakusana kerätään tositteiden otsikot ja kommentit
+ * sekä vientien selitteet, asiakkaat ja viitenumerot. Tositteen rivin
+ * rowid on -tosite.id ja vientin rivin vienti.id, joten triggerit
+ * löytävät muutettavan rivin suoraan.
+ *
+ * Indeksi on päätiedostossa koko historialta, joten haku kattaa myös
+ * osioihin siirretyt tilikaudet (ks. KausiOsiot).
+ *
+ * Jos SQLite on käännetty ilman FTS5:tä, indeksiä ei luoda ja haku
+ * ei ole käytössä.
+ */
+class HakuIndeksi
+{
+public:
+    struct Osuma
+    {
+        int tosite;
+        QDate pvm;
+        QString otsikko;
+        QString osuma;
+    };
+
+    /**
+     * @brief Luo indeksin ja triggerit, ellei niitä vielä ole
+     *
+     * Jos indeksi luodaan, se täytetään olemassa olevista tositteista.
+     * Jos SQLitessä ei ole FTS5:tä, haku ei ole käytössä ja indeksin
+     * triggerit poistetaan.
+     *
+     * @return tosi, jos haku on käytössä
+     */
+    static bool alusta(QSqlDatabase& tietokanta);
+
+    /**
+     * @brief Täyttää indeksin uudelleen tositteista ja vienneistä
+     */
+    static bool rakenna(QSqlDatabase& tietokanta);
+
+    static bool kaytossa() { return kaytossa__; }
+
+    /**
+     * @brief Muodostaa käyttäjän tekstistä FTS5-hakulausekkeen
+     *
+     * Kunkin sanan alulla haetaan, ja kaikkien sanojen on löydyttävä.
+     *
+     * @param sarake Jos annettu, haetaan vain tästä sarakkeesta
+     * @param alussa Jos tosi, tekstin on oltava sarakkeen alussa
+     */
+    static QString lauseke(const QString& teksti, const QString& sarake = QString(), bool alussa = false);
+
+    /**
+     * @brief Hakee tositteet osuvuusjärjestyksessä
+     * @param enintaan Palautettavien tositteiden enimmäismäärä
+     */
+    static QList<Osuma> hae(QSqlDatabase& tietokanta, const QString& teksti, int enintaan = 50);
+
+protected:
+    static bool kaytossa__;
+};
+
+#endif // HAKUINDEKSI_H
@@ -21,8 +21,15 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 
+#include <QCborValue>
+#include <QCborMap>
+#include <QCborStreamReader>
+#include <QMutexLocker>
+
 #include <QDebug>
 
+bool JsonKentta::binaari__ = false;
+
 JsonKentta::JsonKentta() : muokattu_(false)
 {
 
@@ -33,8 +40,40 @@ JsonKentta::JsonKentta(const QByteArray &json) : muokattu_(false)
     fromJson(json);
 }
 
+JsonKentta::JsonKentta(const JsonKentta &toinen)
+{
+    QMutexLocker lukitsin(&toinen.mutex_);
+    map_ = toinen.map_;
+    raaka_ = toinen.raaka_;
+    haetut_ = toinen.haetut_;
+    muokattu_ = toinen.muokattu_;
+}
+
+JsonKentta &JsonKentta::operator=(const JsonKentta &toinen)
+{
+    if( this == &toinen)
+        return *this;
+
+    // Kopioidaan ensin, jotta kumpaakin mutexia ei pidetä yhtä aikaa
+    QMutexLocker lukitsin(&toinen.mutex_);
+    QVariantMap map = toinen.map_;
+    QByteArray raaka = toinen.raaka_;
+    QHash<QString,QVariant> haetut = toinen.haetut_;
+    bool muokattu = toinen.muokattu_;
+    lukitsin.unlock();
+
+    QMutexLocker omaLukitsin(&mutex_);
+    map_ = map;
+    raaka_ = raaka;
+    haetut_ = haetut;
+    muokattu_ = muokattu;
+    return *this;
+}
+
 void JsonKentta::set(const QString &avain, const QString &arvo)
 {
+    QMutexLocker lukitsin(&mutex_);
+    pura();
     if( arvo != map_.value(avain).toString())
     {
         if( arvo.isEmpty())
@@ -47,6 +86,8 @@ void JsonKentta::set(const QString &avain, const QString &arvo)
 
 void JsonKentta::set(const QString &avain, const QDate &pvm)
 {
+    QMutexLocker lukitsin(&mutex_);
+    pura();
     if( pvm != QDate::fromString(map_.value(avain).toString(), Qt::ISODate))
     {
         map_[avain] = QVariant(pvm.toString(Qt::ISODate));
@@ -56,6 +97,8 @@ void JsonKentta::set(const QString &avain, const QDate &pvm)
 
 void JsonKentta::set(const QString &avain, int arvo)
 {
+    QMutexLocker lukitsin(&mutex_);
+    pura();
     if( map_.value(avain).toInt() != arvo )
     {
         map_[avain] = QVariant(arvo);
@@ -65,6 +108,8 @@ void JsonKentta::set(const QString &avain, int arvo)
 
 void JsonKentta::set(const QString &avain, qulonglong arvo)
 {
+    QMutexLocker lukitsin(&mutex_);
+    pura();
     if( map_.value(avain).toULongLong() != arvo )
     {
         map_[avain] = QVariant(arvo);
@@ -74,6 +119,8 @@ void JsonKentta::set(const QString &avain, qulonglong arvo)
 
 void JsonKentta::set(const QString &avain, qlonglong arvo)
 {
+    QMutexLocker lukitsin(&mutex_);
+    pura();
     if( map_.value(avain).toLongLong() != arvo )
     {
         map_[avain] = QVariant(arvo);
@@ -83,6 +130,8 @@ void JsonKentta::set(const QString &avain, qlonglong arvo)
 
 void JsonKentta::unset(const QString &avain)
 {
+    QMutexLocker lukitsin(&mutex_);
+    pura();
     if( map_.contains(avain))
     {
         map_.remove(avain);
@@ -92,6 +141,8 @@ void JsonKentta::unset(const QString &avain)
 
 void JsonKentta::setVar(const QString &avain, const QVariant &arvo)
 {
+    QMutexLocker lukitsin(&mutex_);
+    pura();
     if( map_.value(avain) != arvo)
     {
         map_[avain] = arvo;
@@ -99,54 +150,152 @@ void JsonKentta::setVar(const QString &avain, const QVariant &arvo)
     }
 }
 
-QString JsonKentta::str(const QString &avain)
+QString JsonKentta::str(const QString &avain) const
 {
-    return map_.value(avain).toString();
+    return arvo(avain).toString();
 }
 
-QDate JsonKentta::date(const QString &avain)
+QDate JsonKentta::date(const QString &avain) const
 {
-    return QDate::fromString( map_.value(avain).toString() , Qt::ISODate);
+    return QDate::fromString( arvo(avain).toString() , Qt::ISODate);
 }
 
-int JsonKentta::luku(const QString &avain, int oletus)
+int JsonKentta::luku(const QString &avain, int oletus) const
 {
-    return map_.value(avain, QString::number(oletus) ).toInt();
+    QVariant var = arvo(avain);
+    return var.isValid() ? var.toInt() : oletus;
 }
 
-qlonglong JsonKentta::pitkaluku(QString &avain)
+qlonglong JsonKentta::pitkaluku(QString &avain) const
 {
-    return map_.value(avain).toLongLong();
+    return arvo(avain).toLongLong();
 }
 
-qulonglong JsonKentta::isoluku(const QString &avain)
+qulonglong JsonKentta::isoluku(const QString &avain) const
 {
-    return map_.value(avain).toULongLong();
+    return arvo(avain).toULongLong();
 }
 
-QVariant JsonKentta::variant(const QString &avain)
+QVariant JsonKentta::variant(const QString &avain) const
 {
-    return map_.value(avain);
+    return arvo(avain);
 }
 
-QByteArray JsonKentta::toJson()
+QStringList JsonKentta::avaimet() const
 {
+    QMutexLocker lukitsin(&mutex_);
+    pura();
+    return map_.keys();
+}
+
+QByteArray JsonKentta::toJson() const
+{
+    QMutexLocker lukitsin(&mutex_);
+    pura();
     QJsonDocument doc( QJsonObject::fromVariantMap( map_ ));
     return doc.toJson( QJsonDocument::Compact);
 }
 
 QVariant JsonKentta::toSqlJson()
 {
+    QMutexLocker lukitsin(&mutex_);
     muokattu_ = false;
-    if( map_.count())
-        return QVariant( toJson() );
-    else
+
+    // Muokkaamaton kenttä, joka on jo oikeassa muodossa, tallennetaan sellaisenaan
+    if( !raaka_.isEmpty() && onkoCbor(raaka_) == binaarimuoto() )
+        return QVariant( raaka_ );
+
+    pura();
+    if( map_.isEmpty())
         return QVariant();
+    else if( binaarimuoto() )
+        return QVariant( toCbor() );
+    else
+        return QVariant( QJsonDocument( QJsonObject::fromVariantMap(map_)).toJson(QJsonDocument::Compact) );
 }
 
 void JsonKentta::fromJson(const QByteArray &json)
 {
-    QJsonDocument doc = QJsonDocument::fromJson( json );
-    map_ = doc.object().toVariantMap();
+    // Purkaminen tehdään vasta, kun kenttää tarvitaan
+    QMutexLocker lukitsin(&mutex_);
+    map_.clear();
+    haetut_.clear();
+    raaka_ = json;
     muokattu_ = false;
 }
+
+bool JsonKentta::onkoCbor(const QByteArray &data)
+{
+    // CBOR-kentät alkavat itsensä kuvaavalla tagilla 55799,
+    // json-kentät aaltosulkeella
+    return data.startsWith("\xD9\xD9\xF7");
+}
+
+void JsonKentta::pura() const
+{
+    if( raaka_.isEmpty())
+        return;
+
+    if( onkoCbor(raaka_))
+        map_ = QCborValue::fromCbor(raaka_).taggedValue().toMap().toVariantMap();
+    else
+    {
+        QJsonDocument doc = QJsonDocument::fromJson( raaka_ );
+        map_ = doc.object().toVariantMap();
+    }
+    raaka_.clear();
+    haetut_.clear();
+}
+
+QVariant JsonKentta::arvo(const QString &avain) const
+{
+    QMutexLocker lukitsin(&mutex_);
+    if( raaka_.isEmpty())
+        return map_.value(avain);
+
+    if( onkoCbor(raaka_))
+    {
+        if( haetut_.contains(avain))
+            return haetut_.value(avain);
+
+        // Käydään avaimet läpi ja puretaan vain haetun avaimen arvo
+        QCborStreamReader lukija( raaka_.constData() + 3, raaka_.size() - 3);
+        if( lukija.isMap() && lukija.enterContainer())
+        {
+            while( lukija.hasNext() && lukija.isString())
+            {
+                QString nimi;
+                auto osa = lukija.readString();
+                while( osa.status == QCborStreamReader::Ok)
+                {
+                    nimi.append( osa.data );
+                    osa = lukija.readString();
+                }
+                if( osa.status == QCborStreamReader::Error)
+                    break;
+
+                if( nimi == avain)
+                {
+                    QVariant tulos = QCborValue::fromCbor(lukija).toVariant();
+                    haetut_.insert(avain, tulos);
+                    return tulos;
+                }
+                lukija.next();
+            }
+            if( !lukija.hasNext() && lukija.lastError() == QCborError::NoError)
+            {
+                haetut_.insert(avain, QVariant());
+                return QVariant();
+            }
+        }
+    }
+    // Json tai virheellinen CBOR puretaan kokonaan
+    pura();
+    return map_.value(avain);
+}
+
+QByteArray JsonKentta::toCbor() const
+{
+    QCborValue cbor( QCborKnownTags::Signature, QCborMap::fromVariantMap(map_) );
+    return cbor.toCbor();
+}
@@ -21,6 +21,8 @@
 #include <QDate>
 #include <QMap>
 #include <QVariant>
+#include <QHash>
+#include <QMutex>
 
 /**
  * @brief json-muotoisten kenttien käsittely
@@ -28,12 +30,24 @@
  * Laajennettavuutta ja yksinkertaisempaa tietokantaa silmällä pitäen käytetään
  * json-muotoisia kenttiä, joita käsitellään tämän luokan kautta
  *
+ * Kentät voidaan tallentaa myös binäärisenä CBOR-muotona (asetus JsonCbor).
+ * Luettaessa tunnistetaan kumpikin muoto. CBOR-muotoisesta kentästä puretaan
+ * vain ne avaimet, joita kysytään; koko kenttä puretaan vasta, kun sitä
+ * muokataan tai tarvitaan kokonaan. Tallennettaessa kenttä kirjoitetaan aina
+ * valittuun muotoon, joten vanhat json-kentät muuttuvat vähitellen.
+ *
+ * Purettuja arvoja kirjoitetaan välimuistiin myös const-funktioista, ja
+ * jaetut tiedot (esim. TiliData) luetaan myös taustasäikeistä, joten
+ * välimuistia käsitellään aina mutex_:in suojaamana.
+ *
  */
 class JsonKentta
 {
 public:
     JsonKentta();
     JsonKentta(const QByteArray &json);
+    JsonKentta(const JsonKentta& toinen);
+    JsonKentta& operator=(const JsonKentta& toinen);
 
     void set(const QString& avain, const QString& arvo);
     void set(const QString& avain, const QDate& pvm);
@@ -43,15 +57,15 @@ public:
     void unset(const QString &avain);
     void setVar(const QString& avain, const QVariant& arvo);
 
-    QString str(const QString& avain);
-    QDate date(const QString& avain);
-    int luku(const QString& avain, int oletus = 0);
-    qlonglong pitkaluku(QString& avain);
-    qulonglong isoluku(const QString& avain);
-    QVariant variant(const QString& avain);
-    QStringList avaimet() const { return map_.keys(); }
+    QString str(const QString& avain) const;
+    QDate date(const QString& avain) const;
+    int luku(const QString& avain, int oletus = 0) const;
+    qlonglong pitkaluku(QString& avain) const;
+    qulonglong isoluku(const QString& avain) const;
+    QVariant variant(const QString& avain) const;
+    QStringList avaimet() const;
 
-    QByteArray toJson();
+    QByteArray toJson() const;
     QVariant toSqlJson();
     void fromJson(const QByteArray& json);
 
@@ -65,9 +79,43 @@ public:
      */
     bool onkoMuokattu() const { return muokattu_; }
 
+    /**
+     * @brief Tallennetaanko kentät CBOR-muodossa
+     */
+    static void asetaBinaarimuoto(bool binaari) { binaari__ = binaari; }
+    static bool binaarimuoto() { return binaari__; }
+
+    /**
+     * @brief Onko tietokannasta luettu arvo CBOR-muotoinen
+     */
+    static bool onkoCbor(const QByteArray& data);
+
 protected:
-    QVariantMap map_;
+    /**
+     * @brief Purkaa koko kentän map_:iin
+     *
+     * Kutsujan on lukittava mutex_
+     */
+    void pura() const;
+    /**
+     * @brief Hakee avaimen arvon purkamatta koko kenttää
+     */
+    QVariant arvo(const QString& avain) const;
+    QByteArray toCbor() const;
+
+    mutable QVariantMap map_;
+    /**
+     * @brief Tietokannasta luettu, vielä purkamaton kenttä
+     */
+    mutable QByteArray raaka_;
+    /**
+     * @brief Purkamattomasta kentästä jo haetut avaimet
+     */
+    mutable QHash<QString,QVariant> haetut_;
     bool muokattu_;
+    mutable QMutex mutex_;
+
+    static bool binaari__;
 };
 
 #endif // JSONKENTTA_H
@@ -0,0 +1,351 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "kausiosiot.h"
+#include "kirjanpito.h"
+#include "tilikausi.h"
+
+#include <QSqlQuery>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QUrl>
+#include <QRegularExpression>
+
+// Sama kuin luo.sql:n vientivw, mutta viennit ja tositteet osioista
+static const char* VIENTINAKYMA =
+        "(SELECT vienti.id as vientiId, vienti.pvm as pvm, vienti.debetsnt as debetsnt, "
+        "vienti.kreditsnt as kreditsnt, vienti.selite as selite, vienti.kohdennus as kohdennusId, "
+        "vienti.eraid as eraid, kohdennus.nimi as kohdennus, tositelaji.tunnus as tositelaji, "
+        "tosite.tunniste as tunniste, tosite.id as tositeId, tositelaji.id as tositelajiId, "
+        "tili.nro as tilinro, tili.nimi as tilinimi, tili.tyyppi as tilityyppi "
+        "FROM %1, %2, tili, tositelaji, kohdennus "
+        "WHERE vienti.tosite = tosite.id AND vienti.tili = tili.id AND "
+        "tosite.laji = tositelaji.id AND vienti.kohdennus = kohdennus.id) AS vientivw";
+
+KausiOsiot::KausiOsiot()
+{
+
+}
+
+bool KausiOsiot::alusta(QSqlDatabase &tietokanta)
+{
+    QSqlQuery kysely(tietokanta);
+    if( !kysely.exec("CREATE TABLE IF NOT EXISTS osio ("
+                     "skeema   TEXT NOT NULL PRIMARY KEY,"
+                     "tiedosto TEXT NOT NULL,"
+                     "alkaa    DATE NOT NULL,"
+                     "paattyy  DATE NOT NULL )"))
+    {
+        kp()->lokiin(kysely);
+        return false;
+    }
+    return true;
+}
+
+bool KausiOsiot::lataa(QSqlDatabase &tietokanta, const QString &tiedostopolku)
+{
+    QSqlQuery kysely(tietokanta);
+
+    // Irrotetaan aiemmin liitetyt, jotta juuri erotettu osio liitetään
+    // muiden tapaan vain luku -tilassa
+    for( const Osio& osio : osiot())
+        kysely.exec( QString("DETACH DATABASE %1").arg(osio.skeema));
+    tyhjenna();
+    {
+        QMutexLocker lukitsin(&mutex_);
+        tiedostopolku_ = tiedostopolku;
+    }
+
+    if( !kysely.exec("SELECT skeema, tiedosto, alkaa, paattyy FROM osio ORDER BY alkaa"))
+        return false;
+
+    QDir hakemisto = QFileInfo(tiedostopolku).dir();
+    QList<Osio> luetut;
+    while( kysely.next())
+    {
+        Osio osio;
+        osio.skeema = kysely.value("skeema").toString();
+        osio.polku = hakemisto.absoluteFilePath( kysely.value("tiedosto").toString() );
+        osio.alkaa = kysely.value("alkaa").toDate();
+        osio.paattyy = kysely.value("paattyy").toDate();
+        luetut.append(osio);
+    }
+
+    bool kaikki = true;
+    QList<Osio> liitetyt;
+    for( Osio osio : luetut)
+    {
+        if( !liitaOsio(tietokanta, osio))
+        {
+            kaikki = false;
+            continue;
+        }
+
+        // Sarakkeet valitaan päätiedoston järjestyksessä. Jos päätiedostoon on
+        // osion erottamisen jälkeen lisätty sarakkeita, ne ovat osiossa NULL.
+        for( const QString& taulu : taulut())
+        {
+            QSet<QString> osionSarakkeet;
+            kysely.exec( QString("PRAGMA %1.table_info(%2)").arg(osio.skeema).arg(taulu));
+            while( kysely.next())
+                osionSarakkeet.insert( kysely.value("name").toString());
+
+            QStringList valinnat;
+            kysely.exec( QString("PRAGMA main.table_info(%1)").arg(taulu));
+            while( kysely.next())
+            {
+                QString sarake = kysely.value("name").toString();
+                valinnat.append( osionSarakkeet.contains(sarake) ? sarake : QString("NULL AS %1").arg(sarake) );
+            }
+            if( !osionSarakkeet.isEmpty())
+                osio.sarakkeet.insert(taulu, valinnat.join(", "));
+        }
+        liitetyt.append(osio);
+    }
+
+    QMutexLocker lukitsin(&mutex_);
+    osiot_ = liitetyt;
+    return kaikki;
+}
+
+bool KausiOsiot::liita(QSqlDatabase &yhteys) const
+{
+    QSet<QString> liitetty;
+    QSqlQuery kysely(yhteys);
+    kysely.exec("PRAGMA database_list");
+    while( kysely.next())
+        liitetty.insert( kysely.value("name").toString());
+
+    bool kaikki = true;
+    for( const Osio& osio : osiot())
+        if( !liitetty.contains(osio.skeema))
+            kaikki = liitaOsio(yhteys, osio) && kaikki;
+    return kaikki;
+}
+
+void KausiOsiot::tyhjenna()
+{
+    QMutexLocker lukitsin(&mutex_);
+    osiot_.clear();
+    tiedostopolku_.clear();
+}
+
+QList<KausiOsiot::Osio> KausiOsiot::osiot() const
+{
+    QMutexLocker lukitsin(&mutex_);
+    return osiot_;
+}
+
+bool KausiOsiot::onkoOsioitu(const Tilikausi &kausi) const
+{
+    for( const Osio& osio : osiot())
+        if( osio.alkaa == kausi.alkaa())
+            return true;
+    return false;
+}
+
+QString KausiOsiot::taulu(const QString &nimi, const QDate &alkaa, const QDate &paattyy) const
+{
+    QStringList osat;
+    for( const Osio& osio : osiot())
+    {
+        if( ( paattyy.isValid() && osio.alkaa > paattyy ) ||
+            ( alkaa.isValid() && osio.paattyy < alkaa ))
+            continue;
+        if( osio.sarakkeet.contains(nimi))
+            osat.append( QString("SELECT %1 FROM %2.%3").arg( osio.sarakkeet.value(nimi)).arg(osio.skeema).arg(nimi) );
+        else if( nimi == "vientivw")
+            osat.append( osio.skeema );
+    }
+
+    if( osat.isEmpty())
+        return nimi;
+    if( nimi == "vientivw")
+        return QString(VIENTINAKYMA).arg( taulu("vienti", alkaa, paattyy)).arg( taulu("tosite", alkaa, paattyy));
+
+    return QString("(SELECT * FROM main.%1 UNION ALL %2) AS %1").arg(nimi).arg(osat.join(" UNION ALL "));
+}
+
+bool KausiOsiot::erota(QSqlDatabase &tietokanta, const Tilikausi &kausi)
+{
+    if( onkoOsioitu(kausi))
+        return true;
+
+    QString skeema = skeemaKaudelle(kausi);
+    QFileInfo info( tiedostopolku_ );
+    QString tiedosto = QString("%1-%2.kausi").arg( info.completeBaseName()).arg( kausi.arkistoHakemistoNimi());
+    QString polku = info.dir().absoluteFilePath(tiedosto);
+
+    // Aiemmin keskeytynyt erottaminen
+    if( QFile::exists(polku))
+        QFile::remove(polku);
+
+    QSqlQuery kysely(tietokanta);
+    kysely.prepare( QString("ATTACH DATABASE ? AS %1").arg(skeema));
+    kysely.addBindValue( polku );
+    if( !kysely.exec())
+    {
+        kp()->lokiin(kysely);
+        return false;
+    }
+
+    QString alkaa = kausi.alkaa().toString(Qt::ISODate);
+    QString paattyy = kausi.paattyy().toString(Qt::ISODate);
+
+    // Tositteet, joiden viennit ovat kaudella eivätkä kuulu avoimeen tase-erään
+    QStringList siirto;
+    siirto << "CREATE TEMP TABLE osiosiirto (id INTEGER PRIMARY KEY)"
+           << QString("INSERT INTO temp.osiosiirto SELECT id FROM main.tosite "
+                      "WHERE pvm BETWEEN '%1' AND '%2' AND NOT EXISTS "
+                      "(SELECT 1 FROM main.vienti WHERE vienti.tosite = tosite.id AND "
+                      "(vienti.pvm NOT BETWEEN '%1' AND '%2' OR "
+                      "vienti.eraid IN (SELECT id FROM main.era WHERE debetsnt <> kreditsnt)))")
+              .arg(alkaa).arg(paattyy)
+           << QString("INSERT INTO %1.tosite SELECT * FROM main.tosite WHERE id IN (SELECT id FROM temp.osiosiirto)").arg(skeema)
+           << QString("INSERT INTO %1.vienti SELECT * FROM main.vienti WHERE tosite IN (SELECT id FROM temp.osiosiirto)").arg(skeema)
+           << QString("INSERT INTO %1.merkkaus SELECT * FROM main.merkkaus WHERE vienti IN (SELECT id FROM %1.vienti)").arg(skeema)
+           << QString("INSERT INTO %1.liite SELECT * FROM main.liite WHERE tosite IN (SELECT id FROM temp.osiosiirto)").arg(skeema);
+
+    QStringList poisto;
+    poisto << QString("DELETE FROM main.merkkaus WHERE vienti IN (SELECT id FROM %1.vienti)").arg(skeema)
+           << "DELETE FROM main.liite WHERE tosite IN (SELECT id FROM temp.osiosiirto)"
+           << "DELETE FROM main.vienti WHERE tosite IN (SELECT id FROM temp.osiosiirto)"
+           << "DELETE FROM main.tosite WHERE id IN (SELECT id FROM temp.osiosiirto)"
+           << "DROP TABLE temp.osiosiirto";
+
+    bool onnistui = tietokanta.transaction() && kopioiRakenne(tietokanta, skeema);
+
+    for(int i=0; i < siirto.count() && onnistui; i++)
+        onnistui = kysely.exec( siirto.at(i) );
+
+    // Saldot, erät ja liitetiedostojen viittaukset koskevat koko historiaa,
+    // joten triggerit poistetaan siirron ajaksi
+    QStringList triggerit;
+    if( onnistui )
+    {
+        onnistui = kysely.exec( QString("SELECT name, sql FROM main.sqlite_master WHERE type='trigger' "
+                                        "AND tbl_name IN ('%1')").arg( taulut().join("','") ));
+        QStringList nimet;
+        while( kysely.next())
+        {
+            nimet.append( kysely.value("name").toString());
+            triggerit.append( kysely.value("sql").toString());
+        }
+        for( const QString& nimi : nimet)
+            poisto.prepend( QString("DROP TRIGGER main.%1").arg(nimi));
+    }
+    poisto << triggerit;
+
+    for(int i=0; i < poisto.count() && onnistui; i++)
+        onnistui = kysely.exec( poisto.at(i) );
+
+    if( onnistui )
+    {
+        kysely.prepare("INSERT INTO osio(skeema, tiedosto, alkaa, paattyy) VALUES (?,?,?,?)");
+        kysely.addBindValue(skeema);
+        kysely.addBindValue(tiedosto);
+        kysely.addBindValue(kausi.alkaa());
+        kysely.addBindValue(kausi.paattyy());
+        onnistui = kysely.exec();
+    }
+
+    if( onnistui )
+        onnistui = tietokanta.commit();
+    else
+    {
+        kp()->lokiin(kysely);
+        tietokanta.rollback();
+    }
+
+    kysely.exec( QString("DETACH DATABASE %1").arg(skeema));
+    if( !onnistui )
+    {
+        QFile::remove(polku);
+        return false;
+    }
+
+    return lataa(tietokanta, tiedostopolku_);
+}
+
+QStringList KausiOsiot::taulut()
+{
+    return QStringList() << "tosite" << "vienti" << "merkkaus" << "liite";
+}
+
+QString KausiOsiot::skeemaKaudelle(const Tilikausi &kausi)
+{
+    return QString("osio%1").arg( kausi.alkaa().toString("yyyyMMdd"));
+}
+
+QString KausiOsiot::uri(const QString &polku)
+{
+    return QUrl::fromLocalFile(polku).toString(QUrl::FullyEncoded) + "?mode=ro";
+}
+
+bool KausiOsiot::liitaOsio(QSqlDatabase &yhteys, const Osio &osio) const
+{
+    QSqlQuery kysely(yhteys);
+    kysely.prepare( QString("ATTACH DATABASE ? AS %1").arg(osio.skeema));
+    kysely.addBindValue( uri(osio.polku) );
+    if( !kysely.exec())
+    {
+        kp()->lokiin(kysely);
+        return false;
+    }
+    return true;
+}
+
+bool KausiOsiot::kopioiRakenne(QSqlDatabase &tietokanta, const QString &skeema)
+{
+    // Osion taulut ja indeksit luodaan päätiedoston määrittelyillä
+    QRegularExpression tauluLuonti("^\\s*CREATE\\s+TABLE\\s+(IF\\s+NOT\\s+EXISTS\\s+)?[\"`]?\\w+[\"`]?",
+                                   QRegularExpression::CaseInsensitiveOption);
+    QRegularExpression indeksiLuonti("^(\\s*CREATE\\s+(UNIQUE\\s+)?INDEX\\s+(IF\\s+NOT\\s+EXISTS\\s+)?)",
+                                     QRegularExpression::CaseInsensitiveOption);
+
+    QSqlQuery kysely(tietokanta);
+    QStringList luonti;
+    for( const QString& taulu : taulut())
+    {
+        if( !kysely.exec( QString("SELECT type, sql FROM main.sqlite_master WHERE tbl_name='%1' "
+                                  "AND type IN ('table','index') AND sql IS NOT NULL "
+                                  "ORDER BY type='index'").arg(taulu)))
+        {
+            kp()->lokiin(kysely);
+            return false;
+        }
+        while( kysely.next())
+        {
+            QString sql = kysely.value("sql").toString();
+            if( kysely.value("type").toString() == "table")
+                luonti.append( sql.replace(tauluLuonti, QString("CREATE TABLE %1.%2").arg(skeema).arg(taulu)));
+            else
+                luonti.append( sql.replace(indeksiLuonti, QString("\\1%1.").arg(skeema)));
+        }
+    }
+
+    for( const QString& lause : luonti)
+    {
+        if( !kysely.exec(lause))
+        {
+            kp()->lokiin(kysely);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,135 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KAUSIOSIOT_H
+#define KAUSIOSIOT_H
+
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QSqlDatabase>
+#include <QMutex>
+
+class Tilikausi;
+
+/**
+ * @brief Päätettyjen tilikausien erilliset tietokantatiedostot (osiot)
+ *
+ * Päätetyn tilikauden (TilitPaatetty) tositteet, viennit, merkkaukset ja
+ * liitteet voidaan siirtää kirjanpidon viereen omaan tiedostoonsa
+ * (kirjanpito-2015.kausi), joka liitetään tietokantaan ATTACH-lauseella
+ * vain luku -tilassa. Päätiedostoon jää näin vain avointen kausien
+ * aineisto, joten nykyisen kauden kyselyt pysyvät nopeina.
+ *
+ * Päätiedostoon jätetään myös päätetyn kauden tositteet, joiden vienneillä
+ * on avoimia tase-eriä, joten avoimia eriä ja laskuja käsittelevät
+ * kyselyt voivat edelleen lukea pelkkää päätiedostoa. Saldot, erät ja
+ * tekstihaun indeksi (SaldoTaulu, EraTaulu, HakuIndeksi) pysyvät
+ * päätiedostossa koko historialta.
+ *
+ * Päivämäärävälin aineistoa lukevat kyselyt pyytävät taulun taulu()-
+ * funktiolta, joka palauttaa pelkän taulun nimen, ellei välille osu
+ * yhtään osiota, ja muuten alikyselyn, jossa ovat mukana vain välille
+ * osuvat osiot.
+ *
+ * Osioluetteloa luetaan myös taustasäikeistä (liita()), joten se
+ * käsitellään mutex_:in suojaamana.
+ *
+ * @see Kirjanpito::osiot()
+ */
+class KausiOsiot
+{
+public:
+    struct Osio
+    {
+        QString skeema;
+        QString polku;
+        QDate alkaa;
+        QDate paattyy;
+        QHash<QString,QString> sarakkeet;   // Taulu -> päätiedoston sarakkeet osiosta valittuina
+    };
+
+    KausiOsiot();
+
+    /**
+     * @brief Luo osioiden luettelotaulun, ellei sitä vielä ole
+     */
+    static bool alusta(QSqlDatabase& tietokanta);
+
+    /**
+     * @brief Liittää kirjanpidon osiot pääyhteyteen
+     *
+     * Yhteys on avattava QSQLITE_OPEN_URI-valinnalla, jotta osiot voidaan
+     * liittää vain luku -tilassa.
+     *
+     * @return tosi, jos kaikki osiot saatiin liitettyä
+     */
+    bool lataa(QSqlDatabase& tietokanta, const QString& tiedostopolku);
+
+    /**
+     * @brief Liittää ladatut osiot taustasäikeen yhteyteen
+     *
+     * Liittää vain ne osiot, joita yhteyteen ei vielä ole liitetty, joten
+     * kutsutaan aina yhteyttä käytettäessä: näin myös yhteyden luomisen
+     * jälkeen erotetut osiot tulevat mukaan.
+     */
+    bool liita(QSqlDatabase& yhteys) const;
+
+    void tyhjenna();
+
+    QList<Osio> osiot() const;
+    bool onkoOsioitu(const Tilikausi& kausi) const;
+
+    /**
+     * @brief Taulu, josta päivämäärävälin aineisto luetaan
+     *
+     * Tyhjä alku- tai loppupäivä tarkoittaa rajaamatonta väliä, joten
+     * taulu(nimi) sisältää kaikki osiot esimerkiksi id:llä hakemista varten.
+     *
+     * @param nimi tosite, vienti, merkkaus, liite tai vientivw
+     * @return Taulun nimi tai alikysely, jolla on taulun nimi aliaksena
+     */
+    QString taulu(const QString& nimi, const QDate& alkaa = QDate(), const QDate& paattyy = QDate()) const;
+
+    /**
+     * @brief Siirtää päätetyn tilikauden aineiston omaan osioonsa
+     *
+     * Siirto tehdään yhdessä transaktiossa. Tietokantatiedosto pienenee
+     * vasta, kun se tiivistetään (VACUUM).
+     *
+     * @return tosi, jos onnistui
+     */
+    bool erota(QSqlDatabase& tietokanta, const Tilikausi& kausi);
+
+    /**
+     * @brief Osioihin siirrettävät taulut
+     */
+    static QStringList taulut();
+
+protected:
+    static QString skeemaKaudelle(const Tilikausi& kausi);
+    static QString uri(const QString& polku);
+    bool liitaOsio(QSqlDatabase& yhteys, const Osio& osio) const;
+    bool kopioiRakenne(QSqlDatabase& tietokanta, const QString& skeema);
+
+    QList<Osio> osiot_;
+    QString tiedostopolku_;
+    mutable QMutex mutex_;
+};
+
+#endif // KAUSIOSIOT_H
@@ -0,0 +1,113 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "kirjanpidonmuutos.h"
+
+#include <QSqlQuery>
+#include <QVariant>
+
+KirjanpidonMuutos::KirjanpidonMuutos()
+{
+
+}
+
+KirjanpidonMuutos KirjanpidonMuutos::kaikki()
+{
+    KirjanpidonMuutos muutos;
+    muutos.kaikki_ = true;
+    return muutos;
+}
+
+void KirjanpidonMuutos::lisaaTosite(int tositeId)
+{
+    if( tositeId > 0)
+        tositteet_.insert(tositeId);
+}
+
+void KirjanpidonMuutos::lisaaTili(int tiliId)
+{
+    if( tiliId > 0)
+        tilit_.insert(tiliId);
+}
+
+void KirjanpidonMuutos::lisaaEra(int eraId)
+{
+    if( eraId > 0)
+        erat_.insert(eraId);
+}
+
+void KirjanpidonMuutos::lisaaPaiva(const QDate &pvm)
+{
+    if( !pvm.isValid())
+        return;
+    if( !alkaa_.isValid() || pvm < alkaa_)
+        alkaa_ = pvm;
+    if( !paattyy_.isValid() || pvm > paattyy_)
+        paattyy_ = pvm;
+}
+
+void KirjanpidonMuutos::lisaaTositteenViennit(QSqlDatabase &tietokanta, int tositeId)
+{
+    if( tositeId < 1)
+        return;
+
+    lisaaTosite(tositeId);
+
+    QSqlQuery kysely(tietokanta);
+    kysely.exec(QString("SELECT pvm FROM tosite WHERE id=%1").arg(tositeId));
+    if( kysely.next())
+        lisaaPaiva( kysely.value(0).toDate());
+
+    kysely.exec(QString("SELECT pvm, tili, eraid, viite IS NOT NULL OR asiakas IS NOT NULL "
+                        "FROM vienti WHERE tosite=%1").arg(tositeId));
+    while( kysely.next())
+    {
+        lisaaPaiva( kysely.value(0).toDate());
+        lisaaTili( kysely.value(1).toInt());
+        lisaaEra( kysely.value(2).toInt());
+        if( kysely.value(3).toBool())
+            lisaaLasku();
+    }
+}
+
+void KirjanpidonMuutos::yhdista(const KirjanpidonMuutos &toinen)
+{
+    kaikki_ = kaikki_ || toinen.kaikki_;
+    laskut_ = laskut_ || toinen.laskut_;
+    tositteet_.unite( toinen.tositteet_ );
+    tilit_.unite( toinen.tilit_ );
+    erat_.unite( toinen.erat_ );
+    lisaaPaiva( toinen.alkaa_ );
+    lisaaPaiva( toinen.paattyy_ );
+}
+
+bool KirjanpidonMuutos::onkoTyhja() const
+{
+    return !kaikki_ && !laskut_ && !alkaa_.isValid() &&
+           tositteet_.isEmpty() && tilit_.isEmpty() && erat_.isEmpty();
+}
+
+bool KirjanpidonMuutos::koskeeJaksoa(const QDate &alkaa, const QDate &paattyy) const
+{
+    if( kaikki_ )
+        return true;
+    if( !alkaa_.isValid() )
+        return false;   // Ei päivättyjä vientejä
+
+    return ( !paattyy.isValid() || alkaa_ <= paattyy ) &&
+           ( !alkaa.isValid() || paattyy_ >= alkaa );
+}
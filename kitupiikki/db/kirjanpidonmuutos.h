@@ -0,0 +1,108 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KIRJANPIDONMUUTOS_H
+#define KIRJANPIDONMUUTOS_H
+
+#include <QSet>
+#include <QDate>
+#include <QMetaType>
+#include <QSqlDatabase>
+
+/**
+ * @brief Tieto siitä, mitä kirjanpidossa muuttui
+ *
+ * Muutos kertoo tallennuksen koskettamat tositteet, tilit ja tase-erät
+ * sekä päivämäärävälin, jolle muuttuneet viennit osuvat. Mukana ovat sekä
+ * vanhat että uudet arvot, jotta näkymät osaavat poistaa siirtyneen
+ * viennin vanhalta paikaltaan.
+ *
+ * Näkymät päivittävät muutoksen perusteella vain ne rivit, joihin muutos
+ * vaikuttaa. Jos muutoksen laajuutta ei tiedetä (esim. saldot laskettu
+ * uudelleen), käytetään kaikki()-muutosta, jolloin näkymät ladataan
+ * kokonaan uudelleen.
+ *
+ * @see Kirjanpito::ilmoitaMuutos()
+ */
+class KirjanpidonMuutos
+{
+public:
+    KirjanpidonMuutos();
+
+    /**
+     * @brief Muutos, joka voi koskea mitä tahansa
+     */
+    static KirjanpidonMuutos kaikki();
+
+    void lisaaTosite(int tositeId);
+    void lisaaTili(int tiliId);
+    void lisaaEra(int eraId);
+    void lisaaPaiva(const QDate& pvm);
+
+    /**
+     * @brief Muutos koskee laskua (vientiä, jolla on viite tai asiakas)
+     */
+    void lisaaLasku() { laskut_ = true; }
+
+    /**
+     * @brief Lisää tositteen ja sen tietokantaan tallennetut viennit
+     *
+     * Kutsutaan ennen tallennusta vanhoille ja tallennuksen jälkeen
+     * uusille tiedoille.
+     */
+    void lisaaTositteenViennit(QSqlDatabase& tietokanta, int tositeId);
+
+    /**
+     * @brief Yhdistää toisen muutoksen tähän
+     */
+    void yhdista(const KirjanpidonMuutos& toinen);
+
+    bool onkoKaikki() const { return kaikki_; }
+    bool onkoTyhja() const;
+
+    QSet<int> tositteet() const { return tositteet_; }
+    QSet<int> tilit() const { return tilit_; }
+    QSet<int> erat() const { return erat_; }
+    QDate alkaa() const { return alkaa_; }
+    QDate paattyy() const { return paattyy_; }
+
+    /**
+     * @brief Osuuko muutos päivämäärävälille
+     *
+     * Tyhjä alku- tai loppupäivä tarkoittaa rajaamatonta väliä, joten
+     * tilikauden lopun saldoihin vaikuttavat muutokset saadaan
+     * koskeeJaksoa(QDate(), kausi.paattyy()):llä.
+     */
+    bool koskeeJaksoa(const QDate& alkaa, const QDate& paattyy) const;
+
+    bool koskeeTilia(int tiliId) const { return kaikki_ || tilit_.contains(tiliId); }
+    bool koskeeEria() const { return kaikki_ || !erat_.isEmpty(); }
+    bool koskeeLaskuja() const { return kaikki_ || laskut_ || !erat_.isEmpty(); }
+
+protected:
+    bool kaikki_ = false;
+    bool laskut_ = false;
+    QSet<int> tositteet_;
+    QSet<int> tilit_;
+    QSet<int> erat_;
+    QDate alkaa_;
+    QDate paattyy_;
+};
+
+Q_DECLARE_METATYPE(KirjanpidonMuutos)
+
+#endif // KIRJANPIDONMUUTOS_H
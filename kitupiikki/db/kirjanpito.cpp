@@ -30,16 +30,27 @@
 #include <QTextStream>
 #include <QBuffer>
 #include <QRandomGenerator>
+#include <QProgressDialog>
+#include <QLockFile>
+#include <QTimer>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QMutexLocker>
 
 #include <QDebug>
 
 #include <ctime>
 
 #include "kirjanpito.h"
+#include "saldotaulu.h"
+#include "hakuindeksi.h"
+#include "erataulu.h"
+#include "paivittaja.h"
 #include "naytin/naytinikkuna.h"
 
 Kirjanpito::Kirjanpito(const QString& portableDir) : QObject(nullptr),
-    harjoitusPvm( QDate::currentDate()), tempDir_(nullptr), portableDir_(portableDir)
+    harjoitusPvm( QDate::currentDate()), tempDir_(nullptr), portableDir_(portableDir),
+    wal_(false), lukko_(nullptr)
 {
     if( portableDir.isEmpty())
         settings_ = new QSettings(this);
@@ -62,6 +73,21 @@ Kirjanpito::Kirjanpito(const QString& portableDir) : QObject(nullptr),
     tuotteet_ = new TuoteModel(this);
     liitteet_ = nullptr;
 
+    qRegisterMetaType<KirjanpidonMuutos>();
+    connect( this, &Kirjanpito::kirjanpitoMuuttui, tilikaudetModel_, &TilikausiModel::kirjanpitoMuuttui);
+
+    kyselyt_ = new KyselyVarasto(&tietokanta_);
+    kyselyt_->lisaaVakiokyselyt();
+    liitevarasto_ = new LiiteVarasto();
+    osiot_ = new KausiOsiot();
+
+    // WAL-tilassa loki siirretään tietokantaan, kun muokkaamisesta on kulunut hetki
+    tarkistuspisteAjastin_ = new QTimer(this);
+    tarkistuspisteAjastin_->setSingleShot(true);
+    tarkistuspisteAjastin_->setInterval(30000);
+    connect( tarkistuspisteAjastin_, SIGNAL(timeout()), this, SLOT(tarkistuspiste()));
+    connect( this, SIGNAL(kirjanpitoaMuokattu()), tarkistuspisteAjastin_, SLOT(start()));
+
     printer_ = new QPrinter(QPrinter::HighResolution);
 
     // Jos järjestelmässä ei ole yhtään tulostinta, otetaan käyttöön pdf-tulostus jotte
@@ -76,7 +102,10 @@ Kirjanpito::Kirjanpito(const QString& portableDir) : QObject(nullptr),
 
 Kirjanpito::~Kirjanpito()
 {
-    tietokanta_.close();
+    suljeTietokanta();
+    delete kyselyt_;
+    delete liitevarasto_;
+    delete osiot_;
     delete tempDir_;
 }
 
@@ -95,7 +124,7 @@ QDate Kirjanpito::paivamaara() const
 }
 
 
-Tilikausi Kirjanpito::tilikausiPaivalle(const QDate &paiva) const
+const Tilikausi &Kirjanpito::tilikausiPaivalle(const QDate &paiva) const
 {
     return tilikaudet()->tilikausiPaivalle(paiva);
 }
@@ -140,11 +169,12 @@ QString Kirjanpito::tilapainen(QString nimi) const
 bool Kirjanpito::onkoMaksuperusteinenAlv(const QDate &paiva) const
 {
     // Onko annettuna päivänä maksuperusteinen alv käytössä
-    if( !asetukset()->onko("AlvVelvollinen") || !asetukset()->onko("MaksuAlvAlkaa"))
+    const Asetuskuva& kuva = asetukset()->kuva();
+    if( !kuva.alvVelvollinen || !kuva.maksuAlvAlkaa.isValid())
         return false;
-    if( asetukset()->pvm("MaksuAlvAlkaa") > paiva )
+    if( kuva.maksuAlvAlkaa > paiva )
         return false;
-    if( asetukset()->onko("MaksuAlvLoppuu") && asetukset()->pvm("MaksuAlvLoppuu") <= paiva )
+    if( kuva.maksuAlvLoppuu.isValid() && kuva.maksuAlvLoppuu <= paiva )
         return false;
     return true;
 }
@@ -193,11 +223,23 @@ void Kirjanpito::lokiin(const QSqlQuery &kysely)
     emit tietokantavirhe(ilmoitus);
 }
 
+void Kirjanpito::ilmoitaMuutos(const KirjanpidonMuutos &muutos)
+{
+    emit kirjanpitoMuuttui(muutos);
+    emit kirjanpitoaMuokattu();
+}
+
 
 
 bool Kirjanpito::avaaTietokanta(const QString &tiedosto, bool ilmoitaVirheesta)
 {
+    // Suljetaan edellinen kirjanpito valmisteltuine kyselyineen
+    suljeTietokanta();
+
     tietokanta_.setDatabaseName(tiedosto);
+    // Päätettyjen kausien osiot liitetään vain luku -tilassa uri-muotoisina.
+    // Kirjoitus odottaa, kun varmuuskopioija lukee tietokantaa omalla yhteydellään.
+    tietokanta_.setConnectOptions("QSQLITE_OPEN_URI;QSQLITE_BUSY_TIMEOUT=5000");
     polkuTiedostoon_ = tiedosto;
 
     if( tiedosto.isEmpty())
@@ -214,19 +256,45 @@ bool Kirjanpito::avaaTietokanta(const QString &tiedosto, bool ilmoitaVirheesta)
         return false;
     }
 
-    // Tehostetaan tietokannan nopeutta määrittelemällä, että tietokanta on vain tämän yhden
-    // yhteyden käytössä.
+    // Varmuuskopioija lukee tietokantaa omalla yhteydellään, joten tietokantaa
+    // ei lukita yksinomaan tälle yhteydelle. Kahdesti avaaminen estetään
+    // lukkotiedostolla.
+    bool kaytossa = false;
+    lukko_ = new QLockFile( tiedosto + ".lukko");
+    lukko_->setStaleLockTime(0);
+    if( !lukko_->tryLock() )
+    {
+        kaytossa = lukko_->error() == QLockFile::LockFailedError;
+        delete lukko_;
+        lukko_ = nullptr;
+    }
 
-    tietokanta()->exec("PRAGMA LOCKING_MODE = EXCLUSIVE");
+    if( !lukko_ && !kaytossa )
+    {
+        // Lukkotiedostoa ei voi kirjoittaa hakemistoon, joten tietokanta
+        // lukitaan yksinomaan tälle yhteydelle kuten ennenkin
+        tietokanta()->exec("PRAGMA LOCKING_MODE = EXCLUSIVE");
+    }
+    else if( lukko_ && settings_->value("SqliteWal", false).toBool() )
+    {
+        // WAL-tilassa taustasäikeet voivat lukea tietokantaa omilla yhteyksillään
+        // samaan aikaan, kun tällä yhteydellä kirjoitetaan.
+        QSqlQuery tila( tietokanta_ );
+        wal_ = tila.exec("PRAGMA JOURNAL_MODE = WAL") && tila.next() &&
+                tila.value(0).toString().toLower() == "wal";
+        if( wal_ )
+            tietokanta()->exec("PRAGMA SYNCHRONOUS = NORMAL");
+    }
 
-    tietokanta()->exec("PRAGMA JOURNAL_MODE = PERSIST");
+    if( !wal_ && !kaytossa )
+        tietokanta()->exec("PRAGMA JOURNAL_MODE = PERSIST");
 
-    if( tietokanta()->lastError().isValid())
+    if( kaytossa || tietokanta()->lastError().isValid())
     {
         // Tietokanta on jo käytössä
         if( ilmoitaVirheesta )
         {
-            if( tietokanta()->lastError().text().contains("locked"))
+            if( kaytossa || tietokanta()->lastError().text().contains("locked"))
             {
                 QMessageBox::critical(nullptr, tr("Kitupiikki").arg(tiedosto),
                                       tr("Kirjanpitotiedosto on jo käytössä.\n\n%1\n\n"
@@ -240,7 +308,7 @@ bool Kirjanpito::avaaTietokanta(const QString &tiedosto, bool ilmoitaVirheesta)
             }
         }
 
-        tietokanta()->close();
+        suljeTietokanta();
         asetusModel_->lataa();
         emit tietokantaVaihtui();
         return false;
@@ -256,7 +324,7 @@ bool Kirjanpito::avaaTietokanta(const QString &tiedosto, bool ilmoitaVirheesta)
         // Tämä ei ole lainkaan kelvollinen tietokanta
         QMessageBox::critical(nullptr, tr("Tiedostoa %1 ei voi avata").arg(tiedosto),
                               tr("Valitsemasi tiedosto ei ole Kitupiikin tietokanta, tai tiedosto on vahingoittunut."));
-        tietokanta()->close();
+        suljeTietokanta();
         asetusModel_->lataa();
         emit tietokantaVaihtui();
         return false;
@@ -274,7 +342,7 @@ bool Kirjanpito::avaaTietokanta(const QString &tiedosto, bool ilmoitaVirheesta)
                                  "osoitteesta https://kitupiikki.info").arg( asetusModel_->asetus("LuotuVersiolla"))
                               .arg( qApp->applicationVersion() ));
 
-        tietokanta()->close();
+        suljeTietokanta();
         asetusModel_->lataa();  // Tyhjentää asetukset
         emit tietokantaVaihtui();
 
@@ -295,101 +363,48 @@ bool Kirjanpito::avaaTietokanta(const QString &tiedosto, bool ilmoitaVirheesta)
                                      .arg(qApp->applicationVersion()),
                                   QMessageBox::Yes | QMessageBox::No, QMessageBox::No) != QMessageBox::Yes )
         {
-            tietokanta()->close();
+            suljeTietokanta();
             asetusModel_->lataa();
             emit tietokantaVaihtui();
             return false;
         }
-        // Tietokanta päivitetään suorittamalla update-komennot
-        // nykyiseen tietokantaversioon saakka
+        // Tietokanta päivitetään ajamalla päivitysvaiheet nykyiseen
+        // tietokantaversioon saakka. Kukin vaihe on oma transaktionsa, joten
+        // keskeytynyt päivitys jatkuu seuraavalla avauskerralla.
         // Esitiedostoversioita 1-2 tuetaan VAIN versioon 0.12 saakka ! (Hupsis, näitä tuetaan yhä edelleen...)
 
-        // for(int i = asetusModel_->luku("KpVersio") + 1; i <= TIETOKANTAVERSIO; i++)
-        //     paivita( i );
-
-        if( asetusModel_->luku("KpVersio") < 10)
+        Paivittaja paivittaja( &tietokanta_ );
+        paivittaja.lisaaVaihe(10, ":/sql/update3.sql", [this] (Paivittaja* p) {
+            return siirraLiitteet(p) && siirraLaskut(p) && siirraLogo();
+        });
+        paivittaja.lisaaVaihe(11, ":/sql/update11.sql", [this] (Paivittaja* p) {
+            return taytaLaskusarakkeet(p);
+        });
+
+        QProgressDialog odota(tr("Päivitetään kirjanpitoa"), QString(), 0, 0);
+        odota.setMinimumDuration(0);
+        odota.setWindowModality(Qt::WindowModal);
+        paivittaja.asetaEdistyminen( [&odota] (int valmis, int yhteensa) {
+            odota.setMaximum(yhteensa);
+            odota.setValue(valmis);
+            qApp->processEvents();
+        });
+
+        if( !paivittaja.paivita( asetusModel_->luku("KpVersio") ))
         {
-            paivita(3);
-
-            // Erityiset toimet kolmosversioon
-            // Liitteiden haku tietokantaan
-
-            QSqlQuery liitekysely("SELECT id, tosite, liiteno FROM liite");
-            QSqlQuery liittokysely;
-            liittokysely.prepare("UPDATE liite SET data=:data WHERE id=:id" );
-
-            QFileInfo info( kp()->tiedostopolku());
-
-            while( liitekysely.next())
-            {
-                QString tiedostonnimi = QString("%1-%2.pdf")
-                            .arg( liitekysely.value("tosite").toInt()  , 8, 10, QChar('0') )
-                            .arg( liitekysely.value("liiteno").toInt() , 2, 10, QChar('0') );
-
-                QFile tiedosto( info.dir().absoluteFilePath("liitteet/" + tiedostonnimi));
-                tiedosto.open(QIODevice::ReadOnly);
-                liittokysely.bindValue(":data", tiedosto.readAll());
-                liittokysely.bindValue(":id", liitekysely.value("id").toInt());
-                liittokysely.exec();
-            }
-
-            // Laskujen siirtäminen vienteihin
-
-            QSqlQuery laskukysely("SELECT id, tosite, laskupvm, erapvm, avoinSnt, asiakas, kirjausperuste, json FROM lasku");
-
-            while( laskukysely.next())
-            {
-                int kirjausperuste = laskukysely.value("kirjausperuste").toInt();
-                JsonKentta json( laskukysely.value("json").toByteArray());
-                QSqlQuery lkysely;
-
-                if( kirjausperuste == LaskuModel::SUORITEPERUSTE || kirjausperuste == LaskuModel::LASKUTUSPERUSTE)
-                {
-                    lkysely.prepare("UPDATE vienti SET viite=:viite, laskupvm=:laskupvm, erapvm=:erapvm, asiakas=:asiakas, json=:json "
-                                    "WHERE id=:era");
-                    lkysely.bindValue(":era", json.luku("TaseEra"));
-                }
-                else if( kirjausperuste == LaskuModel::MAKSUPERUSTE)
-                {
-                    lkysely.prepare("INSERT INTO vienti(tosite, vientirivi, pvm, kreditsnt, viite, laskupvm, erapvm, asiakas) "
-                                    " VALUES(:tosite, 999, :laskupvm, :snt, :viite, :laskupvm, :erapvm, :asiakas");
-                    ;
-                    lkysely.bindValue(":tosite", laskukysely.value("tosite").toInt());
-                    lkysely.bindValue(":snt", laskukysely.value("avoinSnt").toInt());
-
-                }
-                else if( kirjausperuste == LaskuModel::KATEISLASKU)
-                {
-                    lkysely.prepare("UPDATE vienti SET eraid=NULL, viite=:viite, laskupvm=:laskupvm, erapvm=:erapvm, asiakas=:asiakas, json=:json"
-                                    "WHERE tosite=:tosite AND debetsnt > 0");
-                    lkysely.bindValue(":tosite", laskukysely.value("tosite").toInt());
-                }
-
-                lkysely.bindValue(":viite", laskukysely.value("id").toString());
-                lkysely.bindValue(":laskupvm", laskukysely.value("laskupvm").toDate());
-                lkysely.bindValue(":asiakas", laskukysely.value("asiakas").toString());
-                lkysely.bindValue(":erapvm", laskukysely.value("erapvm").toDate());
-
-                json.set("Kirjausperuste", laskukysely.value("kirjausperuste").toInt());
-                lkysely.bindValue(":json", json.toJson());
-
-                lkysely.exec();
-
-                if( kirjausperuste == LaskuModel::MAKSUPERUSTE)
-                    tietokanta()->exec( QString("UPDATE vienti SET eraid=id WHERE id=%1").arg( lkysely.lastInsertId().toInt() ));
-            }
-            // Logo
-            QFile logotiedosto( info.dir().absoluteFilePath("logo.png") );
-            logotiedosto.open(QIODevice::ReadOnly);
-            QByteArray ba = logotiedosto.readAll();
-            QImage logo = QImage::fromData(ba, "PNG");
-
-            liitteet_ = new LiiteModel(nullptr, this);
-            asetaLogo(logo);
-            liitteet_->tallenna();
+            odota.close();
+            virheloki_.append( paivittaja.virhe() );
+            QMessageBox::critical(nullptr, tr("Kirjanpidon %1 päivittäminen").arg(asetusModel_->asetus("Nimi")),
+                                  tr("Kirjanpidon päivittäminen epäonnistui, eikä kirjanpitoon ole tehty muutoksia.\n\n%1")
+                                  .arg( paivittaja.virhe() ));
+            suljeTietokanta();
+            asetusModel_->lataa();
+            emit tietokantaVaihtui();
+            return false;
         }
+        odota.close();
 
-        asetusModel_->aseta("KpVersio", TIETOKANTAVERSIO);
+        asetusModel_->lataa();
         asetusModel_->aseta("LuotuVersiolla", qApp->applicationVersion());
         QMessageBox::information(nullptr, tr("Kirjanpito päivitetty"),
                                  tr("Kirjanpito päivitetty käytössä olevaan versioon."));
@@ -397,6 +412,7 @@ bool Kirjanpito::avaaTietokanta(const QString &tiedosto, bool ilmoitaVirheesta)
     }
     // Lukitaan tietokanta
     asetusModel_->aseta("Avattu", QDateTime::currentDateTime().toString(Qt::ISODate));
+    JsonKentta::asetaBinaarimuoto( asetusModel_->onko("JsonCbor") );
 
     // #342 Puuttuva merkkaustaulu
     // Bugi ilmenee, jos ennen versiota 0.11 luotu tietokanta on muunnettu ennen versiota 1.3.2
@@ -410,6 +426,62 @@ bool Kirjanpito::avaaTietokanta(const QString &tiedosto, bool ilmoitaVirheesta)
                        "                                                 ON UPDATE CASCADE"
                    ");");
 
+    // Raporttien summakyselyiden koosteindeksit. Indeksit eivät muuta
+    // tiedostomuotoa, joten ne luodaan ilman tietokantaversion nostoa ja
+    // kirjanpidon voi edelleen avata vanhemmilla versioilla.
+    QSqlQuery indeksikysely( tietokanta_ );
+    if( indeksikysely.exec("SELECT 1 FROM sqlite_master WHERE type='index' AND name='vienti_tili_pvm_index'")
+            && !indeksikysely.next())
+    {
+        QStringList lauseet;
+        lauseet << "DROP INDEX IF EXISTS vienti_tili_index"
+                << "DROP INDEX IF EXISTS vienti_kodennus_index"
+                << "DROP INDEX IF EXISTS vienti_taseera_index"
+                << "CREATE INDEX vienti_tili_pvm_index ON vienti(tili,pvm,debetsnt,kreditsnt)"
+                << "CREATE INDEX vienti_kohdennus_pvm_index ON vienti(kohdennus,pvm,tili,debetsnt,kreditsnt)"
+                << "CREATE INDEX vienti_era_pvm_index ON vienti(eraid,pvm,debetsnt,kreditsnt)"
+                << "ANALYZE vienti";
+
+        // Epäonnistuessa (esim. vain luku -tiedosto) jatketaan vanhoilla indekseillä
+        tietokanta_.transaction();
+        bool onnistui = true;
+        for( const QString& lause : lauseet)
+        {
+            if( !indeksikysely.exec(lause))
+            {
+                lokiin(indeksikysely);
+                onnistui = false;
+                break;
+            }
+        }
+        if( onnistui )
+            tietokanta_.commit();
+        else
+            tietokanta_.rollback();
+    }
+
+    // Tilien päiväsaldot ja tase-erien saldot
+    SaldoTaulu::alusta(tietokanta_);
+    EraTaulu::alusta(tietokanta_);
+    if( asetusModel_->pvm("TilitPaatetty").isValid())
+        SaldoTaulu::tallennaKuva(tietokanta_, asetusModel_->pvm("TilitPaatetty"));
+
+    // Erilliseen varastoon tallennettujen liitteiden viittaukset
+    LiiteVarasto::alusta(tietokanta_);
+    liitevarasto_->asetaHakemisto( LiiteVarasto::hakemistoKirjanpidolle(tiedosto) );
+
+    // Päätettyjen tilikausien osiot
+    KausiOsiot::alusta(tietokanta_);
+    if( !osiot_->lataa(tietokanta_, tiedosto) && ilmoitaVirheesta )
+        QMessageBox::warning(nullptr, tr("Tilikausien tiedostot puuttuvat"),
+                             tr("Kaikkia päätettyjen tilikausien tiedostoja ei voitu avata. "
+                                "Näiden tilikausien tositteet eivät ole käytettävissä.\n\n"
+                                "Tiedostot (*.kausi) on pidettävä samassa hakemistossa "
+                                "kirjanpitotiedoston kanssa.\n\n%1").arg( viimeVirhe() ));
+
+    // Tekstihaun indeksi kattaa myös osiot, joten se luodaan niiden jälkeen
+    HakuIndeksi::alusta(tietokanta_);
+
     tositelajiModel_->lataa();
     tiliModel_->lataa();
     tilikaudetModel_->lataa();
@@ -482,21 +554,289 @@ QString Kirjanpito::satujono(int pituus)
     return randomString;
 }
 
-void Kirjanpito::paivita(int versioon)
+bool Kirjanpito::siirraLiitteet(Paivittaja *paivittaja)
 {
-    QFile sqltiedosto( QString(":/sql/update%1.sql").arg(versioon));
-    sqltiedosto.open(QIODevice::ReadOnly);
-    QTextStream in(&sqltiedosto);
-    QString sqluonti = in.readAll();
-    sqluonti.replace("\n"," ");
-    QStringList sqlista = sqluonti.split(";");
-    QSqlQuery query;
-
-    foreach (QString kysely,sqlista)
+    // Versiossa 3 liitteet siirrettiin tiedostoista tietokantaan.
+    // Tiedosto luetaan muistiin kuvattuna, joten sitä ei kopioida ohjelman muistiin
+    // ennen kuin SQLite kirjoittaa sen tietokantaan.
+
+    QSqlQuery liitekysely( tietokanta_ );
+    liitekysely.setForwardOnly(true);
+    if( !liitekysely.exec("SELECT COUNT(*) FROM liite") || !liitekysely.next())
+        return paivittaja->virhe(liitekysely);
+    paivittaja->lisaaTyota( liitekysely.value(0).toInt() );
+
+    QSqlQuery liittokysely( tietokanta_ );
+    liittokysely.prepare("UPDATE liite SET data=:data WHERE id=:id" );
+
+    QDir hakemisto = QFileInfo( polkuTiedostoon_ ).dir();
+
+    if( !liitekysely.exec("SELECT id, tosite, liiteno FROM liite"))
+        return paivittaja->virhe(liitekysely);
+
+    while( liitekysely.next())
     {
-        query.exec(kysely);
-        qApp->processEvents();
+        QString tiedostonnimi = QString("%1-%2.pdf")
+                    .arg( liitekysely.value(1).toInt()  , 8, 10, QChar('0') )
+                    .arg( liitekysely.value(2).toInt() , 2, 10, QChar('0') );
+
+        QFile tiedosto( hakemisto.absoluteFilePath("liitteet/" + tiedostonnimi));
+        uchar *kuvattu = nullptr;
+        QByteArray data;
+        if( tiedosto.open(QIODevice::ReadOnly) && tiedosto.size() > 0)
+        {
+            kuvattu = tiedosto.map(0, tiedosto.size());
+            if( kuvattu )
+                data = QByteArray::fromRawData( reinterpret_cast<const char*>(kuvattu), static_cast<int>(tiedosto.size()) );
+            else
+                data = tiedosto.readAll();
+        }
+
+        liittokysely.bindValue(":data", data);
+        liittokysely.bindValue(":id", liitekysely.value(0).toInt());
+        bool onnistui = liittokysely.exec();
+
+        // Sidottu arvo viittaa kuvattuun muistiin, joten se vapautetaan ensin
+        liittokysely.bindValue(":data", QVariant());
+        data.clear();
+        if( kuvattu )
+            tiedosto.unmap(kuvattu);
+
+        if( !onnistui )
+            return paivittaja->virhe(liittokysely);
+        paivittaja->edisty();
     }
+    return true;
+}
+
+bool Kirjanpito::siirraLaskut(Paivittaja *paivittaja)
+{
+    // Laskujen siirtäminen vienteihin
+
+    QSqlQuery laskukysely( tietokanta_ );
+    laskukysely.setForwardOnly(true);
+    if( !laskukysely.exec("SELECT COUNT(*) FROM lasku") || !laskukysely.next())
+        return paivittaja->virhe(laskukysely);
+    paivittaja->lisaaTyota( laskukysely.value(0).toInt());
+
+    // Kyselyt valmistellaan kerran ja niitä käytetään kaikille laskuille
+    QSqlQuery eraKysely( tietokanta_ );
+    eraKysely.prepare("UPDATE vienti SET viite=:viite, laskupvm=:laskupvm, erapvm=:erapvm, asiakas=:asiakas, json=:json "
+                      "WHERE id=:era");
+    QSqlQuery maksuperusteKysely( tietokanta_ );
+    maksuperusteKysely.prepare("INSERT INTO vienti(tosite, vientirivi, pvm, kreditsnt, viite, laskupvm, erapvm, asiakas) "
+                               " VALUES(:tosite, 999, :laskupvm, :snt, :viite, :laskupvm, :erapvm, :asiakas)");
+    QSqlQuery kateisKysely( tietokanta_ );
+    kateisKysely.prepare("UPDATE vienti SET eraid=NULL, viite=:viite, laskupvm=:laskupvm, erapvm=:erapvm, asiakas=:asiakas, json=:json "
+                         "WHERE tosite=:tosite AND debetsnt > 0");
+    QSqlQuery uusiEraKysely( tietokanta_ );
+    uusiEraKysely.prepare("UPDATE vienti SET eraid=id WHERE id=:id");
+
+    if( !laskukysely.exec("SELECT id, tosite, laskupvm, erapvm, avoinSnt, asiakas, kirjausperuste, json FROM lasku"))
+        return paivittaja->virhe(laskukysely);
+
+    while( laskukysely.next())
+    {
+        int kirjausperuste = laskukysely.value("kirjausperuste").toInt();
+        JsonKentta json( laskukysely.value("json").toByteArray());
+        QSqlQuery *lkysely = nullptr;
+
+        if( kirjausperuste == LaskuModel::SUORITEPERUSTE || kirjausperuste == LaskuModel::LASKUTUSPERUSTE)
+        {
+            lkysely = &eraKysely;
+            lkysely->bindValue(":era", json.luku("TaseEra"));
+        }
+        else if( kirjausperuste == LaskuModel::MAKSUPERUSTE)
+        {
+            lkysely = &maksuperusteKysely;
+            lkysely->bindValue(":tosite", laskukysely.value("tosite").toInt());
+            lkysely->bindValue(":snt", laskukysely.value("avoinSnt").toLongLong());
+        }
+        else if( kirjausperuste == LaskuModel::KATEISLASKU)
+        {
+            lkysely = &kateisKysely;
+            lkysely->bindValue(":tosite", laskukysely.value("tosite").toInt());
+        }
+        else
+        {
+            paivittaja->edisty();
+            continue;
+        }
+
+        lkysely->bindValue(":viite", laskukysely.value("id").toString());
+        lkysely->bindValue(":laskupvm", laskukysely.value("laskupvm").toDate());
+        lkysely->bindValue(":asiakas", laskukysely.value("asiakas").toString());
+        lkysely->bindValue(":erapvm", laskukysely.value("erapvm").toDate());
+
+        if( lkysely != &maksuperusteKysely )
+        {
+            json.set("Kirjausperuste", laskukysely.value("kirjausperuste").toInt());
+            lkysely->bindValue(":json", json.toSqlJson());
+        }
+
+        if( !lkysely->exec())
+            return paivittaja->virhe(*lkysely);
+
+        if( kirjausperuste == LaskuModel::MAKSUPERUSTE)
+        {
+            uusiEraKysely.bindValue(":id", lkysely->lastInsertId().toInt());
+            if( !uusiEraKysely.exec())
+                return paivittaja->virhe(uusiEraKysely);
+        }
+        paivittaja->edisty();
+    }
+    return true;
+}
+
+bool Kirjanpito::taytaLaskusarakkeet(Paivittaja *paivittaja)
+{
+    // Laskujen suodatuksessa käytettävät json-avaimet omiin sarakkeisiinsa
+
+    QSqlQuery vientikysely( tietokanta_ );
+    vientikysely.setForwardOnly(true);
+    if( !vientikysely.exec("SELECT COUNT(*) FROM vienti WHERE json IS NOT NULL") || !vientikysely.next())
+        return paivittaja->virhe(vientikysely);
+    paivittaja->lisaaTyota( vientikysely.value(0).toInt() );
+
+    QSqlQuery paivityskysely( tietokanta_ );
+    paivityskysely.prepare("UPDATE vienti SET kirjausperuste=:kirjausperuste, hyvityslasku=:hyvityslasku, "
+                           "maksumuistutus=:maksumuistutus WHERE id=:id");
+
+    if( !vientikysely.exec("SELECT id, json FROM vienti WHERE json IS NOT NULL"))
+        return paivittaja->virhe(vientikysely);
+
+    while( vientikysely.next())
+    {
+        JsonKentta json( vientikysely.value(1).toByteArray() );
+        paivittaja->edisty();
+
+        if( json.variant("Kirjausperuste").isNull() && json.variant("Hyvityslasku").isNull() &&
+            json.variant("Maksumuistutus").isNull())
+            continue;
+
+        VientiModel::sidoLaskusarakkeet( paivityskysely, json );
+        paivityskysely.bindValue(":id", vientikysely.value(0).toInt());
+        if( !paivityskysely.exec())
+            return paivittaja->virhe(paivityskysely);
+    }
+    return true;
+}
+
+bool Kirjanpito::siirraLogo()
+{
+    QFile logotiedosto( QFileInfo( polkuTiedostoon_ ).dir().absoluteFilePath("logo.png") );
+    logotiedosto.open(QIODevice::ReadOnly);
+    QImage logo = QImage::fromData(logotiedosto.readAll(), "PNG");
+
+    liitteet_ = new LiiteModel(nullptr, this);
+    asetaLogo(logo);
+    return true;
+}
+
+QSqlDatabase Kirjanpito::lukuyhteys()
+{
+    if( QThread::currentThread() == thread())
+        return tietokanta_;
+    if( !wal_ )
+        return QSqlDatabase();
+
+    // Qt:n tietokantayhteyttä saa käyttää vain säie, joka sen on luonut
+    QString nimi = QString("lukuyhteys-%1").arg( reinterpret_cast<quintptr>(QThread::currentThreadId()) );
+
+    QMutexLocker lukitsin(&yhteysMutex_);
+    if( QSqlDatabase::contains(nimi))
+    {
+        // Yhteyden luomisen jälkeen erotetut osiot
+        QSqlDatabase yhteys = QSqlDatabase::database(nimi);
+        osiot_->liita(yhteys);
+        return yhteys;
+    }
+
+    {
+        QSqlDatabase yhteys = QSqlDatabase::addDatabase("QSQLITE", nimi);
+        yhteys.setDatabaseName( polkuTiedostoon_ );
+        yhteys.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000;QSQLITE_OPEN_URI");
+        if( yhteys.open())
+        {
+            osiot_->liita(yhteys);
+            lukuyhteydet_.insert(nimi, QThread::currentThread());
+
+            // Poolin säikeet elävät pitkään, mutta päättyessään säie poistaa yhteytensä
+            connect( QThread::currentThread(), &QThread::finished, this, [this, nimi] {
+                QMutexLocker lukitsin(&yhteysMutex_);
+                if( lukuyhteydet_.remove(nimi) )
+                    QSqlDatabase::removeDatabase(nimi);
+            }, Qt::DirectConnection);
+
+            return yhteys;
+        }
+        emit tietokantavirhe( QString("%1 -> %2").arg(nimi).arg(yhteys.lastError().text()) );
+    }
+    // Avaamatonta yhteyttä ei jätetä, jotta seuraava kutsu yrittää uudelleen
+    QSqlDatabase::removeDatabase(nimi);
+    return QSqlDatabase();
+}
+
+void Kirjanpito::suljeTietokanta()
+{
+    tarkistuspisteAjastin_->stop();
+    kyselyt_->tyhjenna();
+    suljeLukuyhteydet();
+
+    if( tietokanta_.isOpen() && wal_ )
+    {
+        tietokanta()->exec("PRAGMA wal_checkpoint(TRUNCATE)");
+        tietokanta()->exec("PRAGMA JOURNAL_MODE = DELETE");
+    }
+    tietokanta_.close();
+    osiot_->tyhjenna();
+    wal_ = false;
+
+    delete lukko_;      // Vapauttaa lukkotiedoston
+    lukko_ = nullptr;
+}
+
+void Kirjanpito::suljeLukuyhteydet()
+{
+    QList<QPointer<QThread>> saikeet;
+    {
+        QMutexLocker lukitsin(&yhteysMutex_);
+        saikeet = lukuyhteydet_.values();
+    }
+
+    for( const QPointer<QThread>& saie : saikeet)
+    {
+        if( saie && saie != QThread::currentThread())
+            saie->requestInterruption();
+    }
+
+    // Säikeet tarkastavat keskeytyspyynnön jokaisen luetun rivin jälkeen.
+    // Pitkän kyselyn vuoksi käyttöliittymää ei kuitenkaan jäädytetä:
+    // myöhästynyt säie poistaa yhteytensä itse päättyessään.
+    QElapsedTimer odotettu;
+    odotettu.start();
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    for( const QPointer<QThread>& saie : saikeet)
+    {
+        if( saie && saie != QThread::currentThread())
+        {
+            qint64 jaljella = qMax( SULKEMISODOTUS - odotettu.elapsed(), Q_INT64_C(0));
+            if( !saie->wait( static_cast<unsigned long>(jaljella)))
+                qWarning() << "Lukuyhteyttä käyttävä säie ei päättynyt" << SULKEMISODOTUS << "ms kuluessa";
+        }
+    }
+    QApplication::restoreOverrideCursor();
+}
+
+void Kirjanpito::tarkistuspiste()
+{
+    if( !wal_ || !tietokanta_.isOpen())
+        return;
+
+    // PASSIVE ei odota lukijoita, joten käyttöliittymä ei jää jumiin
+    QSqlQuery kysely( tietokanta_ );
+    if( !kysely.exec("PRAGMA wal_checkpoint(PASSIVE)"))
+        lokiin(kysely);
 }
 
 Kirjanpito* Kirjanpito::instanssi__ = nullptr;
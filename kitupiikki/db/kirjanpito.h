@@ -33,6 +33,10 @@
 #include <QTemporaryDir>
 #include <QImage>
 #include <QStringList>
+#include <QMutex>
+#include <QHash>
+#include <QPointer>
+#include <QThread>
 
 #include "tili.h"
 #include "tilikausi.h"
@@ -45,11 +49,18 @@
 #include "kohdennusmodel.h"
 #include "verotyyppimodel.h"
 #include "tilityyppimodel.h"
+#include "kyselyvarasto.h"
+#include "liitevarasto.h"
+#include "kausiosiot.h"
+#include "kirjanpidonmuutos.h"
 
 #include "laskutus/tuotemodel.h"
 
 class QPrinter;
 class QSettings;
+class QLockFile;
+class Paivittaja;
+class QTimer;
 
 /**
  * @brief Kirjanpidon käsittely
@@ -103,9 +114,9 @@ public:
      * @brief Päivämäärä, johon saakka tilit on päätetty eli ei voi enää muokata
      * @return
      */
-    QDate tilitpaatetty() const { return asetukset()->pvm("TilitPaatetty"); }
+    QDate tilitpaatetty() const { return asetukset()->kuva().tilitPaatetty; }
 
-    Tilikausi tilikausiPaivalle(const QDate &paiva) const;
+    const Tilikausi& tilikausiPaivalle(const QDate &paiva) const;
 
     /**
      * @brief Tositelajien model
@@ -173,6 +184,45 @@ public:
      */
     QSqlDatabase *tietokanta()  { return &tietokanta_; }
 
+    /**
+     * @brief Valmisteltu nimetty kysely
+     *
+     * Usein toistuvat kyselyt on rekisteröity KyselyVarasto:on, josta ne
+     * saadaan valmiiksi käännettyinä. Arvot sidotaan bindValue():lla.
+     *
+     * @param nimi Kyselyn nimi
+     * @return Kysely, joka on luettava ennen saman kyselyn uutta käyttöä
+     */
+    MitattuKysely& kysely(const QString& nimi) { return kyselyt_->kysely(nimi); }
+
+    /**
+     * @brief Onko tietokanta avattu WAL-tilassa
+     *
+     * WAL-tila otetaan käyttöön perusvalinnoista (asetus SqliteWal). Silloin
+     * tietokantaa voi lukea taustasäikeistä lukuyhteys():n kautta samaan
+     * aikaan, kun käyttöliittymä kirjoittaa siihen.
+     *
+     * @return tosi, jos WAL-tila on käytössä
+     */
+    bool onkoWal() const { return wal_; }
+
+    /**
+     * @brief Vain luku -yhteys kutsuvan säikeen käyttöön
+     *
+     * Pääsäikeessä palautetaan käyttöliittymän oma yhteys. WAL-tilassa
+     * muille säikeille luodaan kullekin oma vain luku -yhteys samaan
+     * tiedostoon. Ilman WAL-tilaa lukeminen estäisi pääsäikeen kirjoitukset,
+     * joten muille säikeille palautetaan virheellinen yhteys.
+     *
+     * Yhteyden poistaa sen luonut säie päättyessään. Kun kirjanpito
+     * suljetaan tai vaihdetaan, yhteyksiä käyttäviä säikeitä pyydetään
+     * keskeyttämään (QThread::requestInterruption()) ja niitä odotetaan
+     * hetken aikaa.
+     *
+     * @return Tietokantayhteys
+     */
+    QSqlDatabase lukuyhteys();
+
     /**
      * @brief QPrinter kaikenlaiseen tulosteluun
      * @return
@@ -227,6 +277,19 @@ public:
      */
     LiiteModel *liitteet() { return liitteet_;}
 
+    /**
+     * @brief Liitteiden erillinen tiedostovarasto
+     */
+    LiiteVarasto *liitevarasto() { return liitevarasto_; }
+
+    /**
+     * @brief Päätettyjen tilikausien erilliset tiedostot
+     *
+     * Päivämäärävälin tositteita, vientejä tai liitteitä lukevat kyselyt
+     * hakevat taulun nimen osiot()->taulu():lla.
+     */
+    KausiOsiot *osiot() { return osiot_; }
+
     /**
      * @brief Arkistohakemiston polku
      * @return
@@ -257,6 +320,16 @@ public:
      */
     void lokiin(const QSqlQuery &kysely);
 
+    /**
+     * @brief Ilmoittaa kirjanpidon muuttuneen
+     *
+     * Lähettää kirjanpitoMuuttui()-signaalin muutoksen tiedoin sekä
+     * yleisen kirjanpitoaMuokattu()-signaalin
+     *
+     * @param muutos Muuttuneet tositteet, tilit, tase-erät ja päivät
+     */
+    void ilmoitaMuutos(const KirjanpidonMuutos& muutos);
+
 signals:
     /**
      * @brief Tietokanta on avattu
@@ -266,9 +339,19 @@ signals:
     void tietokantaVaihtui();
     /**
      * @brief Kirjanpitoa on muokattu (tallennettu muokattu vienti)
+     *
+     * Yleinen ilmoitus niille, joille ei ole väliä, mitä muutettiin.
+     * Näkymät käyttävät kirjanpitoMuuttui()-signaalia, jotta niiden ei
+     * tarvitse ladata kaikkia tietojaan uudelleen.
      */
     void kirjanpitoaMuokattu();
 
+    /**
+     * @brief Kirjanpitoa on muokattu
+     * @param muutos Muuttuneet tositteet, tilit, tase-erät ja päivät
+     */
+    void kirjanpitoMuuttui(const KirjanpidonMuutos& muutos);
+
     /**
      * @brief Perusasetuksia muutetaan, joten aloitussivu päivitetään
      */
@@ -279,6 +362,11 @@ signals:
      */
     void inboxMuuttui();
 
+    /**
+     * @brief Ajastetun varmuuskopioinnin asetukset muuttuivat
+     */
+    void varmuuskopiointiMuuttui();
+
     /**
      * @brief Tilikausi on päätetty
      *
@@ -348,6 +436,9 @@ protected:
     TilityyppiModel *tiliTyypit_;
     TuoteModel *tuotteet_;
     LiiteModel *liitteet_;
+    LiiteVarasto *liitevarasto_;
+    KausiOsiot *osiot_;
+    KyselyVarasto *kyselyt_;
     QPrinter *printer_;
 
     QTemporaryDir *tempDir_;
@@ -358,6 +449,12 @@ protected:
 
     QStringList virheloki_;
 
+    bool wal_;
+    QLockFile *lukko_;
+    QTimer *tarkistuspisteAjastin_;
+    QMutex yhteysMutex_;
+    QHash<QString, QPointer<QThread>> lukuyhteydet_;   // Yhteyden nimi -> luonut säie
+
 public:
     /**
      * @brief Staattinen funktio, jonka kautta Kirjanpitoon päästään käsiksi
@@ -383,7 +480,13 @@ public:
      *
      * Jos yritetään avata uudempaa, tulee virhe
      */
-    static const int TIETOKANTAVERSIO = 10;
+    static const int TIETOKANTAVERSIO = 11;
+
+    /**
+     * @brief Kuinka kauan lukuyhteyksiä käyttäviä säikeitä enintään odotetaan
+     * kirjanpitoa suljettaessa (ms)
+     */
+    static const int SULKEMISODOTUS = 2000;
 
     /**
      * @brief Palauttaa satunnaismerkkijonon
@@ -402,10 +505,41 @@ private:
     static Kirjanpito *instanssi__;
 
     /**
-     * @brief Suorittaa päivitykset
-     * @param versioon Tietokantaversion (ei ohjelmaversio!)
+     * @brief Versioon 3 päivitettäessä liitteet siirretään tiedostoista tietokantaan
+     */
+    bool siirraLiitteet(Paivittaja *paivittaja);
+    /**
+     * @brief Versioon 3 päivitettäessä laskujen tiedot siirretään vienteihin
+     */
+    bool siirraLaskut(Paivittaja *paivittaja);
+    /**
+     * @brief Versioon 11 päivitettäessä täytetään laskujen json-avaimista tehdyt sarakkeet
+     */
+    bool taytaLaskusarakkeet(Paivittaja *paivittaja);
+    bool siirraLogo();
+
+    /**
+     * @brief Sulkee tietokannan ja sen lukuyhteydet
+     *
+     * WAL-tilassa loki siirretään ensin tietokantaan ja palataan
+     * tavalliseen lokiin, jotta suljettu kirjanpito on taas yksi tiedosto.
+     */
+    void suljeTietokanta();
+
+    /**
+     * @brief Keskeyttää lukuyhteyksiä käyttävät säikeet
+     *
+     * Qt:n yhteyden saa poistaa vain säie, joka sen on luonut, joten
+     * taustatyöt päätetään eikä yhteyksiä poisteta pääsäikeestä. Säikeitä
+     * odotetaan enintään SULKEMISODOTUS millisekuntia.
+     */
+    void suljeLukuyhteydet();
+
+private slots:
+    /**
+     * @brief Siirtää WAL-lokin tietokantaan, kun kirjanpitoa ei ole hetkeen muokattu
      */
-    void paivita(int versioon);
+    void tarkistuspiste();
 };
 
 /**
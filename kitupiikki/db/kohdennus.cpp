@@ -21,15 +21,21 @@
 #include "kohdennus.h"
 
 
+KohdennusData::KohdennusData(int id, int tyyppi, const QString &nimi, const QDate &alkaa, const QDate &paattyy, bool muokattu)
+    : id_(id), tyyppi_(tyyppi), nimi_(nimi), alkaa_(alkaa), paattyy_(paattyy),
+      muokattu_(muokattu)
+{
+
+}
+
 Kohdennus::Kohdennus(int tyyppi, const QString &nimi) :
-    id_(0), tyyppi_(tyyppi), nimi_(nimi), muokattu_(true)
+    d( new KohdennusData(0, tyyppi, nimi, QDate(), QDate(), true))
 {
 
 }
 
 Kohdennus::Kohdennus(int id, int tyyppi, const QString& nimi, QDate alkaa, QDate paattyy)
-    : id_(id), tyyppi_(tyyppi), nimi_(nimi), alkaa_(alkaa), paattyy_(paattyy),
-      muokattu_(false)
+    : d( new KohdennusData(id, tyyppi, nimi, alkaa, paattyy, false))
 {
 
 }
@@ -59,34 +65,34 @@ int Kohdennus::montakoVientia() const
 
 void Kohdennus::asetaId(int id)
 {
-    id_ = id;
+    d->id_ = id;
 }
 
 void Kohdennus::asetaNimi(const QString &nimi)
 {
-    nimi_ = nimi;
-    muokattu_ = true;
+    d->nimi_ = nimi;
+    d->muokattu_ = true;
 }
 
 void Kohdennus::asetaAlkaa(const QDate &alkaa)
 {
-    alkaa_ = alkaa;
-    muokattu_ = true;
+    d->alkaa_ = alkaa;
+    d->muokattu_ = true;
 }
 
 void Kohdennus::asetaPaattyy(const QDate &paattyy)
 {
-    paattyy_ = paattyy;
-    muokattu_ = true;
+    d->paattyy_ = paattyy;
+    d->muokattu_ = true;
 }
 
 void Kohdennus::asetaTyyppi(Kohdennus::KohdennusTyyppi tyyppi)
 {
-    tyyppi_ = tyyppi;
-    muokattu_ = true;
+    d->tyyppi_ = tyyppi;
+    d->muokattu_ = true;
 }
 
 void Kohdennus::nollaaMuokattu()
 {
-    muokattu_ = false;
+    d->muokattu_ = false;
 }
@@ -21,9 +21,30 @@
 #include <QString>
 #include <QDate>
 #include <QIcon>
+#include <QSharedData>
+
+/**
+ * @brief Kohdennuksen jaetut tiedot
+ */
+class KohdennusData : public QSharedData
+{
+public:
+    KohdennusData(int id, int tyyppi, const QString& nimi, const QDate& alkaa, const QDate& paattyy, bool muokattu);
+
+    int id_;
+    int tyyppi_;
+    QString nimi_;
+    QDate alkaa_;
+    QDate paattyy_;
+
+    bool muokattu_;
+};
 
 /**
  * @brief Kirjauksen kohdennus kustannuspaikalle tai projektiin
+ *
+ * Kohdennus on implisiittisesti jaettu kuten Tili: KohdennusModelin
+ * tietue on yhteinen kaikille kopioille, kunnes kopiota muokataan.
  */
 
 class Kohdennus
@@ -41,14 +62,14 @@ public:
     Kohdennus(int tyyppi = EIKOHDENNETA, const QString& nimi = QString());
     Kohdennus(int id, int tyyppi, const QString &nimi, QDate alkaa = QDate(), QDate paattyy = QDate());
 
-    int id() const { return id_; }
-    QString nimi() const { return nimi_; }
-    QDate alkaa() const { return alkaa_; }
-    QDate paattyy() const { return paattyy_; }
-    int tyyppi() const { return tyyppi_; }
+    int id() const { return d->id_; }
+    QString nimi() const { return d->nimi_; }
+    QDate alkaa() const { return d->alkaa_; }
+    QDate paattyy() const { return d->paattyy_; }
+    int tyyppi() const { return d->tyyppi_; }
     QIcon tyyppiKuvake() const;
 
-    bool muokattu() const { return muokattu_; }
+    bool muokattu() const { return d->muokattu_; }
 
     /**
      * @brief Montako kirjausta tälle kohdennukselle
@@ -64,13 +85,7 @@ public:
     void nollaaMuokattu();
 
 protected:
-    int id_;
-    int tyyppi_;
-    QString nimi_;
-    QDate alkaa_;
-    QDate paattyy_;
-
-    bool muokattu_;
+    QSharedDataPointer<KohdennusData> d;
 };
 
 #endif // KOHDENNUS_H
@@ -71,7 +71,7 @@ QVariant KohdennusModel::data(const QModelIndex &index, int role) const
     if( !index.isValid())
         return QVariant();
 
-    Kohdennus kohdennus = kohdennukset_[index.row()];
+    const Kohdennus& kohdennus = kohdennukset_.at(index.row());
 
     if( role == IdRooli)
         return QVariant( kohdennus.id() );
@@ -120,6 +120,7 @@ bool KohdennusModel::setData(const QModelIndex &index, const QVariant &value, in
     else if( role == NimiRooli)
     {
         kohdennukset_[ index.row()].asetaNimi( value.toString());
+        indeksoi();
     }
     else if( role == AlkaaRooli)
     {
@@ -140,24 +141,14 @@ QString KohdennusModel::nimi(int id) const
     return kohdennus(id).nimi();
 }
 
-Kohdennus KohdennusModel::kohdennus(const int id) const
+const Kohdennus &KohdennusModel::kohdennus(const int id) const
 {
-    foreach (Kohdennus projekti, kohdennukset_)
-    {
-        if( projekti.id() == id)
-            return projekti;
-    }
-    return Kohdennus();
+    return rivilla( idIndeksi_.value(id, -1) );
 }
 
-Kohdennus KohdennusModel::kohdennus(const QString &nimi) const
+const Kohdennus &KohdennusModel::kohdennus(const QString &nimi) const
 {
-    foreach (Kohdennus projekti, kohdennukset_)
-    {
-        if( projekti.nimi() == nimi)
-            return projekti;
-    }
-    return Kohdennus();
+    return rivilla( nimiIndeksi_.value(nimi, -1) );
 }
 
 QList<Kohdennus> KohdennusModel::kohdennukset() const
@@ -193,6 +184,7 @@ void KohdennusModel::poistaRivi(int riviIndeksi)
         poistetutIdt_.append( kohdennus.id());
 
     kohdennukset_.removeAt(riviIndeksi);
+    indeksoi();     // Rivien indeksit siirtyvät
     endRemoveRows();
 }
 
@@ -200,7 +192,7 @@ bool KohdennusModel::onkoMuokattu() const
 {
     if( poistetutIdt_.count())
         return true;
-    foreach (Kohdennus kohdennus, kohdennukset_)
+    for( const Kohdennus& kohdennus : kohdennukset_)
     {
         if( kohdennus.muokattu())
             return true;
@@ -223,6 +215,7 @@ void KohdennusModel::lataa()
                                      kysely.value(3).toDate(),
                                      kysely.value(4).toDate()));
     }
+    indeksoi();
     endResetModel();
 }
 
@@ -230,6 +223,7 @@ void KohdennusModel::lisaaUusi(const Kohdennus& uusi)
 {
     beginInsertRows(QModelIndex(), kohdennukset_.count(), kohdennukset_.count());
     kohdennukset_.append( uusi );
+    indeksoiRivi( kohdennukset_.count() - 1);
     endInsertRows();
 }
 
@@ -275,6 +269,35 @@ void KohdennusModel::tallenna()
     poistetutIdt_.clear();
 
     tietokanta_->commit();
+    indeksoi();     // Uudet kohdennukset saivat id:n
+}
+
+void KohdennusModel::indeksoi()
+{
+    idIndeksi_.clear();
+    nimiIndeksi_.clear();
+    idIndeksi_.reserve( kohdennukset_.count());
+    nimiIndeksi_.reserve( kohdennukset_.count());
+
+    for(int i=0; i < kohdennukset_.count(); i++)
+        indeksoiRivi(i);
+}
+
+void KohdennusModel::indeksoiRivi(int rivi)
+{
+    const Kohdennus& kohdennus = kohdennukset_.at(rivi);
+    // Samalla avaimella ensimmäinen rivi, kuten läpikäyvässä haussa
+    if( !idIndeksi_.contains( kohdennus.id()))
+        idIndeksi_.insert( kohdennus.id(), rivi);
+    if( !nimiIndeksi_.contains( kohdennus.nimi()))
+        nimiIndeksi_.insert( kohdennus.nimi(), rivi);
+}
+
+const Kohdennus &KohdennusModel::rivilla(int rivi) const
+{
+    if( rivi < 0 || rivi >= kohdennukset_.count())
+        return tyhjaKohdennus_;
+    return kohdennukset_.at(rivi);
 }
 
 
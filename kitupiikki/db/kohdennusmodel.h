@@ -21,6 +21,7 @@
 #include <QAbstractTableModel>
 #include <QDate>
 #include <QList>
+#include <QHash>
 #include <QSqlDatabase>
 
 #include "kohdennus.h"
@@ -29,6 +30,8 @@
 /**
  * @brief Kohdennusten luettelo
  *
+ * Kohdennukset haetaan id:n ja nimen perusteella hajautustaulujen kautta.
+ * Indeksit rakennetaan lataa()-funktiossa ja päivitetään muutosten yhteydessä.
  *
  */
 class KohdennusModel : public QAbstractTableModel
@@ -61,8 +64,8 @@ public:
     bool setData(const QModelIndex &index, const QVariant &value, int role);
 
     QString nimi(int id) const;
-    Kohdennus kohdennus(const int id) const;
-    Kohdennus kohdennus(const QString& nimi) const;
+    const Kohdennus& kohdennus(const int id) const;
+    const Kohdennus& kohdennus(const QString& nimi) const;
     QList<Kohdennus> kohdennukset() const;
 
     /**
@@ -90,11 +93,21 @@ public slots:
     void tallenna();
 
 
+protected:
+    void indeksoi();
+    void indeksoiRivi(int rivi);
+    const Kohdennus& rivilla(int rivi) const;
+
 protected:
     QSqlDatabase *tietokanta_;
     QList<Kohdennus> kohdennukset_;
     QList<int> poistetutIdt_;
 
+    QHash<int,int> idIndeksi_;
+    QHash<QString,int> nimiIndeksi_;
+
+    Kohdennus tyhjaKohdennus_;
+
 
 };
 
@@ -0,0 +1,100 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "kyselyloki.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTimer>
+#include <QCoreApplication>
+#include <QRegularExpression>
+
+namespace {
+    QMutex lokiMutex__;
+    QList<KyselyLoki::Merkinta> merkinnat__;
+    int toiminto__ = 0;
+    bool toimintoAuki__ = false;
+}
+
+bool KyselyLoki::kaytossa__ = false;
+
+void KyselyLoki::asetaKaytossa(bool kaytossa)
+{
+    kaytossa__ = kaytossa;
+}
+
+int KyselyLoki::toiminto()
+{
+    QMutexLocker lukko(&lokiMutex__);
+
+    // Uusi toiminto alkaa, kun ensimmäinen kysely suoritetaan
+    // tapahtumasilmukasta palaamisen jälkeen
+    if( QThread::currentThread() == qApp->thread() && !toimintoAuki__ )
+    {
+        toiminto__++;
+        toimintoAuki__ = true;
+        QTimer::singleShot(0, qApp, [] {
+            QMutexLocker lukko(&lokiMutex__);
+            toimintoAuki__ = false;
+        });
+    }
+    return toiminto__;
+}
+
+void KyselyLoki::kirjaa(KyselyLoki::Merkinta merkinta)
+{
+    if( !merkinta.toiminto )
+        merkinta.toiminto = toiminto();
+
+    QMutexLocker lukko(&lokiMutex__);
+
+    QThread *saie = QThread::currentThread();
+    if( saie == qApp->thread())
+        merkinta.saie = QString();
+    else
+        merkinta.saie = QString("0x%1").arg( reinterpret_cast<quintptr>(saie), 0, 16 );
+
+    merkinta.muoto = muoto( merkinta.lause );
+
+    merkinnat__.append( merkinta );
+    if( merkinnat__.count() > ENIMMAISMAARA)
+        merkinnat__.removeFirst();
+}
+
+QList<KyselyLoki::Merkinta> KyselyLoki::merkinnat()
+{
+    QMutexLocker lukko(&lokiMutex__);
+    return merkinnat__;
+}
+
+void KyselyLoki::tyhjenna()
+{
+    QMutexLocker lukko(&lokiMutex__);
+    merkinnat__.clear();
+}
+
+QString KyselyLoki::muoto(const QString &lause)
+{
+    static const QRegularExpression merkkijonoRe(R"('[^']*'|"[^"]*")");
+    static const QRegularExpression lukuRe(R"(\b\d+(\.\d+)?\b)");
+
+    QString tulos(lause);
+    tulos.replace(merkkijonoRe, "?");
+    tulos.replace(lukuRe, "?");
+    return tulos.simplified();
+}
@@ -0,0 +1,89 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KYSELYLOKI_H
+#define KYSELYLOKI_H
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief Sql-kyselyjen mittausloki
+ *
+ * MitattuKysely kirjaa tänne jokaisen suorituksensa: lauseen, sidotut arvot,
+ * keston ja rivimäärän. Kirjaaminen on käytössä vain, kun se on kytketty
+ * päälle kehittäjän työkaluista.
+ *
+ * Kyselyt ryhmitellään käyttäjän toimintoihin: kaikki käyttöliittymäsäikeen
+ * kyselyt, jotka suoritetaan ennen kuin ohjelma palaa tapahtumasilmukkaan,
+ * kuuluvat samaan toimintoon. Kun saman muotoinen kysely (lause, josta
+ * vakiot on poistettu) toistuu yhdessä toiminnossa monta kertaa, kyse on
+ * yleensä N+1-kyselystä, joka kannattaisi korvata yhdellä kyselyllä.
+ */
+class KyselyLoki
+{
+public:
+    struct Merkinta
+    {
+        QDateTime aika;
+        int toiminto = 0;
+        QString saie;
+        QString lause;
+        QString muoto;
+        QString arvot;
+        qint64 kestoUs = 0;
+        int rivit = 0;
+    };
+
+    static void asetaKaytossa(bool kaytossa);
+    static bool kaytossa() { return kaytossa__; }
+
+    /**
+     * @brief Meneillään olevan toiminnon numero
+     *
+     * Käyttöliittymäsäikeessä aloittaa uuden toiminnon, jos ohjelma on
+     * palannut tapahtumasilmukkaan edellisen kyselyn jälkeen. Kutsutaan,
+     * kun kysely suoritetaan, vaikka se kirjataan vasta rivit luettua.
+     */
+    static int toiminto();
+
+    /**
+     * @brief Kirjaa kyselyn suorituksen
+     *
+     * Säie täydennetään kirjattaessa, samoin toiminto, ellei sitä ole annettu
+     */
+    static void kirjaa(Merkinta merkinta);
+
+    static QList<Merkinta> merkinnat();
+    static void tyhjenna();
+
+    /**
+     * @brief Kyselyn muoto: lause, josta luvut ja merkkijonovakiot on korvattu ?-merkillä
+     */
+    static QString muoto(const QString& lause);
+
+    /**
+     * @brief Merkintöjen enimmäismäärä, jonka jälkeen vanhimmat poistetaan
+     */
+    static const int ENIMMAISMAARA = 20000;
+
+protected:
+    static bool kaytossa__;
+};
+
+#endif // KYSELYLOKI_H
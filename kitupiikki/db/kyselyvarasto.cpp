@@ -0,0 +1,106 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "kyselyvarasto.h"
+
+KyselyVarasto::KyselyVarasto(QSqlDatabase *tietokanta) :
+    tietokanta_(tietokanta)
+{
+
+}
+
+KyselyVarasto::~KyselyVarasto()
+{
+    tyhjenna();
+}
+
+void KyselyVarasto::lisaa(const QString &nimi, const QString &lause)
+{
+    delete kyselyt_.take(nimi);
+    lauseet_.insert(nimi, lause);
+}
+
+MitattuKysely &KyselyVarasto::kysely(const QString &nimi)
+{
+    MitattuKysely *kysely = kyselyt_.value(nimi, nullptr);
+    if( kysely )
+    {
+        // Vapautetaan edellisen suorituksen tulokset
+        kysely->finish();
+        return *kysely;
+    }
+
+    kysely = new MitattuKysely( *tietokanta_ );
+    kysely->setForwardOnly(true);
+    kysely->prepare( lauseet_.value(nimi) );
+    kyselyt_.insert(nimi, kysely);
+    return *kysely;
+}
+
+void KyselyVarasto::tyhjenna()
+{
+    qDeleteAll( kyselyt_ );
+    kyselyt_.clear();
+}
+
+void KyselyVarasto::lisaaVakiokyselyt()
+{
+    // Tilien saldot (Tili::saldoPaivalle)
+    // Kertymät lasketaan viimeisimmästä tilinpäätöskuvasta (ks. SaldoTaulu::kertyma)
+    lisaa("TaseSaldo", "WITH raja AS (SELECT tili, pvm, "
+                       "(SELECT MAX(kausi) FROM saldokuva WHERE kausi <= pvm) AS kausi "
+                       "FROM (SELECT :tili AS tili, :pvm AS pvm)) "
+                       "SELECT SUM(debetsnt), SUM(kreditsnt) FROM ("
+                       "SELECT debetsnt, kreditsnt FROM saldokuva, raja "
+                       "WHERE saldokuva.kausi = raja.kausi AND saldokuva.tili = raja.tili "
+                       "UNION ALL "
+                       "SELECT debetsnt, kreditsnt FROM saldo, raja "
+                       "WHERE saldo.tili = raja.tili AND saldo.pvm > IFNULL(raja.kausi, '') "
+                       "AND saldo.pvm <= raja.pvm)");
+    lisaa("TulosSaldo", "SELECT SUM(debetsnt), SUM(kreditsnt) FROM saldo "
+                        "WHERE tili=:tili AND pvm BETWEEN :alkaa AND :loppuu");
+    lisaa("TulosEnnen", "WITH raja AS (SELECT pvm, "
+                        "(SELECT MAX(kausi) FROM saldokuva WHERE kausi <= pvm) AS kausi "
+                        "FROM (SELECT :pvm AS pvm)) "
+                        "SELECT SUM(debetsnt), SUM(kreditsnt) FROM ("
+                        "SELECT saldokuva.tili, debetsnt, kreditsnt FROM saldokuva, raja "
+                        "WHERE saldokuva.kausi = raja.kausi "
+                        "UNION ALL "
+                        "SELECT saldo.tili, debetsnt, kreditsnt FROM saldo, raja "
+                        "WHERE saldo.pvm > IFNULL(raja.kausi, '') AND saldo.pvm <= raja.pvm) AS saldo, tili "
+                        "WHERE saldo.tili = tili.id AND ysiluku > 300000000");
+    lisaa("TulosValilla", "SELECT SUM(debetsnt), SUM(kreditsnt) FROM saldo, tili "
+                          "WHERE saldo.tili = tili.id AND pvm BETWEEN :alkaa AND :loppuu "
+                          "AND ysiluku > 300000000");
+
+    // Tase-erät
+    lisaa("TaseEra", "SELECT era.debetsnt, era.kreditsnt, era.pvm, selite, era.tosite "
+                     "FROM era LEFT OUTER JOIN vienti ON vienti.id=era.id "
+                     "WHERE era.id=:era");
+    lisaa("TositteenTunniste", "SELECT tositelaji.tunnus, tosite.tunniste FROM tositelaji, tosite "
+                               "WHERE tosite.id=:tosite AND tosite.laji=tositelaji.id");
+
+    // Viennit
+    lisaa("VientiMerkkaukset", "SELECT kohdennus FROM merkkaus WHERE vienti=:vienti");
+    lisaa("VientiArkistotunnuksella", "SELECT id FROM vienti WHERE arkistotunnus=:arkistotunnus");
+    lisaa("VientiTilille", "SELECT tili, selite, kohdennus FROM vienti WHERE id=:id");
+
+    // Tiliotteen tuonti (Tuonti::oterivi)
+    lisaa("MyyntiViitteella", "SELECT eraid FROM vienti WHERE viite=:viite AND iban IS NULL");
+    lisaa("OstoViitteella", "SELECT id, tili, selite, kohdennus FROM vienti "
+                            "WHERE iban=:iban AND viite=:viite ORDER BY pvm");
+}
@@ -0,0 +1,82 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KYSELYVARASTO_H
+#define KYSELYVARASTO_H
+
+#include <QHash>
+#include <QString>
+#include <QSqlDatabase>
+#include "mitattukysely.h"
+
+/**
+ * @brief Valmiiksi käännettyjen sql-kyselyjen varasto
+ *
+ * Usein toistuvat kyselyt rekisteröidään nimellä, ja ne valmistellaan
+ * (prepare) tietokannalle vain kerran. Tämän jälkeen kyselyä käytetään
+ * uudelleen sitomalla siihen arvot, jolloin SQLite ei joudu jäsentämään
+ * ja suunnittelemaan kyselyä joka kutsulla uudelleen.
+ *
+ * Kyselyn tulokset on luettava ennen kuin samaa kyselyä pyydetään
+ * uudelleen, sillä kysely() vapauttaa edellisen tulosjoukon.
+ *
+ * Kirjanpito omistaa varaston, ja kyselyt saadaan Kirjanpito::kysely()
+ * -funktiolla. Kyselyt ovat MitattuKyselyjä, joten ne näkyvät kyselylokissa.
+ *
+ */
+class KyselyVarasto
+{
+public:
+    KyselyVarasto(QSqlDatabase *tietokanta);
+    ~KyselyVarasto();
+
+    /**
+     * @brief Rekisteröi nimetyn kyselyn
+     * @param nimi Kyselyn nimi
+     * @param lause Sql-lause, jossa parametrit nimettyinä (:nimi)
+     */
+    void lisaa(const QString& nimi, const QString& lause);
+
+    /**
+     * @brief Palauttaa valmistellun kyselyn
+     *
+     * Kyselyyn sidotaan arvot bindValue()-funktiolla ja se suoritetaan exec()-funktiolla
+     *
+     * @param nimi Rekisteröidyn kyselyn nimi
+     * @return Valmisteltu kysely
+     */
+    MitattuKysely& kysely(const QString& nimi);
+
+    /**
+     * @brief Vapauttaa valmistellut kyselyt
+     *
+     * Kutsuttava ennen kuin tietokanta suljetaan tai vaihdetaan
+     */
+    void tyhjenna();
+
+    /**
+     * @brief Rekisteröi ohjelman vakiokyselyt
+     */
+    void lisaaVakiokyselyt();
+
+protected:
+    QSqlDatabase *tietokanta_;
+    QHash<QString, QString> lauseet_;
+    QHash<QString, MitattuKysely*> kyselyt_;
+};
+
+#endif // KYSELYVARASTO_H
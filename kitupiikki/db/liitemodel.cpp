@@ -42,6 +42,8 @@
 #include <poppler/qt5/poppler-qt5.h>
 
 
+QCache<QString, QByteArray> LiiteModel::valimuisti__( LiiteModel::VALIMUISTI_KT );
+
 LiiteModel::LiiteModel(TositeModel *tositemodel, QObject *parent)
     : QAbstractListModel(parent), tositeModel_(tositemodel), muokattu_(false)
 {
@@ -66,13 +68,13 @@ QVariant LiiteModel::data(const QModelIndex &index, int role) const
         return QVariant( liite.sha);
     else if( role == TiedostoNimiRooli && tositeModel_)
     {
-        if( liite.pdf.startsWith("%PDF") )
+        if( liite.alku.startsWith("%PDF") )
         {
             return QString("%1-%2.pdf")
                     .arg( tositeModel_->id(), 8, 10, QChar('0') )
                     .arg( liite.liiteno , 2, 10, QChar('0') );
         }
-        else if( liite.pdf.startsWith(  static_cast<char>( 0xff) ))
+        else if( liite.alku.startsWith(  static_cast<char>( 0xff) ))
         {
             return QString("%1-%2.png")
                     .arg( tositeModel_->id(), 8, 10, QChar('0') )
@@ -87,7 +89,7 @@ QVariant LiiteModel::data(const QModelIndex &index, int role) const
         }
     }
     else if( role == PdfRooli )
-        return liite.pdf;
+        return sisalto(liite);
     else if( role == LiiteNumeroRooli )
         return liite.liiteno;
     else if( role == IdRooli)
@@ -185,6 +187,7 @@ int LiiteModel::lisaaLiite(const QByteArray &liite, const QString &otsikko, cons
         }
     }
 
+    uusi.alku = uusi.pdf.left(8);
     liitteet_.append(uusi);
 
     endInsertRows();
@@ -256,7 +259,7 @@ QByteArray LiiteModel::liite(const QString &otsikko)
 {
     for( Liite liite : liitteet_ )
         if( liite.otsikko == otsikko )
-            return liite.pdf;
+            return sisalto(liite);
 
     return QByteArray();
 }
@@ -311,13 +314,14 @@ void LiiteModel::lataa()
     endResetModel();
     liitteet_.clear();
 
-    QSqlQuery kysely( *kp()->tietokanta() );
+    QSqlQuery kysely( tositeModel_ ? *tositeModel_->tietokanta() : *kp()->tietokanta() );
 
     if( tositeModel_ )
-        kysely.exec( QString("SELECT id, liiteno, otsikko, peukku, sha, data "
-                         "FROM liite WHERE tosite=%1 ORDER BY liiteno").arg( tositeModel_->id() ));
+        kysely.exec( QString("SELECT id, liiteno, otsikko, peukku, sha, substr(data,1,8) AS alku, data IS NULL AS erillaan "
+                         "FROM %2 WHERE tosite=%1 ORDER BY liiteno").arg( tositeModel_->id() )
+                     .arg( kp()->osiot()->taulu("liite", tositeModel_->pvm(), tositeModel_->pvm()) ));
     else
-        kysely.exec( QString("SELECT id, liiteno, otsikko, peukku, sha, data "
+        kysely.exec( QString("SELECT id, liiteno, otsikko, peukku, sha, substr(data,1,8) AS alku, data IS NULL AS erillaan "
                          "FROM liite WHERE tosite is NULL ORDER BY liiteno"));
 
 
@@ -329,7 +333,13 @@ void LiiteModel::lataa()
         uusi.otsikko = kysely.value("otsikko").toString();
         uusi.sha = kysely.value("sha").toByteArray();
         uusi.thumbnail = kysely.value("peukku").toByteArray();
-        uusi.pdf = kysely.value("data").toByteArray();
+
+        // Sisältö ladataan vasta tarvittaessa, erilliseen varastoon
+        // tallennetun liitteen data on NULL
+        if( kysely.value("erillaan").toBool())
+            uusi.alku = kp()->liitevarasto()->lue( uusi.sha, 8 );
+        else
+            uusi.alku = kysely.value("alku").toByteArray();
 
         liitteet_.append(uusi);
     }
@@ -348,6 +358,7 @@ void LiiteModel::tyhjaa()
 bool LiiteModel::tallenna()
 {
     QString inboxPolku = kp()->asetukset()->asetus("KirjattavienKansio");
+    bool erillaan = kp()->asetukset()->onko("LiitteetErillaan");
 
     QSqlQuery kysely( *kp()->tietokanta() );
     for( int i=0; i<liitteet_.count(); i++)
@@ -372,7 +383,11 @@ bool LiiteModel::tallenna()
                 kysely.bindValue(":sha", liitteet_.at(i).sha);
                 kysely.bindValue(":peukku", liitteet_.at(i).thumbnail);
                 kysely.bindValue(":otsikko", liitteet_[i].otsikko);
-                kysely.bindValue(":data", liitteet_.at(i).pdf);
+                // Varastoon tallennettu sisältö jätetään tietokannasta pois
+                if( erillaan && kp()->liitevarasto()->tallenna( liitteet_.at(i).sha, liitteet_.at(i).pdf ))
+                    kysely.bindValue(":data", QVariant());
+                else
+                    kysely.bindValue(":data", liitteet_.at(i).pdf);
                 kysely.bindValue(":liitetty", QDateTime::currentDateTime());
 
                 if( !kysely.exec() )
@@ -409,10 +424,38 @@ bool LiiteModel::tallenna()
     for( int poistettuId : poistetutIdt_)
         kysely.exec( QString("DELETE from liite WHERE id=%1").arg(poistettuId) );
 
+    // Tositteen liitteiden tiedostot siivotaan vasta, kun tosite on tallennettu
+    if( !tositeModel_ )
+        kp()->liitevarasto()->siivoa( *kp()->tietokanta() );
+
     muokattu_ = false;
     return true;
 }
 
+QByteArray LiiteModel::sisalto(const Liite &liite) const
+{
+    // Lisätty liite on muistissa, kunnes toinen tosite ladataan
+    if( !liite.id || !liite.pdf.isEmpty())
+        return liite.pdf;
+
+    QString avain = QString("%1-%2").arg(liite.id).arg( QString::fromLatin1(liite.sha));
+    if( QByteArray *muistissa = valimuisti__.object(avain))
+        return *muistissa;
+
+    QSqlQuery kysely( tositeModel_ ? *tositeModel_->tietokanta() : *kp()->tietokanta() );
+    if( tositeModel_ )
+        kysely.exec( QString("SELECT data FROM %2 WHERE id=%1").arg(liite.id)
+                     .arg( kp()->osiot()->taulu("liite", tositeModel_->pvm(), tositeModel_->pvm()) ));
+    else
+        kysely.exec( QString("SELECT data FROM liite WHERE id=%1").arg(liite.id));
+    if( !kysely.next())
+        return QByteArray();
+
+    QByteArray data = kp()->liitevarasto()->sisalto( kysely.value("data"), liite.sha );
+    valimuisti__.insert(avain, new QByteArray(data), qMax(1, data.size() / 1024));
+    return data;
+}
+
 int LiiteModel::seuraavaNumero() const
 {
     int seuraava = 1;
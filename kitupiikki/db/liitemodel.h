@@ -22,9 +22,14 @@
 #include <QString>
 #include <QSqlDatabase>
 #include <QBuffer>
+#include <QCache>
 
 /**
  * @brief Yhden liitteen tiedot. TositeModel käyttää.
+ *
+ * Tallennetun liitteen sisältöä (pdf) ei ladata tositteen avaamisen
+ * yhteydessä, vaan vasta kun sitä tarvitaan. Tiedostotyyppi tunnistetaan
+ * sisällön alusta.
  */
 struct Liite
 {
@@ -34,6 +39,7 @@ struct Liite
     QByteArray sha;
 
     QByteArray pdf;
+    QByteArray alku;
     QByteArray thumbnail;
     bool muokattu = false;
     QString lisattyPolusta;
@@ -116,9 +122,25 @@ signals:
     void liiteMuutettu();
 
 
+    /**
+     * @brief Ladattujen liitteiden välimuistin enimmäiskoko kilotavuina
+     */
+    static const int VALIMUISTI_KT = 32 * 1024;
+
 protected:
     int seuraavaNumero() const;
 
+    /**
+     * @brief Liitteen sisältö, tarvittaessa ladattuna tietokannasta
+     *
+     * Ladatut sisällöt pidetään välimuistissa, josta vähiten aikaa sitten
+     * käytetyt poistetaan ensin, joten tositteiden selaaminen edestakaisin
+     * ei lue samoja liitteitä uudelleen.
+     */
+    QByteArray sisalto(const Liite& liite) const;
+
+    static QCache<QString, QByteArray> valimuisti__;
+
     TositeModel *tositeModel_;
     QList<Liite> liitteet_;
     QList<int> poistetutIdt_;
@@ -0,0 +1,253 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "liitevarasto.h"
+#include "kirjanpito.h"
+
+#include <QSqlQuery>
+#include <QSaveFile>
+#include <QTemporaryFile>
+#include <QFileInfo>
+#include <QCryptographicHash>
+#include <QStringList>
+
+LiiteVarasto::LiiteVarasto()
+{
+
+}
+
+QString LiiteVarasto::hakemistoKirjanpidolle(const QString &tiedostopolku)
+{
+    QFileInfo info(tiedostopolku);
+    return info.dir().absoluteFilePath( info.completeBaseName() + ".liitteet");
+}
+
+void LiiteVarasto::asetaHakemisto(const QString &hakemisto)
+{
+    hakemisto_ = QDir(hakemisto);
+}
+
+bool LiiteVarasto::alusta(QSqlDatabase &tietokanta)
+{
+    bool uusi = !tietokanta.tables().contains("liitetiedosto");
+
+    QSqlQuery kysely(tietokanta);
+
+    // Triggerit sisältävät puolipisteitä, joten niitä ei voi
+    // pitää luo.sql:ssä
+    QStringList luonti;
+    luonti << "CREATE TABLE IF NOT EXISTS liitetiedosto ("
+              "sha         TEXT    NOT NULL PRIMARY KEY,"
+              "viittauksia INTEGER NOT NULL DEFAULT 0 ) WITHOUT ROWID"
+
+           << "CREATE INDEX IF NOT EXISTS liitetiedosto_tarpeettomat "
+              "ON liitetiedosto(viittauksia) WHERE viittauksia < 1"
+
+           << "CREATE TRIGGER IF NOT EXISTS liitetiedosto_lisays AFTER INSERT ON liite "
+              "WHEN NEW.data IS NULL "
+              "BEGIN "
+              "INSERT OR IGNORE INTO liitetiedosto(sha) VALUES (NEW.sha); "
+              "UPDATE liitetiedosto SET viittauksia = viittauksia + 1 WHERE sha = NEW.sha; "
+              "END"
+
+           << "CREATE TRIGGER IF NOT EXISTS liitetiedosto_poisto AFTER DELETE ON liite "
+              "WHEN OLD.data IS NULL "
+              "BEGIN "
+              "UPDATE liitetiedosto SET viittauksia = viittauksia - 1 WHERE sha = OLD.sha; "
+              "END"
+
+           << "CREATE TRIGGER IF NOT EXISTS liitetiedosto_muutos AFTER UPDATE OF sha, data ON liite "
+              "BEGIN "
+              "UPDATE liitetiedosto SET viittauksia = viittauksia - 1 "
+              "WHERE sha = OLD.sha AND OLD.data IS NULL; "
+              "INSERT OR IGNORE INTO liitetiedosto(sha) SELECT NEW.sha WHERE NEW.data IS NULL; "
+              "UPDATE liitetiedosto SET viittauksia = viittauksia + 1 "
+              "WHERE sha = NEW.sha AND NEW.data IS NULL; "
+              "END";
+
+    for( const QString& lause : luonti)
+    {
+        if( !kysely.exec(lause) )
+        {
+            kp()->lokiin(kysely);
+            return false;
+        }
+    }
+
+    if( uusi && !kysely.exec("INSERT INTO liitetiedosto(sha, viittauksia) "
+                             "SELECT sha, COUNT(*) FROM liite WHERE data IS NULL GROUP BY sha"))
+    {
+        kp()->lokiin(kysely);
+        return false;
+    }
+    return true;
+}
+
+bool LiiteVarasto::tallenna(const QByteArray &sha, const QByteArray &data)
+{
+    // Sama sisältö tallennetaan vain kerran
+    if( onko(sha))
+        return true;
+
+    QString tiedostopolku = polku(sha);
+    if( !QDir().mkpath( QFileInfo(tiedostopolku).absolutePath() ))
+        return false;
+
+    // QSaveFile kirjoittaa ensin väliaikaiseen tiedostoon, joten varastoon ei
+    // jää keskeneräistä tiedostoa
+    QSaveFile tiedosto( tiedostopolku );
+    if( !tiedosto.open(QIODevice::WriteOnly))
+        return false;
+
+    for(int alku = 0; alku < data.size(); alku += PALANKOKO)
+    {
+        if( tiedosto.write( data.constData() + alku, qMin(PALANKOKO, data.size() - alku)) < 0)
+        {
+            tiedosto.cancelWriting();
+            return false;
+        }
+    }
+    return tiedosto.commit();
+}
+
+bool LiiteVarasto::onko(const QByteArray &sha) const
+{
+    return !sha.isEmpty() && QFile::exists( polku(sha) );
+}
+
+QByteArray LiiteVarasto::lue(const QByteArray &sha, qint64 pituus) const
+{
+    if( sha.isEmpty())
+        return QByteArray();
+
+    QFile tiedosto( polku(sha) );
+    if( !tiedosto.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return pituus < 0 ? tiedosto.readAll() : tiedosto.read(pituus);
+}
+
+QByteArray LiiteVarasto::sisalto(const QVariant &data, const QByteArray &sha) const
+{
+    if( !data.isNull())
+        return data.toByteArray();
+    return lue(sha);
+}
+
+int LiiteVarasto::siivoa(QSqlDatabase &tietokanta)
+{
+    QSqlQuery kysely(tietokanta);
+    if( !kysely.exec("SELECT sha FROM liitetiedosto WHERE viittauksia < 1"))
+        return 0;
+
+    QStringList poistettavat;
+    while( kysely.next())
+        poistettavat.append( kysely.value(0).toString());
+
+    for( const QString& sha : poistettavat)
+    {
+        QFile::remove( polku( sha.toLatin1() ));
+        kysely.exec( QString("DELETE FROM liitetiedosto WHERE sha='%1' AND viittauksia < 1").arg(sha));
+    }
+    return poistettavat.count();
+}
+
+int LiiteVarasto::siirra(QSqlDatabase &tietokanta, Edistyminen edistyminen)
+{
+    if( !hakemisto_.mkpath("."))
+        return -1;
+
+    QSqlQuery kysely(tietokanta);
+    QList<int> siirrettavat;
+    if( !kysely.exec("SELECT id FROM liite WHERE data IS NOT NULL"))
+    {
+        kp()->lokiin(kysely);
+        return -1;
+    }
+    while( kysely.next())
+        siirrettavat.append( kysely.value(0).toInt());
+
+    QSqlQuery palakysely(tietokanta);
+    palakysely.prepare("SELECT substr(data, :alku, :pituus) FROM liite WHERE id=:id");
+
+    QSqlQuery paivityskysely(tietokanta);
+    paivityskysely.prepare("UPDATE liite SET sha=:sha, data=NULL WHERE id=:id");
+
+    int siirretty = 0;
+    for( int id : siirrettavat )
+    {
+        // Data kirjoitetaan paloittain väliaikaistiedostoon ja tiiviste
+        // lasketaan samalla, joten koko liitettä ei tarvita muistiin
+        QTemporaryFile valiaikainen( hakemisto_.absoluteFilePath("siirto-XXXXXX"));
+        if( !valiaikainen.open())
+            return -1;
+
+        QCryptographicHash tiiviste(QCryptographicHash::Sha256);
+        for(int alku = 1; ; alku += PALANKOKO)
+        {
+            palakysely.bindValue(":alku", alku);
+            palakysely.bindValue(":pituus", PALANKOKO);
+            palakysely.bindValue(":id", id);
+            if( !palakysely.exec() || !palakysely.next())
+            {
+                kp()->lokiin(palakysely);
+                return -1;
+            }
+            QByteArray pala = palakysely.value(0).toByteArray();
+            palakysely.finish();
+            if( pala.isEmpty())
+                break;
+
+            tiiviste.addData(pala);
+            if( valiaikainen.write(pala) != pala.size())
+                return -1;
+            if( pala.size() < PALANKOKO)
+                break;
+        }
+        valiaikainen.close();
+
+        QByteArray sha = tiiviste.result().toHex();
+        QString kohde = polku(sha);
+        if( !QFile::exists(kohde) )
+        {
+            if( !QDir().mkpath( QFileInfo(kohde).absolutePath()) || !valiaikainen.rename(kohde))
+                return -1;
+            valiaikainen.setAutoRemove(false);
+        }
+
+        // Tiiviste lasketaan varmuudeksi datasta, jotta liite löytyy varastosta
+        paivityskysely.bindValue(":sha", sha);
+        paivityskysely.bindValue(":id", id);
+        if( !paivityskysely.exec())
+        {
+            kp()->lokiin(paivityskysely);
+            return -1;
+        }
+
+        siirretty++;
+        if( edistyminen )
+            edistyminen( siirretty, siirrettavat.count());
+    }
+
+    return siirretty;
+}
+
+QString LiiteVarasto::polku(const QByteArray &sha) const
+{
+    // Tiedostot jaetaan alihakemistoihin tiivisteen kahden ensimmäisen merkin mukaan
+    QString nimi = QString::fromLatin1(sha);
+    return hakemisto_.absoluteFilePath( nimi.left(2) + "/" + nimi );
+}
@@ -0,0 +1,116 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LIITEVARASTO_H
+#define LIITEVARASTO_H
+
+#include <QDir>
+#include <QByteArray>
+#include <QSqlDatabase>
+
+#include <functional>
+
+/**
+ * @brief Liitteiden erillinen tiedostovarasto
+ *
+ * Liitteiden sisältö voidaan tallentaa tietokannan liite.data-kentän sijaan
+ * kirjanpidon viereiseen hakemistoon (kirjanpito.liitteet), jossa kukin
+ * sisältö on tiedostona SHA-256 -tiivisteensä nimellä. Samanlainen
+ * dokumentti tallennetaan näin vain kerran.
+ *
+ * Varastossa olevan liitteen data on tietokannassa NULL. Taulu
+ * liitetiedosto pitää triggereillä kirjaa, moniko liite viittaa kuhunkin
+ * tiedostoon, ja siivoa() poistaa tiedostot, joihin ei enää viitata.
+ *
+ * Uudet liitteet tallennetaan varastoon, kun asetus LiitteetErillaan on
+ * päällä. Aiemmat liitteet siirretään varastoon siirra()-funktiolla.
+ */
+class LiiteVarasto
+{
+public:
+    typedef std::function<void(int valmis, int yhteensa)> Edistyminen;
+
+    LiiteVarasto();
+
+    /**
+     * @brief Varaston hakemisto kirjanpitotiedoston vieressä
+     * @param tiedostopolku Kirjanpitotiedoston polku
+     */
+    static QString hakemistoKirjanpidolle(const QString& tiedostopolku);
+
+    void asetaHakemisto(const QString& hakemisto);
+    QString hakemisto() const { return hakemisto_.absolutePath(); }
+
+    /**
+     * @brief Luo viittauslaskennan taulun ja triggerit, ellei niitä vielä ole
+     * @return tosi, jos onnistui
+     */
+    static bool alusta(QSqlDatabase& tietokanta);
+
+    /**
+     * @brief Tallentaa sisällön varastoon, ellei samaa sisältöä jo ole
+     * @param sha Sisällön SHA-256 heksamuodossa
+     * @return tosi, jos sisältö on tallennuksen jälkeen varastossa
+     */
+    bool tallenna(const QByteArray& sha, const QByteArray& data);
+
+    bool onko(const QByteArray& sha) const;
+
+    /**
+     * @brief Lukee sisällön varastosta
+     * @param pituus Luettavien tavujen enimmäismäärä, -1 koko sisältö
+     */
+    QByteArray lue(const QByteArray& sha, qint64 pituus = -1) const;
+
+    /**
+     * @brief Liitteen sisältö tietokannasta tai varastosta
+     * @param data liite.data-kentän arvo
+     * @param sha liite.sha-kentän arvo
+     */
+    QByteArray sisalto(const QVariant& data, const QByteArray& sha) const;
+
+    /**
+     * @brief Poistaa tiedostot, joihin ei enää viitata
+     *
+     * Kutsutaan vasta, kun liitteiden poistot on vahvistettu (commit),
+     * jotta perutun poiston tiedostot säilyvät.
+     *
+     * @return Poistettujen tiedostojen määrä
+     */
+    int siivoa(QSqlDatabase& tietokanta);
+
+    /**
+     * @brief Siirtää tietokantaan tallennetut liitteet varastoon
+     *
+     * Liitteet luetaan tietokannasta ja kirjoitetaan varastoon paloittain,
+     * joten suurtakaan liitettä ei ladata kerralla muistiin. Kukin liite
+     * siirretään omana transaktionaan, joten keskeytynyt siirto voidaan
+     * aloittaa uudelleen.
+     *
+     * @return Siirrettyjen liitteiden määrä, -1 jos siirto epäonnistui
+     */
+    int siirra(QSqlDatabase& tietokanta, Edistyminen edistyminen = Edistyminen());
+
+    static const int PALANKOKO = 1024 * 1024;
+
+protected:
+    QString polku(const QByteArray& sha) const;
+
+    QDir hakemisto_;
+};
+
+#endif // LIITEVARASTO_H
@@ -0,0 +1,135 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mitattukysely.h"
+#include "kyselyloki.h"
+
+#include <QStringList>
+#include <QVariant>
+
+MitattuKysely::MitattuKysely(QSqlDatabase tietokanta) :
+    QSqlQuery(tietokanta)
+{
+
+}
+
+MitattuKysely::MitattuKysely(const QString &lause, QSqlDatabase tietokanta) :
+    QSqlQuery(tietokanta)
+{
+    if( !lause.isEmpty())
+        exec(lause);
+}
+
+MitattuKysely::~MitattuKysely()
+{
+    kirjaa();
+}
+
+bool MitattuKysely::exec(const QString &lause)
+{
+    aloita();
+    bool onnistui = QSqlQuery::exec(lause);
+    suoritettu(onnistui);
+    return onnistui;
+}
+
+bool MitattuKysely::exec()
+{
+    aloita();
+
+    if( kesken_ )
+    {
+        QStringList arvot;
+        QMapIterator<QString,QVariant> iter( boundValues() );
+        while( iter.hasNext())
+        {
+            iter.next();
+            arvot.append( QString("%1=%2").arg(iter.key()).arg(iter.value().toString()));
+        }
+        arvot_ = arvot.join(", ");
+        ajastin_.restart();
+    }
+
+    bool onnistui = QSqlQuery::exec();
+    suoritettu(onnistui);
+    return onnistui;
+}
+
+bool MitattuKysely::next()
+{
+    if( !kesken_ )
+        return QSqlQuery::next();
+
+    ajastin_.restart();
+    bool onnistui = QSqlQuery::next();
+    kestoNs_ += ajastin_.nsecsElapsed();
+    if( onnistui )
+        rivit_++;
+    else
+        kirjaa();       // Kaikki rivit on luettu
+    return onnistui;
+}
+
+void MitattuKysely::finish()
+{
+    kirjaa();
+    QSqlQuery::finish();
+}
+
+void MitattuKysely::aloita()
+{
+    // Kesken jäänyt edellinen suoritus kirjataan ennen uutta
+    kirjaa();
+
+    kesken_ = KyselyLoki::kaytossa();
+    kestoNs_ = 0;
+    rivit_ = 0;
+    arvot_.clear();
+    if( kesken_ )
+    {
+        aika_ = QDateTime::currentDateTime();
+        toiminto_ = KyselyLoki::toiminto();
+        ajastin_.start();
+    }
+}
+
+void MitattuKysely::suoritettu(bool onnistui)
+{
+    if( !kesken_ )
+        return;
+
+    kestoNs_ += ajastin_.nsecsElapsed();
+    // Muuttavaa tai epäonnistunutta kyselyä ei lueta next():llä
+    if( !onnistui || !isSelect())
+        kirjaa();
+}
+
+void MitattuKysely::kirjaa()
+{
+    if( !kesken_ )
+        return;
+    kesken_ = false;
+
+    KyselyLoki::Merkinta merkinta;
+    merkinta.aika = aika_;
+    merkinta.toiminto = toiminto_;
+    merkinta.lause = lastQuery();
+    merkinta.arvot = arvot_;
+    merkinta.kestoUs = kestoNs_ / 1000;
+    merkinta.rivit = isSelect() ? rivit_ : numRowsAffected();
+    KyselyLoki::kirjaa( merkinta );
+}
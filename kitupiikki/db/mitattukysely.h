@@ -0,0 +1,65 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MITATTUKYSELY_H
+#define MITATTUKYSELY_H
+
+#include <QSqlQuery>
+#include <QElapsedTimer>
+#include <QDateTime>
+
+/**
+ * @brief Sql-kysely, jonka suoritukset kirjataan KyselyLokiin
+ *
+ * Käytetään kuten QSqlQuerya. Kun kyselyloki on käytössä, kirjataan
+ * kunkin suorituksen lause, sidotut arvot, exec()- ja next()-kutsuihin
+ * kulunut aika sekä luettujen (tai muutettujen) rivien määrä.
+ *
+ * Aika ja toiminto otetaan exec()-kutsusta. Suoritus kirjataan, kun
+ * next() palauttaa epätoden, kun kysely ei palauta rivejä, finish():ssä,
+ * tai viimeistään seuraavassa exec():ssä tai purkajassa.
+ *
+ * Koska QSqlQueryn funktiot eivät ole virtuaalisia, mittaus toimii vain,
+ * kun kyselyä käsitellään MitattuKysely-tyyppisenä.
+ */
+class MitattuKysely : public QSqlQuery
+{
+public:
+    explicit MitattuKysely(QSqlDatabase tietokanta = QSqlDatabase());
+    explicit MitattuKysely(const QString& lause, QSqlDatabase tietokanta = QSqlDatabase());
+    ~MitattuKysely();
+
+    bool exec(const QString& lause);
+    bool exec();
+    bool next();
+    void finish();
+
+protected:
+    void aloita();
+    void suoritettu(bool onnistui);
+    void kirjaa();
+
+    QElapsedTimer ajastin_;
+    QDateTime aika_;
+    int toiminto_ = 0;
+    QString arvot_;
+    qint64 kestoNs_ = 0;
+    int rivit_ = 0;
+    bool kesken_ = false;
+};
+
+#endif // MITATTUKYSELY_H
@@ -0,0 +1,228 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "paivittaja.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
+#include <QVariant>
+
+Paivittaja::Paivittaja(QSqlDatabase *tietokanta)
+    : tietokanta_(tietokanta)
+{
+
+}
+
+void Paivittaja::lisaaVaihe(int versio, const QString &skripti, Paivittaja::Toimet toimet)
+{
+    Vaihe vaihe;
+    vaihe.versio = versio;
+    vaihe.skripti = skripti;
+    vaihe.toimet = toimet;
+    vaiheet_.append(vaihe);
+}
+
+bool Paivittaja::paivita(int nykyinenVersio)
+{
+    valmis_ = 0;
+    yhteensa_ = 0;
+    virhe_.clear();
+    ilmoitettu_.start();
+
+    // Luetaan ensin kaikki skriptit, jotta työn määrä tiedetään
+    QList<QStringList> skriptit;
+    for( const Vaihe& vaihe : vaiheet_)
+    {
+        QStringList lista;
+        if( vaihe.versio > nykyinenVersio && !vaihe.skripti.isEmpty())
+        {
+            QFile tiedosto( vaihe.skripti );
+            if( !tiedosto.open(QIODevice::ReadOnly))
+            {
+                virhe_ = QString("%1 -> %2").arg(vaihe.skripti).arg(tiedosto.errorString());
+                return false;
+            }
+            QTextStream in(&tiedosto);
+            in.setCodec("UTF-8");
+            lista = lauseet( in.readAll() );
+        }
+        yhteensa_ += lista.count() + 1;
+        skriptit.append(lista);
+    }
+
+    // Vierasavaimia ei voi kytkeä pois transaktion sisällä, joten
+    // se tehdään tässä koko päivityksen ajaksi
+    QSqlQuery kysely( *tietokanta_ );
+    bool vierasavaimet = kysely.exec("PRAGMA foreign_keys") && kysely.next() && kysely.value(0).toBool();
+    kysely.exec("PRAGMA foreign_keys = OFF");
+
+    bool onnistui = true;
+    for(int i=0; i < vaiheet_.count() && onnistui; i++)
+    {
+        if( vaiheet_.at(i).versio > nykyinenVersio)
+            onnistui = ajaVaihe( vaiheet_.at(i), skriptit.at(i) );
+    }
+
+    if( vierasavaimet )
+        kysely.exec("PRAGMA foreign_keys = ON");
+
+    ilmoita(true);
+    return onnistui;
+}
+
+void Paivittaja::lisaaTyota(int maara)
+{
+    yhteensa_ += maara;
+}
+
+void Paivittaja::edisty(int maara)
+{
+    valmis_ += maara;
+    ilmoita(false);
+}
+
+bool Paivittaja::virhe(const QSqlQuery &kysely)
+{
+    virhe_ = QString("%1 -> %2")
+            .arg(kysely.lastQuery())
+            .arg(kysely.lastError().text());
+    return false;
+}
+
+QStringList Paivittaja::lauseet(const QString &skripti)
+{
+    QStringList lista;
+    QString lause;
+    QChar lainaus;
+    bool kommentti = false;
+
+    for(int i=0; i < skripti.length(); i++)
+    {
+        QChar merkki = skripti.at(i);
+
+        if( kommentti )
+        {
+            if( merkki == '\n')
+                kommentti = false;
+            continue;
+        }
+        if( !lainaus.isNull() )
+        {
+            if( merkki == lainaus)
+                lainaus = QChar();
+        }
+        else if( merkki == '\'' || merkki == '"')
+            lainaus = merkki;
+        else if( merkki == '-' && skripti.midRef(i, 2) == "--")
+        {
+            kommentti = true;
+            continue;
+        }
+        else if( merkki == ';')
+        {
+            if( !lause.trimmed().isEmpty())
+                lista.append( lause.trimmed() );
+            lause.clear();
+            continue;
+        }
+        lause.append( merkki == '\n' ? QChar(' ') : merkki );
+    }
+    if( !lause.trimmed().isEmpty())
+        lista.append( lause.trimmed());
+
+    return lista;
+}
+
+bool Paivittaja::ajaVaihe(const Paivittaja::Vaihe &vaihe, const QStringList &lauseet)
+{
+    if( !tietokanta_->transaction())
+    {
+        virhe_ = tietokanta_->lastError().text();
+        return false;
+    }
+
+    QSqlQuery kysely( *tietokanta_ );
+    for( const QString& lause : lauseet)
+    {
+        // Vierasavaimet on jo kytketty pois transaktion ulkopuolella
+        if( !lause.startsWith("PRAGMA foreign_keys", Qt::CaseInsensitive) &&
+            !kysely.exec(lause) && !onkoJoTehty(kysely))
+        {
+            virhe(kysely);
+            tietokanta_->rollback();
+            return false;
+        }
+        edisty();
+    }
+
+    if( (vaihe.toimet && !vaihe.toimet(this)) || !merkitseVersio(vaihe.versio))
+    {
+        tietokanta_->rollback();
+        return false;
+    }
+    edisty();
+
+    if( !tietokanta_->commit())
+    {
+        virhe_ = tietokanta_->lastError().text();
+        tietokanta_->rollback();
+        return false;
+    }
+    return true;
+}
+
+bool Paivittaja::onkoJoTehty(const QSqlQuery &kysely)
+{
+    // Osin käsin tai aiemmilla kehitysversioilla päivitetyssä tietokannassa
+    // lisättävä sarake tai indeksi voi jo olla olemassa
+    QString virheteksti = kysely.lastError().text();
+    return virheteksti.contains("duplicate column name") ||
+           ( kysely.lastQuery().startsWith("CREATE", Qt::CaseInsensitive) &&
+             virheteksti.contains("already exists"));
+}
+
+bool Paivittaja::merkitseVersio(int versio)
+{
+    // Versio päivitetään samassa transaktiossa, joten kesken jäänyt
+    // vaihe ajetaan seuraavalla kerralla uudelleen
+    QSqlQuery kysely( *tietokanta_ );
+    kysely.prepare("UPDATE asetus SET arvo=:versio, muokattu=:aika WHERE avain='KpVersio'");
+    kysely.bindValue(":versio", QString::number(versio));
+    kysely.bindValue(":aika", QDateTime::currentDateTime());
+    if( !kysely.exec())
+        return virhe(kysely);
+    if( kysely.numRowsAffected() > 0)
+        return true;
+
+    kysely.prepare("INSERT INTO asetus(avain, arvo, muokattu) VALUES('KpVersio', :versio, :aika)");
+    kysely.bindValue(":versio", QString::number(versio));
+    kysely.bindValue(":aika", QDateTime::currentDateTime());
+    return kysely.exec() || virhe(kysely);
+}
+
+void Paivittaja::ilmoita(bool aina)
+{
+    // Ilmoitetaan enintään kymmenen kertaa sekunnissa
+    if( edistyminen_ && ( aina || ilmoitettu_.elapsed() > 100 ))
+    {
+        edistyminen_( qMin(valmis_, yhteensa_), yhteensa_);
+        ilmoitettu_.restart();
+    }
+}
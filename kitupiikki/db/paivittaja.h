@@ -0,0 +1,130 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAIVITTAJA_H
+#define PAIVITTAJA_H
+
+#include <QSqlDatabase>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QList>
+
+#include <functional>
+
+class QSqlQuery;
+
+/**
+ * @brief Tietokannan rakenteen päivittäjä
+ *
+ * Päivitys koostuu versiovaiheista. Kukin vaihe ajetaan yhtenä
+ * transaktiona: ensin vaiheen sql-skripti, sitten mahdolliset
+ * C++-toimet (esim. tietojen siirto) ja lopuksi asetus KpVersio
+ * päivitetään vaiheen versioon. Jos ohjelma kaatuu tai vaihe epäonnistuu,
+ * vaihe perutaan kokonaan, ja seuraavalla avauskerralla päivitys jatkuu
+ * samasta vaiheesta.
+ *
+ * Edistymisestä ilmoitetaan asetaEdistyminen():llä annetulle funktiolle.
+ */
+class Paivittaja
+{
+public:
+    /**
+     * @brief Edistymisen ilmoittava funktio
+     *
+     * Parametreina tehdyt ja kaikki työvaiheet. Kaikkien määrä voi kasvaa
+     * päivityksen aikana, kun vaiheen toimet kertovat käsiteltävien rivien määrän.
+     */
+    typedef std::function<void(int valmis, int yhteensa)> Edistyminen;
+
+    /**
+     * @brief Vaiheen C++-toimet, palauttaa tosi jos onnistui
+     */
+    typedef std::function<bool(Paivittaja *paivittaja)> Toimet;
+
+    Paivittaja(QSqlDatabase *tietokanta);
+
+    /**
+     * @brief Lisää päivitysvaiheen
+     * @param versio Tietokantaversio, johon vaihe päivittää
+     * @param skripti Ajettavan sql-tiedoston polku, tyhjä jos ei skriptiä
+     * @param toimet Skriptin jälkeen samassa transaktiossa ajettavat toimet
+     */
+    void lisaaVaihe(int versio, const QString& skripti, Toimet toimet = Toimet());
+
+    void asetaEdistyminen(Edistyminen edistyminen) { edistyminen_ = edistyminen; }
+
+    /**
+     * @brief Ajaa vaiheet, joiden versio on suurempi kuin nykyinen
+     * @param nykyinenVersio Tietokannan nykyinen KpVersio
+     * @return tosi, jos kaikki vaiheet onnistuivat
+     */
+    bool paivita(int nykyinenVersio);
+
+    QSqlDatabase *tietokanta() { return tietokanta_; }
+
+    /**
+     * @brief Vaiheen toimet lisäävät työvaiheita (esim. siirrettävien rivien määrän)
+     */
+    void lisaaTyota(int maara);
+
+    /**
+     * @brief Ilmoittaa työvaiheiden valmistuneen
+     */
+    void edisty(int maara = 1);
+
+    /**
+     * @brief Kirjaa kyselyn virheen päivityksen virheeksi
+     * @return aina epätosi, jotta toimet voivat palauttaa sen suoraan
+     */
+    bool virhe(const QSqlQuery& kysely);
+
+    /**
+     * @brief Viimeisin virhe
+     */
+    QString virhe() const { return virhe_; }
+
+    /**
+     * @brief Jakaa sql-skriptin lauseiksi
+     *
+     * Lauseet erotetaan puolipisteillä, jotka eivät ole lainausmerkeissä.
+     * Kommentit ja tyhjät lauseet jätetään pois.
+     */
+    static QStringList lauseet(const QString& skripti);
+
+protected:
+    struct Vaihe
+    {
+        int versio;
+        QString skripti;
+        Toimet toimet;
+    };
+
+    bool ajaVaihe(const Vaihe& vaihe, const QStringList& lauseet);
+    bool merkitseVersio(int versio);
+    static bool onkoJoTehty(const QSqlQuery& kysely);
+    void ilmoita(bool aina);
+
+    QSqlDatabase *tietokanta_;
+    QList<Vaihe> vaiheet_;
+    Edistyminen edistyminen_;
+    QElapsedTimer ilmoitettu_;
+    int valmis_ = 0;
+    int yhteensa_ = 0;
+    QString virhe_;
+};
+
+#endif // PAIVITTAJA_H
@@ -0,0 +1,208 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "saldotaulu.h"
+#include "kirjanpito.h"
+
+#include <QSqlQuery>
+#include <QStringList>
+
+bool SaldoTaulu::alusta(QSqlDatabase &tietokanta)
+{
+    bool uusi = !tietokanta.tables().contains("saldo");
+
+    QSqlQuery kysely(tietokanta);
+
+    // Triggerit sisältävät puolipisteitä, joten niitä ei voi
+    // pitää luo.sql:ssä
+    QStringList luonti;
+    luonti << "CREATE TABLE IF NOT EXISTS saldo ("
+              "tili      INTEGER NOT NULL,"
+              "pvm       DATE    NOT NULL,"
+              "debetsnt  BIGINT  NOT NULL DEFAULT 0,"
+              "kreditsnt BIGINT  NOT NULL DEFAULT 0,"
+              "PRIMARY KEY(tili, pvm) ) WITHOUT ROWID"
+
+           << "CREATE TRIGGER IF NOT EXISTS saldo_vienti_lisays AFTER INSERT ON vienti "
+              "BEGIN "
+              "INSERT OR IGNORE INTO saldo(tili, pvm) SELECT NEW.tili, NEW.pvm "
+              "WHERE NEW.tili IS NOT NULL AND NEW.pvm IS NOT NULL; "
+              "UPDATE saldo SET debetsnt = debetsnt + IFNULL(NEW.debetsnt,0), "
+              "kreditsnt = kreditsnt + IFNULL(NEW.kreditsnt,0) "
+              "WHERE tili = NEW.tili AND pvm = NEW.pvm; "
+              "END"
+
+           << "CREATE TRIGGER IF NOT EXISTS saldo_vienti_poisto AFTER DELETE ON vienti "
+              "BEGIN "
+              "UPDATE saldo SET debetsnt = debetsnt - IFNULL(OLD.debetsnt,0), "
+              "kreditsnt = kreditsnt - IFNULL(OLD.kreditsnt,0) "
+              "WHERE tili = OLD.tili AND pvm = OLD.pvm; "
+              "DELETE FROM saldo WHERE tili = OLD.tili AND pvm = OLD.pvm "
+              "AND debetsnt = 0 AND kreditsnt = 0; "
+              "END"
+
+           << "CREATE TRIGGER IF NOT EXISTS saldo_vienti_muutos "
+              "AFTER UPDATE OF tili, pvm, debetsnt, kreditsnt ON vienti "
+              "BEGIN "
+              "UPDATE saldo SET debetsnt = debetsnt - IFNULL(OLD.debetsnt,0), "
+              "kreditsnt = kreditsnt - IFNULL(OLD.kreditsnt,0) "
+              "WHERE tili = OLD.tili AND pvm = OLD.pvm; "
+              "INSERT OR IGNORE INTO saldo(tili, pvm) SELECT NEW.tili, NEW.pvm "
+              "WHERE NEW.tili IS NOT NULL AND NEW.pvm IS NOT NULL; "
+              "UPDATE saldo SET debetsnt = debetsnt + IFNULL(NEW.debetsnt,0), "
+              "kreditsnt = kreditsnt + IFNULL(NEW.kreditsnt,0) "
+              "WHERE tili = NEW.tili AND pvm = NEW.pvm; "
+              "DELETE FROM saldo WHERE tili = OLD.tili AND pvm = OLD.pvm "
+              "AND debetsnt = 0 AND kreditsnt = 0; "
+              "END"
+
+           << "CREATE INDEX IF NOT EXISTS saldo_pvm ON saldo(pvm)"
+
+           << "CREATE TABLE IF NOT EXISTS saldokuva ("
+              "kausi     DATE    NOT NULL,"
+              "tili      INTEGER NOT NULL,"
+              "debetsnt  BIGINT  NOT NULL DEFAULT 0,"
+              "kreditsnt BIGINT  NOT NULL DEFAULT 0,"
+              "PRIMARY KEY(kausi, tili) ) WITHOUT ROWID"
+
+           // Kuvan kattamien saldojen muuttuessa kuva ei enää pidä paikkaansa
+           << "CREATE TRIGGER IF NOT EXISTS saldokuva_lisays AFTER INSERT ON saldo "
+              "WHEN NEW.pvm <= (SELECT MAX(kausi) FROM saldokuva) "
+              "BEGIN "
+              "DELETE FROM saldokuva WHERE kausi >= NEW.pvm; "
+              "END"
+
+           << "CREATE TRIGGER IF NOT EXISTS saldokuva_poisto AFTER DELETE ON saldo "
+              "WHEN OLD.pvm <= (SELECT MAX(kausi) FROM saldokuva) "
+              "BEGIN "
+              "DELETE FROM saldokuva WHERE kausi >= OLD.pvm; "
+              "END"
+
+           << "CREATE TRIGGER IF NOT EXISTS saldokuva_muutos AFTER UPDATE ON saldo "
+              "WHEN MIN(OLD.pvm, NEW.pvm) <= (SELECT MAX(kausi) FROM saldokuva) "
+              "BEGIN "
+              "DELETE FROM saldokuva WHERE kausi >= MIN(OLD.pvm, NEW.pvm); "
+              "END";
+
+    for( const QString& lause : luonti)
+    {
+        if( !kysely.exec(lause) )
+        {
+            kp()->lokiin(kysely);
+            return false;
+        }
+    }
+
+    if( uusi )
+        return rakenna(tietokanta);
+    return true;
+}
+
+bool SaldoTaulu::rakenna(QSqlDatabase &tietokanta)
+{
+    // Saldoihin lasketaan myös päätettyjen kausien osiot
+    QString viennit = kp()->osiot()->taulu("vienti");
+
+    tietokanta.transaction();
+    QSqlQuery kysely(tietokanta);
+
+    if( !kysely.exec("DELETE FROM saldokuva") ||
+        !kysely.exec("DELETE FROM saldo") ||
+        !kysely.exec(QString("INSERT INTO saldo(tili, pvm, debetsnt, kreditsnt) "
+                     "SELECT tili, pvm, SUM(IFNULL(debetsnt,0)), SUM(IFNULL(kreditsnt,0)) "
+                     "FROM %1 WHERE tili IS NOT NULL AND pvm IS NOT NULL "
+                     "GROUP BY tili, pvm").arg(viennit)) )
+    {
+        kp()->lokiin(kysely);
+        tietokanta.rollback();
+        return false;
+    }
+
+    if( !tietokanta.commit())
+        return false;
+
+    // Kuva lasketaan uudelleen lukitun kauden lopulle
+    QDate paatetty = kp()->asetukset()->pvm("TilitPaatetty");
+    return !paatetty.isValid() || tallennaKuva(tietokanta, paatetty);
+}
+
+int SaldoTaulu::tarkasta(QSqlDatabase &tietokanta)
+{
+    // Nollarivejä ei oteta vertailuun, koska ne eivät vaikuta saldoihin
+    QString vienneista = QString("SELECT tili, pvm, SUM(IFNULL(debetsnt,0)), SUM(IFNULL(kreditsnt,0)) "
+                       "FROM %1 WHERE tili IS NOT NULL AND pvm IS NOT NULL "
+                       "GROUP BY tili, pvm "
+                       "HAVING SUM(IFNULL(debetsnt,0)) <> 0 OR SUM(IFNULL(kreditsnt,0)) <> 0")
+            .arg( kp()->osiot()->taulu("vienti"));
+    QString saldoista("SELECT tili, pvm, debetsnt, kreditsnt FROM saldo "
+                      "WHERE debetsnt <> 0 OR kreditsnt <> 0");
+
+    QSqlQuery kysely(tietokanta);
+    if( !kysely.exec(QString("SELECT COUNT(*) FROM (%1 EXCEPT %2) ").arg(vienneista).arg(saldoista)) || !kysely.next())
+    {
+        kp()->lokiin(kysely);
+        return -1;
+    }
+    int virheita = kysely.value(0).toInt();
+
+    if( !kysely.exec(QString("SELECT COUNT(*) FROM (%2 EXCEPT %1) ").arg(vienneista).arg(saldoista)) || !kysely.next())
+    {
+        kp()->lokiin(kysely);
+        return -1;
+    }
+    return virheita + kysely.value(0).toInt();
+}
+
+bool SaldoTaulu::tallennaKuva(QSqlDatabase &tietokanta, const QDate &paattyy)
+{
+    QSqlQuery kysely(tietokanta);
+    kysely.exec(QString("SELECT 1 FROM saldokuva WHERE kausi='%1' LIMIT 1").arg(paattyy.toString(Qt::ISODate)));
+    if( kysely.next())
+        return true;
+
+    if( !kysely.exec(QString("INSERT INTO saldokuva(kausi, tili, debetsnt, kreditsnt) "
+                             "SELECT '%1', tili, SUM(debetsnt), SUM(kreditsnt) FROM %2 "
+                             "GROUP BY tili")
+                     .arg(paattyy.toString(Qt::ISODate))
+                     .arg(kertyma(paattyy))))
+    {
+        kp()->lokiin(kysely);
+        return false;
+    }
+    return true;
+}
+
+bool SaldoTaulu::poistaKuvat(QSqlDatabase &tietokanta, const QDate &alkaen)
+{
+    QSqlQuery kysely(tietokanta);
+    if( !kysely.exec(QString("DELETE FROM saldokuva WHERE kausi >= '%1'").arg(alkaen.toString(Qt::ISODate))))
+    {
+        kp()->lokiin(kysely);
+        return false;
+    }
+    return true;
+}
+
+QString SaldoTaulu::kertyma(const QDate &pvm)
+{
+    return QString("(SELECT tili, debetsnt, kreditsnt FROM saldokuva "
+                   "WHERE kausi = (SELECT MAX(kausi) FROM saldokuva WHERE kausi <= '%1') "
+                   "UNION ALL "
+                   "SELECT tili, debetsnt, kreditsnt FROM saldo "
+                   "WHERE pvm > IFNULL((SELECT MAX(kausi) FROM saldokuva WHERE kausi <= '%1'), '') "
+                   "AND pvm <= '%1') AS saldo").arg(pvm.toString(Qt::ISODate));
+}
@@ -0,0 +1,96 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SALDOTAULU_H
+#define SALDOTAULU_H
+
+#include <QSqlDatabase>
+#include <QDate>
+
+/**
+ * @brief Tilikohtaisten päiväsaldojen taulu
+ *
+ * Taulussa saldo on kullekin tilille ja päivälle viennien debet- ja
+ * kreditsummat. Taulua ylläpidetään vienti-taulun triggereillä, joten
+ * saldo päivittyy samassa transaktiossa kuin viennit tallennetaan
+ * (VientiModel::tallenna(), TositeModel::poista(), tilinavaus).
+ *
+ * Tilin saldo mille tahansa päivälle saadaan näin (tili, pvm)-avaimen
+ * alkuosalla haettuna, eikä koko vientitaulua tarvitse käydä läpi.
+ *
+ * Tilikautta lukittaessa tilien kertymät tallennetaan tilinpäätöskuvaksi
+ * (taulu saldokuva), joten kertymä() laskee kuvaan vain sen jälkeiset
+ * päiväsaldot. Jos kuvan kattamia saldoja muutetaan, triggerit poistavat
+ * muutospäivän ja sen jälkeiset kuvat.
+ *
+ */
+class SaldoTaulu
+{
+public:
+    /**
+     * @brief Luo saldotaulun ja triggerit, ellei niitä vielä ole
+     *
+     * Jos taulu luodaan, lasketaan saldot olemassa olevista vienneistä.
+     *
+     * @param tietokanta
+     * @return tosi, jos onnistui
+     */
+    static bool alusta(QSqlDatabase &tietokanta);
+
+    /**
+     * @brief Laskee saldotaulun kokonaan uudelleen vienneistä
+     * @param tietokanta
+     * @return tosi, jos onnistui
+     */
+    static bool rakenna(QSqlDatabase &tietokanta);
+
+    /**
+     * @brief Vertaa saldotaulua vienteihin
+     * @param tietokanta
+     * @return Virheellisten (tili, pvm)-rivien määrä, -1 jos tarkastus epäonnistui
+     */
+    static int tarkasta(QSqlDatabase &tietokanta);
+
+    /**
+     * @brief Tallentaa tilien kertymät päivälle tilinpäätöskuvaksi
+     *
+     * Kuva lasketaan edellisestä kuvasta ja sen jälkeisistä päiväsaldoista.
+     * Jo tallennettua kuvaa ei muuteta.
+     *
+     * @param paattyy Lukitun tilikauden päättymispäivä
+     * @return tosi, jos onnistui
+     */
+    static bool tallennaKuva(QSqlDatabase &tietokanta, const QDate& paattyy);
+
+    /**
+     * @brief Poistaa kuvat päivästä alkaen, kun tilikauden lukitus perutaan
+     */
+    static bool poistaKuvat(QSqlDatabase &tietokanta, const QDate& alkaen);
+
+    /**
+     * @brief Tilien kertymät päivään asti
+     *
+     * Alikyselyn (aliaksena saldo) sarakkeet ovat tili, debetsnt ja kreditsnt,
+     * ja tilin rivien summa on tilin kertymä päivään pvm asti. Rivit ovat
+     * viimeisimmän kuvan saldot sekä kuvan jälkeiset päiväsaldot.
+     *
+     * @param pvm Viimeinen mukaan laskettava päivä
+     */
+    static QString kertyma(const QDate& pvm);
+};
+
+#endif // SALDOTAULU_H
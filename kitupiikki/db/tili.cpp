@@ -19,32 +19,42 @@
 
 #include <QDebug>
 #include <QSqlQuery>
+#include <QSqlError>
 
 #include "kirjanpito.h"
 
-Tili::Tili() : id_(0), numero_(0), tila_(1),ylaotsikkoId_(0), muokattu_(false), tilamuokattu_(false), muokkausAika_(QDateTime())
+TiliData::TiliData() : id_(0), numero_(0), tila_(1),ylaotsikkoId_(0), muokattu_(false), tilamuokattu_(false), muokkausAika_(QDateTime())
 {
 
 }
 
-Tili::Tili(int id, int numero, const QString &nimi, const QString &tyyppi, int tila, int ylaotsikkoid, const QDateTime muokkausaika) :
-    id_(id), numero_(numero), nimi_(nimi), ylaotsikkoId_(ylaotsikkoid), muokattu_(false), tilamuokattu_(false), muokkausAika_(muokkausaika)
+Tili::Tili() : d( tyhjaData() )
+{
+
+}
 
+Tili::Tili(int id, int numero, const QString &nimi, const QString &tyyppi, int tila, int ylaotsikkoid, const QDateTime muokkausaika) :
+    d( new TiliData )
 {
+    d->id_ = id;
+    d->numero_ = numero;
+    d->nimi_ = nimi;
+    d->ylaotsikkoId_ = ylaotsikkoid;
+    d->muokkausAika_ = muokkausaika;
     asetaTila(tila);
-    tyyppi_ = kp()->tiliTyypit()->tyyppiKoodilla(tyyppi);
+    d->tyyppi_ = kp()->tiliTyypit()->tyyppiKoodilla(tyyppi);
 }
 
 void Tili::asetaNumero(int numero)
 {
-    numero_ = numero;
-    muokattu_ = true;
+    d->numero_ = numero;
+    d->muokattu_ = true;
 }
 
 void Tili::asetaTyyppi(const QString &tyyppikoodi)
 {
-    tyyppi_ = kp()->tiliTyypit()->tyyppiKoodilla(tyyppikoodi);
-    muokattu_ = true;
+    d->tyyppi_ = kp()->tiliTyypit()->tyyppiKoodilla(tyyppikoodi);
+    d->muokattu_ = true;
 }
 
 bool Tili::onkoValidi() const
@@ -58,18 +68,22 @@ int Tili::ysivertailuluku() const
 }
 
 
-qlonglong Tili::saldoPaivalle(const QDate &pvm)
+qlonglong Tili::saldoPaivalle(const QDate &pvm) const
 {
-    QString kysymys = QString("SELECT SUM(debetsnt), SUM(kreditsnt) FROM vienti WHERE tili=%1 ").arg(id());
+    // Saldot haetaan päiväsaldojen taulusta (ks. SaldoTaulu)
+    Tilikausi kausi = kp()->tilikaudet()->tilikausiPaivalle(pvm);
+
+    MitattuKysely& kysely = onko(TiliLaji::TASE) ? kp()->kysely("TaseSaldo") : kp()->kysely("TulosSaldo");
+    kysely.bindValue(":tili", id());
     if( onko(TiliLaji::TASE) )
-        kysymys.append( QString(" AND pvm <= \"%1\" ").arg(pvm.toString(Qt::ISODate)));
+        kysely.bindValue(":pvm", pvm);
     else
-        kysymys.append( QString(" AND pvm BETWEEN \"%1\" AND \"%2\" ")
-                        .arg( kp()->tilikaudet()->tilikausiPaivalle(pvm).alkaa().toString(Qt::ISODate) )
-                        .arg( pvm.toString(Qt::ISODate )));
+    {
+        kysely.bindValue(":alkaa", kausi.alkaa());
+        kysely.bindValue(":loppuu", pvm);
+    }
 
-    QSqlQuery kysely(kysymys);
-    if( kysely.next())
+    if( kysely.exec() && kysely.next())
     {
         qlonglong debet = kysely.value(0).toLongLong();
         qlonglong kredit = kysely.value(1).toLongLong();
@@ -77,11 +91,9 @@ qlonglong Tili::saldoPaivalle(const QDate &pvm)
         if( onko(TiliLaji::EDELLISTENTULOS) )
         {
             // Edellisten yli/alijaamaan pitää laskea vielä edellisten tulokset
-            QSqlQuery edelliskysely( QString("SELECT SUM(debetsnt), SUM(kreditsnt) FROM vienti, tili "
-                                             "WHERE vienti.tili = tili.id AND pvm < \"%1\" "
-                                             "AND ysiluku > 300000000 ")
-                                     .arg(kp()->tilikaudet()->tilikausiPaivalle(pvm).alkaa().toString(Qt::ISODate)));
-            if( edelliskysely.next())
+            MitattuKysely& edelliskysely = kp()->kysely("TulosEnnen");
+            edelliskysely.bindValue(":pvm", kausi.alkaa().addDays(-1));
+            if( edelliskysely.exec() && edelliskysely.next())
             {
                 return kredit + edelliskysely.value(1).toLongLong() - debet - edelliskysely.value(0).toLongLong();
             }
@@ -89,12 +101,10 @@ qlonglong Tili::saldoPaivalle(const QDate &pvm)
         else if( onko(TiliLaji::KAUDENTULOS))
         {
             // Tämän tilikauden yli/alijaamaan
-            QSqlQuery edelliskysely( QString("SELECT SUM(debetsnt), SUM(kreditsnt) FROM vienti, tili "
-                                             "WHERE vienti.tili = tili.id AND pvm BETWEEN \"%1\" and \"%2\" "
-                                             "AND ysiluku > 300000000 ")
-                                     .arg(kp()->tilikaudet()->tilikausiPaivalle(pvm).alkaa().toString(Qt::ISODate))
-                                     .arg(kp()->tilikaudet()->tilikausiPaivalle(pvm).paattyy().toString(Qt::ISODate)));
-            if( edelliskysely.next())
+            MitattuKysely& edelliskysely = kp()->kysely("TulosValilla");
+            edelliskysely.bindValue(":alkaa", kausi.alkaa());
+            edelliskysely.bindValue(":loppuu", kausi.paattyy());
+            if( edelliskysely.exec() && edelliskysely.next())
             {
                 return kredit + edelliskysely.value(1).toLongLong() - debet - edelliskysely.value(0).toLongLong();
             }
@@ -104,6 +114,8 @@ qlonglong Tili::saldoPaivalle(const QDate &pvm)
         else
             return kredit - debet;
     }
+    else if( kysely.lastError().isValid())
+        kp()->lokiin(kysely);
     return 0;
 }
 
@@ -147,4 +159,9 @@ int Tili::laskeysiluku(int luku, bool loppuu)
     return luku;
 }
 
-
+const QSharedDataPointer<TiliData> &Tili::tyhjaData()
+{
+    // Kaikki tyhjät tilit jakavat saman tietueen
+    static const QSharedDataPointer<TiliData> tyhja( new TiliData );
+    return tyhja;
+}
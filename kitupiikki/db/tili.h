@@ -20,13 +20,42 @@
 
 #include <QString>
 #include <QDate>
+#include <QSharedData>
 
 #include "jsonkentta.h"
 #include "tilityyppimodel.h"
 
+/**
+ * @brief Tilin jaetut tiedot
+ *
+ * Tili-oliot osoittavat samaan TiliData-tietueeseen, kunnes jotain
+ * kopiota muokataan (copy-on-write).
+ */
+class TiliData : public QSharedData
+{
+public:
+    TiliData();
+
+    int id_;
+    int numero_;
+    QString nimi_;
+    TiliTyyppi tyyppi_;
+    int tila_;
+    JsonKentta json_;
+    int ylaotsikkoId_;
+    bool muokattu_;
+    bool tilamuokattu_;
+    QDateTime muokkausAika_;
+};
+
 /**
  * @brief Tilin tai otsikon tiedot
  *
+ * Tili on implisiittisesti jaettu: kopiointi kasvattaa vain viitelaskuria,
+ * ja TiliModelin lataamat tiedot ovat yhteiset kaikille tilin kopioille
+ * (esim. SelausModelin riveille). Tiedot kopioidaan vasta, kun kopiota
+ * muokataan tai sen json()-kenttää käsitellään ei-vakiona.
+ *
  */
 class Tili
 {
@@ -35,39 +64,43 @@ public:
     Tili(int id, int numero, const QString& nimi, const QString& tyyppiKoodi, int tila,
          int ylaotsikkoid = 0, const QDateTime muokkausaika = QDateTime());
 
-    int id() const { return id_; }
-    int numero() const { return numero_; }
-    QString nimi() const { return nimi_; }
-    TiliTyyppi tyyppi() const { return tyyppi_;}
+    int id() const { return d->id_; }
+    int numero() const { return d->numero_; }
+    QString nimi() const { return d->nimi_; }
+    TiliTyyppi tyyppi() const { return d->tyyppi_;}
     QString tyyppiKoodi() const { return tyyppi().koodi(); }
-    int tila() const { return tila_; }
+    int tila() const { return d->tila_; }
     int otsikkotaso() const { return tyyppi().otsikkotaso(); }
-    bool muokattu() const { return muokattu_ || json_.onkoMuokattu() || tilamuokattu_; }
-    bool muokattuMuutakinKuinTilaa() const { return muokattu_ || json_.onkoMuokattu(); }
-    QDateTime muokkausaika() const { return muokkausAika_; }
+    bool muokattu() const { return d->muokattu_ || d->json_.onkoMuokattu() || d->tilamuokattu_; }
+    bool muokattuMuutakinKuinTilaa() const { return d->muokattu_ || d->json_.onkoMuokattu(); }
+    QDateTime muokkausaika() const { return d->muokkausAika_; }
 
     /**
      * @brief Palauttaa tämän tilin tai otsikon yllä olevan otsikon id:n
      * @return
      */
-    int ylaotsikkoId() const { return ylaotsikkoId_; }
+    int ylaotsikkoId() const { return d->ylaotsikkoId_; }
     /**
      * @brief Palauttaa json-tiedot
      *
      * JsonKentta-oliossa on mahdollisuus säilöä erilaista tietoa, jonka lisääminen
      * ei edellytä tietokannan muutoksia.
      *
+     * Ei-vakio json() irrottaa tämän kopion jaetuista tiedoista, joten pelkkään
+     * lukemiseen kannattaa käyttää vakio-oliota.
+     *
      * @return
      */
-    JsonKentta *json()  { return &json_; }
+    JsonKentta *json()  { return &d->json_; }
+    const JsonKentta *json() const { return &d->json_; }
 
-    void asetaId(int id) { id_ = id; }
+    void asetaId(int id) { d->id_ = id; }
     void asetaNumero(int numero);
-    void asetaNimi(const QString& nimi) { nimi_ = nimi; muokattu_ = true; }
+    void asetaNimi(const QString& nimi) { d->nimi_ = nimi; d->muokattu_ = true; }
     void asetaTyyppi(const QString& tyyppikoodi);
-    void asetaTila(int tila) { tila_ = tila; tilamuokattu_ = true; }
+    void asetaTila(int tila) { d->tila_ = tila; d->tilamuokattu_ = true; }
 
-    void nollaaMuokattu() { muokattu_ = false; tilamuokattu_=false;}
+    void nollaaMuokattu() { d->muokattu_ = false; d->tilamuokattu_=false;}
 
     /**
      * @brief Onko tilillä tarvittavat tiedot, että voi tallettaa
@@ -99,7 +132,7 @@ public:
      * @param pvm Päivämäärä, jolle saldo lasketaan
      * @return Saldo sentteinä
      */
-    qlonglong saldoPaivalle(const QDate &pvm);
+    qlonglong saldoPaivalle(const QDate &pvm) const;
 
     /**
      * @brief Montako kirjausta tälle tilille
@@ -141,7 +174,7 @@ public:
      * @brief Millä tasolla tase-erittely laaditaan
      * @return TaseErittelyTapa
      */
-    int taseErittelyTapa() { return json()->luku("Taseerittely"); }
+    int taseErittelyTapa() const { return json()->luku("Taseerittely"); }
 
     /**
      * @brief Pidetäänkö tase-eristä kirjaa
@@ -150,7 +183,7 @@ public:
      *
      * @return
      */
-    bool eritellaankoTase()  { return taseErittelyTapa() == TASEERITTELY_TAYSI ||
+    bool eritellaankoTase() const { return taseErittelyTapa() == TASEERITTELY_TAYSI ||
                                   taseErittelyTapa() == TASEERITTELY_LISTA;  }
 
     /**
@@ -179,18 +212,10 @@ public:
 
 protected:
     static int laskeysiluku(int luku, bool loppuu = false);
+    static const QSharedDataPointer<TiliData>& tyhjaData();
 
 protected:
-    int id_;
-    int numero_;
-    QString nimi_;
-    TiliTyyppi tyyppi_;
-    int tila_;
-    JsonKentta json_;
-    int ylaotsikkoId_;
-    bool muokattu_;
-    bool tilamuokattu_;
-    QDateTime muokkausAika_;
+    QSharedDataPointer<TiliData> d;
 
 };
 
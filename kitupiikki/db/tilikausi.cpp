@@ -22,6 +22,7 @@
 #include "tilikausi.h"
 #include "kirjanpito.h"
 #include "asetusmodel.h"
+#include "saldotaulu.h"
 
 Tilikausi::Tilikausi()
 {
@@ -47,7 +48,8 @@ QDateTime Tilikausi::arkistoitu()
 
 QDateTime Tilikausi::viimeinenPaivitys() const
 {
-    QSqlQuery kysely( QString(R"(SELECT max(muokattu) FROM vienti WHERE pvm BETWEEN "%1" AND "%2" )").arg(alkaa().toString(Qt::ISODate)).arg(paattyy().toString(Qt::ISODate)));
+    QSqlQuery kysely( QString(R"(SELECT max(muokattu) FROM %3 WHERE pvm BETWEEN "%1" AND "%2" )").arg(alkaa().toString(Qt::ISODate)).arg(paattyy().toString(Qt::ISODate))
+                      .arg( kp()->osiot()->taulu("vienti", alkaa(), paattyy())));
     if( kysely.next() )
         return kysely.value(0).toDateTime();
     return QDateTime();
@@ -77,9 +79,9 @@ Tilikausi::TilinpaatosTila Tilikausi::tilinpaatoksenTila()
 qlonglong Tilikausi::tulos() const
 {
     QSqlQuery kysely(  QString("SELECT SUM(kreditsnt), SUM(debetsnt) "
-                               "FROM vienti, tili WHERE "
+                               "FROM saldo, tili WHERE "
                                "pvm BETWEEN \"%1\" AND \"%2\" "
-                               "AND vienti.tili=tili.id AND "
+                               "AND saldo.tili=tili.id AND "
                                "tili.ysiluku > 300000000")
                        .arg(alkaa().toString(Qt::ISODate))
                        .arg(paattyy().toString(Qt::ISODate)));
@@ -92,9 +94,9 @@ qlonglong Tilikausi::tulos() const
 qlonglong Tilikausi::liikevaihto() const
 {
     QSqlQuery kysely(  QString("SELECT SUM(kreditsnt), SUM(debetsnt) "
-                               "FROM vienti, tili WHERE "
+                               "FROM saldo, tili WHERE "
                                "pvm BETWEEN \"%1\" AND \"%2\" "
-                               "AND vienti.tili=tili.id AND "
+                               "AND saldo.tili=tili.id AND "
                                "(tili.tyyppi = \"CL\" OR tili.tyyppi = \"CLX\") ")
                        .arg(alkaa().toString(Qt::ISODate))
                        .arg(paattyy().toString(Qt::ISODate)));
@@ -107,20 +109,19 @@ qlonglong Tilikausi::liikevaihto() const
 qlonglong Tilikausi::tase() const
 {
     QSqlQuery kysely(  QString("SELECT SUM(kreditsnt), SUM(debetsnt) "
-                               "FROM vienti, tili WHERE "
-                               "pvm <= \"%1\" "
-                               "AND vienti.tili=tili.id AND "
+                               "FROM %1, tili WHERE "
+                               "saldo.tili=tili.id AND "
                                "tili.ysiluku < 200000000")
-                       .arg(paattyy().toString(Qt::ISODate)));
+                       .arg(SaldoTaulu::kertyma(paattyy())));
     if( kysely.next())
         return kysely.value(1).toLongLong() - kysely.value(0).toLongLong();
     else
         return 0;
 }
 
-int Tilikausi::henkilosto()
+int Tilikausi::henkilosto() const
 {
-    return json()->luku("Henkilosto");
+    return json_.luku("Henkilosto");
 }
 
 QString Tilikausi::arkistoHakemistoNimi() const
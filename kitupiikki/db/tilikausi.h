@@ -96,7 +96,7 @@ public:
      * @brief Tilikauden keskimääräinen henkilöstö
      * @return
      */
-    int henkilosto();
+    int henkilosto() const;
 
     /**
      * @brief Arkistohakemistossa käytettävä nimi
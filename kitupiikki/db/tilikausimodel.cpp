@@ -79,11 +79,11 @@ QVariant TilikausiModel::data(const QModelIndex &index, int role) const
                              .arg(kausi.alkaa().toString("dd.MM.yyyy"))
                              .arg(kausi.paattyy().toString("dd.MM.yyyy")));
         else if( index.column() == TULOS)
-            return QString("%L1 €").arg( kausi.tulos()  / 100.0,0,'f',2);
+            return QString("%L1 €").arg( tulos(index.row())  / 100.0,0,'f',2);
         else if(index.column() == LIIKEVAIHTO)
-            return QString("%L1 €").arg( kausi.liikevaihto()  / 100.0,0,'f',2);
+            return QString("%L1 €").arg( liikevaihto(index.row())  / 100.0,0,'f',2);
         else if(index.column() == TASE)
-            return QString("%L1 €").arg( kausi.tase()  / 100.0,0,'f',2);
+            return QString("%L1 €").arg( tase(index.row())  / 100.0,0,'f',2);
 
         else if( index.column() == ARKISTOITU )
             return kausi.arkistoitu().date();
@@ -134,7 +134,7 @@ QVariant TilikausiModel::data(const QModelIndex &index, int role) const
         }
         else if(  index.column() == ARKISTOITU)
         {
-            if( kausi.arkistoitu() > kausi.viimeinenPaivitys() &&
+            if( kausi.arkistoitu() > viimeinenPaivitys(index.row()) &&
                     QFile::exists( kp()->arkistopolku() + "/" + kausi.arkistoHakemistoNimi() + "/index.html" )  )
                 return QIcon(":/pic/ok.png");
         }
@@ -189,26 +189,43 @@ void TilikausiModel::muokkaaViimeinenTilikausi(const QDate &paattyy)
     emit kp()->tilikausiAvattu();
 }
 
-Tilikausi TilikausiModel::tilikausiPaivalle(const QDate &paiva) const
+const Tilikausi &TilikausiModel::tilikausiPaivalle(const QDate &paiva) const
 {
-    foreach (Tilikausi kausi, kaudet_)
-    {
-        // Osuuko pyydetty päivä kysyttyyn jaksoon
-        if( kausi.alkaa().daysTo(paiva) >= 0 && paiva.daysTo(kausi.paattyy()) >= 0)
-            return kausi;
-    }
-    return Tilikausi(QDate(), QDate()); // Kelvoton tilikausi
-
+    int indeksi = indeksiPaivalle(paiva);
+    if( indeksi < 0)
+        return kelvoton_;
+    return kaudet_.at(indeksi);
 }
 
 
 int TilikausiModel::indeksiPaivalle(const QDate &paiva) const
 {
-    for(int i=0; i < kaudet_.count(); i++)
-        if( kaudet_[i].alkaa().daysTo(paiva) >= 0 && paiva.daysTo(kaudet_[i].paattyy()) >= 0)
-            return i;
-    return -1;
+    if( !paiva.isValid())
+        return -1;
 
+    qint64 siirto = paiva.toJulianDay() - ensimmaisenPaivanJd_;
+    if( siirto < 0 || siirto >= paivaHakemisto_.count())
+        return -1;
+    return paivaHakemisto_.at( static_cast<int>(siirto) );
+}
+
+QString TilikausiModel::kausitunnusPaivalle(const QDate &paiva) const
+{
+    return tilikausiPaivalle(paiva).kausitunnus();
+}
+
+QString TilikausiModel::tositetunniste(int tunniste, const QDate &pvm, const QString &lajitunnus, bool lajiteltava) const
+{
+    int indeksi = indeksiPaivalle(pvm);
+    const QString& kausiosa = indeksi < 0 ? QString() : kausiOsat_.at(indeksi);
+
+    QString numero = lajiteltava ? QString("%1").arg(tunniste, 8, 10, QChar('0'))
+                                 : QString::number(tunniste);
+    if( lajitunnus.isEmpty())
+        return numero + kausiosa;
+    if( lajiteltava )
+        return lajitunnus + numero + kausiosa;
+    return lajitunnus + QChar(' ') + numero + kausiosa;
 }
 
 Tilikausi TilikausiModel::tilikausiIndeksilla(int indeksi) const
@@ -256,6 +273,114 @@ bool TilikausiModel::onkoBudjetteja() const
     return false;
 }
 
+qlonglong TilikausiModel::tulos(int indeksi) const
+{
+    return yhteenveto(indeksi).tulos;
+}
+
+qlonglong TilikausiModel::liikevaihto(int indeksi) const
+{
+    return yhteenveto(indeksi).liikevaihto;
+}
+
+qlonglong TilikausiModel::tase(int indeksi) const
+{
+    return yhteenveto(indeksi).tase;
+}
+
+QDateTime TilikausiModel::viimeinenPaivitys(int indeksi) const
+{
+    if( indeksi < 0 || indeksi >= kaudet_.count())
+        return QDateTime();
+
+    yhteenveto(indeksi);    // Varmistaa välimuistin koon
+    Yhteenveto& yv = yhteenvedot_[indeksi];
+    if( !yv.paivitysKelpaa )
+    {
+        yv.paivitetty = kaudet_.at(indeksi).viimeinenPaivitys();
+        yv.paivitysKelpaa = true;
+    }
+    return yv.paivitetty;
+}
+
+void TilikausiModel::kirjanpitoMuuttui(const KirjanpidonMuutos &muutos)
+{
+    for(int i=0; i < yhteenvedot_.count(); i++)
+    {
+        const Tilikausi& kausi = kaudet_.at(i);
+        // Taseeseen vaikuttavat myös aiempien kausien kirjaukset
+        bool kaudella = muutos.koskeeJaksoa( kausi.alkaa(), kausi.paattyy());
+        if( kaudella || muutos.koskeeJaksoa( QDate(), kausi.paattyy()))
+        {
+            yhteenvedot_[i].summatKelpaavat = false;
+            yhteenvedot_[i].paivitysKelpaa = yhteenvedot_[i].paivitysKelpaa && !kaudella;
+            emit dataChanged( index(i, LIIKEVAIHTO), index(i, ARKISTOITU));
+        }
+    }
+}
+
+const TilikausiModel::Yhteenveto &TilikausiModel::yhteenveto(int indeksi) const
+{
+    if( yhteenvedot_.count() != kaudet_.count())
+        yhteenvedot_.resize( kaudet_.count());
+
+    if( indeksi < 0 || indeksi >= yhteenvedot_.count())
+    {
+        static const Yhteenveto tyhja;
+        return tyhja;
+    }
+
+    if( !yhteenvedot_.at(indeksi).summatKelpaavat )
+        laskeYhteenvedot();
+
+    return yhteenvedot_.at(indeksi);
+}
+
+void TilikausiModel::laskeYhteenvedot() const
+{
+    QVector<qlonglong> tulokset( kaudet_.count(), 0);
+    QVector<qlonglong> liikevaihdot( kaudet_.count(), 0);
+    QVector<qlonglong> taseet( kaudet_.count(), 0);
+
+    // Päiväkohtaiset summat, jotka jaetaan tilikausille päivähakemistolla
+    QSqlQuery kysely(*tietokanta_);
+    kysely.exec("SELECT saldo.pvm, "
+                "SUM(CASE WHEN tili.ysiluku > 300000000 THEN kreditsnt - debetsnt ELSE 0 END), "
+                "SUM(CASE WHEN tili.tyyppi = 'CL' OR tili.tyyppi = 'CLX' THEN kreditsnt - debetsnt ELSE 0 END), "
+                "SUM(CASE WHEN tili.ysiluku < 200000000 THEN debetsnt - kreditsnt ELSE 0 END) "
+                "FROM saldo JOIN tili ON saldo.tili = tili.id "
+                "GROUP BY saldo.pvm ORDER BY saldo.pvm");
+
+    // Tase on kertymä kaikista kauden loppuun mennessä kirjatuista
+    qlonglong taseKertyma = 0;
+    int kausi = 0;
+
+    while( kysely.next())
+    {
+        QDate pvm = kysely.value(0).toDate();
+        while( kausi < kaudet_.count() && kaudet_.at(kausi).paattyy() < pvm)
+            taseet[kausi++] = taseKertyma;
+
+        int indeksi = indeksiPaivalle(pvm);
+        if( indeksi > -1)
+        {
+            tulokset[indeksi] += kysely.value(1).toLongLong();
+            liikevaihdot[indeksi] += kysely.value(2).toLongLong();
+        }
+        taseKertyma += kysely.value(3).toLongLong();
+    }
+    while( kausi < kaudet_.count())
+        taseet[kausi++] = taseKertyma;
+
+    for(int i=0; i < yhteenvedot_.count(); i++)
+    {
+        yhteenvedot_[i].tulos = tulokset.at(i);
+        yhteenvedot_[i].liikevaihto = liikevaihdot.at(i);
+        yhteenvedot_[i].tase = taseet.at(i);
+        yhteenvedot_[i].summatKelpaavat = true;
+    }
+}
+
 void TilikausiModel::lataa()
 {
     beginResetModel();
@@ -314,4 +439,39 @@ void TilikausiModel::paivitaKausitunnukset()
         }
 
     }
+    paivitaPaivaHakemisto();
+}
+
+void TilikausiModel::paivitaPaivaHakemisto()
+{
+    paivaHakemisto_.clear();
+    kausiOsat_.clear();
+    yhteenvedot_.clear();
+    ensimmaisenPaivanJd_ = 0;
+
+    for( const Tilikausi& kausi : kaudet_)
+        kausiOsat_.append( QChar('/') + kausi.kausitunnus() );
+
+    if( kaudet_.isEmpty() || !kaudet_.first().alkaa().isValid() || !kaudet_.last().paattyy().isValid())
+        return;
+
+    ensimmaisenPaivanJd_ = kaudet_.first().alkaa().toJulianDay();
+    qint64 viimeinen = kaudet_.last().paattyy().toJulianDay();
+    if( viimeinen < ensimmaisenPaivanJd_)
+        return;
+
+    // Vuosikymmenienkin kirjanpidossa taulukossa on vain muutamia kymmeniä tuhansia päiviä
+    paivaHakemisto_.fill(-1, static_cast<int>( viimeinen - ensimmaisenPaivanJd_ + 1));
+    for(int i=0; i < kaudet_.count(); i++)
+    {
+        qint64 alku = qMax( kaudet_.at(i).alkaa().toJulianDay(), ensimmaisenPaivanJd_);
+        qint64 loppu = qMin( kaudet_.at(i).paattyy().toJulianDay(), viimeinen);
+        for(qint64 paiva = alku; paiva <= loppu; paiva++)
+        {
+            // Päällekkäisistä kausista valitaan aiempi kuten ennenkin
+            int& kohta = paivaHakemisto_[ static_cast<int>(paiva - ensimmaisenPaivanJd_) ];
+            if( kohta < 0)
+                kohta = i;
+        }
+    }
 }
@@ -20,8 +20,10 @@
 
 #include <QAbstractTableModel>
 #include <QSqlDatabase>
+#include <QVector>
 
 #include "tilikausi.h"
+#include "kirjanpidonmuutos.h"
 
 /**
  * @brief Tilikaudet
@@ -72,10 +74,37 @@ public:
      */
     void muokkaaViimeinenTilikausi(const QDate& paattyy);
 
-    Tilikausi tilikausiPaivalle(const QDate &paiva) const;
+    /**
+     * @brief Tilikausi, jolle päivä osuu
+     *
+     * Haetaan päivähakemistosta vakioajassa. Viittaus on voimassa, kunnes
+     * tilikausia lisätään, muokataan tai ne ladataan uudelleen.
+     *
+     * @return Tilikausi tai kelvoton tilikausi, jos päivä ei osu millekään kaudelle
+     */
+    const Tilikausi& tilikausiPaivalle(const QDate &paiva) const;
     int indeksiPaivalle(const QDate &paiva) const;
     Tilikausi tilikausiIndeksilla(int indeksi) const;
 
+    /**
+     * @brief Päivän tilikauden kausitunnus (17, 17B)
+     */
+    QString kausitunnusPaivalle(const QDate& paiva) const;
+
+    /**
+     * @brief Tositteen tunniste esim. "MU 12/17" tai "12/17"
+     *
+     * Kauden osa "/17" muodostetaan kerran tilikautta kohden, joten
+     * tunnisteen voi muodostaa riveittäin toistuvissa silmukoissa.
+     *
+     * @param tunniste Tositteen numero
+     * @param pvm Tositteen päivämäärä, josta kausi päätellään
+     * @param lajitunnus Tositelajin tunnus, tyhjä jos tositteet samassa sarjassa
+     * @param lajiteltava Numero etunollilla tasaleveänä lajittelua varten
+     */
+    QString tositetunniste(int tunniste, const QDate& pvm, const QString& lajitunnus = QString(),
+                           bool lajiteltava = false) const;
+
     /**
      * @brief Tilikauden json-kentät
      * @param indeksi
@@ -90,9 +119,28 @@ public:
 
     bool onkoBudjetteja() const;
 
+    /**
+     * @brief Tilikauden tulos, liikevaihto ja tase välimuistista
+     * @see Tilikausi::tulos()
+     */
+    qlonglong tulos(int indeksi) const;
+    qlonglong liikevaihto(int indeksi) const;
+    qlonglong tase(int indeksi) const;
+
+    /**
+     * @brief Milloin kauden kirjauksia on viimeksi muokattu, välimuistista
+     * @see Tilikausi::viimeinenPaivitys()
+     */
+    QDateTime viimeinenPaivitys(int indeksi) const;
+
 public slots:
     void lataa();
 
+    /**
+     * @brief Mitätöi niiden kausien yhteenvedot, joihin muutos vaikuttaa
+     */
+    void kirjanpitoMuuttui(const KirjanpidonMuutos& muutos);
+
     /**
      * @brief tallenna Tallentaa muutetut json-kentät
      */
@@ -101,8 +149,50 @@ public slots:
     void paivitaKausitunnukset();
 
 protected:
+    /**
+     * @brief Rakentaa päivähakemiston ja kausien tunnisteosat
+     */
+    void paivitaPaivaHakemisto();
+
+    /**
+     * @brief Tilikauden lasketut luvut
+     *
+     * Luvut näytetään tilikausiluettelossa, jonka data()-funktiota Qt
+     * kutsuu jokaisella piirtokerralla. Siksi ne lasketaan kaikille
+     * kausille yhdellä saldotaulun kyselyllä ja lasketaan uudelleen vain,
+     * kun kauden kirjauksia on muutettu.
+     */
+    struct Yhteenveto
+    {
+        qlonglong tulos = 0;
+        qlonglong liikevaihto = 0;
+        qlonglong tase = 0;
+        bool summatKelpaavat = false;
+        QDateTime paivitetty;
+        bool paivitysKelpaa = false;
+    };
+
+    /**
+     * @brief Laskee kaikkien kausien summat yhdellä ryhmitellyllä kyselyllä
+     */
+    void laskeYhteenvedot() const;
+    const Yhteenveto& yhteenveto(int indeksi) const;
+
     QSqlDatabase *tietokanta_;
     QList<Tilikausi> kaudet_;
+
+    /**
+     * @brief Kirjanpidon jokaiselle päivälle sen tilikauden indeksi
+     *
+     * Kausien väliin jääville päiville -1. Ensimmäinen alkio on
+     * ensimmaisenPaivanJd_:n päivä.
+     */
+    QVector<int> paivaHakemisto_;
+    qint64 ensimmaisenPaivanJd_ = 0;
+    QVector<QString> kausiOsat_;
+    Tilikausi kelvoton_;
+
+    mutable QVector<Yhteenveto> yhteenvedot_;
 };
 
 #endif // TILIKAUSIMODEL_H
@@ -59,6 +59,7 @@ bool TiliModel::setData(const QModelIndex &index, const QVariant &value, int rol
     else if( role == TiliModel::NroRooli)
     {
         tilit_[ index.row()].asetaNumero( value.toInt());
+        indeksoi();
     }
     else if( role == TiliModel::NimiRooli)
     {
@@ -67,6 +68,7 @@ bool TiliModel::setData(const QModelIndex &index, const QVariant &value, int rol
     else if( role == TiliModel::TyyppiRooli)
     {
         tilit_[index.row()].asetaTyyppi( value.toString());
+        indeksoi();
     }
     else
         return false;
@@ -106,7 +108,7 @@ QVariant TiliModel::data(const QModelIndex &index, int role) const
     if( !index.isValid())     
         return QVariant();
 
-    Tili tili = tilit_.value(index.row());
+    const Tili tili = tilit_.value(index.row());
 
     if( role == IdRooli )
         return QVariant( tili.id());
@@ -193,6 +195,7 @@ void TiliModel::lisaaTili(const Tili& uusi)
 {
     beginInsertRows( QModelIndex(), tilit_.count(), tilit_.count()  );
     tilit_.append(uusi);
+    indeksoiRivi( tilit_.count() - 1);
     // TODO - lisätään oikeaan paikkaan kasiluvun mukaan
     endInsertRows();
 }
@@ -208,64 +211,46 @@ void TiliModel::poistaRivi(int riviIndeksi)
         poistetutIdt_.append( tili.id());
 
     tilit_.removeAt(riviIndeksi);
+    indeksoi();     // Rivien indeksit siirtyvät
     endRemoveRows();
 
 }
 
-Tili TiliModel::tiliIdlla(int id) const
+const Tili &TiliModel::tiliIdlla(int id) const
 {
-    foreach (Tili tili, tilit_)
-    {
-        if( tili.id() == id)
-            return tili;
-    }
-    return Tili();
+    return rivilla( idIndeksi_.value(id, -1) );
 }
 
-Tili TiliModel::tiliNumerolla(int numero, int otsikkotaso) const
+const Tili &TiliModel::tiliNumerolla(int numero, int otsikkotaso) const
 {
     // Vertailu tehdään "ysiluvuilla" joten tilit 154 ja 15400 ovat samoja
     return tiliYsiluvulla( Tili::ysiluku(numero, otsikkotaso) );
 }
 
-Tili TiliModel::tiliYsiluvulla(int ysiluku) const
+const Tili &TiliModel::tiliYsiluvulla(int ysiluku) const
 {
-    foreach (Tili tili, tilit_)
-    {
-        if( tili.ysivertailuluku() == ysiluku )
-            return tili;
-    }
-    return Tili();
+    return rivilla( ysiIndeksi_.value(ysiluku, -1) );
 }
 
-Tili TiliModel::tiliIbanilla(const QString &iban) const
+const Tili &TiliModel::tiliIbanilla(const QString &iban) const
 {
-    for(Tili tili: tilit_)
-    {
-        if( tili.json()->str("IBAN") == iban)
-            return tili;
-    }
-    return Tili();
+    return rivilla( ibanIndeksi_.value(iban, -1) );
 }
 
-Tili TiliModel::edellistenYlijaamaTili() const
+const Tili &TiliModel::edellistenYlijaamaTili() const
 {
-    foreach (Tili tili, tilit_)
+    for( const Tili& tili : tilit_)
     {
         if( tili.onko(TiliLaji::EDELLISTENTULOS) )
             return tili;
     }
-    return Tili();
+    return tyhjaTili_;
 }
 
 
-Tili TiliModel::tiliTyypilla(TiliLaji::TiliLuonne tyyppi) const
+const Tili &TiliModel::tiliTyypilla(TiliLaji::TiliLuonne tyyppi) const
 {
-    foreach (Tili tili, tilit_) {
-        if( tili.tyyppi().luonne() == tyyppi)
-            return tili;
-    }
-    return Tili();
+    return rivilla( tyyppiIndeksi_.value(tyyppi, -1));
 }
 
 JsonKentta *TiliModel::jsonIndeksilla(int i)
@@ -278,7 +263,7 @@ bool TiliModel::onkoMuokattu() const
     if( poistetutIdt_.count())  // Tallennettuja rivejä poistettu
         return true;
 
-    foreach (Tili tili, tilit_)
+    for( const Tili& tili : tilit_)
     {
         if( tili.muokattu())
             return true;        // Tosi, jos yhtäkin tiliä muokattu
@@ -315,7 +300,7 @@ void TiliModel::lataa()
         // Etsitään otsikkotasoa tasojen lopusta alkaen
         for(int i=9; i >= 0; i--)
         {
-            int asti = otsikot[i].json()->luku("Asti") ? Tili::ysiluku( otsikot[i].json()->luku("Asti"),true) : Tili::ysiluku( otsikot[i].numero(), true);
+            int asti = otsikot.at(i).json()->luku("Asti") ? Tili::ysiluku( otsikot.at(i).json()->luku("Asti"),true) : Tili::ysiluku( otsikot[i].numero(), true);
             if( otsikot.at(i).onkoValidi() && otsikot.at(i).ysivertailuluku() <= ysiluku && asti >= ysiluku )
             {
                 otsikkoIdTalle = otsikot.at(i).id();
@@ -340,6 +325,7 @@ void TiliModel::lataa()
 
     }
 
+    indeksoi();
     endResetModel();
 }
 
@@ -400,6 +386,9 @@ bool TiliModel::tallenna(bool tietokantaaLuodaan)
 
     tietokanta_->commit();
 
+    // Uudet tilit saivat id:n ja json-kenttiä (IBAN) on voitu muokata
+    indeksoi();
+
     if( tietokanta_->lastError().isValid() )
     {
         QMessageBox::critical(nullptr, tr("Tietokantavirhe"),
@@ -411,3 +400,39 @@ bool TiliModel::tallenna(bool tietokantaaLuodaan)
     return true;
 }
 
+void TiliModel::indeksoi()
+{
+    idIndeksi_.clear();
+    ysiIndeksi_.clear();
+    ibanIndeksi_.clear();
+    tyyppiIndeksi_.clear();
+
+    idIndeksi_.reserve( tilit_.count() );
+    ysiIndeksi_.reserve( tilit_.count() );
+
+    for(int i=0; i < tilit_.count(); i++)
+        indeksoiRivi(i);
+}
+
+void TiliModel::indeksoiRivi(int rivi)
+{
+    const Tili& tili = tilit_.at(rivi);
+
+    if( !idIndeksi_.contains( tili.id() ))
+        idIndeksi_.insert( tili.id(), rivi);
+    if( !ysiIndeksi_.contains( tili.ysivertailuluku()))
+        ysiIndeksi_.insert( tili.ysivertailuluku(), rivi);
+    if( !tyyppiIndeksi_.contains( tili.tyyppi().luonne()))
+        tyyppiIndeksi_.insert( tili.tyyppi().luonne(), rivi);
+
+    QString iban = tili.json()->str("IBAN");
+    if( !iban.isEmpty() && !ibanIndeksi_.contains(iban))
+        ibanIndeksi_.insert(iban, rivi);
+}
+
+const Tili &TiliModel::rivilla(int rivi) const
+{
+    if( rivi < 0 || rivi >= tilit_.count())
+        return tyhjaTili_;
+    return tilit_.at(rivi);
+}
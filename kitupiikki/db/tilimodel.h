@@ -21,6 +21,7 @@
 #include <QAbstractTableModel>
 #include <QSqlDatabase>
 #include <QList>
+#include <QHash>
 
 #include "db/tili.h"
 
@@ -29,6 +30,10 @@
  *
  * Tilien tiedot
  *
+ * Tilejä haetaan id:n, ysiluvun, IBANin ja tyypin perusteella hajautustaulujen
+ * kautta. Indeksit rakennetaan lataa()-funktiossa ja päivitetään, kun tilejä
+ * lisätään, poistetaan tai tallennetaan. Hakufunktiot palauttavat viittauksen
+ * mallin sisältämään tiliin; jos tiliä ei löydy, palautetaan tyhjä tili.
  *
  */
 class TiliModel : public QAbstractTableModel
@@ -67,23 +72,23 @@ public:
     void lisaaTili(const Tili &uusi);
     void poistaRivi( int riviIndeksi );
 
-    Tili tiliIdlla(int id) const;
+    const Tili& tiliIdlla(int id) const;
     Tili tiliIndeksilla(int i) const { return tilit_.value(i); }
-    Tili tiliNumerolla(int numero, int otsikkotaso = 0) const;
-    Tili tiliYsiluvulla(int ysiluku) const;
-    Tili tiliIbanilla(const QString& iban) const;
+    const Tili& tiliNumerolla(int numero, int otsikkotaso = 0) const;
+    const Tili& tiliYsiluvulla(int ysiluku) const;
+    const Tili& tiliIbanilla(const QString& iban) const;
     /**
      * @brief Palauttaa tilin, jolle kirjataan edellisiltä tilikausilta kertynyt yli/alijäämä
      * @return
      */
-    Tili edellistenYlijaamaTili() const;
+    const Tili& edellistenYlijaamaTili() const;
 
     /**
      * @brief Palauttaa ensimmäisen halutun tyyppisen tilin
      * @param luonne
      * @return
      */
-    Tili tiliTyypilla(TiliLaji::TiliLuonne tyyppi) const;
+    const Tili& tiliTyypilla(TiliLaji::TiliLuonne tyyppi) const;
 
     JsonKentta *jsonIndeksilla(int i);
 
@@ -92,12 +97,33 @@ public:
     void lataa();
     bool tallenna(bool tietokantaaLuodaan = false);
 
+protected:
+    /**
+     * @brief Rakentaa hakuindeksit uudelleen tilit_-listasta
+     */
+    void indeksoi();
+    /**
+     * @brief Lisää indekseihin listan rivin
+     *
+     * Samalla avaimella indeksiin jää ensimmäinen rivi, kuten aiemmassa
+     * järjestyksessä läpikäyvässä haussa.
+     */
+    void indeksoiRivi(int rivi);
+    const Tili& rivilla(int rivi) const;
+
 protected:
     QSqlDatabase *tietokanta_;
 
     QList<Tili> tilit_;
     QList<int> poistetutIdt_;
 
+    QHash<int,int> idIndeksi_;
+    QHash<int,int> ysiIndeksi_;
+    QHash<QString,int> ibanIndeksi_;
+    QHash<int,int> tyyppiIndeksi_;
+
+    Tili tyhjaTili_;
+
 };
 
 #endif // TILIMODEL_H
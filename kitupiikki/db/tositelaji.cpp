@@ -82,7 +82,7 @@ int Tositelaji::seuraavanTunnistenumero(const QDate pvm) const
                                 .arg(kausi.paattyy().toString(Qt::ISODate));
 
     // #323 Tositenumerointi määriteltävissä yhteen sarjaan
-    if(  !kp()->asetukset()->onko("Samaansarjaan")  )
+    if(  !kp()->asetukset()->kuva().samaanSarjaan  )
         kysymys.append( QString(" AND laji=%1").arg( id()));
 
 
@@ -38,6 +38,7 @@ public:
     bool muokattu() const { return muokattu_ | json_.onkoMuokattu(); }
 
     JsonKentta *json() { return &json_; }
+    const JsonKentta *json() const { return &json_; }
 
     void asetaId(int id);
     void asetaTunnus(const QString& tunnus);
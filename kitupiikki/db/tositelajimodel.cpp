@@ -203,24 +203,23 @@ void TositelajiModel::poistaRivi(int riviIndeksi)
     if( laji.id())
         poistetutIdt_.append( laji.id());
     lajit_.removeAt( riviIndeksi);
+    indeksoi();
     endRemoveRows();
 }
 
-Tositelaji TositelajiModel::tositelaji(int id) const
+const Tositelaji &TositelajiModel::tositelaji(int id) const
 {
-
-    foreach (Tositelaji laji, lajit_)
-    {
-        if( laji.id() == id)
-            return laji;
-    }
-    return Tositelaji();
+    int rivi = idIndeksi_.value(id, -1);
+    if( rivi < 0 || rivi >= lajit_.count())
+        return tyhjaLaji_;
+    return lajit_.at(rivi);
 }
 
 QModelIndex TositelajiModel::lisaaRivi()
 {
     beginInsertRows( QModelIndex(), lajit_.count(), lajit_.count() );
     lajit_.append( Tositelaji() );
+    indeksoi();
     endInsertRows();
     return index( lajit_.count()-1, 0);
 
@@ -239,6 +238,7 @@ void TositelajiModel::lataa()
                                       kysely.value(2).toString(), kysely.value(3).toByteArray() ));
     }
 
+    indeksoi();
     endResetModel();
 }
 
@@ -277,8 +277,19 @@ bool TositelajiModel::tallenna()
         tallennus.exec( QString("DELETE FROM tositelaji WHERE id=%1").arg(id));
     }
     poistetutIdt_.clear();
+    indeksoi();     // Uudet lajit saivat id:n
 
     return true;
 }
 
+void TositelajiModel::indeksoi()
+{
+    idIndeksi_.clear();
+    for(int i=0; i < lajit_.count(); i++)
+    {
+        if( !idIndeksi_.contains( lajit_.at(i).id()))
+            idIndeksi_.insert( lajit_.at(i).id(), i);
+    }
+}
+
 
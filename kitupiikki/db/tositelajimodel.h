@@ -20,6 +20,7 @@
 
 #include <QAbstractTableModel>
 #include <QSqlDatabase>
+#include <QHash>
 
 #include "tositelaji.h"
 
@@ -71,7 +72,7 @@ public:
 
     void poistaRivi(int riviIndeksi);
 
-    Tositelaji tositelaji(int id) const;
+    const Tositelaji& tositelaji(int id) const;
 
     QModelIndex lisaaRivi();
 
@@ -80,10 +81,16 @@ public slots:
     void lataa();
     bool tallenna();
 
+protected:
+    void indeksoi();
+
 protected:
     QList<Tositelaji> lajit_;
     QSqlDatabase *tietokanta_;
     QList<int> poistetutIdt_;
+
+    QHash<int,int> idIndeksi_;
+    Tositelaji tyhjaLaji_;
 };
 
 #endif // TOSITELAJIMODEL_H
@@ -170,8 +170,8 @@ void TositeModel::lataa(int id)
 
     QSqlQuery kysely(*tietokanta_);
     kysely.exec( QString("SELECT pvm, otsikko, kommentti, tunniste,"
-                              "laji, tiliote, json, luotu, muokattu FROM tosite "
-                              "WHERE id = %1").arg(id));
+                              "laji, tiliote, json, luotu, muokattu FROM %2 "
+                              "WHERE id = %1").arg(id).arg( kp()->osiot()->taulu("tosite") ));
     if( kysely.next())
     {
         id_ = id;
@@ -225,6 +225,10 @@ bool TositeModel::tallenna()
     // Tallentaa tositteen
     tietokanta()->transaction();
 
+    // Muutokseen otetaan sekä vanhat että uudet viennit
+    KirjanpidonMuutos muutos;
+    muutos.lisaaTositteenViennit( *tietokanta_, id() );
+
     QSqlQuery kysely(*tietokanta_);
     if( id() > -1)
     {
@@ -283,9 +287,13 @@ bool TositeModel::tallenna()
         return false;
     }
 
+    muutos.lisaaTositteenViennit( *tietokanta_, id() );
     tietokanta()->commit();
 
-    emit kp()->kirjanpitoaMuokattu();
+    // Poistettujen liitteiden tiedostot voidaan poistaa vasta vahvistuksen jälkeen
+    kp()->liitevarasto()->siivoa( *tietokanta_ );
+
+    kp()->ilmoitaMuutos(muutos);
     muokattu_ = false;
     muokattuAika_ = QDateTime::currentDateTime();
 
@@ -307,6 +315,10 @@ bool TositeModel::poista()
         kp()->asetukset()->aseta("AlvIlmoitus", json()->date("AlvTilitysAlkaa").addDays(-1));
 
     tietokanta()->transaction();
+
+    KirjanpidonMuutos muutos;
+    muutos.lisaaTositteenViennit( *tietokanta_, id() );
+
     QSqlQuery kysely(*tietokanta());
 
     kysely.exec(QString("DELETE FROM vienti WHERE tosite=%1").arg( id() ));
@@ -315,7 +327,8 @@ bool TositeModel::poista()
 
     if( tietokanta()->commit())
     {
-        emit kp()->kirjanpitoaMuokattu();
+        kp()->liitevarasto()->siivoa( *tietokanta_ );
+        kp()->ilmoitaMuutos(muutos);
         return true;
     }
     else
@@ -0,0 +1,308 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "varmuuskopioija.h"
+#include "liitevarasto.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDirIterator>
+#include <QRegularExpression>
+#include <QSqlQuery>
+
+#include <sqlite3.h>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+Varmuuskopioija::Varmuuskopioija(const QString &tiedosto, const QString &kohde, bool wal, QObject *parent) :
+    QThread(parent),
+    tiedosto_(tiedosto),
+    kohde_(kohde),
+    wal_(wal)
+{
+
+}
+
+QString Varmuuskopioija::ajastettuTiedosto(const QString &tiedosto, const QString &hakemisto, const QDateTime &aika)
+{
+    return QDir(hakemisto).absoluteFilePath( QString("%1-%2.kitupiikki")
+                                             .arg( QFileInfo(tiedosto).completeBaseName())
+                                             .arg( aika.toString("yyyyMMdd-HHmmss")));
+}
+
+/**
+ * @brief Hakemiston ajastetut varmuuskopiot uusimmasta vanhimpaan
+ */
+static QStringList ajastetut(const QString &tiedosto, const QString &hakemisto)
+{
+    QRegularExpression malli( QString("^%1-\\d{8}-\\d{6}\\.kitupiikki$")
+                              .arg( QRegularExpression::escape( QFileInfo(tiedosto).completeBaseName())));
+    QStringList loydetyt = QDir(hakemisto).entryList( QStringList() << "*.kitupiikki", QDir::Files, QDir::Name | QDir::Reversed);
+    return loydetyt.filter(malli);
+}
+
+QDateTime Varmuuskopioija::viimeisin(const QString &tiedosto, const QString &hakemisto)
+{
+    QStringList loydetyt = ajastetut(tiedosto, hakemisto);
+    if( loydetyt.isEmpty())
+        return QDateTime();
+
+    QString nimi = loydetyt.first();
+    return QDateTime::fromString( nimi.mid( nimi.length() - 26, 15), "yyyyMMdd-HHmmss");
+}
+
+int Varmuuskopioija::karsi(const QString &tiedosto, const QString &hakemisto, int sailytettavia)
+{
+    QDir dir(hakemisto);
+    QStringList poistettavat = ajastetut(tiedosto, hakemisto).mid( qMax(sailytettavia, 1) );
+
+    for( const QString& nimi : poistettavat)
+    {
+        QString polku = dir.absoluteFilePath(nimi);
+        QFile::remove(polku);
+        QDir( LiiteVarasto::hakemistoKirjanpidolle(polku) ).removeRecursively();
+    }
+    // Osiot ovat kaikille varmuuskopioille yhteisiä, joten niitä ei poisteta.
+    // Liitteiden kovat linkit pitävät tiedoston tallessa muille kopioille.
+    return poistettavat.count();
+}
+
+void Varmuuskopioija::run()
+{
+    // Kopio kirjoitetaan ensin väliaikaiseen tiedostoon, jottei
+    // keskeneräinen kopio korvaa aiempaa.
+    if( !kopioiTietokanta())
+    {
+        QFile::remove( valiaikainen());
+        return;
+    }
+
+    QFile::remove(kohde_);
+    if( !QFile::rename( valiaikainen(), kohde_))
+    {
+        virhe_ = tr("Tiedostoon %1 kirjoittaminen epäonnistui").arg(kohde_);
+        QFile::remove( valiaikainen());
+        return;
+    }
+
+    onnistui_ = kopioiOheistiedostot() && kopioiLiitteet();
+}
+
+bool Varmuuskopioija::samaSqlite(QSqlDatabase tietokanta)
+{
+    // Muistiraja on kirjastokohtainen, joten ajuri näkee sen vain,
+    // jos se käyttää samaa kirjastoa
+    sqlite3_int64 aiempi = sqlite3_soft_heap_limit64(-1);
+    sqlite3_int64 tunniste = aiempi > 0 ? aiempi + 1 : Q_INT64_C(0x4b6974757069);
+    sqlite3_soft_heap_limit64(tunniste);
+
+    QSqlQuery kysely(tietokanta);
+    bool sama = kysely.exec("PRAGMA soft_heap_limit") && kysely.next() &&
+            kysely.value(0).toLongLong() == tunniste;
+
+    sqlite3_soft_heap_limit64(aiempi);
+    return sama;
+}
+
+bool Varmuuskopioija::kopioiTietokanta()
+{
+    // Molemmat tiedostot avataan ohjelmaan linkitetyllä SQLitellä. Se on sama
+    // kirjasto kuin Qt:n ajurissa (samaSqlite), mutta ajurin kahvaa ei käytetä,
+    // koska ajuri avaa yhteytensä ilman SQLiten säielukitusta.
+    sqlite3 *lahde = nullptr;
+    sqlite3 *kohde = nullptr;
+    int tulos = sqlite3_open_v2( tiedosto_.toUtf8().constData(), &lahde, SQLITE_OPEN_READONLY, nullptr);
+    if( tulos != SQLITE_OK )
+    {
+        virhe_ = QString::fromUtf8( sqlite3_errmsg(lahde));
+        sqlite3_close(lahde);
+        return false;
+    }
+    sqlite3_busy_timeout(lahde, 5000);
+
+    // WAL-tilassa koko kopio luetaan samasta lukutapahtumasta, joten muiden
+    // yhteyksien kirjoitukset eivät aloita kopiointia alusta
+    if( wal_ )
+        tulos = sqlite3_exec(lahde, "BEGIN; SELECT COUNT(*) FROM sqlite_master", nullptr, nullptr, nullptr);
+    if( tulos != SQLITE_OK )
+        virhe_ = QString::fromUtf8( sqlite3_errmsg(lahde));
+    else if( sqlite3_open_v2( valiaikainen().toUtf8().constData(), &kohde,
+                              SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK )
+    {
+        tulos = SQLITE_CANTOPEN;
+        virhe_ = tr("Tiedostoon %1 kirjoittaminen epäonnistui").arg(kohde_);
+    }
+    else
+    {
+        tulos = SQLITE_ERROR;
+        sqlite3_backup *varmistus = sqlite3_backup_init(kohde, "main", lahde, "main");
+        if( varmistus )
+        {
+            int varattuna = 0;
+            int aloituksia = 0;
+            int jaljella = -1;
+            do
+            {
+                tulos = sqlite3_backup_step(varmistus, SIVUJA);
+                int yhteensa = sqlite3_backup_pagecount(varmistus);
+                emit edistyminen( yhteensa - sqlite3_backup_remaining(varmistus), yhteensa);
+
+                // Kun pääyhteys kirjoittaa kesken kopioinnin, kopiointi alkaa alusta
+                if( jaljella >= 0 && sqlite3_backup_remaining(varmistus) > jaljella &&
+                    ++aloituksia >= YRITYKSIA )
+                {
+                    tulos = SQLITE_BUSY;
+                    break;
+                }
+                jaljella = sqlite3_backup_remaining(varmistus);
+
+                if( tulos == SQLITE_BUSY || tulos == SQLITE_LOCKED)
+                {
+                    if( ++varattuna >= YRITYKSIA )
+                        break;
+                    msleep(100);
+                }
+                else
+                    varattuna = 0;
+            } while( (tulos == SQLITE_OK || tulos == SQLITE_BUSY || tulos == SQLITE_LOCKED)
+                     && !isInterruptionRequested() );
+
+            sqlite3_backup_finish(varmistus);
+        }
+
+        if( tulos != SQLITE_DONE && isInterruptionRequested())
+            virhe_ = tr("Varmuuskopiointi keskeytettiin");
+        else if( tulos == SQLITE_BUSY || tulos == SQLITE_LOCKED)
+            virhe_ = tr("Tietokanta oli liian kauan varattuna");
+        else if( tulos != SQLITE_DONE )
+            virhe_ = QString::fromUtf8( sqlite3_errmsg(kohde));
+    }
+
+    sqlite3_close(kohde);
+    if( wal_ )
+        sqlite3_exec(lahde, "ROLLBACK", nullptr, nullptr, nullptr);
+    sqlite3_close(lahde);
+
+    return tulos == SQLITE_DONE;
+}
+
+bool Varmuuskopioija::kopioiOheistiedostot()
+{
+    QDir hakemisto = QFileInfo(kohde_).dir();
+
+    for( const QString& tiedosto : oheistiedostot_)
+    {
+        QFileInfo lahde(tiedosto);
+        QFileInfo kohde( hakemisto.absoluteFilePath( lahde.fileName()));
+        if( kohde.exists() && kohde.size() == lahde.size())
+            continue;
+
+        QFile::remove( kohde.absoluteFilePath());
+        if( !QFile::copy( lahde.absoluteFilePath(), kohde.absoluteFilePath()))
+        {
+            virhe_ = tr("Tiedoston %1 kopioiminen epäonnistui").arg(lahde.fileName());
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Luo kovan linkin olemassa olevaan tiedostoon
+ * @return tosi, jos onnistui
+ */
+static bool linkita(const QString& tiedosto, const QString& linkki)
+{
+#ifdef Q_OS_WIN
+    return CreateHardLinkW( reinterpret_cast<LPCWSTR>( QDir::toNativeSeparators(linkki).utf16()),
+                            reinterpret_cast<LPCWSTR>( QDir::toNativeSeparators(tiedosto).utf16()),
+                            nullptr );
+#else
+    return ::link( QFile::encodeName(tiedosto).constData(), QFile::encodeName(linkki).constData()) == 0;
+#endif
+}
+
+bool Varmuuskopioija::kopioiLiitteet()
+{
+    if( liitehakemisto_.isEmpty() || !QDir(liitehakemisto_).exists())
+        return true;
+
+    QDir lahde(liitehakemisto_);
+    QDir kohde( LiiteVarasto::hakemistoKirjanpidolle(kohde_));
+
+    // Varaston tiedostot nimetään sisältönsä mukaan, joten saman niminen
+    // tiedosto aiemmassa varmuuskopiossa on sama liite. Se linkitetään
+    // kopioimisen sijaan, jottei jokainen säilytetty kopio vie liitteiden tilaa.
+    QString kohdehakemisto = QFileInfo(kohde_).absolutePath();
+    QList<QDir> aiemmat;
+    for( const QString& nimi : ajastetut(tiedosto_, kohdehakemisto))
+    {
+        QString polku = QDir(kohdehakemisto).absoluteFilePath(nimi);
+        if( polku != QFileInfo(kohde_).absoluteFilePath())
+            aiemmat.append( QDir( LiiteVarasto::hakemistoKirjanpidolle(polku)));
+    }
+
+    QDirIterator iter(liitehakemisto_, QDir::Files, QDirIterator::Subdirectories);
+    while( iter.hasNext() && !isInterruptionRequested())
+    {
+        QString polku = iter.next();
+        // Keskeneräisen siirron väliaikaistiedostoja ei kopioida
+        if( iter.fileName().startsWith("siirto-"))
+            continue;
+
+        QString suhteellinen = lahde.relativeFilePath(polku);
+        QString kohdepolku = kohde.absoluteFilePath( suhteellinen );
+        if( QFile::exists(kohdepolku))
+            continue;
+
+        if( !QDir().mkpath( QFileInfo(kohdepolku).absolutePath()))
+        {
+            virhe_ = tr("Liitteen %1 kopioiminen epäonnistui").arg( iter.fileName());
+            return false;
+        }
+
+        bool linkitetty = false;
+        for( const QDir& aiempi : aiemmat)
+        {
+            QFileInfo vanha( aiempi.absoluteFilePath(suhteellinen));
+            if( vanha.exists() && vanha.size() == iter.fileInfo().size() &&
+                linkita( vanha.absoluteFilePath(), kohdepolku))
+            {
+                linkitetty = true;
+                break;
+            }
+        }
+
+        // Linkki ei onnistu esimerkiksi FAT-levyllä, jolloin tiedosto kopioidaan
+        if( !linkitetty && !QFile::copy(polku, kohdepolku))
+        {
+            virhe_ = tr("Liitteen %1 kopioiminen epäonnistui").arg( iter.fileName());
+            return false;
+        }
+    }
+    if( isInterruptionRequested())
+    {
+        virhe_ = tr("Varmuuskopiointi keskeytettiin");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,142 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef VARMUUSKOPIOIJA_H
+#define VARMUUSKOPIOIJA_H
+
+#include <QThread>
+#include <QStringList>
+#include <QDateTime>
+#include <QSqlDatabase>
+
+/**
+ * @brief Kirjanpidon varmuuskopiointi taustasäikeessä
+ *
+ * Tietokanta kopioidaan SQLiten backup-rajapinnalla (sqlite3_backup_step)
+ * sivu kerrallaan omalla vain luku -yhteydellään, joten kirjanpitoa voi
+ * käyttää kopioinnin aikana.
+ *
+ * WAL-tilassa kopio otetaan yhdestä lukutapahtumasta, jolloin kopio on eheä
+ * eikä kopiointi estä kirjoittamista. Ilman WAL-tilaa lukeminen estäisi
+ * kirjoittamisen, joten jokainen askel lukee omassa tapahtumassaan.
+ * Jos kirjanpitoa muokataan kesken kopioinnin, SQLite aloittaa kopioinnin
+ * alusta, jotta kopio on silloinkin eheä.
+ *
+ * Tietokannan jälkeen kopioidaan päätettyjen kausien osiot (*.kausi) ja
+ * erillisen liitevaraston tiedostot. Niistä kopioidaan vain ne, joita
+ * kohteessa ei vielä ole, koska osiot ja varaston tiedostot eivät muutu.
+ * Liitteet, jotka ovat jo aiemmassa samaan hakemistoon otetussa
+ * varmuuskopiossa, linkitetään siihen kovalla linkillä.
+ *
+ * Valmistuttuaan säie lähettää finished()-signaalin, jonka jälkeen
+ * tulos saadaan onnistui()- ja virhe()-funktioilla.
+ */
+class Varmuuskopioija : public QThread
+{
+    Q_OBJECT
+public:
+    /**
+     * @param tiedosto Kirjanpitotiedosto
+     * @param kohde Varmuuskopion tiedosto
+     * @param wal Onko kirjanpito WAL-tilassa
+     */
+    Varmuuskopioija(const QString& tiedosto, const QString& kohde, bool wal, QObject *parent = nullptr);
+
+    /**
+     * @brief Kopioitavat oheistiedostot, jotka sijoitetaan varmuuskopion viereen
+     */
+    void asetaOheistiedostot(const QStringList& tiedostot) { oheistiedostot_ = tiedostot; }
+    /**
+     * @brief Liitevaraston hakemisto, jos liitteitä on tallennettu erilleen
+     */
+    void asetaLiitehakemisto(const QString& hakemisto) { liitehakemisto_ = hakemisto; }
+
+    QString kohde() const { return kohde_; }
+    bool onnistui() const { return onnistui_; }
+    QString virhe() const { return virhe_; }
+
+    /**
+     * @brief Ajastetun varmuuskopion tiedostonimi
+     * @param tiedosto Kirjanpitotiedosto
+     * @param hakemisto Varmuuskopioiden hakemisto
+     */
+    static QString ajastettuTiedosto(const QString& tiedosto, const QString& hakemisto,
+                                     const QDateTime& aika = QDateTime::currentDateTime());
+
+    /**
+     * @brief Viimeisimmän ajastetun varmuuskopion aika, null jos ei ole
+     */
+    static QDateTime viimeisin(const QString& tiedosto, const QString& hakemisto);
+
+    /**
+     * @brief Poistaa vanhimmat ajastetut varmuuskopiot
+     * @param sailytettavia Montako uusinta varmuuskopiota säilytetään
+     * @return Poistettujen määrä
+     */
+    static int karsi(const QString& tiedosto, const QString& hakemisto, int sailytettavia);
+
+    /**
+     * @brief Käyttääkö Qt:n SQLite-ajuri samaa SQLite-kirjastoa kuin varmuuskopiointi
+     *
+     * Jos Qt:n ajurissa on oma SQLitensä, kaksi kirjastoa samassa prosessissa
+     * voivat vapauttaa toistensa POSIX-tiedostolukot, eikä kirjanpitoa voi
+     * silloin turvallisesti lukea rinnakkaisella yhteydellä. Kirjastot
+     * tunnistetaan asettamalla ohjelman SQLitellä muistiraja
+     * (sqlite3_soft_heap_limit64) ja lukemalla se ajurin yhteydellä.
+     *
+     * Kutsutaan pääsäikeestä.
+     *
+     * @param tietokanta Qt:n avoin SQLite-yhteys
+     */
+    static bool samaSqlite(QSqlDatabase tietokanta);
+
+    /**
+     * @brief Tietokantasivuja kopioidaan kerralla
+     */
+    static const int SIVUJA = 256;
+
+    /**
+     * @brief Montako kertaa varattuna olevaa tietokantaa yritetään peräkkäin,
+     * ja montako kertaa kopiointi aloitetaan alusta muokkausten vuoksi
+     */
+    static const int YRITYKSIA = 50;
+
+signals:
+    /**
+     * @brief Tietokannan kopioinnin edistyminen sivuina
+     */
+    void edistyminen(int valmis, int yhteensa);
+
+protected:
+    void run() override;
+
+    QString valiaikainen() const { return kohde_ + ".osa"; }
+    bool kopioiTietokanta();
+    bool kopioiOheistiedostot();
+    bool kopioiLiitteet();
+
+    QString tiedosto_;
+    QString kohde_;
+    bool wal_;
+    QStringList oheistiedostot_;
+    QString liitehakemisto_;
+
+    bool onnistui_ = false;
+    QString virhe_;
+};
+
+#endif // VARMUUSKOPIOIJA_H
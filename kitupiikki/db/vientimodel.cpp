@@ -280,7 +280,7 @@ QVariant VientiModel::data(const QModelIndex &index, int role) const
                 return QIcon(":/pic/lukittu.png");
             else if( rivi.pvm <= kp()->tilitpaatetty() || rivi.pvm > kp()->tilikaudet()->kirjanpitoLoppuu() )
                 return QIcon(":/pic/varoitus.png");
-            else if( kp()->asetukset()->pvm("AlvIlmoitus") >= rivi.pvm && rivi.alvkoodi )
+            else if( kp()->asetukset()->kuva().alvIlmoitus >= rivi.pvm && rivi.alvkoodi )
                 return QIcon(":/pic/vero.png");
         }
     }
@@ -335,7 +335,7 @@ bool VientiModel::setData(const QModelIndex &index, const QVariant &value, int
 
             viennit_[index.row()].tili = uusitili;
             // Tällä tilivalinnalla tulee myös oletukset veroille
-            int alvlaji = uusitili.json()->luku("AlvLaji");
+            int alvlaji = qAsConst(uusitili).json()->luku("AlvLaji");
             //  Uuden rivin alv-laji oletuksena bruttoa
             if( !viennit_[index.row()].alvkoodi &&  alvlaji % 10 == 1)
                 alvlaji++;
@@ -350,7 +350,7 @@ bool VientiModel::setData(const QModelIndex &index, const QVariant &value, int
 
 
             if( alvlaji)
-                viennit_[index.row()].alvprosentti = uusitili.json()->luku("AlvProsentti");
+                viennit_[index.row()].alvprosentti = qAsConst(uusitili).json()->luku("AlvProsentti");
 
             emit dataChanged(index, index.sibling(index.row(), ALV));
             emit muuttunut();
@@ -465,7 +465,7 @@ bool VientiModel::setData(const QModelIndex &index, const QVariant &value, int
 Qt::ItemFlags VientiModel::flags(const QModelIndex &index) const
 {
 
-    VientiRivi rivi = viennit_.value(index.row());
+    const VientiRivi rivi = viennit_.value(index.row());
 
     // Vientien muokkaus: Jos model sallii eikä ole lukittu
     // Huom! Rivien lukitus
@@ -540,13 +540,13 @@ QModelIndex VientiModel::lisaaVienti(int indeksi)
         // Tositelajin oletustili
         int oletustili = tositeModel_->tositelaji().json()->luku("Oletustili");
         uusirivi.tili = kp()->tilit()->tiliNumerolla(oletustili);
-        uusirivi.alvkoodi = uusirivi.tili.json()->luku("AlvLaji");
+        uusirivi.alvkoodi = qAsConst(uusirivi.tili).json()->luku("AlvLaji");
 
         // Kuitenkin käsin kirjattaessa käytetään bruttokirjauksia (#37)
         if( uusirivi.alvkoodi % 10 == 1)
             uusirivi.alvkoodi++;
 
-        uusirivi.alvprosentti = uusirivi.tili.json()->luku("AlvProsentti");
+        uusirivi.alvprosentti = qAsConst(uusirivi.tili).json()->luku("AlvProsentti");
     }
     else
     {
@@ -558,7 +558,7 @@ QModelIndex VientiModel::lisaaVienti(int indeksi)
         int vastatili = tositeModel_->tositelaji().json()->luku("Vastatili");
         if( !vastatili && viennit_.count())
         {
-            vastatili = viennit_.last().tili.json()->luku("Vastatili");
+            vastatili = viennit_.constLast().tili.json()->luku("Vastatili");
         }
         uusirivi.tili = kp()->tilit()->tiliNumerolla( vastatili);
     }
@@ -637,7 +637,8 @@ bool VientiModel::tallenna()
                           "kreditsnt=:kreditsnt, selite=:selite, alvkoodi=:alvkoodi,"
                           "kohdennus=:kohdennus, eraid=:eraid, alvprosentti=:alvprosentti, "
                           "viite=:viite, iban=:iban, erapvm=:erapvm, arkistotunnus=:arkistotunnus, "
-                          "muokattu=:muokattu, json=:json, asiakas=:asiakas, vientirivi=:rivinro, laskupvm=:laskupvm"
+                          "muokattu=:muokattu, json=:json, asiakas=:asiakas, vientirivi=:rivinro, laskupvm=:laskupvm, "
+                          "kirjausperuste=:kirjausperuste, hyvityslasku=:hyvityslasku, maksumuistutus=:maksumuistutus"
                           " WHERE id=:id");
             query.bindValue(":id", rivi.vientiId);
             if( poistetutVientiIdt_.contains(rivi.vientiId))
@@ -647,10 +648,12 @@ bool VientiModel::tallenna()
         {
             query.prepare("INSERT INTO vienti(tosite,pvm,tili,debetsnt,kreditsnt,selite,"
                            "alvkoodi, alvprosentti, luotu, muokattu, json, kohdennus, eraid, vientirivi,"
-                           "viite, iban, erapvm, arkistotunnus,asiakas,laskupvm) "
+                           "viite, iban, erapvm, arkistotunnus,asiakas,laskupvm,"
+                           "kirjausperuste, hyvityslasku, maksumuistutus) "
                             "VALUES(:tosite,:pvm,:tili,:debetsnt,:kreditsnt,:selite,"
                             ":alvkoodi, :alvprosentti, :luotu, :muokattu, :json, :kohdennus, :eraid, :rivinro,"
-                            ":viite, :iban, :erapvm, :arkistotunnus, :asiakas, :laskupvm)");
+                            ":viite, :iban, :erapvm, :arkistotunnus, :asiakas, :laskupvm,"
+                            ":kirjausperuste, :hyvityslasku, :maksumuistutus)");
             query.bindValue(":luotu",  QDateTime::currentDateTime() );            
         }
         query.bindValue(":rivinro", i + 1);        // Pidetään viennit siististi numeroituina
@@ -699,7 +702,7 @@ bool VientiModel::tallenna()
         query.bindValue(":laskupvm", rivi.laskupvm);
         query.bindValue(":arkistotunnus", rivi.arkistotunnus);
         query.bindValue(":asiakas", rivi.asiakas);
-        query.bindValue(":json", rivi.json.toSqlJson());
+        sidoJson(query, rivi.json);
 
         if( !query.exec() )
         {
@@ -774,8 +777,16 @@ void VientiModel::lataa()
     query.exec(QString("SELECT id, pvm, tili, debetsnt, kreditsnt, selite, "
                        "alvkoodi, alvprosentti, luotu, muokattu, json, "
                        "kohdennus, eraid, vientirivi, viite, iban, erapvm, arkistotunnus, asiakas, laskupvm "
-                       "FROM vienti WHERE tosite=%1 "
-                       "ORDER BY vientirivi").arg( tositeModel_->id() ));
+                       "FROM %2 WHERE tosite=%1 "
+                       "ORDER BY vientirivi").arg( tositeModel_->id() )
+                       .arg( kp()->osiot()->taulu("vienti", tositeModel_->pvm(), tositeModel_->pvm()) ));
+
+    // Tositemallin yhteys voi olla muu kuin pääyhteys, joten tagikyselyä ei
+    // oteta kyselyvarastosta
+    QSqlQuery tagiKysely( *tositeModel_->tietokanta() );
+    tagiKysely.prepare( QString("SELECT kohdennus FROM %1 WHERE vienti=:vienti")
+                        .arg( kp()->osiot()->taulu("merkkaus", tositeModel_->pvm(), tositeModel_->pvm())));
+
     while( query.next())
     {
         VientiRivi rivi;
@@ -808,8 +819,8 @@ void VientiModel::lataa()
         rivi.laskupvm = query.value("laskupvm").toDate();
 
         // Tagien hakeminen
-        QSqlQuery tagiKysely( *tositeModel_->tietokanta() );
-        tagiKysely.exec( QString("SELECT kohdennus FROM merkkaus WHERE vienti=%1").arg(rivi.vientiId));
+        tagiKysely.bindValue(":vienti", rivi.vientiId);
+        tagiKysely.exec();
         while( tagiKysely.next())
         {
             rivi.tagit.append( kp()->kohdennukset()->kohdennus( tagiKysely.value(0).toInt() ) );
@@ -824,3 +835,20 @@ void VientiModel::lataa()
     emit muuttunut();
 }
 
+void VientiModel::sidoJson(QSqlQuery &kysely, JsonKentta &json)
+{
+    sidoLaskusarakkeet(kysely, json);
+    kysely.bindValue(":json", json.toSqlJson());
+}
+
+void VientiModel::sidoLaskusarakkeet(QSqlQuery &kysely, const JsonKentta &json)
+{
+    // Puuttuva avain tallennetaan NULLina
+    QVariant kirjausperuste = json.variant("Kirjausperuste");
+    QVariant hyvityslasku = json.variant("Hyvityslasku");
+    QVariant maksumuistutus = json.variant("Maksumuistutus");
+
+    kysely.bindValue(":kirjausperuste", kirjausperuste.isNull() ? QVariant() : QVariant( kirjausperuste.toInt() ));
+    kysely.bindValue(":hyvityslasku", hyvityslasku.isNull() ? QVariant() : QVariant( hyvityslasku.toLongLong() ));
+    kysely.bindValue(":maksumuistutus", maksumuistutus.isNull() ? QVariant() : QVariant( maksumuistutus.toLongLong() ));
+}
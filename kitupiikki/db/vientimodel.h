@@ -27,6 +27,7 @@
 #include "verotyyppimodel.h"
 #include "db/eranvalintamodel.h"
 
+class QSqlQuery;
 class TositeModel;
 
 
@@ -157,6 +158,30 @@ public:
      */
     void uusiPohjalta(const QString& otsikko);
 
+    /**
+     * @brief Sitoo viennin json-kentän ja siitä poimitut laskusarakkeet
+     *
+     * Kaikki vienti-taulun json-kentän kirjoitukset tehdään tämän kautta,
+     * jotta laskusarakkeet pysyvät jsonin mukaisina. Tietokannan
+     * triggereissä ei voi käyttää json_extract():ia, koska kenttä voi olla
+     * CBOR-muotoinen.
+     *
+     * @param kysely Kysely, jossa paikat :json, :kirjausperuste, :hyvityslasku ja :maksumuistutus
+     * @param json Viennin json-kenttä
+     */
+    static void sidoJson(QSqlQuery& kysely, JsonKentta& json);
+
+    /**
+     * @brief Sitoo laskujen json-avaimet omiin sarakkeisiinsa
+     *
+     * Kirjausperuste, Hyvityslasku ja Maksumuistutus tallennetaan jsonin lisäksi
+     * omiin sarakkeisiinsa, jotta laskuja voidaan suodattaa kyselyssä
+     *
+     * @param kysely Kysely, jossa paikat :kirjausperuste, :hyvityslasku ja :maksumuistutus
+     * @param json Viennin json-kenttä
+     */
+    static void sidoLaskusarakkeet(QSqlQuery& kysely, const JsonKentta& json);
+
 public slots:
     /**
      * @brief Tallentaa viennit
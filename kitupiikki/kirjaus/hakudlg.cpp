@@ -0,0 +1,80 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QLineEdit>
+#include <QListWidget>
+#include <QVBoxLayout>
+#include <QTimer>
+
+#include "hakudlg.h"
+#include "db/kirjanpito.h"
+#include "db/hakuindeksi.h"
+
+HakuDlg::HakuDlg()
+{
+    setWindowTitle( tr("Etsi tositteita"));
+    resize(600, 400);
+
+    hakuEdit_ = new QLineEdit;
+    hakuEdit_->setPlaceholderText( tr("Otsikko, selite, asiakas tai viitenumero"));
+    hakuEdit_->setClearButtonEnabled(true);
+    lista_ = new QListWidget;
+
+    QVBoxLayout *leiska = new QVBoxLayout;
+    leiska->addWidget(hakuEdit_);
+    leiska->addWidget(lista_);
+    setLayout(leiska);
+
+    // Haetaan vasta, kun kirjoittaminen pysähtyy hetkeksi
+    viive_ = new QTimer(this);
+    viive_->setSingleShot(true);
+    viive_->setInterval(150);
+
+    connect( hakuEdit_, &QLineEdit::textChanged, viive_, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect( viive_, &QTimer::timeout, this, &HakuDlg::hae);
+    connect( lista_, &QListWidget::itemActivated, this, &HakuDlg::valitse);
+    connect( hakuEdit_, &QLineEdit::returnPressed, [this] { if( lista_->count()) valitse( lista_->item(0)); });
+}
+
+void HakuDlg::hae()
+{
+    lista_->clear();
+    if( hakuEdit_->text().trimmed().length() < 2)
+        return;
+
+    for( const HakuIndeksi::Osuma& osuma : HakuIndeksi::hae( *kp()->tietokanta(), hakuEdit_->text()))
+    {
+        QListWidgetItem *item = new QListWidgetItem( QString("%1  %2").arg( osuma.pvm.toString("dd.MM.yyyy")).arg(osuma.otsikko), lista_);
+        if( osuma.osuma != osuma.otsikko)
+            item->setText( item->text() + QString(" – %1").arg(osuma.osuma));
+        item->setData( Qt::UserRole, osuma.tosite);
+    }
+}
+
+void HakuDlg::valitse(QListWidgetItem *item)
+{
+    tosite_ = item->data(Qt::UserRole).toInt();
+    accept();
+}
+
+int HakuDlg::tositeId()
+{
+    HakuDlg dlg;
+    if( dlg.exec() == Accepted )
+        return dlg.tosite_;
+    return 0;
+}
@@ -0,0 +1,57 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HAKUDLG_H
+#define HAKUDLG_H
+
+#include <QDialog>
+
+class QLineEdit;
+class QListWidget;
+class QListWidgetItem;
+class QTimer;
+
+/**
+ * @brief Dialogi tositteiden etsimiseen tekstillä kaikilta tilikausilta
+ *
+ * Haku tehdään HakuIndeksi-tekstihakuindeksistä kirjoitettaessa.
+ */
+class HakuDlg : public QDialog
+{
+    Q_OBJECT
+protected:
+    HakuDlg();
+
+protected slots:
+    void hae();
+    void valitse(QListWidgetItem* item);
+
+public:
+    /**
+     * @brief Näyttää hakudialogin
+     * @return Valitun tositteen id, 0 jos ei valittu
+     */
+    static int tositeId();
+
+protected:
+    QLineEdit *hakuEdit_;
+    QListWidget *lista_;
+    QTimer *viive_;
+    int tosite_ = 0;
+};
+
+#endif // HAKUDLG_H
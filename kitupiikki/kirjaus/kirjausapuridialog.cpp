@@ -194,7 +194,7 @@ KirjausApuriDialog::~KirjausApuriDialog()
 void KirjausApuriDialog::tiliTaytetty()
 {
     // Jos tilillä on vastatili, niin täytetään se
-    Tili tili = kp()->tilit()->tiliNumerolla(  ui->tiliEdit->valittuTilinumero() );
+    const Tili tili = kp()->tilit()->tiliNumerolla(  ui->tiliEdit->valittuTilinumero() );
 
     if( tili.onkoValidi() && tili.numero() && ui->tiliEdit->text().length() > 5)
     {
@@ -290,7 +290,7 @@ void KirjausApuriDialog::alvLajiMuuttui()
     else    
     {
         ui->alvSpin->setEnabled(true);
-        Tili tili = kp()->tilit()->tiliNumerolla(  ui->tiliEdit->valittuTilinumero() );
+        const Tili tili = kp()->tilit()->tiliNumerolla(  ui->tiliEdit->valittuTilinumero() );
         if( tili.json()->luku("AlvProsentti"))
             ui->alvSpin->setValue( tili.json()->luku("AlvProsentti"));
         else
@@ -452,8 +452,8 @@ void KirjausApuriDialog::vaihdaDebetKredit()
 
 void KirjausApuriDialog::kohdennusNakyviin()
 {
-    Tili tili = ui->tiliEdit->valittuTili();
-    Tili vastatili = ui->vastatiliEdit->valittuTili();
+    const Tili tili = ui->tiliEdit->valittuTili();
+    const Tili vastatili = ui->vastatiliEdit->valittuTili();
 
     bool naytetaan = kp()->kohdennukset()->kohdennuksia() &&  ( ui->valintaTab->currentIndex() != SIIRTO ||
             tili.onko(TiliLaji::TULOS) || tili.json()->luku("Kohdennukset") ||
@@ -587,7 +587,7 @@ void KirjausApuriDialog::ehdota()
             else
                 taserivi.debetSnt = nettoSnt;
 
-            if( taserivi.tili.json()->luku("Kohdennukset"))
+            if( qAsConst(taserivi.tili).json()->luku("Kohdennukset"))
                 taserivi.kohdennus = kp()->kohdennukset()->kohdennus(ui->kohdennusCombo->currentData(KohdennusModel::IdRooli).toInt());
 
             if( ui->vastaTaseEraCombo->isVisible())
@@ -722,7 +722,7 @@ void KirjausApuriDialog::ehdota()
             if( ui->vastaTaseEraCombo->isVisible())
                 taserivi.eraId = ui->vastaTaseEraCombo->currentData(EranValintaModel::EraIdRooli).toInt();
 
-            if( taserivi.tili.json()->luku("Kohdennukset"))
+            if( qAsConst(taserivi.tili).json()->luku("Kohdennukset"))
                 taserivi.kohdennus = kohdennus;
 
             if(vastatili.onko(TiliLaji::OSTOVELKA))
@@ -758,7 +758,7 @@ void KirjausApuriDialog::ehdota()
             if( ui->taseEraCombo->isVisible())
                 rivi.eraId = ui->taseEraCombo->currentData(EranValintaModel::EraIdRooli).toInt();
 
-            if( rivi.tili.json()->luku("Kohdennukset"))
+            if( qAsConst(rivi.tili).json()->luku("Kohdennukset"))
                 rivi.kohdennus = kohdennus;
             rivi.tagit = tagit;
             ehdotus.lisaaVienti(rivi);
@@ -771,7 +771,7 @@ void KirjausApuriDialog::ehdota()
             if( ui->vastaTaseEraCombo->isVisible())
                 rivi.eraId = ui->vastaTaseEraCombo->currentData(EranValintaModel::EraIdRooli).toInt();
 
-            if( rivi.tili.json()->luku("Kohdennukset"))
+            if( qAsConst(rivi.tili).json()->luku("Kohdennukset"))
                 rivi.kohdennus = kohdennus;
 
             rivi.tagit = tagit;
@@ -52,6 +52,7 @@
 #include "siirrydlg.h"
 
 #include "db/kirjanpito.h"
+#include "db/hakuindeksi.h"
 #include "laskutus/laskunmaksudialogi.h"
 
 #include "tuonti/tuonti.h"
@@ -501,7 +502,10 @@ void KirjausWg::siirryTositteeseen()
 
 void KirjausWg::paivitaOtsikonTaydennys(const QString &teksti)
 {
-    if( teksti.length() > 2 && !teksti.contains(QChar('\'')))
+    if( teksti.length() > 2 && !teksti.contains(QChar('\'')) && HakuIndeksi::kaytossa())
+        taydennysSql_->setQuery(QString("SELECT DISTINCT otsikko FROM hakusana WHERE hakusana MATCH '%1' order by otsikko")
+                                .arg( HakuIndeksi::lauseke(teksti, "otsikko", true)));
+    else if( teksti.length() > 2 && !teksti.contains(QChar('\'')))
         taydennysSql_->setQuery(QString("SELECT otsikko FROM tosite WHERE otsikko LIKE '%1%' order by otsikko").arg(teksti));
     else
         taydennysSql_->clear();
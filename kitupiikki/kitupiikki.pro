@@ -7,10 +7,15 @@ QT += network
 QT += svg
 QT += xml
 
+# Json-kenttien CBOR-muoto (JsonKentta) vaatii Qt 5.12:n
+equals(QT_MAJOR_VERSION, 5):lessThan(QT_MINOR_VERSION, 12) {
+    error("Kitupiikki vaatii Qt:n version 5.12 tai uudemman")
+}
 
 LIBS += -lpoppler-qt5
 LIBS += -lpoppler
 LIBS += -lzip
+LIBS += -lsqlite3
 
 windows {
     LIBS += -lopenjp2
@@ -20,6 +25,9 @@ windows {
 macx {
     LIBS += -L/usr/local/opt/poppler/lib -lpoppler-qt5
     LIBS += -L/usr/local/opt/libzip -lzip
+    # Homebrew'n qt@5 käyttää Homebrew'n SQLiteä, jota varmuuskopiointikin käyttää
+    LIBS += -L/usr/local/opt/sqlite/lib
+    INCLUDEPATH += /usr/local/opt/sqlite/include
     INCLUDEPATH += /usr/local/include
 }
 
@@ -50,6 +58,8 @@ SOURCES += main.cpp \
     selaus/selauswg.cpp \
     db/tilikausi.cpp \
     selaus/selausmodel.cpp \
+    selaus/selausrivit.cpp \
+    selaus/selaushakija.cpp \
     raportti/raporttisivu.cpp \
     raportti/raportti.cpp \
     raportti/paivakirjaraportti.cpp \
@@ -146,6 +156,7 @@ SOURCES += main.cpp \
     laskutus/nayukiQR/QrSegment.cpp \
     tuonti/titotuonti.cpp \
     kirjaus/siirrydlg.cpp \
+    kirjaus/hakudlg.cpp \
     laskutus/ostolaskutmodel.cpp \
     tools/kpdateedit.cpp \
     uusikp/kirjausperustesivu.cpp \
@@ -160,6 +171,7 @@ SOURCES += main.cpp \
     naytin/naytinikkuna.cpp \
     maaritys/tallentavamaarityswidget.cpp \
     maaritys/inboxmaaritys.cpp \
+    maaritys/varmuuskopiomaaritys.cpp \
     tools/inboxlista.cpp \
     arkisto/budjettimodel.cpp \
     arkisto/budjettidlg.cpp \
@@ -191,7 +203,19 @@ SOURCES += main.cpp \
     kirjaus/viennitview.cpp \
     kirjaus/edellinenseuraavatieto.cpp \
     uusikp/numerointisivu.cpp \
-    kirjaus/verotarkastaja.cpp
+    kirjaus/verotarkastaja.cpp \
+    db/saldotaulu.cpp \
+    db/erataulu.cpp \
+    db/kyselyvarasto.cpp \
+    db/paivittaja.cpp \
+    db/kyselyloki.cpp \
+    db/kirjanpidonmuutos.cpp \
+    db/mitattukysely.cpp \
+    db/liitevarasto.cpp \
+    db/kausiosiot.cpp \
+    db/varmuuskopioija.cpp \
+    db/hakuindeksi.cpp \
+    tools/kyselylokimodel.cpp
 
 HEADERS += \
     uusikp/uusikirjanpito.h \
@@ -214,6 +238,8 @@ HEADERS += \
     selaus/selauswg.h \
     db/tilikausi.h \
     selaus/selausmodel.h \
+    selaus/selausrivit.h \
+    selaus/selaushakija.h \
     raportti/raporttisivu.h \
     raportti/raportti.h \
     raportti/paivakirjaraportti.h \
@@ -310,6 +336,7 @@ HEADERS += \
     laskutus/nayukiQR/QrSegment.hpp \
     tuonti/titotuonti.h \
     kirjaus/siirrydlg.h \
+    kirjaus/hakudlg.h \
     laskutus/ostolaskutmodel.h \
     tools/kpdateedit.h \
     uusikp/kirjausperustesivu.h \
@@ -324,6 +351,7 @@ HEADERS += \
     naytin/naytinikkuna.h \
     maaritys/tallentavamaarityswidget.h \
     maaritys/inboxmaaritys.h \
+    maaritys/varmuuskopiomaaritys.h \
     tools/inboxlista.h \
     arkisto/budjettimodel.h \
     arkisto/budjettidlg.h \
@@ -356,7 +384,19 @@ HEADERS += \
     kirjaus/viennitview.h \
     kirjaus/edellinenseuraavatieto.h \
     uusikp/numerointisivu.h \
-    kirjaus/verotarkastaja.h
+    kirjaus/verotarkastaja.h \
+    db/saldotaulu.h \
+    db/erataulu.h \
+    db/kyselyvarasto.h \
+    db/paivittaja.h \
+    db/kyselyloki.h \
+    db/kirjanpidonmuutos.h \
+    db/mitattukysely.h \
+    db/liitevarasto.h \
+    db/kausiosiot.h \
+    db/varmuuskopioija.h \
+    db/hakuindeksi.h \
+    tools/kyselylokimodel.h
 
 RESOURCES += \
     tilikartat/tilikartat.qrc \
@@ -432,6 +472,7 @@ FORMS += \
     uusikp/kirjausperuste.ui \
     laskutus/yhteystiedot.ui \
     maaritys/inboxmaaritys.ui \
+    maaritys/varmuuskopiomaaritys.ui \
     arkisto/budjettidlg.ui \
     laskutus/ryhmantuontidlg.ui \
     maaritys/verkkolaskumaaritys.ui \
@@ -26,6 +26,9 @@
 #include <QDateEdit>
 #include <QMouseEvent>
 #include <QShortcut>
+#include <QProgressBar>
+#include <QTimer>
+#include <QMessageBox>
 
 #include <QMenuBar>
 
@@ -52,12 +55,15 @@
 #include "alv/alvsivu.h"
 
 #include "db/kirjanpito.h"
+#include "db/varmuuskopioija.h"
+#include "db/hakuindeksi.h"
 
 #include "onniwidget.h"
 
 #include "lisaikkuna.h"
 #include "laskutus/laskudialogi.h"
 #include "kirjaus/siirrydlg.h"
+#include "kirjaus/hakudlg.h"
 
 #include "tools/inboxlista.h"
 
@@ -138,12 +144,26 @@ KitupiikkiIkkuna::KitupiikkiIkkuna(QWidget *parent) : QMainWindow(parent),
     new QShortcut(QKeySequence(Qt::SHIFT + Qt::Key_F4), this, SLOT(uusiLasku()), nullptr, Qt::ApplicationShortcut);
 
     new QShortcut(QKeySequence("Ctrl+G"), this, SLOT(siirryTositteeseen()), nullptr, Qt::ApplicationShortcut);
+    new QShortcut(QKeySequence("Ctrl+Shift+F"), this, SLOT(etsiTosite()), nullptr, Qt::ApplicationShortcut);
     new QShortcut(QKeySequence(Qt::Key_F8), this, SLOT(kirjaaKirjattavienKansiosta()), nullptr, Qt::ApplicationShortcut  );
 
 
     toolbar->installEventFilter(this);
     toolbar->setContextMenuPolicy(Qt::PreventContextMenu);
 
+    // Varmuuskopioinnin edistyminen näytetään tilarivillä
+    varmuuskopioPalkki_ = new QProgressBar;
+    varmuuskopioPalkki_->setMaximumWidth(200);
+    statusBar()->addPermanentWidget(varmuuskopioPalkki_);
+    statusBar()->hide();
+
+    connect( aloitussivu, &AloitusSivu::varmuuskopioiTiedostoon, this, [this] (const QString& tiedosto) { varmuuskopioi(tiedosto); });
+
+    varmuuskopioAjastin_ = new QTimer(this);
+    varmuuskopioAjastin_->start( 60 * 60 * 1000 );
+    connect( varmuuskopioAjastin_, &QTimer::timeout, this, &KitupiikkiIkkuna::tarkastaAjastettuVarmuuskopio);
+    connect( kp(), &Kirjanpito::varmuuskopiointiMuuttui, this, &KitupiikkiIkkuna::tarkastaAjastettuVarmuuskopio);
+
 
 
 }
@@ -202,6 +222,53 @@ void KitupiikkiIkkuna::kirjanpitoLadattu()
 
     edellisetIndeksit.clear();  // Tyhjennetään "selaushistoria"
     piilotaAlvJosEiVerovelvollinen();
+
+    // Annetaan kirjanpidon latautua ennen varmuuskopiointia
+    QTimer::singleShot(10000, this, &KitupiikkiIkkuna::tarkastaAjastettuVarmuuskopio);
+}
+
+void KitupiikkiIkkuna::varmuuskopioi(const QString &tiedostoon, bool ajastettu)
+{
+    if( varmuuskopioija_ )
+    {
+        if( !ajastettu )
+            QMessageBox::information(this, tr("Varmuuskopiointi"), tr("Varmuuskopiointi on jo käynnissä."));
+        return;
+    }
+
+    if( !Varmuuskopioija::samaSqlite( *kp()->tietokanta()))
+    {
+        // Ajastettu varmuuskopio yritetään tunnin välein, mutta varoitetaan kerran
+        if( !ajastettu || !sqliteVaroitettu_ )
+            QMessageBox::critical(this, tr("Varmuuskopiointi"),
+                                  tr("Kirjanpitoa ei voi varmuuskopioida, koska Qt:n tietokanta-ajuri "
+                                     "käyttää eri SQLite-kirjastoa kuin Kitupiikki.\n\n"
+                                     "Kopioi kirjanpitotiedosto ohjelman ollessa suljettuna."));
+        sqliteVaroitettu_ = true;
+        return;
+    }
+
+    varmuuskopioija_ = new Varmuuskopioija( kp()->tiedostopolku(), tiedostoon, kp()->onkoWal(), this);
+    ajastettuVarmuuskopio_ = ajastettu;
+
+    // Päätettyjen kausien osiot ja erillinen liitevarasto kuuluvat kirjanpitoon
+    QStringList osiot;
+    for( const KausiOsiot::Osio& osio : kp()->osiot()->osiot())
+        osiot.append( osio.polku );
+    varmuuskopioija_->asetaOheistiedostot(osiot);
+    varmuuskopioija_->asetaLiitehakemisto( kp()->liitevarasto()->hakemisto());
+
+    connect( varmuuskopioija_, &Varmuuskopioija::edistyminen, this, [this] (int valmis, int yhteensa) {
+        varmuuskopioPalkki_->setRange(0, yhteensa);
+        varmuuskopioPalkki_->setValue(valmis);
+    });
+    connect( varmuuskopioija_, &Varmuuskopioija::finished, this, &KitupiikkiIkkuna::varmuuskopioValmis);
+
+    varmuuskopioPalkki_->setRange(0, 0);
+    statusBar()->showMessage( tr("Varmuuskopioidaan tiedostoon %1").arg( QDir::toNativeSeparators(tiedostoon)));
+    statusBar()->show();
+
+    varmuuskopioija_->start(QThread::LowPriority);
 }
 
 void KitupiikkiIkkuna::palaaSivulta()
@@ -325,6 +392,19 @@ void KitupiikkiIkkuna::siirryTositteeseen()
 
 }
 
+void KitupiikkiIkkuna::etsiTosite()
+{
+    if( !kp()->tietokanta()->isOpen() || !HakuIndeksi::kaytossa())
+        return;
+
+    int id = HakuDlg::tositeId();
+    if( !id || (nykysivu && !nykysivu->poistuSivulta(KIRJAUSSIVU) ))
+        return;
+
+    valitseSivu(KIRJAUSSIVU, false);
+    kirjaussivu->naytaTosite( id );
+}
+
 void KitupiikkiIkkuna::kirjaaKirjattavienKansiosta()
 {
     valitseSivu(KIRJAUSSIVU, false);
@@ -374,8 +454,56 @@ bool KitupiikkiIkkuna::eventFilter(QObject *watched, QEvent *event)
     return QMainWindow::eventFilter(watched, event);
 }
 
+void KitupiikkiIkkuna::tarkastaAjastettuVarmuuskopio()
+{
+    QString hakemisto = kp()->asetukset()->asetus("VarmuuskopioKansio");
+    int vali = kp()->asetukset()->luku("VarmuuskopioVali");
+    if( varmuuskopioija_ || hakemisto.isEmpty() || vali < 1 || !kp()->tietokanta()->isOpen())
+        return;
+
+    QDateTime viimeisin = Varmuuskopioija::viimeisin( kp()->tiedostopolku(), hakemisto);
+    if( viimeisin.isValid() && viimeisin.addDays(vali) > QDateTime::currentDateTime())
+        return;
+
+    if( QDir().mkpath(hakemisto))
+        varmuuskopioi( Varmuuskopioija::ajastettuTiedosto( kp()->tiedostopolku(), hakemisto), true);
+}
+
+void KitupiikkiIkkuna::varmuuskopioValmis()
+{
+    Varmuuskopioija *valmis = varmuuskopioija_;
+    varmuuskopioija_ = nullptr;
+    valmis->deleteLater();
+
+    statusBar()->clearMessage();
+    statusBar()->hide();
+
+    if( !valmis->onnistui())
+    {
+        QMessageBox::critical(this, tr("Virhe"), tr("Kirjanpidon varmuuskopiointi epäonnistui.\n\n%1").arg(valmis->virhe()));
+        return;
+    }
+
+    if( ajastettuVarmuuskopio_ )
+    {
+        int sailytettavia = kp()->asetukset()->luku("VarmuuskopioMaara");
+        if( sailytettavia > 0)
+            Varmuuskopioija::karsi( kp()->tiedostopolku(), QFileInfo(valmis->kohde()).absolutePath(), sailytettavia);
+        naytaOnni( tr("Kirjanpito varmuuskopioitu"));
+    }
+    else
+        QMessageBox::information(this, kp()->asetukset()->asetus("Nimi"), tr("Kirjanpidon varmuuskopiointi onnistui."));
+}
+
 void KitupiikkiIkkuna::closeEvent(QCloseEvent *event)
 {
+    // Keskeneräinen varmuuskopio perutaan
+    if( varmuuskopioija_ )
+    {
+        varmuuskopioija_->requestInterruption();
+        varmuuskopioija_->wait();
+    }
+
     // Pääikkunan sulkeutuessa sivuikkunatkin suljetaan
     qApp->quit();
     event->accept();
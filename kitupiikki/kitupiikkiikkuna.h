@@ -38,6 +38,9 @@ class AlvSivu;
 
 class QDateEdit;
 class QDockWidget;
+class QProgressBar;
+class QTimer;
+class Varmuuskopioija;
 
 #include "db/tilikausi.h"
 #include "kitupiikkisivu.h"
@@ -76,6 +79,13 @@ public slots:
     void uusiSelausIkkuna();
     void uusiLasku();
 
+    /**
+     * @brief Aloittaa kirjanpidon varmuuskopioinnin taustalla
+     * @param tiedostoon Varmuuskopion tiedosto
+     * @param ajastettu Ajastettu varmuuskopio, jonka jälkeen vanhat karsitaan
+     */
+    void varmuuskopioi(const QString& tiedostoon, bool ajastettu = false);
+
 
 protected slots:
     void aktivoiSivu(QAction* aktio);
@@ -95,6 +105,11 @@ protected slots:
 
     void siirryTositteeseen();
 
+    /**
+     * @brief Etsii tositteen tekstihaulla kaikilta tilikausilta
+     */
+    void etsiTosite();
+
     /**
      * @brief Kirjaa ensimmäisen tositteen Kirjattavien kansiosta
      */
@@ -102,6 +117,12 @@ protected slots:
 
     void piilotaAlvJosEiVerovelvollinen();
 
+    /**
+     * @brief Aloittaa ajastetun varmuuskopion, jos edellisestä on kulunut asetettu aika
+     */
+    void tarkastaAjastettuVarmuuskopio();
+    void varmuuskopioValmis();
+
 
 protected:
     void mousePressEvent(QMouseEvent *event);
@@ -136,6 +157,12 @@ protected:
     QAction* uusiSelausAktio;
     QAction* uusiLaskuAktio;
 
+    Varmuuskopioija *varmuuskopioija_ = nullptr;
+    bool ajastettuVarmuuskopio_ = false;
+    bool sqliteVaroitettu_ = false;
+    QProgressBar *varmuuskopioPalkki_;
+    QTimer *varmuuskopioAjastin_;
+
 
 
 
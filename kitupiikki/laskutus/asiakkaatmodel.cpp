@@ -90,7 +90,7 @@ void AsiakkaatModel::paivita(bool toimittajat)
 
     beginResetModel();
     rivit_.clear();
-    QSqlQuery query( kysely );
+    MitattuKysely query( kysely );
 
     while( query.next())
     {
@@ -101,7 +101,9 @@ void AsiakkaatModel::paivita(bool toimittajat)
             continue;
 
         // Summien laskeminen eri kyselyllä
-        QString summakysely = QString("SELECT id, pvm, debetsnt, kreditsnt, erapvm, eraid, tili FROM vienti "
+        QString summakysely = QString("SELECT vienti.id, vienti.pvm, vienti.debetsnt, vienti.kreditsnt, erapvm, eraid, vienti.tili, "
+                                      "era.debetsnt - era.kreditsnt AS erasaldo "
+                                      "FROM vienti LEFT OUTER JOIN era ON vienti.eraid=era.id "
                                       "WHERE asiakas=\"%1\" and iban is ").arg(rivi.nimi.replace("\"","\\\""));
         if( toimittajat_)
             summakysely.append("not ");
@@ -112,17 +114,15 @@ void AsiakkaatModel::paivita(bool toimittajat)
         qlonglong avoimet = 0;
 
 
-        QSqlQuery summaquery( summakysely );
+        MitattuKysely summaquery( summakysely );
         while( summaquery.next())
         {
 
            qlonglong sentit = toimittajat_ ? summaquery.value("kreditsnt").toLongLong() - summaquery.value("debetsnt").toLongLong()  :  summaquery.value("debetsnt").toLongLong() - summaquery.value("kreditsnt").toLongLong();
            summa += sentit;
 
-           int eraId = summaquery.value("eraid").toInt();
-           TaseEra era( eraId );
-
-           qlonglong avoinsnt = toimittajat_ ? 0 - era.saldoSnt : era.saldoSnt;
+           qlonglong eraSaldo = summaquery.value("erasaldo").toLongLong();
+           qlonglong avoinsnt = toimittajat_ ? 0 - eraSaldo : eraSaldo;
            if( avoinsnt > sentit)
                avoinsnt = sentit;
 
@@ -732,7 +732,7 @@ bool LaskuModel::tallenna(Tili rahatili)
 
     // #123: Jos rahatilillä käytössä kohdennukset, tehdään kohdennus jos koko maksu samaa kohdennusta
     Kohdennus tasekohdennus;
-    if( rivit_.count() && rahatili.json()->luku("Kohdennukset"))
+    if( rivit_.count() && qAsConst(rahatili).json()->luku("Kohdennukset"))
         tasekohdennus = rivit_.first().kohdennus;
 
     foreach (LaskuRivi rivi, rivit_)
@@ -900,12 +900,12 @@ bool LaskuModel::tallenna(Tili rahatili)
 
     if( tyyppi() == HYVITYSLASKU )
     {
-        raharivi.json.set("Hyvityslasku", viittausLasku().viite.toULongLong());
+        raharivi.json.set("Hyvityslasku", viittausLasku().viite.toLongLong());
         raharivi.eraId = viittausLasku().eraId;        // EräId
     }
     else if( tyyppi() == MAKSUMUISTUTUS)
     {
-        raharivi.json.set("Maksumuistutus", viittausLasku().viite.toULongLong());
+        raharivi.json.set("Maksumuistutus", viittausLasku().viite.toLongLong());
         raharivi.eraId = viittausLasku().eraId;
     }
     else if( kirjausperuste() != KATEISLASKU)
@@ -119,7 +119,7 @@ void LaskunMaksuDialogi::kirjaa()
     rahaRivi.selite = selite;
     rahaRivi.tili = kp()->tilit()->tiliNumerolla( ui->tiliEdit->valittuTilinumero() );
 
-    if( rahaRivi.tili.json()->luku("Kohdennuksella"))
+    if( qAsConst(rahaRivi.tili).json()->luku("Kohdennuksella"))
         rahaRivi.kohdennus = kp()->kohdennukset()->kohdennus( index.data(LaskutModel::KohdennusIdRooli).toInt() );
 
     if( index.data(LaskutModel::KirjausPerusteRooli).toInt() == LaskuModel::MAKSUPERUSTE )
@@ -186,7 +186,7 @@ void LaskunMaksuDialogi::kirjaa()
         saatavaRivi.pvm = ui->pvmEdit->date();
         saatavaRivi.selite = selite;
 
-        if( saatavaRivi.tili.json()->luku("Kohdennuksella"))
+        if( qAsConst(saatavaRivi.tili).json()->luku("Kohdennuksella"))
             saatavaRivi.kohdennus = kp()->kohdennukset()->kohdennus( index.data(LaskutModel::KohdennusIdRooli).toInt() );
 
         ehdotus.lisaaVienti(saatavaRivi);
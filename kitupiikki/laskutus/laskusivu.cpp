@@ -85,7 +85,7 @@ LaskuSivu::LaskuSivu()
              this, &LaskuSivu::asiakasValintaMuuttuu);
     connect( mistaEdit_, &QDateEdit::dateChanged, this, &LaskuSivu::paivitaLaskulista);
     connect( mihinEdit_, &QDateEdit::dateChanged, this, &LaskuSivu::paivitaLaskulista);
-    connect( kp(), &Kirjanpito::kirjanpitoaMuokattu, this, &LaskuSivu::paivitaLaskulista);
+    connect( kp(), &Kirjanpito::kirjanpitoMuuttui, this, &LaskuSivu::kirjanpitoMuuttui);
     connect( laskuView_->selectionModel(), &QItemSelectionModel::selectionChanged,
              this, &LaskuSivu::laskuValintaMuuttuu);
 
@@ -166,6 +166,14 @@ void LaskuSivu::paivitaLaskulista()
     }
 }
 
+void LaskuSivu::kirjanpitoMuuttui(const KirjanpidonMuutos &muutos)
+{
+    // Piilossa oleva lista ladataan sivulle siirryttäessä, ja laskulistaan
+    // vaikuttavat vain laskujen ja tase-erien muutokset
+    if( isVisible() && muutos.koskeeLaskuja())
+        paivitaLaskulista();
+}
+
 void LaskuSivu::asiakasValintaMuuttuu()
 {
     laskuAsiakasProxy_->setFilterFixedString( asiakasView_->currentIndex().data(AsiakkaatModel::NimiRooli).toString() );
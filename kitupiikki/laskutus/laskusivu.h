@@ -24,6 +24,7 @@
   */
 
 #include "kitupiikkisivu.h"
+#include "db/kirjanpidonmuutos.h"
 
 class QTabBar;
 class QSplitter;
@@ -62,6 +63,7 @@ public slots:
     void paaTab(int indeksi);
     void paivitaAsiakasSuodatus();
     void paivitaLaskulista();
+    void kirjanpitoMuuttui(const KirjanpidonMuutos& muutos);
     void asiakasValintaMuuttuu();
     void laskuValintaMuuttuu();
 
@@ -196,27 +196,35 @@ void LaskutModel::lataaAvoimet()
 
 void LaskutModel::paivita(int valinta, QDate mista, QDate mihin)
 {
-    QString kysely = QString("SELECT vienti.id, pvm, tili, debetsnt, kreditsnt, eraid, viite, erapvm, vienti.json, tosite, asiakas, laskupvm, kohdennus, tyyppi, selite "
+    // Maksumuistutus on samassa erässä oleva vienti, jonka maksumuistutus-sarakkeessa on laskun viite.
+    // Viite on tekstiä ja maksumuistutus luku, joten viite muunnetaan luvuksi indeksin käyttämiseksi
+    QString kysely = QString("SELECT vienti.id, vienti.pvm, vienti.tili, vienti.debetsnt, vienti.kreditsnt, eraid, viite, erapvm, vienti.json, vienti.tosite, asiakas, laskupvm, kohdennus, tyyppi, selite, "
+                             "vienti.kirjausperuste, vienti.hyvityslasku, "
+                             "era.debetsnt - era.kreditsnt AS erasaldo, "
+                             "EXISTS (SELECT 1 FROM vienti AS muistutus WHERE muistutus.eraid=vienti.eraid "
+                             "AND muistutus.maksumuistutus=CAST(vienti.viite AS INTEGER)) AS muistutettu "
                              "FROM vienti LEFT OUTER JOIN tili ON vienti.tili=tili.id "
+                             "LEFT OUTER JOIN era ON vienti.eraid=era.id "
                              "WHERE ((viite IS NOT NULL AND iban IS NULL) OR (tyyppi='AO' and vienti.id=vienti.eraid)) ");
 
     if( mista.isValid() && mihin.isValid())
-        kysely.append( QString(" AND pvm BETWEEN '%1' AND '%2' ") .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)) );
+        kysely.append( QString(" AND vienti.pvm BETWEEN '%1' AND '%2' ") .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)) );
+
+    // Hyvityslaskuja ei näytetä avoimina saatika erääntyneinä
+    if( valinta != KAIKKI)
+        kysely.append(" AND era.debetsnt <> era.kreditsnt AND erapvm IS NOT NULL AND vienti.hyvityslasku IS NULL ");
+    if( valinta == ERAANTYNEET)
+        kysely.append( QString(" AND erapvm <= '%1' ").arg(kp()->paivamaara().toString(Qt::ISODate)));
 
     beginResetModel();
     laskut.clear();
-    QSqlQuery query( kysely );
+    MitattuKysely query( kysely );
 
     while( query.next())
     {
-        TaseEra era( query.value("eraid").toInt());
+        qlonglong eraSaldo = query.value("erasaldo").toLongLong();
         int vientiId = query.value("vienti.id").toInt();
 
-        if( valinta == AVOIMET && (!era.saldoSnt || !query.value("erapvm").toDate().isValid() ))
-            continue;
-        if( valinta == ERAANTYNEET && ( !era.saldoSnt || !query.value("erapvm").toDate().isValid() || query.value("erapvm").toDate() > kp()->paivamaara() ))
-            continue;
-
         JsonKentta json( query.value("vienti.json").toByteArray() );
 
         // Tämä lasku kelpaa ;)        
@@ -227,32 +235,20 @@ void LaskutModel::paivita(int valinta, QDate mista, QDate mihin)
         lasku.erapvm = query.value("erapvm").toDate();
         lasku.eraId = query.value("eraid").toInt();
         lasku.summaSnt = query.value("debetSnt").toInt() - query.value("kreditSnt").toInt();
-        lasku.avoinSnt = json.luku("Hyvityslasku") ? 0 : era.saldoSnt;        // Hyvityslaskuille avoinsnt näytetään nollaa
+        lasku.avoinSnt = query.value("hyvityslasku").isNull() ? eraSaldo : 0;        // Hyvityslaskuille avoinsnt näytetään nollaa
         lasku.asiakas = query.value("asiakas").toString();
         if( lasku.asiakas.isEmpty())
             lasku.asiakas = query.value("selite").toString();
         lasku.tosite = query.value("tosite").toInt();
 
-        lasku.kirjausperuste =  json.luku("Kirjausperuste");
+        lasku.kirjausperuste =  query.value("kirjausperuste").toInt();
         lasku.tiliid = query.value("tili").toInt();
         lasku.json = json;
         lasku.kohdennusId = query.value("kohdennus").toInt();
 
-        if( valinta != KAIKKI && !lasku.avoinSnt)
-            continue;   // Hyvityslaskuja ei näytetä avoimina saatika erääntyneinä
-
-        // Jos lasku on erääntynyt, selvitetään, onko siitä jo lähetetty maksumuistutus
+        // Onko erääntyneestä laskusta jo lähetetty maksumuistutus
         if( !lasku.viite.isEmpty() && lasku.erapvm < kp()->paivamaara())
-        {
-            QString muistutuskysymys = QString("SELECT json FROM vienti WHERE eraid=%1").arg(lasku.eraId);
-            QSqlQuery muistutuskysely(muistutuskysymys);
-            while( muistutuskysely.next())
-            {
-                JsonKentta muistutusJson( muistutuskysely.value("json").toByteArray() );
-                if( muistutusJson.str("Maksumuistutus")==lasku.viite)
-                    lasku.muistutettu = true;
-            }
-        }
+            lasku.muistutettu = query.value("muistutettu").toBool();
 
         laskut.append(lasku);
     }
@@ -319,13 +315,13 @@ QString LaskutModel::bicIbanilla(const QString &iban)
 
 void AvoinLasku::haeLasku(int vientiid)
 {
-    QString kysely = QString("SELECT pvm, tili, debetsnt, kreditsnt, eraid, viite, erapvm, json, tosite, asiakas, laskupvm, kohdennus, selite "
-                             "FROM vienti WHERE id=%1").arg(vientiid);
+    QString kysely = QString("SELECT vienti.pvm, vienti.tili, vienti.debetsnt, vienti.kreditsnt, eraid, viite, erapvm, json, vienti.tosite, asiakas, laskupvm, kohdennus, selite, "
+                             "vienti.kirjausperuste, era.debetsnt - era.kreditsnt AS erasaldo "
+                             "FROM vienti LEFT OUTER JOIN era ON vienti.eraid=era.id WHERE vienti.id=%1").arg(vientiid);
     QSqlQuery query( kysely );
 
     if( query.next())
     {
-        TaseEra era( query.value("eraid").toInt());
         json.fromJson( query.value("vienti.json").toByteArray() );
 
         vientiId = vientiid;
@@ -334,10 +330,10 @@ void AvoinLasku::haeLasku(int vientiid)
         eraId = query.value("eraid").toInt();
         erapvm = query.value("erapvm").toDate();
         summaSnt = query.value("debetSnt").toInt() - query.value("kreditSnt").toInt();
-        avoinSnt =  vientiId == eraId ? era.saldoSnt : 0; ;
+        avoinSnt =  vientiId == eraId ? query.value("erasaldo").toLongLong() : 0;
         asiakas = query.value("asiakas").toString();
         tosite = query.value("tosite").toInt();
-        kirjausperuste = json.luku("Kirjausperuste");
+        kirjausperuste = query.value("kirjausperuste").toInt();
         tiliid = query.value("tili").toInt();
         kohdennusId = query.value("kohdennus").toInt();
     }
@@ -51,12 +51,18 @@ void OstolaskutModel::lataaAvoimet()
 
 void OstolaskutModel::paivita(int valinta, QDate mista, QDate mihin)
 {
-    QString kysely = QString("SELECT vienti.id, pvm, tili, debetsnt, kreditsnt, eraid, viite, erapvm, vienti.json as json, tosite, asiakas, laskupvm, kohdennus, selite FROM vienti,tili "
-                     "WHERE vienti.tili=tili.id AND tili.tyyppi='BO' AND eraid=vienti.id ");
+    QString kysely = QString("SELECT vienti.id, vienti.pvm, vienti.tili, vienti.debetsnt, vienti.kreditsnt, eraid, viite, erapvm, vienti.json as json, vienti.tosite, asiakas, laskupvm, kohdennus, selite, "
+                     "vienti.kirjausperuste, era.debetsnt - era.kreditsnt AS erasaldo FROM vienti, tili, era "
+                     "WHERE vienti.tili=tili.id AND tili.tyyppi='BO' AND eraid=vienti.id AND era.id=vienti.id ");
 
 
     if( mista.isValid() && mihin.isValid())
-        kysely.append( QString(" AND pvm BETWEEN '%1' AND '%2' ") .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)) );
+        kysely.append( QString(" AND vienti.pvm BETWEEN '%1' AND '%2' ") .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)) );
+
+    if( valinta != KAIKKI)
+        kysely.append(" AND era.debetsnt <> era.kreditsnt ");
+    if( valinta == ERAANTYNEET)
+        kysely.append( QString(" AND (erapvm IS NULL OR erapvm <= '%1') ").arg(kp()->paivamaara().toString(Qt::ISODate)));
 
     beginResetModel();
     laskut.clear();
@@ -64,15 +70,9 @@ void OstolaskutModel::paivita(int valinta, QDate mista, QDate mihin)
 
     while( query.next())
     {
-        TaseEra era( query.value("eraid").toInt());
+        qlonglong eraSaldo = query.value("erasaldo").toLongLong();
 
         JsonKentta json( query.value("json").toByteArray() );
-        int vientiId = query.value("vienti.id").toInt();
-
-        if( valinta == AVOIMET && (!era.saldoSnt || era.eraId != vientiId))
-            continue;
-        if( valinta == ERAANTYNEET && ( !era.saldoSnt || query.value("erapvm").toDate() > kp()->paivamaara() ))
-            continue;
 
         // Tämä lasku kelpaa ;)
         AvoinLasku lasku;
@@ -81,7 +81,7 @@ void OstolaskutModel::paivita(int valinta, QDate mista, QDate mihin)
         lasku.erapvm = query.value("erapvm").toDate();
         lasku.eraId = query.value("eraid").toInt();
         lasku.summaSnt = query.value("kreditSnt").toInt() -  query.value("debetSnt").toInt();
-        lasku.avoinSnt = 0LL - era.saldoSnt;
+        lasku.avoinSnt = 0LL - eraSaldo;
 
         lasku.asiakas = query.value("asiakas").toString();
         if( lasku.asiakas.length())
@@ -89,7 +89,7 @@ void OstolaskutModel::paivita(int valinta, QDate mista, QDate mihin)
         lasku.asiakas.append( query.value("selite").toString());
 
         lasku.tosite = query.value("tosite").toInt();
-        lasku.kirjausperuste =  json.luku("Kirjausperuste");
+        lasku.kirjausperuste =  query.value("kirjausperuste").toInt();
         lasku.tiliid = query.value("tili").toInt();
         lasku.json = json;
         lasku.kohdennusId = query.value("kohdennus").toInt();
@@ -19,6 +19,7 @@
 #include "ui_yhteystiedot.h"
 #include "validator/ytunnusvalidator.h"
 #include "db/jsonkentta.h"
+#include "db/vientimodel.h"
 
 #include <QSqlQuery>
 
@@ -104,10 +105,10 @@ void YhteystietoWidget::tallenna()
 
 
     QSqlQuery kysely;
-    kysely.prepare("INSERT INTO vienti (vientirivi, asiakas, json, luotu, muokattu) "
-                   "VALUES (0, :asiakas, :json, :luotu, :muokattu)");
+    kysely.prepare("INSERT INTO vienti (vientirivi, asiakas, json, kirjausperuste, hyvityslasku, maksumuistutus, luotu, muokattu) "
+                   "VALUES (0, :asiakas, :json, :kirjausperuste, :hyvityslasku, :maksumuistutus, :luotu, :muokattu)");
     kysely.bindValue(":asiakas", nimi_);
-    kysely.bindValue(":json", json.toSqlJson());
+    VientiModel::sidoJson(kysely, json);
     kysely.bindValue(":luotu", QDateTime::currentDateTime());
     kysely.bindValue(":muokattu", QDateTime::currentDateTime());
 
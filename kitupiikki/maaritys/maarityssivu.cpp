@@ -37,6 +37,7 @@
 #include "tuontimaarityswidget.h"
 #include "tilikarttaohje.h"
 #include "inboxmaaritys.h"
+#include "varmuuskopiomaaritys.h"
 #include "finvoicemaaritys.h"
 
 #include "ktpvienti/ktpvienti.h"
@@ -61,6 +62,7 @@ MaaritysSivu::MaaritysSivu() :
     lisaaSivu("Verkkolasku", VERKKOLASKU, QIcon(":/pic/verkkolasku.png"));
     lisaaSivu("Tuonti", TUONTI, QIcon(":/pic/tuotiedosto.png"));
     lisaaSivu("Kirjattavien kansio", INBOX, QIcon(":/pic/inbox.png"));
+    lisaaSivu("Varmuuskopiointi", VARMUUSKOPIO, QIcon(":/pic/talleta.png"));
     lisaaSivu("Raportit", RAPORTIT, QIcon(":/pic/print.png"));
     lisaaSivu("Tilinpäätöksen malli", LIITETIETOKAAVA, QIcon(":/pic/tekstisivu.png"));
     lisaaSivu("Tilikartan ohje", TILIKARTTAOHJE, QIcon(":/pic/ohje.png"));
@@ -215,6 +217,8 @@ void MaaritysSivu::valitseSivu(QListWidgetItem *item)
         nykyinen = new TilikarttaOhje;
     else if(sivu == INBOX)
         nykyinen = new InboxMaaritys;
+    else if(sivu == VARMUUSKOPIO)
+        nykyinen = new VarmuuskopioMaaritys;
     else if( sivu == VERKKOLASKU)
         nykyinen = new FinvoiceMaaritys;
     else
@@ -58,7 +58,8 @@ public:
         INBOX,
         RAPORTIT,
         LIITETIETOKAAVA,
-        TILIKARTTAOHJE
+        TILIKARTTAOHJE,
+        VARMUUSKOPIO
 
     };
 
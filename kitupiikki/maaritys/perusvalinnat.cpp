@@ -55,6 +55,8 @@ Perusvalinnat::Perusvalinnat() :
     connect( ui->avaaArkistoNappi, &QPushButton::clicked, [] { kp()->avaaUrl( kp()->arkistopolku() ); } );    
     connect( ui->poistaLogoNappi, &QPushButton::clicked, [this] { poistalogo=true; ui->logoLabel->clear(); ilmoitaMuokattu(); });
     connect( ui->eipdfCheck, SIGNAL(toggled(bool)), this, SLOT(ilmoitaMuokattu()));
+    connect( ui->walCheck, SIGNAL(toggled(bool)), this, SLOT(ilmoitaMuokattu()));
+    connect( ui->cborCheck, SIGNAL(toggled(bool)), this, SLOT(ilmoitaMuokattu()));
     connect( ui->pienennaJpg, SIGNAL(toggled(bool)), this, SLOT(ilmoitaMuokattu()));
 
     ui->ytunnusEdit->setValidator(new YTunnusValidator());
@@ -107,6 +109,8 @@ bool Perusvalinnat::nollaa()
 
     ui->paivitysCheck->setChecked( kp()->settings()->value("NaytaPaivitykset", true).toBool() );
     ui->eipdfCheck->setChecked(kp()->settings()->value("PopplerPois", false).toBool());
+    ui->walCheck->setChecked( kp()->settings()->value("SqliteWal", false).toBool());
+    ui->cborCheck->setChecked( kp()->asetukset()->onko("JsonCbor"));
     ui->pienennaJpg->setChecked( !kp()->asetukset()->onko("SailytaJpgKoko"));
 
     uusilogo = QImage();
@@ -163,6 +167,8 @@ bool Perusvalinnat::onkoMuokattu()
             ui->sahkopostiEdit->text() != kp()->asetukset()->asetus("Sahkoposti") ||
             ui->paivitysCheck->isChecked() != kp()->settings()->value("NaytaPaivitykset",true).toBool() ||
             ui->eipdfCheck->isChecked() != kp()->settings()->value("PopplerPois",true).toBool() ||
+            ui->walCheck->isChecked() != kp()->settings()->value("SqliteWal",false).toBool() ||
+            ui->cborCheck->isChecked() != kp()->asetukset()->onko("JsonCbor") ||
             ui->logossaNimiBox->isChecked() != kp()->asetukset()->onko("LogossaNimi") ||
             poistalogo ||
             ( ui->muotoCombo->currentText() != kp()->asetukset()->asetus("Muoto")) ||
@@ -174,6 +180,7 @@ bool Perusvalinnat::tallenna()
 
     kp()->settings()->setValue("NaytaPaivitykset", ui->paivitysCheck->isChecked());
     kp()->settings()->setValue("PopplerPois", ui->eipdfCheck->isChecked());
+    kp()->settings()->setValue("SqliteWal", ui->walCheck->isChecked());
 
     kp()->asetukset()->aseta("Nimi", ui->organisaatioEdit->text());
     kp()->asetukset()->aseta("Ytunnus", ui->ytunnusEdit->text());
@@ -185,6 +192,8 @@ bool Perusvalinnat::tallenna()
     kp()->asetukset()->aseta("Sahkoposti", ui->sahkopostiEdit->text());
     kp()->asetukset()->aseta("LogossaNimi", ui->logossaNimiBox->isChecked());
     kp()->asetukset()->aseta("SailytaJpgKoko", !ui->pienennaJpg->isChecked());
+    kp()->asetukset()->aseta("JsonCbor", ui->cborCheck->isChecked());
+    JsonKentta::asetaBinaarimuoto( ui->cborCheck->isChecked() );
 
     if( poistalogo )
     {
@@ -20,6 +20,7 @@
 #include <QLineEdit>
 #include <QCheckBox>
 #include <QRadioButton>
+#include <QSpinBox>
 
 TallentavaMaaritysWidget::TallentavaMaaritysWidget(QWidget *parent)
     : MaaritysWidget (parent)
@@ -50,6 +51,12 @@ bool TallentavaMaaritysWidget::nollaa()
             radio->setChecked( kp()->asetukset()->onko(asetustunnus) );
             continue;
         }
+        QSpinBox *spin = qobject_cast<QSpinBox*>(widget);
+        if( spin )
+        {
+            spin->setValue( kp()->asetukset()->luku(asetustunnus) );
+            continue;
+        }
     }
     return true;
 }
@@ -80,6 +87,13 @@ bool TallentavaMaaritysWidget::tallenna()
             continue;
         }
 
+        QSpinBox *spin = qobject_cast<QSpinBox*>( widget );
+        if( spin )
+        {
+            kp()->asetukset()->aseta(asetustunnus, spin->value());
+            continue;
+        }
+
     }
     return true;
 }
@@ -104,6 +118,11 @@ bool TallentavaMaaritysWidget::onkoMuokattu()
           if( kp()->asetukset()->onko(asetustunnus) != radio->isChecked())
               return true;
 
+        QSpinBox *spin = qobject_cast<QSpinBox*>(widget);
+        if( spin )
+            if( kp()->asetukset()->luku(asetustunnus) != spin->value())
+                return true;
+
     }
     return false;
 }
@@ -130,4 +149,8 @@ void TallentavaMaaritysWidget::rekisteroi(QWidget *widget, const QString &asetus
     if( radio )
         connect(radio, &QRadioButton::toggled, this, &TallentavaMaaritysWidget::ilmoitaMuokattu);
 
+    QSpinBox *spin = qobject_cast<QSpinBox*>(widget);
+    if( spin )
+        connect(spin, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &TallentavaMaaritysWidget::ilmoitaMuokattu);
+
 }
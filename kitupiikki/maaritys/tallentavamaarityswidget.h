@@ -27,7 +27,7 @@
  * Perityn widgetin rakentajassa käytettävät komponentit rekisteröidään
  * käytetyille asetusten tunnuksille rekisteroi-metodilla
  *
- * Tuetut widgetit: QLineEdit
+ * Tuetut widgetit: QLineEdit, QCheckBox, QRadioButton, QSpinBox
  *
  */
 class TallentavaMaaritysWidget : public MaaritysWidget
@@ -276,6 +276,11 @@ bool TilinavausModel::tallenna()
     }
     kp()->asetukset()->aseta("Tilinavaus",1);   // Tilit merkitään avatuiksi
 
+    // Avaussaldot vaikuttavat kaikkien kausien taseisiin
+    KirjanpidonMuutos muutos;
+    muutos.lisaaPaiva(avauspaiva);
+    kp()->ilmoitaMuutos(muutos);
+
     muokattu_ = false;
     return true;
 }
@@ -0,0 +1,51 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "varmuuskopiomaaritys.h"
+#include "ui_varmuuskopiomaaritys.h"
+#include "db/kirjanpito.h"
+
+#include <QFileDialog>
+
+VarmuuskopioMaaritys::VarmuuskopioMaaritys() :
+    ui_(new Ui::VarmuuskopioMaaritys)
+{
+    ui_->setupUi(this);
+    rekisteroi( ui_->kansioEdit, "VarmuuskopioKansio");
+    rekisteroi( ui_->valiSpin, "VarmuuskopioVali");
+    rekisteroi( ui_->maaraSpin, "VarmuuskopioMaara");
+    connect( ui_->valitseNappi, &QPushButton::clicked, this, &VarmuuskopioMaaritys::valitseKansio);
+}
+
+VarmuuskopioMaaritys::~VarmuuskopioMaaritys()
+{
+    delete ui_;
+}
+
+bool VarmuuskopioMaaritys::tallenna()
+{
+    TallentavaMaaritysWidget::tallenna();
+    emit kp()->varmuuskopiointiMuuttui();
+    return true;
+}
+
+void VarmuuskopioMaaritys::valitseKansio()
+{
+    QString kansio = QFileDialog::getExistingDirectory(this, tr("Valitse varmuuskopioiden kansio"),
+                                                       QDir::homePath());
+    if( !kansio.isEmpty())
+        ui_->kansioEdit->setText(kansio);
+}
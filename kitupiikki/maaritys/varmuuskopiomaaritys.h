@@ -0,0 +1,44 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VARMUUSKOPIOMAARITYS_H
+#define VARMUUSKOPIOMAARITYS_H
+
+#include "tallentavamaarityswidget.h"
+
+namespace Ui {
+    class VarmuuskopioMaaritys;
+}
+
+/**
+ * @brief Ajastetun varmuuskopioinnin kansio, väli ja säilytettävien määrä
+ */
+class VarmuuskopioMaaritys : public TallentavaMaaritysWidget
+{
+public:
+    VarmuuskopioMaaritys();
+    ~VarmuuskopioMaaritys() override;
+
+    bool tallenna() override;
+
+public slots:
+    void valitseKansio();
+
+private:
+    Ui::VarmuuskopioMaaritys *ui_;
+};
+
+#endif // VARMUUSKOPIOMAARITYS_H
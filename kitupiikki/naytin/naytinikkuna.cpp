@@ -80,11 +80,11 @@ void NaytinIkkuna::naytaTiedosto(const QString &tiedostonnimi)
 
 void NaytinIkkuna::naytaLiite(const int tositeId, const int liiteId)
 {
-    QSqlQuery kysely( QString("SELECT data FROM liite WHERE tosite=%1 AND liiteno=%2")
-                      .arg(tositeId).arg(liiteId));
+    QSqlQuery kysely( QString("SELECT data, sha FROM %3 WHERE tosite=%1 AND liiteno=%2")
+                      .arg(tositeId).arg(liiteId).arg( kp()->osiot()->taulu("liite") ));
     if( kysely.next() )
     {
-        QByteArray data = kysely.value("data").toByteArray();
+        QByteArray data = kp()->liitevarasto()->sisalto( kysely.value("data"), kysely.value("sha").toByteArray() );
         nayta(data);
     }
     else
@@ -70,11 +70,13 @@ RaportinKirjoittaja AlvErittely::kirjoitaRaporti(QDate alkupvm, QDate loppupvm)
 
     QSqlQuery kysely;
     QString kysymys = QString("select vienti.pvm as paiva, debetsnt, kreditsnt, selite, alvkoodi, alvprosentti, nro, tunniste, laji "
-                              "from vienti,tili,tosite where vienti.tosite=tosite.id and vienti.tili=tili.id "
+                              "from %3,tili,%4 where vienti.tosite=tosite.id and vienti.tili=tili.id "
                               "and vienti.pvm between \"%1\" and \"%2\" "
                               "and alvkoodi > 0 order by alvkoodi, alvprosentti desc, tili, vienti.pvm")
             .arg(alkupvm.toString(Qt::ISODate))
-            .arg(loppupvm.toString(Qt::ISODate));
+            .arg(loppupvm.toString(Qt::ISODate))
+            .arg(kp()->osiot()->taulu("vienti", alkupvm, loppupvm))
+            .arg(kp()->osiot()->taulu("tosite", alkupvm, loppupvm));
 
     int nAlvkoodi = -1; // edellisten alv-prosentti jne...
     int nTili = -1;
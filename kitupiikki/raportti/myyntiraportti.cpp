@@ -75,16 +75,17 @@ RaportinKirjoittaja MyyntiRaportti::kirjoitaRaportti(QDate mista, QDate mihin, b
     QMap<QString,qlonglong> bruttoSnt;
 
     QSqlQuery kysely;
-    kysely.exec(QString("SELECT json from vienti where viite is not null and pvm between '%1' and '%2'")
-                .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)));
+    kysely.exec(QString("SELECT json from %3 where viite is not null and iban is null and json is not null and pvm between '%1' and '%2'")
+                .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate))
+                .arg(kp()->osiot()->taulu("vienti", mista, mihin)));
 
     while( kysely.next())
     {
-        QJsonDocument json = QJsonDocument::fromJson( kysely.value(0).toByteArray() );
-        QVariantMap vmap = json.toVariant().toMap();
-        if( vmap.contains("Laskurivit"))
+        JsonKentta json( kysely.value(0).toByteArray() );
+        QVariant laskurivit = json.variant("Laskurivit");
+        if( laskurivit.isValid())
         {
-            for( const QVariant& var : vmap.value("Laskurivit").toList())
+            for( const QVariant& var : laskurivit.toList())
             {
                 QString nimike = var.toMap().value("Nimike").toString();
 
@@ -21,6 +21,7 @@
 
 #include "db/kirjanpito.h"
 #include "db/tilikausi.h"
+#include "db/saldotaulu.h"
 
 #include "raportinkirjoittaja.h"
 
@@ -119,22 +120,32 @@ RaportinKirjoittaja PaakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihin,
     QString kysymys;
     QSqlQuery kysely;
 
+    // Päätettyjen kausien osiot: kohdennuksen alkusaldoihin tarvitaan koko
+    // historia, muuten riittää tilikauden alusta raportin loppuun
+    QString historia = kp()->osiot()->taulu("vienti", QDate(), mihin);
+    QString historianMerkkaukset = kp()->osiot()->taulu("merkkaus", QDate(), mihin);
+    QString viennit = kp()->osiot()->taulu("vienti", tilikausi.alkaa(), mihin);
+    QString merkkaukset = kp()->osiot()->taulu("merkkaus", tilikausi.alkaa(), mihin);
+    QString nakyma = kp()->osiot()->taulu("vientivw", mista, mihin);
+
     // 1) Tasetilit
     if( kohdennuksella > -1)
     {
         if( kohdennus.tyyppi() == Kohdennus::MERKKAUS)
             kysymys = QString("SELECT ysiluku, tyyppi, SUM(debetsnt), SUM(kreditsnt) "
-                                 "FROM vienti, tili, merkkaus WHERE vienti.tili=tili.id AND tili.ysiluku < 300000000 AND "
-                                 "pvm < \"%1\" AND vienti.id=merkkaus.vienti AND merkkaus.kohdennus=%2 GROUP BY nro").arg(mista.toString(Qt::ISODate)).arg(kohdennuksella);
+                                 "FROM %3, tili, %4 WHERE vienti.tili=tili.id AND tili.ysiluku < 300000000 AND "
+                                 "pvm < \"%1\" AND vienti.id=merkkaus.vienti AND merkkaus.kohdennus=%2 GROUP BY nro").arg(mista.toString(Qt::ISODate)).arg(kohdennuksella)
+                                 .arg(historia).arg(historianMerkkaukset);
         else
             kysymys = QString("SELECT ysiluku, tyyppi, SUM(debetsnt), SUM(kreditsnt) "
-                                 "FROM vienti, tili WHERE vienti.tili=tili.id AND tili.ysiluku < 300000000 AND "
-                                 "pvm < \"%1\" AND vienti.kohdennus=%2 GROUP BY nro").arg(mista.toString(Qt::ISODate)).arg(kohdennuksella);
+                                 "FROM %3, tili WHERE vienti.tili=tili.id AND tili.ysiluku < 300000000 AND "
+                                 "pvm < \"%1\" AND vienti.kohdennus=%2 GROUP BY nro").arg(mista.toString(Qt::ISODate)).arg(kohdennuksella)
+                                 .arg(historia);
     }
     else
         kysymys = QString("SELECT ysiluku, tyyppi, SUM(debetsnt), SUM(kreditsnt) "
-                             "FROM vienti, tili WHERE vienti.tili=tili.id AND tili.ysiluku < 300000000 AND "
-                             "pvm < \"%1\" GROUP BY nro").arg(mista.toString(Qt::ISODate));
+                             "FROM %1, tili WHERE saldo.tili=tili.id AND tili.ysiluku < 300000000 "
+                             "GROUP BY nro").arg( SaldoTaulu::kertyma(mista.addDays(-1)));
 
     kysely.exec(kysymys);
     while( kysely.next())
@@ -153,9 +164,9 @@ RaportinKirjoittaja PaakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihin,
     // Lisätään aiempien tilikausien tulos (ei kuitenkaan kohdennusotteelle)
     if( kohdennuksella < 0)
     {
-        kysymys = QString("SELECT sum(debetsnt), sum(kreditsnt) FROM vienti, tili "
-                          "WHERE vienti.tili=tili.id AND ysiluku > 300000000 AND "
-                          "pvm < \"%1\" ").arg(tilikausi.alkaa().toString(Qt::ISODate));
+        kysymys = QString("SELECT sum(debetsnt), sum(kreditsnt) FROM %1, tili "
+                          "WHERE saldo.tili=tili.id AND ysiluku > 300000000")
+                .arg( SaldoTaulu::kertyma(tilikausi.alkaa().addDays(-1)));
         kysely.exec( kysymys );
         if( kysely.next())
         {
@@ -174,22 +185,24 @@ RaportinKirjoittaja PaakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihin,
     {
         if( kohdennuksella > -1 && kohdennus.tyyppi() == Kohdennus::MERKKAUS)
             kysymys = QString("SELECT ysiluku, SUM(debetsnt), SUM(kreditsnt) "
-                                     "FROM merkkaus,vienti, tili WHERE merkkaus.kohdennus=%3 AND merkkaus.vienti=vienti.id AND "
+                                     "FROM %4,%5, tili WHERE merkkaus.kohdennus=%3 AND merkkaus.vienti=vienti.id AND "
                                      "vienti.tili=tili.id AND tili.ysiluku > 300000000 AND "
                                      "pvm BETWEEN \"%1\" AND \"%2\" GROUP BY nro")
                     .arg(alkupaiva.toString(Qt::ISODate))
                     .arg(mista.addDays(-1).toString(Qt::ISODate))
-                    .arg(kohdennuksella);
+                    .arg(kohdennuksella)
+                    .arg(merkkaukset).arg(viennit);
         else if( kohdennuksella > -1)
             kysymys = QString("SELECT ysiluku, SUM(debetsnt), SUM(kreditsnt) "
-                                     "FROM vienti, tili WHERE vienti.tili=tili.id AND tili.ysiluku > 300000000 AND "
+                                     "FROM %4, tili WHERE vienti.tili=tili.id AND tili.ysiluku > 300000000 AND "
                                      "pvm BETWEEN \"%1\" AND \"%2\" AND vienti.kohdennus=%3 GROUP BY nro")
                     .arg(alkupaiva.toString(Qt::ISODate))
                     .arg(mista.addDays(-1).toString(Qt::ISODate))
-                    .arg(kohdennuksella);
+                    .arg(kohdennuksella)
+                    .arg(viennit);
         else
             kysymys = QString("SELECT ysiluku, SUM(debetsnt), SUM(kreditsnt) "
-                                     "FROM vienti, tili WHERE vienti.tili=tili.id AND tili.ysiluku > 300000000 AND "
+                                     "FROM saldo, tili WHERE saldo.tili=tili.id AND tili.ysiluku > 300000000 AND "
                                      "pvm BETWEEN \"%1\" AND \"%2\" GROUP BY nro")
                     .arg(alkupaiva.toString(Qt::ISODate))
                     .arg(mista.addDays(-1).toString(Qt::ISODate));
@@ -207,18 +220,21 @@ RaportinKirjoittaja PaakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihin,
 
     // Varmistetaan, että kaikilla tämän tilikauden tileillä on tietue
     if( kohdennuksella > -1 && kohdennus.tyyppi() == Kohdennus::MERKKAUS)
-        kysymys = QString("SELECT ysiluku FROM merkkaus,vienti, tili WHERE "
+        kysymys = QString("SELECT ysiluku FROM %4,%5, tili WHERE "
                           "merkkaus.kohdennus=%3 AND merkkaus.vienti=vienti.id AND vienti.tili = tili.id AND "
                           "pvm BETWEEN \"%1\" AND \"%2\" GROUP BY nro")
-                .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)).arg(kohdennuksella);
+                .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)).arg(kohdennuksella)
+                .arg(merkkaukset).arg(viennit);
     else if( kohdennuksella > -1)
-        kysymys = QString("SELECT ysiluku FROM vienti, tili WHERE vienti.tili = tili.id AND "
+        kysymys = QString("SELECT ysiluku FROM %4, tili WHERE vienti.tili = tili.id AND "
                           "pvm BETWEEN \"%1\" AND \"%2\" AND vienti.kohdennus=%3 GROUP BY nro")
-                .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)).arg(kohdennuksella);
+                .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)).arg(kohdennuksella)
+                .arg(viennit);
     else
-        kysymys = QString("SELECT ysiluku FROM vienti, tili WHERE vienti.tili = tili.id AND "
+        kysymys = QString("SELECT ysiluku FROM %3, tili WHERE vienti.tili = tili.id AND "
                       "pvm BETWEEN \"%1\" AND \"%2\" GROUP BY nro")
-                .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate));
+                .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate))
+                .arg(viennit);
 
     kysely.exec(kysymys);
     while( kysely.next() )
@@ -257,22 +273,25 @@ RaportinKirjoittaja PaakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihin,
 
         if( kohdennuksella > -1 && kohdennus.tyyppi() == Kohdennus::MERKKAUS)
             kysymys = QString("SELECT pvm, tositelaji, tunniste, kohdennusId, tositeId, "
-                                      "vientivw.kohdennus as kohdennusnimi, selite, debetsnt, kreditsnt FROM merkkaus, vientivw "
+                                      "vientivw.kohdennus as kohdennusnimi, selite, debetsnt, kreditsnt FROM %5, %6 "
                                       "WHERE merkkaus.kohdennus=%4 AND merkkaus.vienti=vientiId AND tilinro=%1 AND pvm BETWEEN \"%2\" AND \"%3\" "
                                       "ORDER BY pvm, vientiId ")
-                    .arg(tili.numero()).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)).arg(kohdennuksella);
+                    .arg(tili.numero()).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)).arg(kohdennuksella)
+                    .arg(merkkaukset).arg(nakyma);
         else if( kohdennuksella > -1)
             kysymys = QString("SELECT pvm, tositelaji, tunniste, kohdennusId, tositeId, "
-                                      "kohdennus as kohdennusnimi, selite, debetsnt, kreditsnt FROM vientivw "
+                                      "kohdennus as kohdennusnimi, selite, debetsnt, kreditsnt FROM %5 "
                                       "WHERE tilinro=%1 AND pvm BETWEEN \"%2\" AND \"%3\" AND kohdennusId=%4 "
                                       "ORDER BY pvm, vientiId ")
-                    .arg(tili.numero()).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)).arg(kohdennuksella);
+                    .arg(tili.numero()).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)).arg(kohdennuksella)
+                    .arg(nakyma);
         else
             kysymys = QString("SELECT pvm, tositelaji, tunniste, kohdennusId, tositeId, "
-                                      "kohdennus as kohdennusnimi, selite, debetsnt, kreditsnt FROM vientivw "
+                                      "kohdennus as kohdennusnimi, selite, debetsnt, kreditsnt FROM %4 "
                                       "WHERE tilinro=%1 AND pvm BETWEEN \"%2\" AND \"%3\" "
                                       "ORDER BY pvm, vientiId ")
-                    .arg(tili.numero()).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate));
+                    .arg(tili.numero()).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate))
+                    .arg(nakyma);
 
 
         kysely.exec(kysymys);
@@ -355,7 +374,8 @@ RaportinKirjoittaja PaakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihin,
 
 void PaakirjaRaportti::haeTilitComboon()
 {
-    QString kysymys = QString(R"(SELECT DISTINCT tili FROM vienti WHERE pvm BETWEEN "%1" AND "%2")").arg(ui->alkupvm->date().toString(Qt::ISODate)).arg(ui->loppupvm->date().toString(Qt::ISODate));
+    QString kysymys = QString(R"(SELECT DISTINCT tili FROM %3 WHERE pvm BETWEEN "%1" AND "%2")").arg(ui->alkupvm->date().toString(Qt::ISODate)).arg(ui->loppupvm->date().toString(Qt::ISODate))
+            .arg( kp()->osiot()->taulu("vienti", ui->alkupvm->date(), ui->loppupvm->date()));
     QSqlQuery kysely(kysymys);
     ui->tiliCombo->clear();
 
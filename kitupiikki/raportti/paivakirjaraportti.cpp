@@ -140,6 +140,11 @@ RaportinKirjoittaja PaivakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihi
     else if( ryhmitalajeittain )
         jarjestys = " tositelajiId, vienti.pvm, vientiId";
 
+    // Päätettyjen kausien osiot, jotka osuvat raportin ajalle
+    QString viennit = kp()->osiot()->taulu("vienti", mista, mihin);
+    QString tositteet = kp()->osiot()->taulu("tosite", mista, mihin);
+    QString merkkaukset = kp()->osiot()->taulu("merkkaus", mista, mihin);
+
     QString kysymys;
 
 
@@ -150,23 +155,26 @@ RaportinKirjoittaja PaivakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihi
 
 
         if( kp()->kohdennukset()->kohdennus(kohdennuksella).tyyppi() == Kohdennus::MERKKAUS)
-            kysymys.append( QString(" FROM merkkaus, vienti, tosite WHERE merkkaus.kohdennus=%4 AND vienti.pvm BETWEEN '%1' AND '%2' AND vienti.tosite=tosite.id ORDER BY %3")
+            kysymys.append( QString(" FROM %5, %6, %7 WHERE merkkaus.kohdennus=%4 AND vienti.pvm BETWEEN '%1' AND '%2' AND vienti.tosite=tosite.id ORDER BY %3")
                               .arg(mista.toString(Qt::ISODate) )
                               .arg( mihin.toString(Qt::ISODate))
-                              .arg(jarjestys).arg(kohdennuksella));
+                              .arg(jarjestys).arg(kohdennuksella)
+                              .arg(merkkaukset).arg(viennit).arg(tositteet));
         else
-            kysymys.append(QString("FROM vienti,tosite "
+            kysymys.append(QString("FROM %5,%6 "
                               "WHERE vienti.pvm BETWEEN \"%1\" AND \"%2\" AND vienti.tosite=tosite.id AND kohdennus=%4 ORDER BY %3")
                               .arg(mista.toString(Qt::ISODate) )
                               .arg( mihin.toString(Qt::ISODate))
-                              .arg(jarjestys).arg(kohdennuksella));
+                              .arg(jarjestys).arg(kohdennuksella)
+                              .arg(viennit).arg(tositteet));
     }
     else
-        kysymys.append(QString("FROM vienti, tosite "
+        kysymys.append(QString("FROM %4, %5 "
                               "WHERE vienti.pvm BETWEEN \"%1\" AND \"%2\" AND vienti.tosite=tosite.id ORDER BY %3")
                               .arg(mista.toString(Qt::ISODate) )
                               .arg( mihin.toString(Qt::ISODate))
-                              .arg(jarjestys));
+                              .arg(jarjestys)
+                              .arg(viennit).arg(tositteet));
 
     qDebug() << kysymys;
 
@@ -213,13 +221,11 @@ RaportinKirjoittaja PaivakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihi
 
         Tositelaji laji = kp()->tositelajit()->tositelaji( kysely.value("tositelajiId").toInt() );
 
-        rivi.lisaaLinkilla( RaporttiRiviSarake::TOSITE_ID, kysely.value("tositeId").toInt() ,
-                          QString("%1%2/%3").arg( laji.tunnus() ).arg(kysely.value("tunniste").toInt())
-                          .arg( kp()->tilikaudet()->tilikausiPaivalle(pvm).kausitunnus() ));
+        QString tositetunniste = laji.tunnus() + QString::number( kysely.value("tunniste").toInt())
+                + QChar('/') + kp()->tilikaudet()->kausitunnusPaivalle(pvm);
 
-        csvRivi.lisaaLinkilla( RaporttiRiviSarake::TOSITE_ID, kysely.value("tositeId").toInt() ,
-                          QString("%1%2/%3").arg( laji.tunnus() ).arg(kysely.value("tunniste").toInt())
-                          .arg( kp()->tilikaudet()->tilikausiPaivalle(pvm).kausitunnus() ));
+        rivi.lisaaLinkilla( RaporttiRiviSarake::TOSITE_ID, kysely.value("tositeId").toInt() , tositetunniste);
+        csvRivi.lisaaLinkilla( RaporttiRiviSarake::TOSITE_ID, kysely.value("tositeId").toInt() , tositetunniste);
 
         Tili tili = kp()->tilit()->tiliIdlla( kysely.value("tili").toInt() );
         if( !tili.onkoValidi())
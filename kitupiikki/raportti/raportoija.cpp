@@ -27,6 +27,7 @@
 
 #include "db/kirjanpito.h"
 #include "db/tilikausi.h"
+#include "db/saldotaulu.h"
 
 
 Raportoija::Raportoija(const QString &raportinNimi) :
@@ -551,7 +552,7 @@ void Raportoija::laskeTulosData()
         {
 
             QString kysymys = QString("SELECT ysiluku, sum(debetsnt), sum(kreditsnt) "
-                                      "from vienti,tili where vienti.tili = tili.id and ysiluku > 300000000 "
+                                      "from saldo,tili where saldo.tili = tili.id and ysiluku > 300000000 "
                                       "and pvm between \"%1\" and \"%2\" "
                                       "group by ysiluku").arg( alkuPaivat_.at(i).toString(Qt::ISODate)).arg(loppuPaivat_.at(i).toString(Qt::ISODate));
 
@@ -568,9 +569,8 @@ void Raportoija::laskeTaseDate()
     {
         // 1) Tasetilien summat
         QString kysymys = QString("SELECT ysiluku, sum(debetsnt), sum(kreditsnt) "
-                                  "from vienti,tili where vienti.tili = tili.id and ysiluku < 300000000 "
-                                  "and pvm <= \"%1\" "
-                                  "group by ysiluku").arg(loppuPaivat_.at(i).toString(Qt::ISODate));
+                                  "from %1,tili where saldo.tili = tili.id and ysiluku < 300000000 "
+                                  "group by ysiluku").arg( SaldoTaulu::kertyma(loppuPaivat_.at(i)));
         QSqlQuery query(kysymys);
         while (query.next())
         {
@@ -589,8 +589,8 @@ void Raportoija::laskeTaseDate()
         // 2)  Sijoitetaan "edellisten tilikausien alijäämä/ylijäämä" ko.tilille
         Tilikausi tilikausi = kp()->tilikaudet()->tilikausiPaivalle( loppuPaivat_.at(i) );
 
-        kysymys = QString("SELECT sum(debetsnt), sum(kreditsnt) FROM vienti, tili WHERE vienti.tili=tili.id "
-                          " AND ysiluku > 300000000 AND pvm < \"%1\" ").arg( tilikausi.alkaa().toString(Qt::ISODate));
+        kysymys = QString("SELECT sum(debetsnt), sum(kreditsnt) FROM %1, tili WHERE saldo.tili=tili.id "
+                          " AND ysiluku > 300000000").arg( SaldoTaulu::kertyma(tilikausi.alkaa().addDays(-1)));
         query.exec(kysymys);
         if( query.next())
         {
@@ -606,7 +606,7 @@ void Raportoija::laskeTaseDate()
         }
 
         // 3) Sijoitetaan tämän tilikauden tulos "tulostilille" 0 ja määritellylle tulostilille
-        kysymys = QString("SELECT sum(debetsnt), sum(kreditsnt) FROM vienti, tili WHERE vienti.tili=tili.id"
+        kysymys = QString("SELECT sum(debetsnt), sum(kreditsnt) FROM saldo, tili WHERE saldo.tili=tili.id"
                           " AND ysiluku > 300000000 AND pvm BETWEEN \"%1\" AND \"%2\"")
                 .arg( tilikausi.alkaa().toString(Qt::ISODate) ).arg( loppuPaivat_.at(i).toString(Qt::ISODate));
 
@@ -641,38 +641,44 @@ void Raportoija::laskeKohdennusData(int kohdennusId, bool poiminnassa)
 
         if( kohdennus.tyyppi() == Kohdennus::MERKKAUS)
             kysymys = QString("SELECT ysiluku, sum(debetsnt), sum(kreditsnt) "
-                                  "from merkkaus, vienti,tili where merkkaus.kohdennus=%3 "
+                                  "from %4, %5,tili where merkkaus.kohdennus=%3 "
                                   "AND merkkaus.vienti=vienti.id AND vienti.tili = tili.id and ysiluku > 300000000 "
                                   "and pvm between \"%1\" and \"%2\"  "
                                   "group by ysiluku")
                 .arg( alkuPaivat_.at(i).toString(Qt::ISODate))
                 .arg(loppuPaivat_.at(i).toString(Qt::ISODate))
-                .arg(kohdennusId);
+                .arg(kohdennusId)
+                .arg( kp()->osiot()->taulu("merkkaus", alkuPaivat_.at(i), loppuPaivat_.at(i)))
+                .arg( kp()->osiot()->taulu("vienti", alkuPaivat_.at(i), loppuPaivat_.at(i)));
         else
             kysymys = QString("SELECT ysiluku, sum(debetsnt), sum(kreditsnt) "
-                                  "from vienti,tili where vienti.tili = tili.id and ysiluku > 300000000 "
+                                  "from %4,tili where vienti.tili = tili.id and ysiluku > 300000000 "
                                   "and pvm between \"%1\" and \"%2\" and kohdennus=%3 "
                                   "group by ysiluku")
                 .arg( alkuPaivat_.at(i).toString(Qt::ISODate))
                 .arg(loppuPaivat_.at(i).toString(Qt::ISODate))
-                .arg(kohdennusId);
+                .arg(kohdennusId)
+                .arg( kp()->osiot()->taulu("vienti", alkuPaivat_.at(i), loppuPaivat_.at(i)));
 
         sijoitaTulosKyselyData(kysymys, i);
 
         // Tasetilien summat
         if( kohdennus.tyyppi() == Kohdennus::MERKKAUS)
             kysymys = QString("SELECT ysiluku, sum(debetsnt), sum(kreditsnt) "
-                                      "from merkkaus, vienti,tili where merkkaus.kohdennus=%2 AND "
+                                      "from %3, %4,tili where merkkaus.kohdennus=%2 AND "
                                       "merkkaus.vienti=vienti.id AND vienti.tili = tili.id and ysiluku < 300000000 "
                                       "and pvm <= \"%1\"  "
                                       "group by ysiluku").arg(loppuPaivat_.at(i).toString(Qt::ISODate))
-                                                         .arg(kohdennusId);
+                                                         .arg(kohdennusId)
+                                                         .arg( kp()->osiot()->taulu("merkkaus", QDate(), loppuPaivat_.at(i)))
+                                                         .arg( kp()->osiot()->taulu("vienti", QDate(), loppuPaivat_.at(i)));
 
         kysymys = QString("SELECT ysiluku, sum(debetsnt), sum(kreditsnt) "
-                                  "from vienti,tili where vienti.tili = tili.id and ysiluku < 300000000 "
+                                  "from %3,tili where vienti.tili = tili.id and ysiluku < 300000000 "
                                   "and pvm <= \"%1\" and kohdennus=%2 "
                                   "group by ysiluku").arg(loppuPaivat_.at(i).toString(Qt::ISODate))
-                                                     .arg(kohdennusId);
+                                                     .arg(kohdennusId)
+                                                     .arg( kp()->osiot()->taulu("vienti", QDate(), loppuPaivat_.at(i)));
         QSqlQuery query(kysymys);
         while (query.next())
         {
@@ -759,9 +765,10 @@ void Raportoija::etsiKohdennukset()
 {
     for( int i = 0; i < loppuPaivat_.count(); i++)
     {
-        QString kysymys = QString("SELECT kohdennus from vienti where pvm between \"%1\" and \"%2\" group by kohdennus")
+        QString kysymys = QString("SELECT kohdennus from %3 where pvm between \"%1\" and \"%2\" group by kohdennus")
                 .arg( alkuPaivat_.at(i).toString(Qt::ISODate))
-                .arg( loppuPaivat_.at(i).toString( Qt::ISODate));
+                .arg( loppuPaivat_.at(i).toString( Qt::ISODate))
+                .arg( kp()->osiot()->taulu("vienti", alkuPaivat_.at(i), loppuPaivat_.at(i)));
         QSqlQuery kysely(kysymys);
 
         while( kysely.next())
@@ -70,12 +70,17 @@ RaportinKirjoittaja TaseErittely::kirjoitaRaportti(QDate mista, QDate mihin)
         rk.lisaaRivi();
     }
 
+    // Päätettyjen tilikausien osiot mukaan sekä jakson että historian kyselyihin
+    QString viennit = kp()->osiot()->taulu("vienti", mista, mihin);
+    QString historia = kp()->osiot()->taulu("vienti", QDate(), mihin);
+    QString historianTositteet = kp()->osiot()->taulu("tosite", QDate(), mihin);
+
     // Haetaan tilit, joissa kirjauksia
     QSqlQuery kysely;
     QSet<QString> nroSet;
 
-    kysely.exec( QString("select DISTINCT tili.nro from tili,vienti where vienti.tili=tili.id and tili.ysiluku < 300000000 "
-                         "and pvm <= '%1' order by tili.ysiluku").arg(mihin.toString(Qt::ISODate)) );
+    kysely.exec( QString("select DISTINCT tili.nro from tili,%2 where vienti.tili=tili.id and tili.ysiluku < 300000000 "
+                         "and pvm <= '%1' order by tili.ysiluku").arg(mihin.toString(Qt::ISODate)).arg(historia) );
     while(kysely.next() )
         nroSet.insert( kysely.value(0).toString());
 
@@ -93,7 +98,7 @@ RaportinKirjoittaja TaseErittely::kirjoitaRaportti(QDate mista, QDate mihin)
 
     foreach (int tiliId, tiliIdt)
     {
-        Tili tili = kp()->tilit()->tiliIdlla(tiliId);
+        const Tili tili = kp()->tilit()->tiliIdlla(tiliId);
 
         // Ohitetaan tyhjät/tapahtumattomat tilit
         if( !tili.saldoPaivalle(mihin))
@@ -105,8 +110,9 @@ RaportinKirjoittaja TaseErittely::kirjoitaRaportti(QDate mista, QDate mihin)
             else
             {
                 // Jos täysi tai muutos-tapahtumaerittely, niin ohitetaan jos ei myöskään tapahtumia
-                QSqlQuery tapahtumakysely( QString("SELECT count(id) from vienti where tili=%1 and pvm between '%2' and '%3")
-                                           .arg(tiliId).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)));
+                QSqlQuery tapahtumakysely( QString("SELECT count(id) from %4 where tili=%1 and pvm between '%2' and '%3")
+                                           .arg(tiliId).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate))
+                                           .arg(viennit));
                 if( tapahtumakysely.next())
                     if(!tapahtumakysely.value(0).toInt())
                         continue;
@@ -194,9 +200,10 @@ RaportinKirjoittaja TaseErittely::kirjoitaRaportti(QDate mista, QDate mihin)
                 }
 
                 // Muutokset
-                kysely.exec(QString("SELECT tositelaji,tunniste,pvm,selite,debetsnt,kreditsnt,tositeId from vientivw where tilinro=%1 and "
+                kysely.exec(QString("SELECT tositelaji,tunniste,pvm,selite,debetsnt,kreditsnt,tositeId from %4 where tilinro=%1 and "
                             "pvm between \"%2\" and \"%3\" order by pvm")
-                            .arg(tili.numero()).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)) );
+                            .arg(tili.numero()).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate))
+                            .arg(kp()->osiot()->taulu("vientivw", mista, mihin)) );
 
                 while( kysely.next() )
                 {
@@ -245,9 +252,9 @@ RaportinKirjoittaja TaseErittely::kirjoitaRaportti(QDate mista, QDate mihin)
                 QHash<int,qlonglong> alkusaldot;
 
                 // Alkusaldot
-                kysely.exec(QString("SELECT eraid, sum(debetsnt) as debetit, sum(kreditsnt) as kreditit from vienti "
+                kysely.exec(QString("SELECT eraid, sum(debetsnt) as debetit, sum(kreditsnt) as kreditit from %3 "
                                    "where tili=%1 and eraid is not null and pvm < \"%2\" group by eraid")
-                           .arg(tili.id()).arg(mista.toString(Qt::ISODate)));
+                           .arg(tili.id()).arg(mista.toString(Qt::ISODate)).arg(historia));
 
 
                 // Tallennetaan saldotaulukkoon tilien eräsaldot
@@ -260,9 +267,9 @@ RaportinKirjoittaja TaseErittely::kirjoitaRaportti(QDate mista, QDate mihin)
                 }
 
                 // Sitten haetaan tase-erän tiedot
-                kysely.exec(QString("SELECT vienti.id, debetsnt, kreditsnt, vienti.pvm, selite, laji, tunniste from vienti, tosite "
+                kysely.exec(QString("SELECT vienti.id, debetsnt, kreditsnt, vienti.pvm, selite, laji, tunniste from %2, %3 "
                            "where tili=%1 and vienti.tosite=tosite.id and eraid=vienti.id order by vienti.pvm")
-                           .arg(tili.id()));
+                           .arg(tili.id()).arg(historia).arg(historianTositteet));
 
                 while( kysely.next())
                 {
@@ -281,10 +288,11 @@ RaportinKirjoittaja TaseErittely::kirjoitaRaportti(QDate mista, QDate mihin)
                     if( !saldo )
                     {
                         QSqlQuery takysely;
-                        takysely.exec( QString("SELECT count(id) FROM vienti WHERE eraid=%1 AND pvm BETWEEN '%2' AND '%3'")
+                        takysely.exec( QString("SELECT count(id) FROM %4 WHERE eraid=%1 AND pvm BETWEEN '%2' AND '%3'")
                                        .arg( eraId )
                                        .arg( mista.toString(Qt::ISODate) )
-                                       .arg( mihin.toString( Qt::ISODate)) );
+                                       .arg( mihin.toString( Qt::ISODate))
+                                       .arg( viennit ) );
                         qDebug() << takysely.lastQuery();
                         if( takysely.next() && !takysely.value(0).toInt())
                             continue;
@@ -326,9 +334,10 @@ RaportinKirjoittaja TaseErittely::kirjoitaRaportti(QDate mista, QDate mihin)
 
                     // Muutokset
                     QSqlQuery muKysely;
-                    muKysely.exec(QString("SELECT tositelaji,tunniste,pvm,selite,debetsnt,kreditsnt,tositeId from vientivw where eraid=%1 and "
+                    muKysely.exec(QString("SELECT tositelaji,tunniste,pvm,selite,debetsnt,kreditsnt,tositeId from %4 where eraid=%1 and "
                                 "vientiId<>eraid and  pvm between \"%2\" and \"%3\" order by pvm")
-                                .arg( eraId ).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)) );
+                                .arg( eraId ).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate))
+                                .arg( kp()->osiot()->taulu("vientivw", mista, mihin)) );
 
                     while( muKysely.next() )
                     {
@@ -107,9 +107,10 @@ RaportinKirjoittaja TilikarttaRaportti::kirjoitaRaportti(TilikarttaRaportti::Kar
     // tiliIdtKaytossa - settiin lisätään kaikki, joissa kirjauksia ko. tilikaudella
     // Lisäksi käytössä ovat ne tasetilit, joilla on saldoa
 
-    QSqlQuery kysely( QString("SELECT DISTINCT tili FROM vienti WHERE PVM BETWEEN \"%1\" AND \"%2\" ")
+    QSqlQuery kysely( QString("SELECT DISTINCT tili FROM %3 WHERE PVM BETWEEN \"%1\" AND \"%2\" ")
             .arg(tilikaudelta.alkaa().toString(Qt::ISODate))
-            .arg(tilikaudelta.paattyy().toString(Qt::ISODate)) );
+            .arg(tilikaudelta.paattyy().toString(Qt::ISODate))
+            .arg(kp()->osiot()->taulu("vienti", tilikaudelta.alkaa(), tilikaudelta.paattyy())) );
     while( kysely.next())
     {
         // Kirjataan myös "ylätileille"
@@ -117,7 +118,7 @@ RaportinKirjoittaja TilikarttaRaportti::kirjoitaRaportti(TilikarttaRaportti::Kar
         while( tiliId)
         {
             tiliIdtKaytossa.insert( tiliId);    // Merkitään, että on käytössä
-            Tili tili = kp()->tilit()->tiliIdlla( tiliId );
+            const Tili tili = kp()->tilit()->tiliIdlla( tiliId );
             tiliId = tili.ylaotsikkoId();       // Haetaan seuraavaksi tämän ylätili
         }
     }
@@ -125,7 +126,7 @@ RaportinKirjoittaja TilikarttaRaportti::kirjoitaRaportti(TilikarttaRaportti::Kar
     QSet<int> ehtoTaytetty;     // Jos valitaan Käytössä tai Suosikit
     for(int i=0; i < kp()->tilit()->rowCount( QModelIndex());i++)
     {
-        Tili tili = kp()->tilit()->tiliIndeksilla(i);
+        const Tili tili = kp()->tilit()->tiliIndeksilla(i);
         if( (valinta == KAYTOSSA_TILIT && tili.tila() > 0) ||
             (valinta == SUOSIKKI_TILIT && tili.tila() > 1) )
         {
@@ -134,7 +135,7 @@ RaportinKirjoittaja TilikarttaRaportti::kirjoitaRaportti(TilikarttaRaportti::Kar
             while( tiliId)
             {
                 ehtoTaytetty.insert(tiliId);
-                Tili tili = kp()->tilit()->tiliIdlla(tiliId);
+                const Tili tili = kp()->tilit()->tiliIdlla(tiliId);
                 tiliId = tili.ylaotsikkoId();
             }
         }
@@ -147,7 +148,7 @@ RaportinKirjoittaja TilikarttaRaportti::kirjoitaRaportti(TilikarttaRaportti::Kar
         RaporttiRivi rr(RaporttiRivi::EICSV);
         RaporttiRivi csvr(RaporttiRivi::CSV);
 
-        Tili tili = kp()->tilit()->tiliIndeksilla(i);
+        const Tili tili = kp()->tilit()->tiliIndeksilla(i);
 
         if( tili.otsikkotaso() && !otsikot)
             continue;
@@ -108,11 +108,16 @@ RaportinKirjoittaja TositeluetteloRaportti::kirjoitaRaportti(QDate mista, QDate
     else if( ryhmittelelajeittain )
         jarjestys = "laji, pvm, id";
 
-    QString kysymys = QString("SELECT id, pvm, otsikko, tunniste, laji FROM tosite "
+    QString kysymys = QString("SELECT id, pvm, otsikko, tunniste, laji FROM %4 "
                               "WHERE pvm BETWEEN \"%1\" AND \"%2\" ORDER BY %3")
             .arg(mista.toString(Qt::ISODate))
             .arg(mihin.toString(Qt::ISODate))
-            .arg(jarjestys);
+            .arg(jarjestys)
+            .arg(kp()->osiot()->taulu("tosite", mista, mihin));
+
+    // Tositteiden viennit ja liitteet ovat samassa osiossa kuin tositteet
+    QString viennit = kp()->osiot()->taulu("vienti", mista, mihin);
+    QString liitteet = kp()->osiot()->taulu("liite", mista, mihin);
 
     QSqlQuery kysely(kysymys);
 
@@ -158,7 +163,7 @@ RaportinKirjoittaja TositeluetteloRaportti::kirjoitaRaportti(QDate mista, QDate
 
         // Tässä välissä tositelajikohtaisia toimia...
 
-        QSqlQuery lisakysely( QString("SELECT SUM(debetsnt), SUM(kreditsnt) FROM vienti WHERE tosite=%1 ").arg(tositeId));
+        QSqlQuery lisakysely( QString("SELECT SUM(debetsnt), SUM(kreditsnt) FROM %2 WHERE tosite=%1 ").arg(tositeId).arg(viennit));
         if( lisakysely.next())
         {
             // Tositteen summa: debet ja kredit yleensä yhtä suuret :)
@@ -185,7 +190,7 @@ RaportinKirjoittaja TositeluetteloRaportti::kirjoitaRaportti(QDate mista, QDate
 
         }
 
-        lisakysely.exec( QString("SELECT COUNT(liiteno) FROM liite WHERE tosite=%1").arg(tositeId));
+        lisakysely.exec( QString("SELECT COUNT(liiteno) FROM %2 WHERE tosite=%1").arg(tositeId).arg(liitteet));
         if( lisakysely.next())
         {
             liitteita = lisakysely.value(0).toInt();
@@ -213,8 +218,8 @@ RaportinKirjoittaja TositeluetteloRaportti::kirjoitaRaportti(QDate mista, QDate
         {
 
             lisakysely.exec(QString("SELECT pvm, tili, kohdennus, selite, debetsnt, kreditsnt "
-                                    "FROM vienti WHERE tosite=%1 ORDER BY id")
-                            .arg(tositeId));
+                                    "FROM %2 WHERE tosite=%1 ORDER BY id")
+                            .arg(tositeId).arg(viennit));
             while( lisakysely.next())
             {
                 if( !lisakysely.value("tili").toInt())
@@ -0,0 +1,66 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "selaushakija.h"
+#include "db/kirjanpito.h"
+
+SelausHakija::SelausHakija(const QString &kysymys, QObject *parent) :
+    QThread(parent),
+    kysymys_(kysymys)
+{
+
+}
+
+void SelausHakija::irrota()
+{
+    if( parent())
+        disconnect(parent());
+    setParent(nullptr);
+    requestInterruption();
+
+    connect( this, &SelausHakija::finished, this, &SelausHakija::deleteLater);
+    if( isFinished())
+        deleteLater();
+}
+
+void SelausHakija::run()
+{
+    QSqlDatabase yhteys = kp()->lukuyhteys();
+    if( !yhteys.isOpen() || isInterruptionRequested())
+        return;
+
+    MitattuKysely kysely( yhteys );
+    kysely.setForwardOnly(true);
+    kysely.exec(kysymys_);
+
+    int erassa = 0;
+    int eranKoko = ENSIMMAINEN_ERA;
+
+    while( !isInterruptionRequested() && kysely.next())
+    {
+        lue(kysely);
+        if( ++erassa == eranKoko )
+        {
+            emit rivejaSaatu( otaEra() );
+            erassa = 0;
+            eranKoko = ERA;
+        }
+    }
+
+    if( erassa && !isInterruptionRequested())
+        emit rivejaSaatu( otaEra() );
+}
@@ -0,0 +1,81 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SELAUSHAKIJA_H
+#define SELAUSHAKIJA_H
+
+#include <QThread>
+#include <QVariant>
+
+class QSqlQuery;
+
+/**
+ * @brief Selauksen rivien haku taustasäikeessä
+ *
+ * Kysely ajetaan säikeen omalla Kirjanpito::lukuyhteys():llä, ja luetut
+ * rivit lähetetään modelille erinä rivejaSaatu()-signaalilla. Ensimmäinen
+ * erä on pieni, jotta näkymän ensimmäinen sivullinen saadaan heti esiin.
+ *
+ * Model keskeyttää haun irrota():lla, kun aikaväli vaihtuu tai model
+ * poistetaan. Aliluokka lukee rivit omaan muotoonsa lue()-funktiolla.
+ */
+class SelausHakija : public QThread
+{
+    Q_OBJECT
+public:
+    explicit SelausHakija(const QString& kysymys, QObject *parent = nullptr);
+
+    /**
+     * @brief Ensimmäisen erän koko: näkymän sivullinen
+     */
+    static const int ENSIMMAINEN_ERA = 100;
+    /**
+     * @brief Seuraavien erien koko
+     */
+    static const int ERA = 2000;
+
+    /**
+     * @brief Keskeyttää haun ja irrottaa säikeen modelista
+     *
+     * Modelia ei jäädä odottamaan: säie poistaa itsensä päätyttyään,
+     * eikä sen vielä lähettämiä eriä toimiteta modelille.
+     */
+    void irrota();
+
+signals:
+    /**
+     * @brief Erä rivejä otaEra()-funktion palauttamana
+     */
+    void rivejaSaatu(const QVariant& rivit);
+
+protected:
+    void run() override;
+
+    /**
+     * @brief Lukee kyselyn nykyisen rivin erään
+     */
+    virtual void lue(const QSqlQuery& kysely) = 0;
+
+    /**
+     * @brief Palauttaa kerätyn erän ja aloittaa uuden
+     */
+    virtual QVariant otaEra() = 0;
+
+    QString kysymys_;
+};
+
+#endif // SELAUSHAKIJA_H
@@ -17,19 +17,60 @@
 
 #include "selausmodel.h"
 
+#include "selaushakija.h"
+
 #include <QSqlQuery>
+#include <QTimer>
 #include "db/kirjanpito.h"
+#include "db/eranvalintamodel.h"
 
 #include <QDebug>
 
+/**
+ * @brief Vientien haku taustasäikeessä
+ */
+class VientiHakija : public SelausHakija
+{
+public:
+    using SelausHakija::SelausHakija;
+
+protected:
+    void lue(const QSqlQuery &kysely) override
+    {
+        rivit_.lueRivi(kysely);
+    }
+
+    QVariant otaEra() override
+    {
+        QVariant era = QVariant::fromValue(rivit_);
+        rivit_ = SelausRivit();
+        return era;
+    }
+
+    SelausRivit rivit_;
+};
+
 SelausModel::SelausModel()
 {
+    viipaleAjastin_ = new QTimer(this);
+    viipaleAjastin_->setSingleShot(true);
+    connect( viipaleAjastin_, &QTimer::timeout, this, &SelausModel::haeViipale);
+}
 
+SelausModel::~SelausModel()
+{
+    // Kesken oleva haku päättyy itsestään
+    keskeytaHaku();
+}
+
+bool SelausModel::lataamassa() const
+{
+    return hakija_ || viipaleAjastin_->isActive();
 }
 
 int SelausModel::rowCount(const QModelIndex & /* parent */) const
 {
-    return rivit.count();
+    return naytetty_;
 }
 
 int SelausModel::columnCount(const QModelIndex & /* parent */) const
@@ -72,7 +113,7 @@ QVariant SelausModel::data(const QModelIndex &index, int role) const
     if( !index.isValid())
         return QVariant();
 
-    SelausRivi rivi = rivit.at( index.row());
+    const int rivi = index.row();
 
     if( role == Qt::DisplayRole || role == Qt::EditRole)
     {
@@ -80,62 +121,75 @@ QVariant SelausModel::data(const QModelIndex &index, int role) const
         switch (index.column())
         {
             case TOSITE:
-                if( role == Qt::EditRole)
-                    return rivi.lajiteltavaTositetunniste;
-                return QVariant( rivi.tositetunniste);
+            {
+                QDate pvm = rivit.pvm(rivi);
+                QString lajitunnus = kp()->asetukset()->kuva().samaanSarjaan ? QString()
+                                   : kp()->tositelajit()->tositelaji( rivit.laji.at(rivi) ).tunnus();
+                return kp()->tilikaudet()->tositetunniste( rivit.tunniste.at(rivi), pvm, lajitunnus,
+                                                           role == Qt::EditRole);
+            }
 
             case PVM:
                 if( role == Qt::DisplayRole)
-                    return QVariant( rivi.pvm );
+                    return QVariant( rivit.pvm(rivi) );
                 else
                     return QString("%1 %2")
-                            .arg(rivi.pvm.toString(Qt::ISODate))
-                            .arg(rivi.vientiId, 8, 10, QChar('0') );
+                            .arg(rivit.pvm(rivi).toString(Qt::ISODate))
+                            .arg(rivit.vienti.at(rivi), 8, 10, QChar('0') );
 
             case TILI:
+            {
+                const Tili& tili = kp()->tilit()->tiliIdlla( rivit.tili.at(rivi) );
                 if( role == Qt::EditRole)
-                    return rivi.tili.numero();
-                else if( rivi.tili.numero())
-                    return QVariant( QString("%1 %2").arg(rivi.tili.numero()).arg(rivi.tili.nimi()) );
+                    return tili.numero();
+                else if( tili.numero())
+                    return QVariant( QString("%1 %2").arg(tili.numero()).arg(tili.nimi()) );
                 else
                     return QVariant();
+            }
 
             case DEBET:
                 if( role == Qt::EditRole)
-                    return QVariant( rivi.debetSnt);
-                else if( rivi.debetSnt )
-                    return QVariant( QString("%L1 €").arg(rivi.debetSnt / 100.0,0,'f',2));
+                    return QVariant( rivit.debetSnt.at(rivi));
+                else if( rivit.debetSnt.at(rivi) )
+                    return QVariant( QString("%L1 €").arg(rivit.debetSnt.at(rivi) / 100.0,0,'f',2));
                 else
                     return QVariant();
 
             case KREDIT:
                 if( role == Qt::EditRole)
-                    return QVariant( rivi.kreditSnt);
-                else if( rivi.kreditSnt )
-                    return QVariant( QString("%L1 €").arg(rivi.kreditSnt / 100.0,0,'f',2));
+                    return QVariant( rivit.kreditSnt.at(rivi));
+                else if( rivit.kreditSnt.at(rivi) )
+                    return QVariant( QString("%L1 €").arg(rivit.kreditSnt.at(rivi) / 100.0,0,'f',2));
                 else
                     return QVariant();
 
-            case SELITE: return QVariant( rivi.selite );
+            case SELITE: return QVariant( rivit.selite(rivi) );
 
             case KOHDENNUS :
                 QString txt;
 
-                if( rivi.kohdennus.tyyppi() != Kohdennus::EIKOHDENNETA)
-                    txt = rivi.kohdennus.nimi();
+                const Kohdennus& kohdennus = kp()->kohdennukset()->kohdennus( rivit.kohdennus.at(rivi) );
+                if( kohdennus.tyyppi() != Kohdennus::EIKOHDENNETA)
+                    txt = kohdennus.nimi();
 
-                if( rivi.taseEra.eraId && rivi.taseEra.eraId != rivi.vientiId)
+                // Erän viite muodostetaan kuten TaseEra::tositteenTunniste(),
+                // mutta rivin tiedoista ilman kyselyä
+                if( rivit.era.at(rivi) && rivit.era.at(rivi) != rivit.vienti.at(rivi))
                 {
                     if( !txt.isEmpty())
                         txt.append(" \n");
-                    txt.append( rivi.taseEra.tositteenTunniste() );
+                    txt.append( QString("%1%2/%3")
+                                .arg( kp()->tositelajit()->tositelaji( rivit.eraLaji.at(rivi) ).tunnus() )
+                                .arg( rivit.eraTunniste.at(rivi) )
+                                .arg( kp()->tilikaudet()->tilikausiPaivalle( rivit.eraPvm(rivi) ).kausitunnus() ));
                 }
 
-                if( rivi.tagit.count())
+                if( !rivit.tagit(rivi).isEmpty())
                 {
                     if( !txt.isEmpty())
                         txt.append(" \n");
-                    txt.append(  rivi.tagit.join(", ") );
+                    txt.append( rivit.tagit(rivi) );
                 }
                 return txt;
 
@@ -152,17 +206,17 @@ QVariant SelausModel::data(const QModelIndex &index, int role) const
     else if( role == Qt::UserRole)
     {
         // UserRolena on tositeid, jotta selauksesta pääsee helposti tositteeseen
-        return QVariant( rivi.tositeId );
+        return QVariant( rivit.tosite.at(rivi) );
     }
     else if( role == Qt::DecorationRole && index.column() == KOHDENNUS )
     {
-        if( rivi.eraMaksettu)
+        if( rivit.eraMaksettu(rivi))
             return QIcon(":/pic/ok.png");
-        return rivi.kohdennus.tyyppiKuvake();
+        return kp()->kohdennukset()->kohdennus( rivit.kohdennus.at(rivi) ).tyyppiKuvake();
     }
     else if( role == Qt::DecorationRole && index.column() == TOSITE)
     {
-        if( rivi.liitteita )
+        if( rivit.liitteita(rivi) )
             return QIcon(":/pic/liite.png");
         else
             return QIcon(":/pic/tyhja.png");
@@ -172,85 +226,247 @@ QVariant SelausModel::data(const QModelIndex &index, int role) const
     return QVariant();
 }
 
+bool SelausModel::canFetchMore(const QModelIndex & /* parent */) const
+{
+    return naytetty_ < rivit.maara() || lataamassa();
+}
+
+void SelausModel::fetchMore(const QModelIndex & /* parent */)
+{
+    if( naytetty_ == rivit.maara())
+    {
+        // Näytetään seuraavat rivit heti niiden saavuttua
+        odottaaLisaa_ = true;
+        return;
+    }
+
+    int lisattavia = qMin( rivit.maara() - naytetty_, SelausHakija::ERA );
+    beginInsertRows(QModelIndex(), naytetty_, naytetty_ + lisattavia - 1);
+    naytetty_ += lisattavia;
+    odottaaLisaa_ = false;
+    endInsertRows();
+}
+
 void SelausModel::lataa(const QDate &alkaa, const QDate &loppuu)
 {
-    QString kysymys = QString("SELECT vienti.tosite, vienti.pvm, tili, debetsnt, kreditsnt, selite, kohdennus, eraid, "
-                              "tosite.laji, tosite.tunniste, vienti.id, liite.id "
-                              "FROM vienti, tosite LEFT OUTER JOIN liite ON tosite.id=liite.tosite "
-                              "WHERE vienti.pvm BETWEEN \"%1\" AND \"%2\" "
-                              "AND vienti.tosite=tosite.id AND tili is not null ORDER BY vienti.pvm, vienti.id")
-                              .arg( alkaa.toString(Qt::ISODate ) )
-                              .arg( loppuu.toString(Qt::ISODate)) ;
+    alkaa_ = alkaa;
+    loppuu_ = loppuu;
+    keskeytaHaku();
 
     beginResetModel();
-    rivit.clear();
-    tileilla.clear();
+    naytetty_ = 0;
+    odottaaLisaa_ = false;
+    rivit = SelausRivit();
+
+    // Ilman WAL-tilaa taustasäikeellä ei ole omaa yhteyttä
+    if( kp()->onkoWal())
+    {
+        hakija_ = new VientiHakija( kysymys(alkaa, loppuu), this);
+        connect( hakija_, &SelausHakija::rivejaSaatu, this, &SelausModel::rivejaSaatu);
+        connect( hakija_, &SelausHakija::finished, this, &SelausModel::hakuValmis);
+        hakija_->start();
+    }
+    paivitaTililista();
+    endResetModel();
+
+    if( !hakija_ )
+        haeViipale();
+}
+
+void SelausModel::rivejaSaatu(const QVariant &saadut)
+{
+    // Keskeytetyn haun jo lähetetyt erät ohitetaan
+    if( !hakija_ || sender() != hakija_ )
+        return;
 
-    int edellinenVientiId = -1;
+    SelausRivit uudet = saadut.value<SelausRivit>();
+    lisaaRivit(uudet);
+}
 
-    QSqlQuery query;
-    query.exec(kysymys);
+void SelausModel::haeViipale()
+{
+    // Ensimmäinen viipale on sivullinen, jotta näkymä saadaan heti esiin
+    const int koko = rivit.maara() ? SelausHakija::ERA : SelausHakija::ENSIMMAINEN_ERA;
+
+    SelausRivit uudet;
+    MitattuKysely query( *kp()->tietokanta() );
+    query.setForwardOnly(true);
+    query.exec( kysymys(alkaa_, loppuu_, QList<int>(), rivit.maara() ? &rivit : nullptr)
+                + QString(" LIMIT %1").arg(koko) );
     while( query.next())
+        uudet.lueRivi(query);
+
+    const bool valmis = uudet.maara() < koko;
+    lisaaRivit(uudet);
+
+    if( valmis )
     {
-        if( query.value("vienti.id").toInt() == edellinenVientiId)
-            continue;
+        paivitaTililista();
+        emit ladattu();
+    }
+    else
+        viipaleAjastin_->start();
+}
 
-        SelausRivi rivi;
-        rivi.tositeId = query.value(0).toInt();
-        rivi.pvm = query.value(1).toDate();
-        rivi.tili = kp()->tilit()->tiliIdlla( query.value(2).toInt());
-        rivi.debetSnt = query.value(3).toLongLong();
-        rivi.kreditSnt = query.value(4).toLongLong();
-        rivi.selite = query.value(5).toString();
-        rivi.kohdennus = kp()->kohdennukset()->kohdennus( query.value(6).toInt());
-        rivi.taseEra = TaseEra( query.value(7).toInt());
-        if( kp()->asetukset()->onko("Samaansarjaan"))
-        {
-            rivi.tositetunniste = QString("%1/%2")
-                                           .arg( query.value(9).toInt()  )
-                                           .arg( kp()->tilikaudet()->tilikausiPaivalle(rivi.pvm).kausitunnus() );
-
-            rivi.lajiteltavaTositetunniste = QString("%1/%2")
-                                           .arg( query.value(9).toInt(),8,10,QChar('0'))
-                                           .arg( kp()->tilikaudet()->tilikausiPaivalle(rivi.pvm).kausitunnus() );
-        } else {
-            rivi.tositetunniste = QString("%1 %2/%3")
-                                           .arg( kp()->tositelajit()->tositelaji( query.value(8).toInt()  ).tunnus() )
-                                           .arg( query.value(9).toInt()  )
-                                           .arg( kp()->tilikaudet()->tilikausiPaivalle(rivi.pvm).kausitunnus() );
-
-            rivi.lajiteltavaTositetunniste = QString("%1%2/%3")
-                                       .arg( kp()->tositelajit()->tositelaji( query.value(8).toInt()  ).tunnus() )
-                                       .arg( query.value(9).toInt(),8,10,QChar('0'))
-                                       .arg( kp()->tilikaudet()->tilikausiPaivalle(rivi.pvm).kausitunnus() );
-        }
+void SelausModel::lisaaRivit(SelausRivit &uudet)
+{
+    tarkastaMaksetut(uudet);
+    rivit.lisaa( uudet );
+    if( naytetty_ == 0 || odottaaLisaa_ )
+        fetchMore(QModelIndex());
+}
 
-        rivi.vientiId = query.value("vienti.id").toInt();
-        rivi.liitteita = !query.value("liite.id").isNull();
+void SelausModel::hakuValmis()
+{
+    if( !hakija_ || sender() != hakija_ )
+        return;
+
+    hakija_->deleteLater();
+    hakija_ = nullptr;
+    paivitaTililista();
+    emit ladattu();
+}
+
+void SelausModel::keskeytaHaku()
+{
+    viipaleAjastin_->stop();
+    if( !hakija_ )
+        return;
+
+    hakija_->irrota();
+    hakija_ = nullptr;
+}
+
+void SelausModel::paivita(const KirjanpidonMuutos &muutos)
+{
+    // Kesken olevan haun tulokset voivat olla jo vanhentuneita
+    if( muutos.onkoKaikki() || lataamassa() )
+    {
+        lataa(alkaa_, loppuu_);
+        return;
+    }
 
-        edellinenVientiId = rivi.vientiId;
+    // Poistetaan muuttuneiden tositteiden vanhat viennit. Vielä näyttämättömät
+    // rivit muutetaan ilman näkymälle ilmoittamista.
+    QSet<int> tositteet = muutos.tositteet();
+    for(int i = rivit.maara() - 1; i >= 0 && !tositteet.isEmpty(); i--)
+    {
+        if( tositteet.contains( rivit.tosite.at(i) ))
+        {
+            if( i < naytetty_ )
+            {
+                beginRemoveRows(QModelIndex(), i, i);
+                rivit.poista(i);
+                naytetty_--;
+                endRemoveRows();
+            }
+            else
+                rivit.poista(i);
+        }
+    }
 
-        if( query.value("eraid").toInt() && rivi.tili.eritellaankoTase() )
+    // ja lisätään uudet viennit paikoilleen päivämäärän mukaiseen järjestykseen
+    if( !tositteet.isEmpty() && muutos.koskeeJaksoa(alkaa_, loppuu_))
+    {
+        SelausRivit uudet = haeRivit( alkaa_, loppuu_, tositteet.toList());
+        for( int i=0; i < uudet.maara(); i++)
         {
-            TaseEra era( query.value("eraid").toInt() );
-            rivi.eraMaksettu = era.saldoSnt == 0 ;
+            int indeksi = rivit.sijoituskohta(uudet, i);
+            if( indeksi < naytetty_ || naytetty_ == rivit.maara() )
+            {
+                beginInsertRows(QModelIndex(), indeksi, indeksi);
+                rivit.lisaa(indeksi, uudet, i);
+                naytetty_++;
+                endInsertRows();
+            }
+            else
+                rivit.lisaa(indeksi, uudet, i);
         }
+    }
 
-        QSqlQuery tagikysely( QString("SELECT kohdennus FROM merkkaus WHERE vienti=%1").arg( query.value("vienti.id").toInt() ));
-        while( tagikysely.next())
+    // Muiden tositteiden viennit, joiden tase-erään muutos vaikutti
+    QHash<int,TaseEra> erat;
+    QHash<int,QPair<int,int>> eraTositteet;     // Erä -> tositteen tunniste ja laji
+    for(int i=0; i < rivit.maara() && !muutos.erat().isEmpty(); i++)
+    {
+        const int eraId = rivit.era.at(i);
+        if( tositteet.contains(rivit.tosite.at(i)) || !muutos.erat().contains( eraId ))
+            continue;
+
+        if( !erat.contains( eraId ))
         {
-            rivi.tagit.append( kp()->kohdennukset()->kohdennus( tagikysely.value(0).toInt() ).nimi() );
+            erat.insert( eraId, TaseEra( eraId ));
+            QSqlQuery kysely( QString("SELECT tunniste, laji FROM %1 WHERE id=%2")
+                              .arg( kp()->osiot()->taulu("tosite"))
+                              .arg( erat.value(eraId).tositeId ));
+            if( kysely.next())
+                eraTositteet.insert( eraId, qMakePair( kysely.value(0).toInt(), kysely.value(1).toInt()));
         }
+        const TaseEra& era = erat[eraId];
+        rivit.eraTunniste[i] = eraTositteet.value(eraId).first;
+        rivit.eraLaji[i] = eraTositteet.value(eraId).second;
+        rivit.eraPaiva[i] = static_cast<int>( era.pvm.toJulianDay() );
+        if( kp()->tilit()->tiliIdlla( rivit.tili.at(i) ).eritellaankoTase())
+            rivit.asetaEraMaksettu(i, era.saldoSnt == 0);
+        if( i < naytetty_ )
+            emit dataChanged( index(i, KOHDENNUS), index(i, KOHDENNUS) );
+    }
+
+    paivitaTililista();
+}
+
+void SelausModel::paivitaTililista()
+{
+    tileilla.clear();
 
-        rivit.append(rivi);
+    // Kukin tili muotoillaan vain kerran
+    QSet<int> tiliIdt;
+    for( int tiliId : rivit.tili )
+        tiliIdt.insert(tiliId);
 
-        QString tilistr = QString("%1 %2")
-                    .arg(rivi.tili.numero())
-                    .arg(rivi.tili.nimi());
-        if( !tileilla.contains(tilistr))
-            tileilla.append(tilistr);
+    for( int tiliId : tiliIdt)
+    {
+        const Tili& tili = kp()->tilit()->tiliIdlla(tiliId);
+        tileilla.append( QString("%1 %2").arg(tili.numero()).arg(tili.nimi()) );
     }
 
     tileilla.sort();
-    endResetModel();
+}
+
+SelausRivit SelausModel::haeRivit(const QDate &alkaa, const QDate &loppuu,
+                                  const QList<int> &tositteet)
+{
+    SelausRivit rivit;
+
+    MitattuKysely query( *kp()->tietokanta() );
+    query.setForwardOnly(true);
+    query.exec( kysymys(alkaa, loppuu, tositteet) );
+    while( query.next())
+        rivit.lueRivi(query);
+    tarkastaMaksetut(rivit);
+
+    return rivit;
+}
+
+QString SelausModel::kysymys(const QDate &alkaa, const QDate &loppuu, const QList<int> &tositteet,
+                             const SelausRivit *jalkeen)
+{
+    return SelausRivit::kysymys( *kp()->osiot(), alkaa, loppuu, tositteet, jalkeen);
+}
+
+void SelausModel::tarkastaMaksetut(SelausRivit &rivit)
+{
+    // Kunkin tilin erittely katsotaan vain kerran
+    QHash<int,bool> eritellaan;
+    for(int i=0; i < rivit.maara(); i++)
+    {
+        if( !rivit.eraMaksettu(i))
+            continue;
+
+        const int tiliId = rivit.tili.at(i);
+        if( !eritellaan.contains(tiliId))
+            eritellaan.insert( tiliId, kp()->tilit()->tiliIdlla(tiliId).eritellaankoTase());
+        if( !eritellaan.value(tiliId))
+            rivit.asetaEraMaksettu(i, false);
+    }
 }
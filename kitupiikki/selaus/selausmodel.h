@@ -22,35 +22,27 @@
 #include <QList>
 #include <QDate>
 
-#include "db/tili.h"
-#include "db/kohdennus.h"
-#include "db/eranvalintamodel.h"
-
-/**
- * @brief SelausModel:in yhden rivin (viennin) tiedot
- */
-struct SelausRivi
-{
-    int tositeId;
-    QDate pvm;
-    Tili tili;
-    Kohdennus kohdennus;
-
-    QString selite;
-    qlonglong debetSnt;
-    qlonglong kreditSnt;
-    TaseEra taseEra;
-    QString tositetunniste;
-    QString lajiteltavaTositetunniste;
-    QStringList tagit;
-    bool eraMaksettu = false;
-    int vientiId;
-    bool liitteita = false;
-};
+#include "selausrivit.h"
+#include "db/kirjanpidonmuutos.h"
 
 /**
  * @brief Selaussivun model vientien selaamiseen
+ *
+ * Kysely muodostetaan kp():n modeleiden (osiot) avulla pääsäikeessä.
+ *
+ * Rivit säilytetään sarakkeittain (ks. SelausRivit), ja näytettävät
+ * tekstit muodostetaan data()-funktiossa.
+ *
+ * WAL-tilassa lataa() hakee rivit taustasäikeessä (ks. SelausHakija).
+ * Muuten rivit haetaan pääsäikeen yhteydellä viipaleina (haeViipale()),
+ * jotka ajetaan tapahtumasilmukasta, joten pitkäkään aikaväli ei jäädytä
+ * käyttöliittymää. Ensimmäinen sivullinen näytetään heti, ja loput saapuneet
+ * rivit tuodaan näkymään fetchMore():lla näkymää vieritettäessä. Uusi lataa()
+ * keskeyttää kesken olevan haun.
  */
+class SelausHakija;
+class QTimer;
+
 class SelausModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -62,6 +54,7 @@ public:
     };
 
     SelausModel();
+    ~SelausModel() override;
 
     int rowCount(const QModelIndex &parent) const;
     int columnCount(const QModelIndex &parent) const;
@@ -69,15 +62,100 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role) const;
     QVariant data(const QModelIndex &index, int role) const;
 
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    /**
+     * @brief Onko haku kesken
+     */
+    bool lataamassa() const;
+
+    /**
+     * @brief Käytetyt tilit, myös vielä näyttämättömiltä riveiltä
+     */
     QStringList kaytetytTilit() const { return tileilla; }
 
+    /**
+     * @brief Hakee aikavälin viennit
+     *
+     * Käyttää pääsäikeen yhteyttä ja kp():n modeleita, joten kutsutaan
+     * vain pääsäikeestä.
+     *
+     * @param alkaa
+     * @param loppuu
+     * @param tositteet Jos annettu, haetaan vain näiden tositteiden viennit
+     * @return Selauksen rivit
+     */
+    static SelausRivit haeRivit(const QDate& alkaa, const QDate& loppuu,
+                                const QList<int>& tositteet = QList<int>());
+
+    /**
+     * @brief Vientien hakukysely kirjanpidon osioista, muodostetaan pääsäikeessä
+     * @param jalkeen Jos annettu, haetaan vain tämän rivin jälkeiset viennit
+     * @see SelausRivit::kysymys()
+     */
+    static QString kysymys(const QDate& alkaa, const QDate& loppuu, const QList<int>& tositteet = QList<int>(),
+                           const SelausRivit* jalkeen = nullptr);
+
+signals:
+    /**
+     * @brief Kaikki aikavälin rivit on haettu
+     */
+    void ladattu();
+
 public slots:
     void lataa(const QDate& alkaa, const QDate& loppuu);
 
+    /**
+     * @brief Päivittää muutoksen koskemat rivit
+     *
+     * Muuttuneiden tositteiden viennit haetaan uudelleen ja muuttuneisiin
+     * tase-eriin kuuluvien rivien erätiedot päivitetään. Muita rivejä ei
+     * haeta uudelleen.
+     */
+    void paivita(const KirjanpidonMuutos& muutos);
+
+protected slots:
+    void rivejaSaatu(const QVariant& rivit);
+    void hakuValmis();
+
+    /**
+     * @brief Hakee pääsäikeessä seuraavan erän rivejä jo haettujen jälkeen
+     *
+     * Rivit haetaan päivämäärän ja viennin id:n mukaan jatkuvalla kyselyllä,
+     * jolloin jokainen viipale käyttää indeksiä eikä ohita aiempia rivejä.
+     */
+    void haeViipale();
+
 protected:
-    QList<SelausRivi> rivit;
+    void lisaaRivit(SelausRivit& uudet);
+
+    /**
+     * @brief Poistaa maksettu-merkinnän tileiltä, joiden eriä ei seurata
+     *
+     * Käyttää tilimodelia, joten kutsutaan pääsäikeestä.
+     */
+    static void tarkastaMaksetut(SelausRivit& rivit);
+
+    void paivitaTililista();
+    void keskeytaHaku();
+
+    QDate alkaa_;
+    QDate loppuu_;
+    SelausRivit rivit;
     QStringList tileilla;
 
+    /**
+     * @brief Näkymälle näytettyjen rivien määrä, loput odottavat fetchMore():a
+     */
+    int naytetty_ = 0;
+    /**
+     * @brief Näkymä on pyytänyt lisää rivejä ennen kuin niitä on saapunut
+     */
+    bool odottaaLisaa_ = false;
+    SelausHakija *hakija_ = nullptr;
+    QTimer *viipaleAjastin_;
+
 };
 
 #endif // SELAUSMODEL_H
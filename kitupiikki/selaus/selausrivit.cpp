@@ -0,0 +1,238 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "selausrivit.h"
+#include "db/kausiosiot.h"
+
+#include <QSqlQuery>
+#include <QVariant>
+
+SelausRivit::SelausRivit()
+{
+    // Tyhjä teksti on aina indeksillä 0
+    tekstinId( QString() );
+}
+
+void SelausRivit::varaa(int maara)
+{
+    vienti.reserve(maara);
+    tosite.reserve(maara);
+    paiva.reserve(maara);
+    tili.reserve(maara);
+    debetSnt.reserve(maara);
+    kreditSnt.reserve(maara);
+    seliteId.reserve(maara);
+    kohdennus.reserve(maara);
+    era.reserve(maara);
+    tunniste.reserve(maara);
+    laji.reserve(maara);
+    eraTunniste.reserve(maara);
+    eraLaji.reserve(maara);
+    eraPaiva.reserve(maara);
+    tagitId.reserve(maara);
+    liput.reserve(maara);
+}
+
+void SelausRivit::tyhjenna()
+{
+    *this = SelausRivit();
+}
+
+void SelausRivit::lisaa(int vientiId, int tositeId, const QDate &pvm, int tiliId, qlonglong debet, qlonglong kredit,
+                        const QString &selite, int kohdennusId, int eraId, int tositeTunniste, int lajiId,
+                        int eraTositeTunniste, int eraLajiId, const QDate &eraPvm,
+                        const QString &tagit, bool liitteita, bool eraMaksettu)
+{
+    vienti.append( vientiId );
+    tosite.append( tositeId );
+    paiva.append( static_cast<int>( pvm.toJulianDay() ) );
+    tili.append( tiliId );
+    debetSnt.append( debet );
+    kreditSnt.append( kredit );
+    seliteId.append( tekstinId(selite) );
+    kohdennus.append( kohdennusId );
+    era.append( eraId );
+    tunniste.append( tositeTunniste );
+    laji.append( lajiId );
+    eraTunniste.append( eraTositeTunniste );
+    eraLaji.append( eraLajiId );
+    eraPaiva.append( static_cast<int>( eraPvm.toJulianDay() ) );
+    tagitId.append( tekstinId(tagit) );
+    liput.append( static_cast<quint8>( (liitteita ? LIITTEITA : 0) | (eraMaksettu ? ERA_MAKSETTU : 0) ) );
+}
+
+void SelausRivit::lisaa(int indeksi, const SelausRivit &lahde, int rivi)
+{
+    vienti.insert( indeksi, lahde.vienti.at(rivi) );
+    tosite.insert( indeksi, lahde.tosite.at(rivi) );
+    paiva.insert( indeksi, lahde.paiva.at(rivi) );
+    tili.insert( indeksi, lahde.tili.at(rivi) );
+    debetSnt.insert( indeksi, lahde.debetSnt.at(rivi) );
+    kreditSnt.insert( indeksi, lahde.kreditSnt.at(rivi) );
+    seliteId.insert( indeksi, tekstinId( lahde.selite(rivi) ) );
+    kohdennus.insert( indeksi, lahde.kohdennus.at(rivi) );
+    era.insert( indeksi, lahde.era.at(rivi) );
+    tunniste.insert( indeksi, lahde.tunniste.at(rivi) );
+    laji.insert( indeksi, lahde.laji.at(rivi) );
+    eraTunniste.insert( indeksi, lahde.eraTunniste.at(rivi) );
+    eraLaji.insert( indeksi, lahde.eraLaji.at(rivi) );
+    eraPaiva.insert( indeksi, lahde.eraPaiva.at(rivi) );
+    tagitId.insert( indeksi, tekstinId( lahde.tagit(rivi) ) );
+    liput.insert( indeksi, lahde.liput.at(rivi) );
+}
+
+void SelausRivit::lisaa(const SelausRivit &lahde)
+{
+    for(int i=0; i < lahde.maara(); i++)
+        lisaa( maara(), lahde, i);
+}
+
+void SelausRivit::poista(int indeksi)
+{
+    // Tekstit jäävät taulukkoon, koska muut rivit voivat käyttää niitä
+    vienti.remove(indeksi);
+    tosite.remove(indeksi);
+    paiva.remove(indeksi);
+    tili.remove(indeksi);
+    debetSnt.remove(indeksi);
+    kreditSnt.remove(indeksi);
+    seliteId.remove(indeksi);
+    kohdennus.remove(indeksi);
+    era.remove(indeksi);
+    tunniste.remove(indeksi);
+    laji.remove(indeksi);
+    eraTunniste.remove(indeksi);
+    eraLaji.remove(indeksi);
+    eraPaiva.remove(indeksi);
+    tagitId.remove(indeksi);
+    liput.remove(indeksi);
+}
+
+int SelausRivit::sijoituskohta(const SelausRivit &lahde, int rivi) const
+{
+    const int uusiPaiva = lahde.paiva.at(rivi);
+    const int uusiVienti = lahde.vienti.at(rivi);
+
+    // Ensimmäinen rivi, joka on lisättävän jälkeen
+    int alku = 0;
+    int loppu = maara();
+    while( alku < loppu )
+    {
+        int keski = alku + (loppu - alku) / 2;
+        if( paiva.at(keski) < uusiPaiva || ( paiva.at(keski) == uusiPaiva && vienti.at(keski) <= uusiVienti ))
+            alku = keski + 1;
+        else
+            loppu = keski;
+    }
+    return alku;
+}
+
+void SelausRivit::asetaEraMaksettu(int indeksi, bool maksettu)
+{
+    if( maksettu )
+        liput[indeksi] |= ERA_MAKSETTU;
+    else
+        liput[indeksi] &= static_cast<quint8>(~ERA_MAKSETTU);
+}
+
+qint64 SelausRivit::muisti() const
+{
+    qint64 tavut = sizeof(SelausRivit);
+    tavut += ( vienti.capacity() + tosite.capacity() + paiva.capacity() + tili.capacity()
+               + seliteId.capacity() + kohdennus.capacity() + era.capacity()
+               + tunniste.capacity() + laji.capacity() + eraTunniste.capacity() + eraLaji.capacity()
+               + eraPaiva.capacity() + tagitId.capacity() ) * static_cast<qint64>(sizeof(int));
+    tavut += ( debetSnt.capacity() + kreditSnt.capacity() ) * static_cast<qint64>(sizeof(qlonglong));
+    tavut += liput.capacity() * static_cast<qint64>(sizeof(quint8));
+
+    // Tekstin data on jaettu listan ja hajautustaulun kesken
+    for( const QString& teksti : tekstit_)
+        tavut += static_cast<qint64>( sizeof(QString) * 2 + sizeof(QArrayData) + sizeof(QChar) * (teksti.capacity() + 1)
+                                      + sizeof(void*) * 2 + sizeof(int) * 2 );
+    return tavut;
+}
+
+int SelausRivit::tekstinId(const QString &teksti)
+{
+    auto iter = tekstiIdt_.constFind(teksti);
+    if( iter != tekstiIdt_.constEnd())
+        return iter.value();
+
+    int id = tekstit_.count();
+    tekstit_.append(teksti);
+    tekstiIdt_.insert(teksti, id);
+    return id;
+}
+
+QString SelausRivit::kysymys(const KausiOsiot &osiot, const QDate &alkaa, const QDate &loppuu,
+                             const QList<int> &tositteet, const SelausRivit *jalkeen)
+{
+    QString rajaus;
+    if( !tositteet.isEmpty())
+    {
+        QStringList idt;
+        for(int id : tositteet)
+            idt.append( QString::number(id) );
+        rajaus = QString("AND vienti.tosite IN (%1) ").arg( idt.join(',') );
+    }
+    if( jalkeen && jalkeen->maara())
+    {
+        // Jatketaan järjestyksessä viimeisen rivin jälkeen
+        const int viimeinen = jalkeen->maara() - 1;
+        rajaus.append( QString("AND vienti.pvm >= \"%1\" AND (vienti.pvm > \"%1\" OR vienti.id > %2) ")
+                       .arg( jalkeen->pvm(viimeinen).toString(Qt::ISODate))
+                       .arg( jalkeen->vienti.at(viimeinen)) );
+    }
+
+    // Merkkaukset, tase-erän saldo ja viite sekä liitteiden olemassaolo haetaan
+    // samalla kyselyllä, jottei jokaiselle riville tarvita omia kyselyitä.
+    // Erän tosite voi olla millä tahansa kaudella.
+    return QString("SELECT vienti.id, vienti.tosite, vienti.pvm, vienti.tili, vienti.debetsnt, vienti.kreditsnt, "
+                   "vienti.selite, vienti.kohdennus, vienti.eraid, tosite.laji, tosite.tunniste, "
+                   "(SELECT tosite.tunniste FROM %8 WHERE tosite.id=era.tosite), "
+                   "IFNULL(era.debetsnt,0) - IFNULL(era.kreditsnt,0), "
+                   "EXISTS (SELECT 1 FROM %6 WHERE liite.tosite=vienti.tosite), "
+                   "(SELECT GROUP_CONCAT(kohdennus.nimi, ', ') FROM %7 JOIN kohdennus "
+                   "ON kohdennus.id=merkkaus.kohdennus WHERE merkkaus.vienti=vienti.id), "
+                   "(SELECT tosite.laji FROM %8 WHERE tosite.id=era.tosite), era.pvm "
+                   "FROM %4 JOIN %5 ON vienti.tosite=tosite.id "
+                   "LEFT OUTER JOIN era ON era.id=vienti.eraid "
+                   "WHERE vienti.pvm BETWEEN \"%1\" AND \"%2\" "
+                   "AND vienti.tili IS NOT NULL %3"
+                   "ORDER BY vienti.pvm, vienti.id")
+                   .arg( alkaa.toString(Qt::ISODate ) )
+                   .arg( loppuu.toString(Qt::ISODate))
+                   .arg( rajaus )
+                   .arg( osiot.taulu("vienti", alkaa, loppuu))
+                   .arg( osiot.taulu("tosite", alkaa, loppuu))
+                   .arg( osiot.taulu("liite", alkaa, loppuu))
+                   .arg( osiot.taulu("merkkaus", alkaa, loppuu))
+                   .arg( osiot.taulu("tosite"));
+}
+
+void SelausRivit::lueRivi(const QSqlQuery &query)
+{
+    int eraId = query.value(8).toInt();
+    bool eraMaksettu = eraId && query.value(12).toLongLong() == 0;
+
+    lisaa( query.value(0).toInt(), query.value(1).toInt(), query.value(2).toDate(), query.value(3).toInt(),
+           query.value(4).toLongLong(), query.value(5).toLongLong(),
+           query.value(6).toString(), query.value(7).toInt(),
+           eraId, query.value(10).toInt(), query.value(9).toInt(),
+           query.value(11).toInt(), query.value(15).toInt(), query.value(16).toDate(),
+           query.value(14).toString(), query.value(13).toBool(), eraMaksettu );
+}
@@ -0,0 +1,144 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SELAUSRIVIT_H
+#define SELAUSRIVIT_H
+
+#include <QVector>
+#include <QStringList>
+#include <QHash>
+#include <QDate>
+#include <QMetaType>
+
+class QSqlQuery;
+class KausiOsiot;
+
+/**
+ * @brief SelausModel:in rivit (viennit) sarakkeittain
+ *
+ * Kunkin viennin tiedot ovat kaikissa vektoreissa samalla indeksillä.
+ * Tilit, kohdennukset ja tase-erät tallennetaan id:inä, päivämäärät
+ * päivänumeroina ja selitteet sekä merkkaukset tekstitaulukon indekseinä,
+ * jolloin samaa tekstiä ei tallenneta kahdesti. Tase-erän tositteen
+ * tunniste, laji ja erän päivämäärä tallennetaan, jotta erän viite
+ * voidaan muodostaa ilman kyselyä. Näytettävät tekstit muodostetaan
+ * vasta SelausModel::data():ssa.
+ *
+ * Rivit ovat päivämäärän ja viennin id:n mukaisessa järjestyksessä.
+ *
+ * Kysely ja rivin lukeminen eivät käytä kp():tä, joten rivit voidaan
+ * hakea myös taustasäikeessä ja testeissä pelkällä tietokannalla.
+ */
+class SelausRivit
+{
+public:
+    enum Liput
+    {
+        LIITTEITA = 0b01,
+        ERA_MAKSETTU = 0b10
+    };
+
+    SelausRivit();
+
+    int maara() const { return vienti.count(); }
+    void varaa(int maara);
+    void tyhjenna();
+
+    /**
+     * @brief Lisää rivin loppuun
+     */
+    void lisaa(int vientiId, int tositeId, const QDate& pvm, int tiliId, qlonglong debetSnt, qlonglong kreditSnt,
+               const QString& selite, int kohdennusId, int eraId, int tunniste, int lajiId,
+               int eraTunniste, int eraLajiId, const QDate& eraPvm,
+               const QString& tagit, bool liitteita, bool eraMaksettu);
+
+    /**
+     * @brief Lisää toisen taulukon rivin indeksin kohdalle
+     */
+    void lisaa(int indeksi, const SelausRivit& lahde, int rivi);
+
+    /**
+     * @brief Lisää toisen taulukon kaikki rivit loppuun
+     */
+    void lisaa(const SelausRivit& lahde);
+
+    void poista(int indeksi);
+
+    /**
+     * @brief Vientien hakukysely
+     * @param osiot Osiot, joiden tauluista viennit haetaan
+     * @param tositteet Jos annettu, haetaan vain näiden tositteiden viennit
+     * @param jalkeen Jos annettu, haetaan vain tämän rivin jälkeiset viennit
+     */
+    static QString kysymys(const KausiOsiot& osiot, const QDate& alkaa, const QDate& loppuu,
+                           const QList<int>& tositteet = QList<int>(), const SelausRivit* jalkeen = nullptr);
+
+    /**
+     * @brief Lukee kysymys()-kyselyn nykyisen rivin loppuun
+     *
+     * Erä merkitään maksetuksi saldon perusteella, ja tilin erittely
+     * tarkastetaan pääsäikeessä (SelausModel::tarkastaMaksetut()).
+     */
+    void lueRivi(const QSqlQuery& kysely);
+
+    /**
+     * @brief Indeksi, johon rivi lisätään järjestyksen säilyttämiseksi
+     */
+    int sijoituskohta(const SelausRivit& lahde, int rivi) const;
+
+    QDate pvm(int indeksi) const { return QDate::fromJulianDay( paiva.at(indeksi) ); }
+    QDate eraPvm(int indeksi) const { return QDate::fromJulianDay( eraPaiva.at(indeksi) ); }
+    const QString& teksti(int id) const { return tekstit_.at(id); }
+    const QString& selite(int indeksi) const { return tekstit_.at( seliteId.at(indeksi)); }
+    const QString& tagit(int indeksi) const { return tekstit_.at( tagitId.at(indeksi)); }
+
+    bool liitteita(int indeksi) const { return liput.at(indeksi) & LIITTEITA; }
+    bool eraMaksettu(int indeksi) const { return liput.at(indeksi) & ERA_MAKSETTU; }
+    void asetaEraMaksettu(int indeksi, bool maksettu);
+
+    /**
+     * @brief Rivien ja tekstien viemä muisti tavuina
+     */
+    qint64 muisti() const;
+
+    QVector<int> vienti;
+    QVector<int> tosite;
+    QVector<int> paiva;
+    QVector<int> tili;
+    QVector<qlonglong> debetSnt;
+    QVector<qlonglong> kreditSnt;
+    QVector<int> seliteId;
+    QVector<int> kohdennus;
+    QVector<int> era;
+    QVector<int> tunniste;
+    QVector<int> laji;
+    QVector<int> eraTunniste;
+    QVector<int> eraLaji;
+    QVector<int> eraPaiva;
+    QVector<int> tagitId;
+    QVector<quint8> liput;
+
+protected:
+    int tekstinId(const QString& teksti);
+
+    QStringList tekstit_;
+    QHash<QString,int> tekstiIdt_;
+};
+
+Q_DECLARE_METATYPE(SelausRivit)
+
+#endif // SELAUSRIVIT_H
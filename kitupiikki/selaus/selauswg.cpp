@@ -69,7 +69,10 @@ SelausWg::SelausWg() :
     ui->valintaTab->setCurrentIndex(0);     // Oletuksena tositteiden selaus
     connect( ui->valintaTab, SIGNAL(currentChanged(int)), this, SLOT(selaa(int)));
 
-    connect( Kirjanpito::db(), SIGNAL(kirjanpitoaMuokattu()), this, SLOT(paivita()));
+    connect( model, &SelausModel::ladattu, this, &SelausWg::lataamisValmis);
+    connect( tositeModel, &TositeSelausModel::ladattu, this, &SelausWg::lataamisValmis);
+
+    connect( kp(), &Kirjanpito::kirjanpitoMuuttui, this, &SelausWg::kirjanpitoMuuttui);
     connect( kp(), SIGNAL(tietokantaVaihtui()), this, SLOT(alusta()));
 
     connect( ui->alkuEdit, SIGNAL(dateChanged(QDate)), this, SLOT(alkuPvmMuuttui()));
@@ -100,45 +103,91 @@ void SelausWg::alusta()
     ui->alkuEdit->setDate(nytalkaa);
     ui->loppuEdit->setDate(nytloppuu);
 
+    paivitettava = true;
+
 }
 
 void SelausWg::paivita()
 {
-    bool lopussa = ui->selausView->verticalScrollBar()->value() >=
+    lopussa_ = ui->selausView->verticalScrollBar()->value() >=
             ui->selausView->verticalScrollBar()->maximum() - ui->selausView->verticalScrollBar()->pageStep();
+    valittu_ = ui->tiliCombo->currentText();
+    paivitettava = false;
 
+    // Rivit saapuvat taustasäikeestä, ja valinnat päivitetään ladattu()-signaalista
     if( ui->valintaTab->currentIndex() == 1 )
-    {
         model->lataa( ui->alkuEdit->date(), ui->loppuEdit->date());
+    else
+        tositeModel->lataa( ui->alkuEdit->date(), ui->loppuEdit->date());
+}
+
+void SelausWg::lataamisValmis()
+{
+    if( sender() != proxyModel->sourceModel())
+        return;
+
+    ui->tiliCombo->blockSignals(true);
+    ui->tiliCombo->clear();
+    if( ui->valintaTab->currentIndex() == 1 )
+    {
+        // Summat lasketaan kaikista vienneistä
+        while( model->canFetchMore(QModelIndex()))
+            model->fetchMore(QModelIndex());
 
-        QString valittu = ui->tiliCombo->currentText();
-        ui->tiliCombo->clear();
         ui->tiliCombo->insertItem(0, QIcon(":/pic/Possu64.png"),"Kaikki tilit", QVariant("*"));
         ui->tiliCombo->insertItems(1, model->kaytetytTilit());
-        ui->tiliCombo->setCurrentText(valittu);
-
     }
     else
     {
-        tositeModel->lataa( ui->alkuEdit->date(), ui->loppuEdit->date());
-
-        QString valittu = ui->tiliCombo->currentText();
-        ui->tiliCombo->clear();
         ui->tiliCombo->insertItem(0, QIcon(":/pic/Possu64.png"),"Kaikki tositteet", QVariant("*"));
         ui->tiliCombo->insertItems(1, tositeModel->lajiLista() );
-        ui->tiliCombo->setCurrentText(valittu);
-
     }
+    ui->tiliCombo->setCurrentText(valittu_);
+    ui->tiliCombo->blockSignals(false);
+    suodata();
 
     ui->selausView->resizeColumnsToContents();
-    paivitaSummat();
-    paivitettava = false;
 
-    if( lopussa )
+    if( lopussa_ )
         ui->selausView->verticalScrollBar()->setValue( ui->selausView->verticalScrollBar()->maximum() );
 
 }
 
+void SelausWg::kirjanpitoMuuttui(const KirjanpidonMuutos &muutos)
+{
+    // Piilossa olevaa sivua päivitetään vasta sille siirryttäessä
+    if( !isVisible())
+        odottavaMuutos.yhdista(muutos);
+    else
+        paivitaMuutos(muutos);
+}
+
+void SelausWg::paivitaMuutos(const KirjanpidonMuutos &muutos)
+{
+    if( !muutos.koskeeJaksoa( ui->alkuEdit->date(), ui->loppuEdit->date()) && !muutos.koskeeEria())
+        return;
+
+    QString valittu = ui->tiliCombo->currentText();
+    ui->tiliCombo->blockSignals(true);
+    ui->tiliCombo->clear();
+    if( ui->valintaTab->currentIndex() == 1 )
+    {
+        model->paivita(muutos);
+        ui->tiliCombo->insertItem(0, QIcon(":/pic/Possu64.png"),"Kaikki tilit", QVariant("*"));
+        ui->tiliCombo->insertItems(1, model->kaytetytTilit());
+    }
+    else
+    {
+        tositeModel->paivita(muutos);
+        ui->tiliCombo->insertItem(0, QIcon(":/pic/Possu64.png"),"Kaikki tositteet", QVariant("*"));
+        ui->tiliCombo->insertItems(1, tositeModel->lajiLista() );
+    }
+    ui->tiliCombo->setCurrentText(valittu);
+    ui->tiliCombo->blockSignals(false);
+
+    paivitaSummat();
+}
+
 void SelausWg::suodata()
 {
     if( ui->tiliCombo->currentData().toString() == "*")
@@ -208,9 +257,10 @@ void SelausWg::selaa(int tilinumero, const Tilikausi& tilikausi)
 
     paivita();
 
+    // Jos viennit haetaan taustalla, tili valitaan vasta haun valmistuttua
     Tili selattava = Kirjanpito::db()->tilit()->tiliNumerolla(tilinumero);
-
-    ui->tiliCombo->setCurrentText(QString("%1 %2").arg(selattava.numero() ).arg(selattava.nimi()));
+    valittu_ = QString("%1 %2").arg(selattava.numero() ).arg(selattava.nimi());
+    ui->tiliCombo->setCurrentText(valittu_);
 
 }
 
@@ -260,8 +310,18 @@ void SelausWg::selaa(int kumpi)
 
 void SelausWg::siirrySivulle()
 {
+    // Jo ladatusta selauksesta päivitetään vain poissa ollessa muuttuneet rivit
+    KirjanpidonMuutos muutos = odottavaMuutos;
+    odottavaMuutos = KirjanpidonMuutos();
 
-    selaa( ui->valintaTab->currentIndex() );
+    if( paivitettava )
+        selaa( ui->valintaTab->currentIndex() );
+    else
+    {
+        if( !muutos.onkoTyhja())
+            paivitaMuutos(muutos);
+        ui->selausView->setFocus();
+    }
 }
 
 bool SelausWg::eventFilter(QObject *watched, QEvent *event)
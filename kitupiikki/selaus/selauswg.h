@@ -27,6 +27,7 @@
 
 #include "ui_selauswg.h"
 #include "db/tilikausi.h"
+#include "db/kirjanpidonmuutos.h"
 
 #include "kitupiikkisivu.h"
 
@@ -52,8 +53,19 @@ public:
 public slots:
     void alusta();
     void paivita();
+
+    /**
+     * @brief Päivittää näytetyistä riveistä vain muuttuneet
+     */
+    void kirjanpitoMuuttui(const KirjanpidonMuutos& muutos);
+
     void suodata();
     void paivitaSummat();
+
+    /**
+     * @brief Päivittää tilivalinnan ja summat, kun selauksen rivit on haettu
+     */
+    void lataamisValmis();
     void naytaTositeRivilta(QModelIndex index);
 
     void selaa(int tilinumero, const Tilikausi &tilikausi);
@@ -94,6 +106,22 @@ private:
      */
     bool paivitettava = true;
 
+    /**
+     * @brief Oliko näkymä vieritetty loppuun, kun lataaminen aloitettiin
+     */
+    bool lopussa_ = false;
+    /**
+     * @brief Lataamisen jälkeen valittava tili tai tositelaji
+     */
+    QString valittu_;
+
+    /**
+     * @brief Sivun ollessa piilossa kertyneet muutokset
+     */
+    KirjanpidonMuutos odottavaMuutos;
+
+    void paivitaMuutos(const KirjanpidonMuutos& muutos);
+
 };
 
 #endif // SELAUSWG_H
@@ -19,18 +19,58 @@
 
 #include <QDebug>
 #include <QSqlError>
+#include <QTimer>
+#include <algorithm>
 
 #include "tositeselausmodel.h"
+#include "selaushakija.h"
 #include "db/kirjanpito.h"
 
+/**
+ * @brief Tositteiden haku taustasäikeessä
+ */
+class TositeHakija : public SelausHakija
+{
+public:
+    using SelausHakija::SelausHakija;
+
+protected:
+    void lue(const QSqlQuery &kysely) override
+    {
+        rivit_.append( TositeSelausModel::lueRivi(kysely) );
+    }
+
+    QVariant otaEra() override
+    {
+        QVariant era = QVariant::fromValue(rivit_);
+        rivit_.clear();
+        return era;
+    }
+
+    QList<TositeSelausRivi> rivit_;
+};
+
 TositeSelausModel::TositeSelausModel()
 {
+    viipaleAjastin_ = new QTimer(this);
+    viipaleAjastin_->setSingleShot(true);
+    connect( viipaleAjastin_, &QTimer::timeout, this, &TositeSelausModel::haeViipale);
+}
+
+TositeSelausModel::~TositeSelausModel()
+{
+    // Kesken oleva haku päättyy itsestään
+    keskeytaHaku();
+}
 
+bool TositeSelausModel::lataamassa() const
+{
+    return hakija_ || viipaleAjastin_->isActive();
 }
 
 int TositeSelausModel::rowCount(const QModelIndex & /* parent */) const
 {
-    return rivit.count();
+    return naytetty_;
 }
 
 int TositeSelausModel::columnCount(const QModelIndex & /* parent */) const
@@ -75,27 +115,13 @@ QVariant TositeSelausModel::data(const QModelIndex &index, int role) const
         {
 
         case TUNNISTE:
-            if( role == Qt::EditRole) {
-                // Lajittelua varten tasaleveä kenttä
-                if( kp()->asetukset()->onko("Samaansarjaan"))
-                    return QVariant(QString("%1/%2")
-                           .arg( rivi.tositeTunniste,8,10,QChar('0'))
-                           .arg( kp()->tilikaudet()->tilikausiPaivalle(rivi.pvm).kausitunnus() ));
-                else
-                     return QVariant(QString("%1%2/%3")
-                            .arg( kp()->tositelajit()->tositelaji( rivi.tositeLaji ).tunnus() )
-                            .arg( rivi.tositeTunniste,8,10,QChar('0'))
-                            .arg( kp()->tilikaudet()->tilikausiPaivalle(rivi.pvm).kausitunnus() ));
-             }
-            if( kp()->asetukset()->onko("Samaansarjaan"))
-                return QVariant(QString("%1/%2")
-                    .arg( rivi.tositeTunniste)
-                    .arg( kp()->tilikaudet()->tilikausiPaivalle(rivi.pvm).kausitunnus() ));
-            else
-                return QVariant(QString("%1 %2/%3")
-                    .arg( kp()->tositelajit()->tositelaji( rivi.tositeLaji ).tunnus() )
-                    .arg( rivi.tositeTunniste)
-                    .arg( kp()->tilikaudet()->tilikausiPaivalle(rivi.pvm).kausitunnus() ));
+        {
+            // Lajittelua varten EditRolessa tasaleveä kenttä
+            QString lajitunnus = kp()->asetukset()->kuva().samaanSarjaan ? QString()
+                                  : kp()->tositelajit()->tositelaji( rivi.tositeLaji ).tunnus();
+            return kp()->tilikaudet()->tositetunniste( rivi.tositeTunniste, rivi.pvm, lajitunnus,
+                                                       role == Qt::EditRole );
+        }
         case PVM:
             if( role == Qt::DisplayRole)
                 return QVariant( rivi.pvm );
@@ -148,62 +174,226 @@ QVariant TositeSelausModel::data(const QModelIndex &index, int role) const
 
 
 
+bool TositeSelausModel::canFetchMore(const QModelIndex & /* parent */) const
+{
+    return naytetty_ < rivit.count() || lataamassa();
+}
+
+void TositeSelausModel::fetchMore(const QModelIndex & /* parent */)
+{
+    if( naytetty_ == rivit.count())
+    {
+        // Näytetään seuraavat rivit heti niiden saavuttua
+        odottaaLisaa_ = true;
+        return;
+    }
+
+    int lisattavia = qMin( rivit.count() - naytetty_, SelausHakija::ERA );
+    beginInsertRows(QModelIndex(), naytetty_, naytetty_ + lisattavia - 1);
+    naytetty_ += lisattavia;
+    odottaaLisaa_ = false;
+    endInsertRows();
+}
+
 void TositeSelausModel::lataa(const QDate &alkaa, const QDate &loppuu)
 {
-    QString kysymys = QString("SELECT tosite.id, tosite.pvm, tosite.otsikko, laji, tunniste, liite.id "
-                              "FROM tosite LEFT OUTER JOIN liite ON tosite.id=liite.tosite "
-                              "WHERE tosite.pvm BETWEEN \"%1\" AND \"%2\" "
-                              "ORDER BY tosite.pvm, tosite.id ")
-            .arg(alkaa.toString(Qt::ISODate)).arg(loppuu.toString(Qt::ISODate)) ;
+    alkaa_ = alkaa;
+    loppuu_ = loppuu;
+    keskeytaHaku();
 
     beginResetModel();
-
+    naytetty_ = 0;
+    odottaaLisaa_ = false;
     rivit.clear();
-    kaytetytLajinimet.clear();
 
-    QSqlQuery kysely;
-    kysely.exec(kysymys);
-    int edellinenId = -1;
+    // Ilman WAL-tilaa taustasäikeellä ei ole omaa yhteyttä
+    if( kp()->onkoWal())
+    {
+        hakija_ = new TositeHakija( kysymys(), this);
+        connect( hakija_, &SelausHakija::rivejaSaatu, this, &TositeSelausModel::rivejaSaatu);
+        connect( hakija_, &SelausHakija::finished, this, &TositeSelausModel::hakuValmis);
+        hakija_->start();
+    }
+    paivitaLajilista();
+    endResetModel();
+
+    if( !hakija_ )
+        haeViipale();
+}
+
+void TositeSelausModel::rivejaSaatu(const QVariant &saadut)
+{
+    // Keskeytetyn haun jo lähetetyt erät ohitetaan
+    if( !hakija_ || sender() != hakija_ )
+        return;
+
+    lisaaRivit( saadut.value<QList<TositeSelausRivi>>() );
+}
 
+void TositeSelausModel::haeViipale()
+{
+    // Ensimmäinen viipale on sivullinen, jotta näkymä saadaan heti esiin
+    const int koko = rivit.isEmpty() ? SelausHakija::ENSIMMAINEN_ERA : SelausHakija::ERA;
+
+    // Jatketaan järjestyksessä viimeisen tositteen jälkeen
+    QString jatko;
+    if( !rivit.isEmpty())
+        jatko = QString("AND tosite.pvm >= \"%1\" AND (tosite.pvm > \"%1\" OR tosite.id > %2) ")
+                .arg( rivit.last().pvm.toString(Qt::ISODate))
+                .arg( rivit.last().tositeId );
+
+    QList<TositeSelausRivi> uudet;
+    QSqlQuery kysely( *kp()->tietokanta() );
+    kysely.setForwardOnly(true);
+    kysely.exec( kysymys(jatko) + QString(" LIMIT %1").arg(koko) );
     while( kysely.next())
+        uudet.append( lueRivi(kysely) );
+
+    lisaaRivit(uudet);
+
+    if( uudet.count() < koko )
     {
-        if( kysely.value(0).toInt() == edellinenId)
-            continue;   // Jotta tosite ei toistu
-
-        TositeSelausRivi rivi;
-        rivi.tositeId = kysely.value(0).toInt();
-        rivi.pvm = kysely.value(1).toDate();
-        rivi.otsikko = kysely.value(2).toString();
-        rivi.tositeLaji = kysely.value(3).toInt();
-        rivi.tositeTunniste = kysely.value(4).toInt();
-        rivi.liitteita = !kysely.value(5).isNull();
-
-        edellinenId = rivi.tositeId;
-
-        // #138 Jotta viennittömät kirjaukset näytettäisiin, kysellään summat erikseen
-        QSqlQuery summakysely( QString("SELECT sum(debetsnt), sum(kreditsnt) FROM vienti WHERE tosite=%1").arg(rivi.tositeId));
-        if( summakysely.next())
-        {
-            qlonglong debet = summakysely.value(0).toLongLong();
-            qlonglong kredit = summakysely.value(1).toLongLong();
+        paivitaLajilista();
+        emit ladattu();
+    }
+    else
+        viipaleAjastin_->start();
+}
+
+void TositeSelausModel::lisaaRivit(const QList<TositeSelausRivi> &uudet)
+{
+    rivit.append( uudet );
+    if( naytetty_ == 0 || odottaaLisaa_ )
+        fetchMore(QModelIndex());
+}
+
+void TositeSelausModel::hakuValmis()
+{
+    if( !hakija_ || sender() != hakija_ )
+        return;
+
+    hakija_->deleteLater();
+    hakija_ = nullptr;
+    paivitaLajilista();
+    emit ladattu();
+}
+
+void TositeSelausModel::keskeytaHaku()
+{
+    viipaleAjastin_->stop();
+    if( !hakija_ )
+        return;
+
+    hakija_->irrota();
+    hakija_ = nullptr;
+}
+
+void TositeSelausModel::paivita(const KirjanpidonMuutos &muutos)
+{
+    // Kesken olevan haun tulokset voivat olla jo vanhentuneita
+    if( muutos.onkoKaikki() || lataamassa() )
+    {
+        lataa(alkaa_, loppuu_);
+        return;
+    }
+    if( muutos.tositteet().isEmpty())
+        return;
 
-            // Yleensä kreditin ja debetin pitäisi täsmätä ;)
-            if( debet > kredit)
-                rivi.summa = debet;
+    // Vielä näyttämättömät rivit muutetaan ilman näkymälle ilmoittamista
+    QSet<int> tositteet = muutos.tositteet();
+    for(int i = rivit.count() - 1; i >= 0; i--)
+    {
+        if( tositteet.contains( rivit.at(i).tositeId ))
+        {
+            if( i < naytetty_ )
+            {
+                beginRemoveRows(QModelIndex(), i, i);
+                rivit.removeAt(i);
+                naytetty_--;
+                endRemoveRows();
+            }
             else
-                rivi.summa = kredit;
+                rivit.removeAt(i);
+        }
+    }
+
+    QStringList idt;
+    for(int id : tositteet)
+        idt.append( QString::number(id));
+
+    for( const TositeSelausRivi& uusi : haeRivit( QString("AND tosite.id IN (%1) ").arg(idt.join(','))))
+    {
+        auto paikka = std::upper_bound( rivit.begin(), rivit.end(), uusi,
+                                        [] (const TositeSelausRivi& a, const TositeSelausRivi& b)
+                    { return a.pvm < b.pvm || ( a.pvm == b.pvm && a.tositeId < b.tositeId ); });
+        int indeksi = static_cast<int>( paikka - rivit.begin() );
+        if( indeksi < naytetty_ || naytetty_ == rivit.count() )
+        {
+            beginInsertRows(QModelIndex(), indeksi, indeksi);
+            rivit.insert(indeksi, uusi);
+            naytetty_++;
+            endInsertRows();
         }
+        else
+            rivit.insert(indeksi, uusi);
+    }
+
+    paivitaLajilista();
+}
+
+QList<TositeSelausRivi> TositeSelausModel::haeRivit(const QString &rajaus) const
+{
+    QList<TositeSelausRivi> lista;
+
+    QSqlQuery kysely( *kp()->tietokanta() );
+    kysely.setForwardOnly(true);
+    kysely.exec( kysymys(rajaus) );
+    while( kysely.next())
+        lista.append( lueRivi(kysely) );
+
+    return lista;
+}
+
+QString TositeSelausModel::kysymys(const QString &rajaus) const
+{
+    // #138 Viennittömätkin tositteet näytetään, joten summa lasketaan alikyselyllä.
+    // Yleensä kreditin ja debetin pitäisi täsmätä ;)
+    return QString("SELECT tosite.id, tosite.pvm, tosite.otsikko, tosite.laji, tosite.tunniste, "
+                   "EXISTS (SELECT 1 FROM %5 WHERE liite.tosite=tosite.id), "
+                   "(SELECT MAX(IFNULL(SUM(debetsnt),0), IFNULL(SUM(kreditsnt),0)) FROM %6 WHERE vienti.tosite=tosite.id) "
+                   "FROM %4 "
+                   "WHERE tosite.pvm BETWEEN \"%1\" AND \"%2\" %3"
+                   "ORDER BY tosite.pvm, tosite.id ")
+            .arg(alkaa_.toString(Qt::ISODate)).arg(loppuu_.toString(Qt::ISODate)).arg(rajaus)
+            .arg( kp()->osiot()->taulu("tosite", alkaa_, loppuu_))
+            .arg( kp()->osiot()->taulu("liite", alkaa_, loppuu_))
+            .arg( kp()->osiot()->taulu("vienti", alkaa_, loppuu_));
+}
 
-        rivit.append(rivi);
+TositeSelausRivi TositeSelausModel::lueRivi(const QSqlQuery &kysely)
+{
+    TositeSelausRivi rivi;
+    rivi.tositeId = kysely.value(0).toInt();
+    rivi.pvm = kysely.value(1).toDate();
+    rivi.otsikko = kysely.value(2).toString();
+    rivi.tositeLaji = kysely.value(3).toInt();
+    rivi.tositeTunniste = kysely.value(4).toInt();
+    rivi.liitteita = kysely.value(5).toBool();
+    rivi.summa = kysely.value(6).toLongLong();
+    return rivi;
+}
 
-        // Listalla käytettyjen lajien tunnukset
+void TositeSelausModel::paivitaLajilista()
+{
+    kaytetytLajinimet.clear();
+
+    // Listalla käytettyjen lajien tunnukset
+    for( const TositeSelausRivi& rivi : rivit)
+    {
         QString tositelajinimi = kp()->tositelajit()->tositelaji( rivi.tositeLaji ).nimi();
         if( !kaytetytLajinimet.contains(tositelajinimi))
             kaytetytLajinimet.append(tositelajinimi);
-
     }
 
     kaytetytLajinimet.sort();
-    endResetModel();
-
 }
@@ -22,6 +22,8 @@
 #include <QDate>
 #include <QList>
 
+#include "db/kirjanpidonmuutos.h"
+
 /**
  * @brief Yhden tositteen tiedot tositteiden selauksessa
  */
@@ -39,11 +41,22 @@ struct TositeSelausRivi
 
 };
 
+Q_DECLARE_METATYPE(TositeSelausRivi)
+
+class SelausHakija;
+class QSqlQuery;
+class QTimer;
+
 /**
  * @brief Tositteiden selauksen model
+ *
+ * Kuten SelausModel, WAL-tilassa tositteet haetaan taustasäikeessä ja
+ * muuten pääsäikeessä viipaleina tapahtumasilmukasta. Ne tuodaan
+ * näkymään fetchMore():lla.
  */
 class TositeSelausModel : public QAbstractTableModel
 {
+    Q_OBJECT
 public:
     enum Sarake
     {
@@ -57,6 +70,7 @@ public:
     };
 
     TositeSelausModel();
+    ~TositeSelausModel() override;
 
     int rowCount(const QModelIndex &parent) const;
     int columnCount(const QModelIndex &parent) const;
@@ -64,15 +78,65 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role) const;
     QVariant data(const QModelIndex &index, int role) const;
 
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    /**
+     * @brief Onko haku kesken
+     */
+    bool lataamassa() const;
+
     QStringList lajiLista() const { return kaytetytLajinimet; }
 
+    static TositeSelausRivi lueRivi(const QSqlQuery& kysely);
+
+signals:
+    /**
+     * @brief Kaikki aikavälin tositteet on haettu
+     */
+    void ladattu();
+
 public slots:
     void lataa(const QDate& alkaa, const QDate& loppuu);
 
+    /**
+     * @brief Hakee uudelleen vain muutoksen koskemat tositteet
+     */
+    void paivita(const KirjanpidonMuutos& muutos);
+
+protected slots:
+    void rivejaSaatu(const QVariant& rivit);
+    void hakuValmis();
+
+    /**
+     * @brief Hakee pääsäikeessä seuraavan erän tositteita jo haettujen jälkeen
+     */
+    void haeViipale();
+
 protected:
+    void lisaaRivit(const QList<TositeSelausRivi>& uudet);
+    /**
+     * @brief Hakee aikavälin tositteet
+     * @param rajaus Lisäehto kyselyyn, esim. "AND tosite.id IN (1,2)"
+     */
+    QList<TositeSelausRivi> haeRivit(const QString& rajaus = QString()) const;
+    QString kysymys(const QString& rajaus = QString()) const;
+    void paivitaLajilista();
+    void keskeytaHaku();
+
+    QDate alkaa_;
+    QDate loppuu_;
     QList<TositeSelausRivi> rivit;
     QStringList kaytetytLajinimet;
 
+    /**
+     * @brief Näkymälle näytettyjen rivien määrä, loput odottavat fetchMore():a
+     */
+    int naytetty_ = 0;
+    bool odottaaLisaa_ = false;
+    SelausHakija *hakija_ = nullptr;
+    QTimer *viipaleAjastin_;
+
 };
 
 #endif // TOSITESELAUSMODEL_H
@@ -16,12 +16,22 @@
 */
 
 #include <QSettings>
+#include <QElapsedTimer>
+#include <QSortFilterProxyModel>
+#include <QFileDialog>
+#include <QDir>
+#include <QMessageBox>
+#include <QApplication>
 
 #include "devtool.h"
 #include "ui_devtool.h"
 
 #include "db/kirjanpito.h"
+#include "db/saldotaulu.h"
+#include "db/erataulu.h"
 #include "uusikp/skripti.h"
+#include "db/kyselyloki.h"
+#include "kyselylokimodel.h"
 
 DevTool::DevTool(QWidget *parent) :
     QDialog(parent),
@@ -40,6 +50,23 @@ DevTool::DevTool(QWidget *parent) :
 
     connect( ui->tabWidget, SIGNAL(currentChanged(int)), this, SLOT(tabMuuttui(int)));
 
+    connect( ui->saldoTarkastaNappi, SIGNAL(clicked(bool)), this, SLOT(tarkastaSaldot()));
+    connect( ui->saldoRakennaNappi, SIGNAL(clicked(bool)), this, SLOT(rakennaSaldot()));
+    connect( ui->liiteSiirtoNappi, SIGNAL(clicked(bool)), this, SLOT(siirraLiitteet()));
+    connect( ui->osioNappi, SIGNAL(clicked(bool)), this, SLOT(erotaKaudet()));
+
+    kyselyLoki_ = new KyselyLokiModel(this);
+    QSortFilterProxyModel *kyselyProxy = new QSortFilterProxyModel(this);
+    kyselyProxy->setSourceModel(kyselyLoki_);
+    ui->kyselyView->setModel(kyselyProxy);
+    ui->kirjaaKyselytCheck->setChecked( KyselyLoki::kaytossa() );
+    kyselyLoki_->lataa();
+
+    connect( ui->kirjaaKyselytCheck, SIGNAL(toggled(bool)), this, SLOT(kirjaaKyselyt(bool)));
+    connect( ui->kyselytPaivitaNappi, SIGNAL(clicked(bool)), kyselyLoki_, SLOT(lataa()));
+    connect( ui->kyselytTyhjennaNappi, SIGNAL(clicked(bool)), this, SLOT(tyhjennaKyselyt()));
+    connect( ui->kyselytCsvNappi, SIGNAL(clicked(bool)), this, SLOT(vieKyselyt()));
+
     connect( kp(), &Kirjanpito::tietokantavirhe, [this]() { this->ui->lokiBrowser->setPlainText( kp()->virheloki().join('\n') ); } );
 
     ui->avainLista->setCurrentRow(0);
@@ -111,6 +138,143 @@ void DevTool::tabMuuttui(int tab)
     }
 }
 
+void DevTool::tarkastaSaldot()
+{
+    QElapsedTimer ajastin;
+    ajastin.start();
+
+    int saldovirheita = SaldoTaulu::tarkasta( *kp()->tietokanta() );
+    int eravirheita = EraTaulu::tarkasta( *kp()->tietokanta() );
+
+    if( saldovirheita < 0 || eravirheita < 0)
+        yllapitoLokiin( tr("Saldojen tarkastaminen epäonnistui: %1").arg( kp()->viimeVirhe()));
+    else if( saldovirheita || eravirheita )
+        yllapitoLokiin( tr("Saldotaulussa %1 ja erätaulussa %2 virheellistä riviä (%3 ms)")
+                        .arg(saldovirheita).arg(eravirheita).arg(ajastin.elapsed()));
+    else
+        yllapitoLokiin( tr("Saldot ja tase-erät täsmäävät vientien kanssa (%1 ms)").arg(ajastin.elapsed()));
+}
+
+void DevTool::rakennaSaldot()
+{
+    QElapsedTimer ajastin;
+    ajastin.start();
+
+    if( SaldoTaulu::rakenna( *kp()->tietokanta() ) && EraTaulu::rakenna( *kp()->tietokanta()) )
+    {
+        yllapitoLokiin( tr("Saldot ja tase-erät laskettu uudelleen (%1 ms)").arg(ajastin.elapsed()));
+        kp()->ilmoitaMuutos( KirjanpidonMuutos::kaikki() );
+    }
+    else
+        yllapitoLokiin( tr("Saldojen laskeminen epäonnistui: %1").arg( kp()->viimeVirhe()));
+}
+
+void DevTool::siirraLiitteet()
+{
+    LiiteVarasto *varasto = kp()->liitevarasto();
+    if( QMessageBox::question(this, tr("Liitteiden siirtäminen"),
+                              tr("Liitteet siirretään tietokannasta hakemistoon %1, ja myös "
+                                 "uudet liitteet tallennetaan sinne.\n\n"
+                                 "Hakemisto on jatkossa varmuuskopioitava ja siirrettävä "
+                                 "yhdessä kirjanpitotiedoston kanssa.\n\n"
+                                 "Siirretäänkö liitteet?").arg( QDir::toNativeSeparators(varasto->hakemisto())))
+            != QMessageBox::Yes)
+        return;
+
+    QElapsedTimer ajastin;
+    ajastin.start();
+
+    kp()->asetukset()->aseta("LiitteetErillaan", true);
+    int siirretty = varasto->siirra( *kp()->tietokanta(), [] (int, int) { qApp->processEvents(); } );
+    if( siirretty < 0)
+    {
+        yllapitoLokiin( tr("Liitteiden siirtäminen epäonnistui: %1").arg( kp()->viimeVirhe()));
+        return;
+    }
+
+    // Tietokantatiedosto pienenee vasta, kun vapautunut tila tiivistetään
+    kp()->tietokanta()->exec("VACUUM");
+    yllapitoLokiin( tr("%1 liitettä siirretty hakemistoon %2 (%3 ms)")
+                    .arg(siirretty)
+                    .arg( QDir::toNativeSeparators(varasto->hakemisto()))
+                    .arg(ajastin.elapsed()));
+}
+
+void DevTool::erotaKaudet()
+{
+    QDate paatetty = kp()->asetukset()->pvm("TilitPaatetty");
+    QList<Tilikausi> erotettavat;
+    for(int i=0; i < kp()->tilikaudet()->rowCount(QModelIndex()); i++)
+    {
+        Tilikausi kausi = kp()->tilikaudet()->tilikausiIndeksilla(i);
+        if( kausi.paattyy() <= paatetty && !kp()->osiot()->onkoOsioitu(kausi))
+            erotettavat.append(kausi);
+    }
+
+    if( erotettavat.isEmpty())
+    {
+        yllapitoLokiin( tr("Ei erotettavia päätettyjä tilikausia"));
+        return;
+    }
+
+    if( QMessageBox::question(this, tr("Tilikausien erottaminen"),
+                              tr("%1 päätetyn tilikauden tositteet siirretään kirjanpitotiedoston "
+                                 "viereen omiin tiedostoihinsa.\n\n"
+                                 "Tiedostot on jatkossa varmuuskopioitava ja siirrettävä "
+                                 "yhdessä kirjanpitotiedoston kanssa, eikä erotettujen kausien "
+                                 "lukitusta voi enää perua.\n\n"
+                                 "Erotetaanko tilikaudet?").arg(erotettavat.count()))
+            != QMessageBox::Yes)
+        return;
+
+    QElapsedTimer ajastin;
+    ajastin.start();
+
+    for( const Tilikausi& kausi : erotettavat)
+    {
+        if( !kp()->osiot()->erota( *kp()->tietokanta(), kausi))
+        {
+            yllapitoLokiin( tr("Tilikauden %1 erottaminen epäonnistui: %2")
+                            .arg(kausi.kausivaliTekstina()).arg( kp()->viimeVirhe()));
+            break;
+        }
+        yllapitoLokiin( tr("Tilikausi %1 erotettu").arg(kausi.kausivaliTekstina()));
+        qApp->processEvents();
+    }
+
+    kp()->tietokanta()->exec("VACUUM");
+    kp()->ilmoitaMuutos( KirjanpidonMuutos::kaikki() );
+    yllapitoLokiin( tr("Tilikausien erottaminen valmis (%1 ms)").arg(ajastin.elapsed()));
+}
+
+void DevTool::kirjaaKyselyt(bool kirjataanko)
+{
+    KyselyLoki::asetaKaytossa(kirjataanko);
+    kyselyLoki_->lataa();
+}
+
+void DevTool::tyhjennaKyselyt()
+{
+    KyselyLoki::tyhjenna();
+    kyselyLoki_->lataa();
+}
+
+void DevTool::vieKyselyt()
+{
+    kyselyLoki_->lataa();
+    QString tiedosto = QFileDialog::getSaveFileName(this, tr("Vie kyselyloki"), QDir::homePath(), tr("CSV-tiedosto (*.csv)"));
+    if( !tiedosto.isEmpty() && !kyselyLoki_->vieCsv(tiedosto))
+        QMessageBox::critical(this, tr("Tiedoston kirjoittaminen epäonnistui"),
+                              tr("Kyselylokin kirjoittaminen tiedostoon %1 epäonnistui.").arg(tiedosto));
+}
+
+void DevTool::yllapitoLokiin(const QString &teksti)
+{
+    ui->yllapitoBrowser->append( QString("%1 %2")
+                                 .arg( QTime::currentTime().toString("hh:mm:ss"))
+                                 .arg( teksti ));
+}
+
 void DevTool::uusiPeli()
 {
     ui->tulosLabel->clear();
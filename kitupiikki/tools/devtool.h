@@ -26,6 +26,8 @@ namespace Ui {
 class DevTool;
 }
 
+class KyselyLokiModel;
+
 /**
  * @brief Kehittäjän työkaluja
  */
@@ -46,6 +48,15 @@ protected slots:
     void uusiPeli();
     void peliNapautus(int ruutu);
 
+    void tarkastaSaldot();
+    void rakennaSaldot();
+    void siirraLiitteet();
+    void erotaKaudet();
+
+    void kirjaaKyselyt(bool kirjataanko);
+    void tyhjennaKyselyt();
+    void vieKyselyt();
+
 protected:
     /**
      * @brief Tarkastaa voiton ja ilmoittaa tuloksen
@@ -59,12 +70,19 @@ protected:
     int voitonTarkastaja(const QVector<int> &taulu);
     int voittajaRivilla(const QVector<int> &taulu, int a, int b, int c) const;
 
+    /**
+     * @brief Lisää rivin ylläpitotoimien lokiin
+     */
+    void yllapitoLokiin(const QString& teksti);
+
 protected:
     void alustaRistinolla();
     QMap<int,QPushButton*> pelinapit_;
     QVector<int> peliRuudut_;
     bool pelissa_ = true;
 
+    KyselyLokiModel *kyselyLoki_;
+
 
 private:
     Ui::DevTool *ui;
@@ -0,0 +1,145 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "kyselylokimodel.h"
+#include "db/kirjanpito.h"
+
+#include <QFile>
+#include <QBrush>
+#include <QColor>
+
+KyselyLokiModel::KyselyLokiModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+
+}
+
+int KyselyLokiModel::rowCount(const QModelIndex & /* parent */) const
+{
+    return merkinnat_.count();
+}
+
+int KyselyLokiModel::columnCount(const QModelIndex & /* parent */) const
+{
+    return 8;
+}
+
+QVariant KyselyLokiModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if( role == Qt::DisplayRole && orientation == Qt::Horizontal)
+    {
+        switch (section) {
+        case TOIMINTO: return tr("Toiminto");
+        case AIKA: return tr("Aika");
+        case KESTO: return tr("Kesto µs");
+        case RIVIT: return tr("Rivit");
+        case TOISTOT: return tr("Toistot");
+        case SAIE: return tr("Säie");
+        case LAUSE: return tr("Kysely");
+        case ARVOT: return tr("Arvot");
+        }
+    }
+    return QVariant();
+}
+
+QVariant KyselyLokiModel::data(const QModelIndex &index, int role) const
+{
+    if( !index.isValid())
+        return QVariant();
+
+    const KyselyLoki::Merkinta& merkinta = merkinnat_.at(index.row());
+
+    if( role == Qt::DisplayRole || role == Qt::EditRole)
+    {
+        // Lukusarakkeet palautetaan lukuina, jotta lajittelu toimii
+        switch (index.column()) {
+        case TOIMINTO: return merkinta.toiminto;
+        case AIKA: return merkinta.aika.time().toString("hh:mm:ss.zzz");
+        case KESTO: return merkinta.kestoUs;
+        case RIVIT: return merkinta.rivit;
+        case TOISTOT: return toistot_.at(index.row());
+        case SAIE: return merkinta.saie;
+        case LAUSE: return merkinta.lause.simplified();
+        case ARVOT: return merkinta.arvot;
+        }
+    }
+    else if( role == Qt::ToolTipRole && index.column() == LAUSE)
+        return merkinta.muoto;
+    else if( role == Qt::TextAlignmentRole && index.column() >= KESTO && index.column() <= TOISTOT)
+        return QVariant( Qt::AlignRight | Qt::AlignVCenter);
+    else if( role == Qt::BackgroundRole && toistot_.at(index.row()) >= TOISTORAJA)
+        return QBrush( QColor(255, 220, 220));
+
+    return QVariant();
+}
+
+bool KyselyLokiModel::vieCsv(const QString &tiedostonnimi) const
+{
+    QChar erotin = kp()->settings()->value("CsvErotin", QChar(',')).toChar();
+
+    QStringList rivit;
+    QStringList otsikot;
+    for(int sarake = 0; sarake < columnCount(); sarake++)
+        otsikot.append( headerData(sarake, Qt::Horizontal, Qt::DisplayRole).toString());
+    rivit.append( otsikot.join(erotin));
+
+    for(int rivi = 0; rivi < rowCount(); rivi++)
+    {
+        QStringList sarakkeet;
+        for(int sarake = 0; sarake < columnCount(); sarake++)
+        {
+            QString arvo = teksti(rivi, sarake);
+            if( arvo.contains(erotin) || arvo.contains('"') || arvo.contains('\n'))
+                arvo = QString("\"%1\"").arg( arvo.replace("\"","\"\""));
+            sarakkeet.append(arvo);
+        }
+        rivit.append( sarakkeet.join(erotin));
+    }
+
+    QFile tiedosto(tiedostonnimi);
+    if( !tiedosto.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QString txt = rivit.join("\r\n");
+    if( kp()->settings()->value("CsvKoodaus").toString() == "latin1")
+        tiedosto.write( txt.toLatin1() );
+    else
+        tiedosto.write( txt.toUtf8() );
+    return true;
+}
+
+void KyselyLokiModel::lataa()
+{
+    beginResetModel();
+    merkinnat_ = KyselyLoki::merkinnat();
+
+    // Saman muotoisten kyselyjen määrä toiminnoittain
+    QHash<QString,int> maarat;
+    for( const KyselyLoki::Merkinta& merkinta : merkinnat_)
+        maarat[ QString("%1/%2/%3").arg(merkinta.toiminto).arg(merkinta.saie).arg(merkinta.muoto) ] += 1;
+
+    toistot_.clear();
+    for( const KyselyLoki::Merkinta& merkinta : merkinnat_)
+        toistot_.append( maarat.value( QString("%1/%2/%3").arg(merkinta.toiminto).arg(merkinta.saie).arg(merkinta.muoto) ));
+
+    endResetModel();
+}
+
+QString KyselyLokiModel::teksti(int rivi, int sarake) const
+{
+    return data( index(rivi, sarake), Qt::DisplayRole).toString();
+}
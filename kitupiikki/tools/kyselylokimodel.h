@@ -0,0 +1,70 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KYSELYLOKIMODEL_H
+#define KYSELYLOKIMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+
+#include "db/kyselyloki.h"
+
+/**
+ * @brief Kyselylokin merkinnät kehittäjän työkalujen taulukossa
+ *
+ * Kullekin merkinnälle lasketaan, montako kertaa saman muotoinen kysely
+ * suoritettiin samassa toiminnossa ja säikeessä. Toistuvat kyselyt
+ * korostetaan, koska ne ovat yleensä N+1-kyselyjä.
+ */
+class KyselyLokiModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Sarake { TOIMINTO, AIKA, KESTO, RIVIT, TOISTOT, SAIE, LAUSE, ARVOT };
+
+    /**
+     * @brief Toistomäärä, josta alkaen kysely korostetaan
+     */
+    static const int TOISTORAJA = 10;
+
+    KyselyLokiModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+
+    /**
+     * @brief Kirjoittaa merkinnät csv-muodossa
+     * @return tosi, jos onnistui
+     */
+    bool vieCsv(const QString& tiedostonnimi) const;
+
+public slots:
+    /**
+     * @brief Lukee lokin merkinnät uudelleen
+     */
+    void lataa();
+
+protected:
+    QString teksti(int rivi, int sarake) const;
+
+    QList<KyselyLoki::Merkinta> merkinnat_;
+    QList<int> toistot_;
+};
+
+#endif // KYSELYLOKIMODEL_H
@@ -219,8 +219,9 @@ void Tuonti::oterivi(QDate pvm, qlonglong sentit, const QString& iban, QString v
     // Tuplatuonnin esto
     if(!arkistotunnus.isEmpty())
     {
-    QSqlQuery tupla( QString("SELECT id FROM vienti WHERE arkistotunnus='%1'").arg(arkistotunnus));
-    if( tupla.next() )
+    MitattuKysely& tupla = kp()->kysely("VientiArkistotunnuksella");
+    tupla.bindValue(":arkistotunnus", arkistotunnus);
+    if( tupla.exec() && tupla.next() )
         return;
     }
 
@@ -234,7 +235,9 @@ void Tuonti::oterivi(QDate pvm, qlonglong sentit, const QString& iban, QString v
     // MYYNTILASKU
     if( sentit > 0 && !viite.isEmpty())
     {
-        QSqlQuery kysely( QString("SELECT eraid FROM vienti WHERE viite='%1' AND iban IS NULL ").arg(viite));
+        MitattuKysely& kysely = kp()->kysely("MyyntiViitteella");
+        kysely.bindValue(":viite", viite);
+        kysely.exec();
         while( kysely.next())
         {
             TaseEra era( kysely.value(0).toInt() );
@@ -242,8 +245,9 @@ void Tuonti::oterivi(QDate pvm, qlonglong sentit, const QString& iban, QString v
             {
                 // Tällä viittellä on lasku, joka voidaan maksaa
                 // Viitteen maksamiseen tarvitaan erän tiedot
-                QSqlQuery tilikysely( QString("SELECT tili, selite, kohdennus FROM vienti WHERE id=%1").arg(era.eraId));
-                if( tilikysely.next() && tilikysely.value("tili").toInt())
+                MitattuKysely& tilikysely = kp()->kysely("VientiTilille");
+                tilikysely.bindValue(":id", era.eraId);
+                if( tilikysely.exec() && tilikysely.next() && tilikysely.value("tili").toInt())
                 {
                     vastarivi.tili = kp()->tilit()->tiliIdlla( tilikysely.value("tili").toInt() );
                     vastarivi.kohdennus = kp()->kohdennukset()->kohdennus( tilikysely.value("kohdennus").toInt() );
@@ -292,8 +296,10 @@ void Tuonti::oterivi(QDate pvm, qlonglong sentit, const QString& iban, QString v
         // Ostolasku
         // Kirjataan vanhin lasku, joka täsmää senttimäärään ja joka vielä maksamatta
 
-        QSqlQuery kysely( QString("SELECT id, tili, selite, kohdennus FROM vienti WHERE iban='%1' AND viite='%2' ORDER BY pvm")
-                          .arg(iban).arg(viite) );
+        MitattuKysely& kysely = kp()->kysely("OstoViitteella");
+        kysely.bindValue(":iban", iban);
+        kysely.bindValue(":viite", viite);
+        kysely.exec();
         while( kysely.next())
         {
             int eraId = kysely.value("id").toInt();
@@ -92,6 +92,9 @@ CREATE TABLE vienti (
     erapvm          DATE,
     arkistotunnus   VARCHAR(60),
     asiakas         VARCHAR(60),
+    kirjausperuste  INTEGER,
+    hyvityslasku    BIGINT,
+    maksumuistutus  BIGINT,
     json            TEXT,
     luotu           DATETIME,
     muokattu        DATETIME
@@ -99,11 +102,12 @@ CREATE TABLE vienti (
 
 CREATE INDEX vienti_tosite_index ON vienti(tosite);
 CREATE INDEX vienti_pvm_index ON vienti(pvm);
-CREATE INDEX vienti_tili_index ON vienti(tili);
-CREATE INDEX vienti_kodennus_index ON vienti(kohdennus);
-CREATE INDEX vienti_taseera_index ON vienti(eraid);
+CREATE INDEX vienti_tili_pvm_index ON vienti(tili,pvm,debetsnt,kreditsnt);
+CREATE INDEX vienti_kohdennus_pvm_index ON vienti(kohdennus,pvm,tili,debetsnt,kreditsnt);
+CREATE INDEX vienti_era_pvm_index ON vienti(eraid,pvm,debetsnt,kreditsnt);
 CREATE INDEX vienti_ibanviite_index ON vienti(iban,viite);
 CREATE INDEX vienti_arkisto_index ON vienti(arkistotunnus);
+CREATE INDEX vienti_muistutus_index ON vienti(eraid,maksumuistutus);
 
 CREATE TABLE liite (
     id       INTEGER      PRIMARY KEY AUTOINCREMENT,
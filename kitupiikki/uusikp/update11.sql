@@ -0,0 +1,5 @@
+ALTER TABLE vienti ADD COLUMN kirjausperuste INTEGER;
+ALTER TABLE vienti ADD COLUMN hyvityslasku BIGINT;
+ALTER TABLE vienti ADD COLUMN maksumuistutus BIGINT;
+
+CREATE INDEX vienti_muistutus_index ON vienti(eraid,maksumuistutus);
@@ -0,0 +1,26 @@
+QT += testlib
+QT += sql widgets
+
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../kitupiikki
+
+HEADERS += ../../kitupiikki/db/tili.h \
+    ../../kitupiikki/db/kohdennus.h \
+    ../../kitupiikki/db/tilityyppimodel.h \
+    ../../kitupiikki/db/jsonkentta.h \
+    ../../kitupiikki/db/kyselyvarasto.h \
+    ../../kitupiikki/db/mitattukysely.h \
+    ../../kitupiikki/db/kyselyloki.h
+
+SOURCES +=  tst_jaettutili.cpp \
+    ../../kitupiikki/db/tili.cpp \
+    ../../kitupiikki/db/kohdennus.cpp \
+    ../../kitupiikki/db/tilityyppimodel.cpp \
+    ../../kitupiikki/db/jsonkentta.cpp \
+    ../../kitupiikki/db/kyselyvarasto.cpp \
+    ../../kitupiikki/db/mitattukysely.cpp \
+    ../../kitupiikki/db/kyselyloki.cpp
@@ -0,0 +1,197 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QCoreApplication>
+#include <QSqlQuery>
+#include <QSqlError>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#if __GLIBC_PREREQ(2,33)
+#define MALLINFO2
+#endif
+#endif
+
+#include "db/kirjanpito.h"
+#include "db/tili.h"
+#include "db/kohdennus.h"
+
+// Tili käyttää Kirjanpitoa vain saldokyselyissä, joita ei tässä tarvita
+
+Kirjanpito *kp() { return nullptr; }
+
+void Kirjanpito::lokiin(const QSqlQuery &kysely)
+{
+    qWarning() << kysely.lastQuery() << kysely.lastError().text();
+}
+
+Tilikausi::Tilikausi(QDate tkalkaa, QDate tkpaattyy, const QByteArray& json) :
+    alkaa_(tkalkaa),
+    paattyy_(tkpaattyy),
+    json_(json)
+{
+
+}
+
+const Tilikausi& TilikausiModel::tilikausiPaivalle(const QDate & /* paiva */) const
+{
+    static Tilikausi kausi( QDate(2019,1,1), QDate(2019,12,31));
+    return kausi;
+}
+
+/**
+ * @brief Tilien ja kohdennusten jakaminen
+ *
+ * Ajetaan komennolla ./jaettutili. Tulosteessa on 500 000 tilin ja
+ * kohdennuksen kopion muistinkäyttö, kun kopiot jakavat mallinsa tiedot
+ * ja kun jokainen kopio on irrotettu omaksi tietueekseen, kuten ennen
+ * jakamista. Muisti mitataan glibc:n mallinfo2():lla.
+ *
+ * Kopiot ovat QVectorissa, jottei listan solmujen varaaminen peitä eroa.
+ * Irrotettu kopio vie oman tietueensa verran, jaettu vain osoittimen.
+ */
+class JaettuTiliTesti : public QObject
+{
+    Q_OBJECT
+
+public:
+    JaettuTiliTesti();
+
+private slots:
+    void vakioLukeminenEiIrrota();
+    void tilienMuisti();
+    void kohdennustenMuisti();
+
+protected:
+    static const int KOPIOITA = 500000;
+
+    static qint64 kaytossa();
+    static Tili malliTili();
+};
+
+JaettuTiliTesti::JaettuTiliTesti()
+{
+
+}
+
+qint64 JaettuTiliTesti::kaytossa()
+{
+#ifdef MALLINFO2
+    struct mallinfo2 tiedot = mallinfo2();
+    return static_cast<qint64>( tiedot.uordblks + tiedot.hblkhd );
+#else
+    return -1;
+#endif
+}
+
+Tili JaettuTiliTesti::malliTili()
+{
+    // Tilillä on tavanomaiset json-asetukset, kuten TiliModelin lataamalla
+    Tili tili;
+    tili.asetaId(12);
+    tili.asetaNumero(1700);
+    tili.asetaNimi("Myyntisaamiset");
+    tili.json()->set("Taseerittely", 3);
+    tili.json()->set("Kohdennukset", 1);
+    tili.json()->set("Kirjausohje", QString("Myyntilaskujen saamiset asiakkailta"));
+    tili.json()->set("IBAN", QString("FI21 1234 5600 0007 85"));
+    tili.nollaaMuokattu();
+    return tili;
+}
+
+void JaettuTiliTesti::vakioLukeminenEiIrrota()
+{
+    const Tili malli = malliTili();
+    Tili kopio = malli;
+
+    // Vakio json() lukee jaettua tietuetta
+    QCOMPARE( qAsConst(kopio).json()->luku("Taseerittely"), 3);
+    QCOMPARE( qAsConst(kopio).json(), malli.json());
+
+    // Ei-vakio json() irrottaa kopion omaksi tietueekseen
+    QCOMPARE( kopio.json()->luku("Taseerittely"), 3);
+    QVERIFY( qAsConst(kopio).json() != malli.json());
+}
+
+void JaettuTiliTesti::tilienMuisti()
+{
+    if( kaytossa() < 0)
+        QSKIP("Muistinkäyttöä ei voi mitata tällä alustalla");
+
+    const Tili malli = malliTili();
+    qint64 jaettuina = 0;
+    qint64 irrotettuina = 0;
+    {
+        qint64 alussa = kaytossa();
+        QVector<Tili> tilit;
+        for(int i=0; i < KOPIOITA; i++)
+            tilit.append( malli );
+        jaettuina = kaytossa() - alussa;
+    }
+    {
+        qint64 alussa = kaytossa();
+        QVector<Tili> tilit;
+        for(int i=0; i < KOPIOITA; i++)
+        {
+            Tili kopio = malli;
+            kopio.json();           // irrottaa
+            tilit.append( kopio );
+        }
+        irrotettuina = kaytossa() - alussa;
+    }
+
+    qDebug() << "Tilit jaettuina" << jaettuina / 1024 / 1024 << "Mt," << jaettuina / KOPIOITA << "tavua/kopio";
+    qDebug() << "Tilit irrotettuina" << irrotettuina / 1024 / 1024 << "Mt," << irrotettuina / KOPIOITA << "tavua/kopio";
+    QVERIFY( jaettuina * 5 < irrotettuina );
+}
+
+void JaettuTiliTesti::kohdennustenMuisti()
+{
+    if( kaytossa() < 0)
+        QSKIP("Muistinkäyttöä ei voi mitata tällä alustalla");
+
+    const Kohdennus malli(3, Kohdennus::PROJEKTI, "Kevään markkinointikampanja",
+                          QDate(2019,3,1), QDate(2019,5,31));
+    qint64 jaettuina = 0;
+    qint64 irrotettuina = 0;
+    {
+        qint64 alussa = kaytossa();
+        QVector<Kohdennus> kohdennukset;
+        for(int i=0; i < KOPIOITA; i++)
+            kohdennukset.append( malli );
+        jaettuina = kaytossa() - alussa;
+    }
+    {
+        qint64 alussa = kaytossa();
+        QVector<Kohdennus> kohdennukset;
+        for(int i=0; i < KOPIOITA; i++)
+        {
+            Kohdennus kopio = malli;
+            kopio.asetaId( malli.id());     // irrottaa
+            kohdennukset.append( kopio );
+        }
+        irrotettuina = kaytossa() - alussa;
+    }
+
+    qDebug() << "Kohdennukset jaettuina" << jaettuina / 1024 / 1024 << "Mt," << jaettuina / KOPIOITA << "tavua/kopio";
+    qDebug() << "Kohdennukset irrotettuina" << irrotettuina / 1024 / 1024 << "Mt," << irrotettuina / KOPIOITA << "tavua/kopio";
+    QVERIFY( jaettuina * 3 < irrotettuina );
+}
+
+QTEST_MAIN(JaettuTiliTesti)
+
+#include "tst_jaettutili.moc"
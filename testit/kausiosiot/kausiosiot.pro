@@ -0,0 +1,16 @@
+QT += testlib
+QT += sql widgets
+
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../kitupiikki
+
+HEADERS += ../../kitupiikki/db/kausiosiot.h \
+    ../../kitupiikki/db/jsonkentta.h
+
+SOURCES +=  tst_kausiosiot.cpp \
+    ../../kitupiikki/db/kausiosiot.cpp \
+    ../../kitupiikki/db/jsonkentta.cpp
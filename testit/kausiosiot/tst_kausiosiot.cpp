@@ -0,0 +1,262 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QCoreApplication>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QTemporaryDir>
+
+#include "db/kirjanpito.h"
+#include "db/kausiosiot.h"
+
+// KausiOsiot käyttää Kirjanpidosta vain lokia ja tilikauden päivämääriä,
+// joten koko Kirjanpitoa ei tarvita
+
+Kirjanpito *kp() { return nullptr; }
+
+void Kirjanpito::lokiin(const QSqlQuery &kysely)
+{
+    qWarning() << kysely.lastQuery() << kysely.lastError().text();
+}
+
+Tilikausi::Tilikausi(QDate tkalkaa, QDate tkpaattyy, const QByteArray& json) :
+    alkaa_(tkalkaa),
+    paattyy_(tkpaattyy),
+    json_(json)
+{
+
+}
+
+QString Tilikausi::arkistoHakemistoNimi() const
+{
+    return alkaa().toString("yyyy");
+}
+
+/**
+ * @brief Raporttien kyselyt ennen ja jälkeen tilikauden erottamisen osioon
+ *
+ * Raportoijan tulos- ja tasekyselyt muodostetaan taulu()-funktion
+ * tauluilla, joten niiden summien pitää olla samat, vaikka päätetty
+ * kausi on siirretty omaan tiedostoonsa.
+ */
+class KausiOsiotTesti : public QObject
+{
+    Q_OBJECT
+
+public:
+    KausiOsiotTesti();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void raportitErottamisenJalkeen();
+    void uusiOsioSaikeenYhteyteen();
+
+protected:
+    QString tulos(QSqlDatabase& yhteys, const QDate& alkaa, const QDate& paattyy) const;
+    QString tase(QSqlDatabase& yhteys, const QDate& paattyy) const;
+    QString merkkaukset(QSqlDatabase& yhteys, const QDate& alkaa, const QDate& paattyy) const;
+    static QString summat(QSqlQuery& kysely);
+
+    QTemporaryDir hakemisto_;
+    QSqlDatabase tietokanta_;
+    QSqlDatabase saie_;
+    KausiOsiot osiot_;
+};
+
+KausiOsiotTesti::KausiOsiotTesti()
+{
+
+}
+
+void KausiOsiotTesti::initTestCase()
+{
+    QVERIFY( hakemisto_.isValid() );
+    QString polku = hakemisto_.filePath("testi.kitupiikki");
+
+    tietokanta_ = QSqlDatabase::addDatabase("QSQLITE", "paa");
+    tietokanta_.setConnectOptions("QSQLITE_OPEN_URI");
+    tietokanta_.setDatabaseName( polku );
+    QVERIFY( tietokanta_.open() );
+
+    QSqlQuery kysely(tietokanta_);
+    QVERIFY( kysely.exec("CREATE TABLE tili (id INTEGER PRIMARY KEY, nro INTEGER, nimi TEXT, "
+                         "tyyppi TEXT, ysiluku INTEGER NOT NULL)") );
+    QVERIFY( kysely.exec("CREATE TABLE tositelaji (id INTEGER PRIMARY KEY, tunnus TEXT)") );
+    QVERIFY( kysely.exec("CREATE TABLE kohdennus (id INTEGER PRIMARY KEY, nimi TEXT)") );
+    QVERIFY( kysely.exec("CREATE TABLE era (id INTEGER PRIMARY KEY, debetsnt BIGINT, kreditsnt BIGINT)") );
+    QVERIFY( kysely.exec("CREATE TABLE tosite (id INTEGER PRIMARY KEY AUTOINCREMENT, pvm DATE, "
+                         "otsikko TEXT, tunniste INTEGER, laji INTEGER)") );
+    QVERIFY( kysely.exec("CREATE TABLE vienti (id INTEGER PRIMARY KEY AUTOINCREMENT, tosite INTEGER, "
+                         "pvm DATE, tili INTEGER, debetsnt BIGINT, kreditsnt BIGINT, selite TEXT, "
+                         "kohdennus INTEGER DEFAULT(0), eraid INTEGER)") );
+    QVERIFY( kysely.exec("CREATE INDEX vienti_tili_pvm_index ON vienti(tili,pvm,debetsnt,kreditsnt)") );
+    QVERIFY( kysely.exec("CREATE TABLE merkkaus (id INTEGER PRIMARY KEY AUTOINCREMENT, vienti INTEGER, "
+                         "kohdennus INTEGER)") );
+    QVERIFY( kysely.exec("CREATE TABLE liite (id INTEGER PRIMARY KEY AUTOINCREMENT, tosite INTEGER, "
+                         "otsikko TEXT)") );
+    QVERIFY( KausiOsiot::alusta(tietokanta_) );
+
+    QVERIFY( kysely.exec("INSERT INTO tili VALUES (1, 1910, 'Pankki', 'ARP', 191000000), "
+                         "(2, 3000, 'Myynti', 'CT', 300000000 + 1), (3, 4000, 'Ostot', 'DS', 400000000)") );
+    QVERIFY( kysely.exec("INSERT INTO tositelaji VALUES (0, '*'), (1, 'MU')") );
+    QVERIFY( kysely.exec("INSERT INTO kohdennus VALUES (0, 'Yleinen'), (1, 'Projekti'), (2, 'Merkkaus')") );
+
+    // Kaksi tilikautta, joilla molemmilla myyntejä ja ostoja
+    tietokanta_.transaction();
+    for(int i=0; i < 730; i++)
+    {
+        QDate pvm = QDate(2017,1,1).addDays(i);
+        bool myynti = i % 3;
+        kysely.prepare("INSERT INTO tosite(pvm, tunniste, laji) VALUES (?, ?, 1)");
+        kysely.addBindValue(pvm);
+        kysely.addBindValue(i + 1);
+        QVERIFY( kysely.exec() );
+        int tosite = kysely.lastInsertId().toInt();
+
+        kysely.prepare("INSERT INTO vienti(tosite, pvm, tili, debetsnt, kreditsnt, kohdennus) "
+                       "VALUES (?, ?, ?, ?, ?, ?)");
+        kysely.addBindValue(tosite);
+        kysely.addBindValue(pvm);
+        kysely.addBindValue(1);
+        kysely.addBindValue( myynti ? 100 + i : 0);
+        kysely.addBindValue( myynti ? 0 : 50 + i);
+        kysely.addBindValue(0);
+        QVERIFY( kysely.exec() );
+
+        kysely.prepare("INSERT INTO vienti(tosite, pvm, tili, debetsnt, kreditsnt, kohdennus) "
+                       "VALUES (?, ?, ?, ?, ?, ?)");
+        kysely.addBindValue(tosite);
+        kysely.addBindValue(pvm);
+        kysely.addBindValue( myynti ? 2 : 3);
+        kysely.addBindValue( myynti ? 0 : 50 + i);
+        kysely.addBindValue( myynti ? 100 + i : 0);
+        kysely.addBindValue( i % 5 ? 0 : 1);
+        QVERIFY( kysely.exec() );
+        int vienti = kysely.lastInsertId().toInt();
+
+        if( i % 7 == 0)
+            QVERIFY( kysely.exec( QString("INSERT INTO merkkaus(vienti, kohdennus) VALUES (%1, 2)").arg(vienti)) );
+    }
+    QVERIFY( tietokanta_.commit() );
+    QVERIFY( osiot_.lataa(tietokanta_, polku) );
+
+    // Taustasäikeen yhteys avataan ennen kuin kausi erotetaan
+    saie_ = QSqlDatabase::addDatabase("QSQLITE", "saie");
+    saie_.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_OPEN_URI");
+    saie_.setDatabaseName( polku );
+    QVERIFY( saie_.open() );
+    QVERIFY( osiot_.liita(saie_) );
+}
+
+void KausiOsiotTesti::cleanupTestCase()
+{
+    saie_.close();
+    tietokanta_.close();
+}
+
+void KausiOsiotTesti::raportitErottamisenJalkeen()
+{
+    const QDate alkaa(2017,1,1);
+    const QDate paattyy(2017,12,31);
+    const QDate avoinAlkaa(2018,1,1);
+    const QDate avoinPaattyy(2018,12,31);
+
+    QString tulosEnnen = tulos(tietokanta_, alkaa, paattyy);
+    QString avoinEnnen = tulos(tietokanta_, avoinAlkaa, avoinPaattyy);
+    QString taseEnnen = tase(tietokanta_, avoinPaattyy);
+    QString merkkauksetEnnen = merkkaukset(tietokanta_, alkaa, paattyy);
+    QVERIFY( !tulosEnnen.isEmpty() );
+    QVERIFY( !merkkauksetEnnen.isEmpty() );
+
+    QVERIFY( osiot_.erota(tietokanta_, Tilikausi(alkaa, paattyy)) );
+    QCOMPARE( osiot_.osiot().count(), 1);
+
+    QSqlQuery kysely(tietokanta_);
+    QVERIFY( kysely.exec("SELECT COUNT(*) FROM main.vienti WHERE pvm <= '2017-12-31'") );
+    QVERIFY( kysely.next() );
+    QCOMPARE( kysely.value(0).toInt(), 0);
+
+    QCOMPARE( tulos(tietokanta_, alkaa, paattyy), tulosEnnen);
+    QCOMPARE( tulos(tietokanta_, avoinAlkaa, avoinPaattyy), avoinEnnen);
+    QCOMPARE( tase(tietokanta_, avoinPaattyy), taseEnnen);
+    QCOMPARE( merkkaukset(tietokanta_, alkaa, paattyy), merkkauksetEnnen);
+}
+
+void KausiOsiotTesti::uusiOsioSaikeenYhteyteen()
+{
+    // Ennen erottamista avattuun yhteyteen liitetään vain uusi osio
+    QVERIFY( osiot_.liita(saie_) );
+    QVERIFY( osiot_.liita(saie_) );
+
+    QCOMPARE( tulos(saie_, QDate(2017,1,1), QDate(2017,12,31)),
+              tulos(tietokanta_, QDate(2017,1,1), QDate(2017,12,31)) );
+    QCOMPARE( tase(saie_, QDate(2018,12,31)), tase(tietokanta_, QDate(2018,12,31)) );
+}
+
+QString KausiOsiotTesti::tulos(QSqlDatabase &yhteys, const QDate &alkaa, const QDate &paattyy) const
+{
+    // Raportoija::laskeTulosData
+    QSqlQuery kysely( QString("SELECT ysiluku, sum(debetsnt), sum(kreditsnt) "
+                              "from %3,tili where vienti.tili = tili.id and ysiluku > 300000000 "
+                              "and pvm between \"%1\" and \"%2\" group by ysiluku")
+                      .arg( alkaa.toString(Qt::ISODate))
+                      .arg( paattyy.toString(Qt::ISODate))
+                      .arg( osiot_.taulu("vienti", alkaa, paattyy)), yhteys);
+    return summat(kysely);
+}
+
+QString KausiOsiotTesti::tase(QSqlDatabase &yhteys, const QDate &paattyy) const
+{
+    // Raportoija::laskeKohdennusData, tasetilien summat
+    QSqlQuery kysely( QString("SELECT ysiluku, sum(debetsnt), sum(kreditsnt) "
+                              "from %2,tili where vienti.tili = tili.id and ysiluku < 300000000 "
+                              "and pvm <= \"%1\" group by ysiluku")
+                      .arg( paattyy.toString(Qt::ISODate))
+                      .arg( osiot_.taulu("vienti", QDate(), paattyy)), yhteys);
+    return summat(kysely);
+}
+
+QString KausiOsiotTesti::merkkaukset(QSqlDatabase &yhteys, const QDate &alkaa, const QDate &paattyy) const
+{
+    QSqlQuery kysely( QString("SELECT ysiluku, sum(debetsnt), sum(kreditsnt) "
+                              "from %3, %4,tili where merkkaus.kohdennus=2 "
+                              "AND merkkaus.vienti=vienti.id AND vienti.tili = tili.id and ysiluku > 300000000 "
+                              "and pvm between \"%1\" and \"%2\" group by ysiluku")
+                      .arg( alkaa.toString(Qt::ISODate))
+                      .arg( paattyy.toString(Qt::ISODate))
+                      .arg( osiot_.taulu("merkkaus", alkaa, paattyy))
+                      .arg( osiot_.taulu("vienti", alkaa, paattyy)), yhteys);
+    return summat(kysely);
+}
+
+QString KausiOsiotTesti::summat(QSqlQuery &kysely)
+{
+    if( kysely.lastError().isValid())
+        return kysely.lastError().text();
+
+    QStringList rivit;
+    while( kysely.next())
+        rivit.append( QString("%1:%2:%3").arg(kysely.value(0).toString())
+                      .arg(kysely.value(1).toString()).arg(kysely.value(2).toString()));
+    return rivit.join(";");
+}
+
+QTEST_MAIN(KausiOsiotTesti)
+
+#include "tst_kausiosiot.moc"
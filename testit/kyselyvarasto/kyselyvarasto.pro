@@ -0,0 +1,16 @@
+QT += testlib
+QT += sql
+
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+HEADERS += ../../kitupiikki/db/kyselyvarasto.h \
+    ../../kitupiikki/db/mitattukysely.h \
+    ../../kitupiikki/db/kyselyloki.h
+
+SOURCES +=  tst_kyselyvarasto.cpp \
+    ../../kitupiikki/db/kyselyvarasto.cpp \
+    ../../kitupiikki/db/mitattukysely.cpp \
+    ../../kitupiikki/db/kyselyloki.cpp
@@ -0,0 +1,172 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QCoreApplication>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+
+#include "../../kitupiikki/db/kyselyvarasto.h"
+#include "../../kitupiikki/db/kyselyloki.h"
+
+/**
+ * @brief Vertaa merkkijonosta rakennettua kyselyä valmisteltuun
+ *
+ * Ajetaan komennolla ./kyselyvarasto, tulosteessa kyselyn hinta
+ * millisekunteina sataa kutsua kohden
+ */
+class KyselyvarastoTesti : public QObject
+{
+    Q_OBJECT
+
+public:
+    KyselyvarastoTesti();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void tulosTesti();
+    void lokiTesti();
+    void merkkijonokysely();
+    void varastokysely();
+
+protected:
+    QSqlDatabase tietokanta_;
+};
+
+KyselyvarastoTesti::KyselyvarastoTesti()
+{
+
+}
+
+void KyselyvarastoTesti::initTestCase()
+{
+    tietokanta_ = QSqlDatabase::addDatabase("QSQLITE");
+    tietokanta_.setDatabaseName(":memory:");
+    QVERIFY( tietokanta_.open() );
+
+    QSqlQuery kysely(tietokanta_);
+    QVERIFY( kysely.exec("CREATE TABLE saldo (tili INTEGER NOT NULL, pvm DATE NOT NULL, "
+                         "debetsnt BIGINT NOT NULL DEFAULT 0, kreditsnt BIGINT NOT NULL DEFAULT 0, "
+                         "PRIMARY KEY(tili, pvm)) WITHOUT ROWID") );
+
+    tietokanta_.transaction();
+    kysely.prepare("INSERT INTO saldo(tili, pvm, debetsnt, kreditsnt) VALUES (:tili, :pvm, :debet, :kredit)");
+    QDate pvm(2010,1,1);
+    for(int paiva = 0; paiva < 3000; paiva++)
+    {
+        for(int tili = 1; tili < 20; tili++)
+        {
+            kysely.bindValue(":tili", tili);
+            kysely.bindValue(":pvm", pvm.addDays(paiva));
+            kysely.bindValue(":debet", tili * 100);
+            kysely.bindValue(":kredit", paiva % 7 * 100);
+            kysely.exec();
+        }
+    }
+    tietokanta_.commit();
+}
+
+void KyselyvarastoTesti::cleanupTestCase()
+{
+    tietokanta_.close();
+}
+
+void KyselyvarastoTesti::tulosTesti()
+{
+    // Valmisteltu kysely antaa saman tuloksen toistuvasti
+    KyselyVarasto varasto(&tietokanta_);
+    varasto.lisaa("Saldo", "SELECT SUM(debetsnt) FROM saldo WHERE tili=:tili AND pvm <= :pvm");
+
+    for(int i=0; i < 3; i++)
+    {
+        QSqlQuery& kysely = varasto.kysely("Saldo");
+        kysely.bindValue(":tili", 3);
+        kysely.bindValue(":pvm", QDate(2010,1,10));
+        QVERIFY( kysely.exec() );
+        QVERIFY( kysely.next() );
+        QCOMPARE( kysely.value(0).toLongLong(), 3000LL);
+    }
+}
+
+void KyselyvarastoTesti::lokiTesti()
+{
+    // Varaston kyselyt kirjataan lokiin, kun loki on käytössä
+    KyselyVarasto varasto(&tietokanta_);
+    varasto.lisaa("Paiva", "SELECT tili FROM saldo WHERE pvm = :pvm");
+
+    KyselyLoki::tyhjenna();
+    KyselyLoki::asetaKaytossa(true);
+    for(int i=0; i < 2; i++)
+    {
+        MitattuKysely& kysely = varasto.kysely("Paiva");
+        kysely.bindValue(":pvm", QDate(2010,1,1).addDays(i));
+        QVERIFY( kysely.exec() );
+        while( kysely.next())
+            ;
+        // Suoritus kirjataan heti, kun rivit on luettu
+        QCOMPARE( KyselyLoki::merkinnat().count(), i + 1);
+    }
+    varasto.tyhjenna();
+    KyselyLoki::asetaKaytossa(false);
+
+    QList<KyselyLoki::Merkinta> merkinnat = KyselyLoki::merkinnat();
+    QCOMPARE( merkinnat.count(), 2);
+    QCOMPARE( merkinnat.first().rivit, 19);
+    // Tapahtumasilmukkaan ei palattu välillä, joten kyselyt ovat samaa toimintoa
+    QCOMPARE( merkinnat.first().toiminto, merkinnat.last().toiminto);
+    QVERIFY( merkinnat.first().arvot.contains("2010-01-01"));
+    QCOMPARE( merkinnat.first().muoto, merkinnat.last().muoto);
+
+    QCOMPARE( KyselyLoki::muoto("SELECT * FROM vienti WHERE id=12 AND viite='123'"),
+              QString("SELECT * FROM vienti WHERE id=? AND viite=?"));
+}
+
+void KyselyvarastoTesti::merkkijonokysely()
+{
+    QBENCHMARK
+    {
+        for(int i=0; i < 100; i++)
+        {
+            QSqlQuery kysely( QString("SELECT SUM(debetsnt), SUM(kreditsnt) FROM saldo WHERE tili=%1 AND pvm <= \"%2\"")
+                              .arg(i % 19 + 1)
+                              .arg(QDate(2010,1,1).addDays(i).toString(Qt::ISODate)), tietokanta_);
+            kysely.next();
+        }
+    }
+}
+
+void KyselyvarastoTesti::varastokysely()
+{
+    KyselyVarasto varasto(&tietokanta_);
+    varasto.lisaa("Saldo", "SELECT SUM(debetsnt), SUM(kreditsnt) FROM saldo WHERE tili=:tili AND pvm <= :pvm");
+
+    QBENCHMARK
+    {
+        for(int i=0; i < 100; i++)
+        {
+            QSqlQuery& kysely = varasto.kysely("Saldo");
+            kysely.bindValue(":tili", i % 19 + 1);
+            kysely.bindValue(":pvm", QDate(2010,1,1).addDays(i));
+            kysely.exec();
+            kysely.next();
+        }
+    }
+}
+
+QTEST_MAIN(KyselyvarastoTesti)
+
+#include "tst_kyselyvarasto.moc"
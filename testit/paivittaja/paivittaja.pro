@@ -0,0 +1,14 @@
+QT += testlib
+QT += sql
+
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
+
+HEADERS += ../../kitupiikki/db/paivittaja.h
+
+SOURCES +=  tst_paivittaja.cpp \
+    ../../kitupiikki/db/paivittaja.cpp
@@ -0,0 +1,164 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QCoreApplication>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+#include "../../kitupiikki/db/paivittaja.h"
+
+/**
+ * @brief Tietokannan päivitys vanhasta versiosta
+ *
+ * Ajetaan komennolla ./paivittaja, tulosteessa update3.sql-päivityksen
+ * kesto miljoonan viennin kirjanpidolle
+ */
+class PaivittajaTesti : public QObject
+{
+    Q_OBJECT
+
+public:
+    PaivittajaTesti();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void lauseTesti();
+    void peruutusTesti();
+    void paivitysTesti();
+
+protected:
+    int versio();
+
+    QTemporaryDir hakemisto_;
+    QSqlDatabase tietokanta_;
+};
+
+PaivittajaTesti::PaivittajaTesti()
+{
+
+}
+
+void PaivittajaTesti::initTestCase()
+{
+    QVERIFY( hakemisto_.isValid() );
+
+    tietokanta_ = QSqlDatabase::addDatabase("QSQLITE");
+    tietokanta_.setDatabaseName( hakemisto_.filePath("vanha.kitupiikki") );
+    QVERIFY( tietokanta_.open() );
+
+    // Versiota 2 vastaava rakenne
+    QSqlQuery kysely(tietokanta_);
+    QVERIFY( kysely.exec("CREATE TABLE asetus (avain TEXT PRIMARY KEY, arvo TEXT, muokattu DATETIME)") );
+    QVERIFY( kysely.exec("INSERT INTO asetus(avain, arvo) VALUES ('KpVersio','2')") );
+    QVERIFY( kysely.exec("CREATE TABLE tosite (id INTEGER PRIMARY KEY AUTOINCREMENT, pvm DATE, otsikko TEXT, "
+                         "kommentti TEXT, tunniste INTEGER, laji INTEGER, tiliote INTEGER, json TEXT)") );
+    QVERIFY( kysely.exec("CREATE TABLE kohdennus (id INTEGER PRIMARY KEY AUTOINCREMENT, tyyppi INTEGER, "
+                         "nimi TEXT, alkaa DATE, loppuu DATE)") );
+    QVERIFY( kysely.exec("CREATE TABLE liite (id INTEGER PRIMARY KEY AUTOINCREMENT, liiteno INTEGER, "
+                         "tosite INTEGER, otsikko TEXT, sha TEXT, peukku BLOB)") );
+    QVERIFY( kysely.exec("CREATE TABLE tili (id INTEGER PRIMARY KEY AUTOINCREMENT, nro INTEGER, nimi TEXT)") );
+    QVERIFY( kysely.exec("CREATE TABLE vienti (id INTEGER PRIMARY KEY AUTOINCREMENT, tosite INTEGER REFERENCES tosite(id), "
+                         "vientirivi INTEGER NOT NULL, pvm DATE, tili INTEGER REFERENCES tili(id), "
+                         "debetsnt BIGINT, kreditsnt BIGINT, selite TEXT, alvkoodi INTEGER DEFAULT(0), "
+                         "alvprosentti INTEGER DEFAULT(0), kohdennus INTEGER DEFAULT(0), eraid INTEGER, "
+                         "json TEXT, luotu DATETIME, muokattu DATETIME)") );
+
+    tietokanta_.transaction();
+    kysely.prepare("INSERT INTO vienti(tosite, vientirivi, pvm, tili, debetsnt, kreditsnt, selite) "
+                   "VALUES (:tosite, :rivi, :pvm, :tili, :debet, :kredit, :selite)");
+    QDate pvm(2010,1,1);
+    for(int i=0; i < 1000000; i++)
+    {
+        kysely.bindValue(":tosite", i / 2 + 1);
+        kysely.bindValue(":rivi", i % 2);
+        kysely.bindValue(":pvm", pvm.addDays( i / 500 ));
+        kysely.bindValue(":tili", i % 30 + 1);
+        kysely.bindValue(":debet", i % 2 ? QVariant(100) : QVariant());
+        kysely.bindValue(":kredit", i % 2 ? QVariant() : QVariant(100));
+        kysely.bindValue(":selite", "Testivienti");
+        kysely.exec();
+    }
+    QVERIFY( tietokanta_.commit() );
+}
+
+void PaivittajaTesti::cleanupTestCase()
+{
+    tietokanta_.close();
+}
+
+void PaivittajaTesti::lauseTesti()
+{
+    QStringList lauseet = Paivittaja::lauseet("-- kommentti; ei lause\n"
+                                              "UPDATE a SET b='x;y';\n"
+                                              "\n;"
+                                              "SELECT 1");
+    QCOMPARE( lauseet.count(), 2);
+    QCOMPARE( lauseet.at(0), QString("UPDATE a SET b='x;y'"));
+    QCOMPARE( lauseet.at(1), QString("SELECT 1"));
+}
+
+void PaivittajaTesti::peruutusTesti()
+{
+    // Epäonnistuneen vaiheen jälkeen tietokanta on ennallaan,
+    // joten päivitys voidaan aloittaa alusta
+    Paivittaja paivittaja(&tietokanta_);
+    paivittaja.lisaaVaihe(10, QString(SRCDIR) + "../../kitupiikki/uusikp/update3.sql",
+                          [] (Paivittaja*) { return false; });
+    QVERIFY( !paivittaja.paivita(2) );
+
+    QCOMPARE( versio(), 2);
+    QVERIFY( !tietokanta_.tables().contains("vienti_old") );
+    QVERIFY( !tietokanta_.tables().contains("merkkaus") );
+}
+
+void PaivittajaTesti::paivitysTesti()
+{
+    Paivittaja paivittaja(&tietokanta_);
+    paivittaja.lisaaVaihe(10, QString(SRCDIR) + "../../kitupiikki/uusikp/update3.sql");
+
+    int ilmoituksia = 0;
+    paivittaja.asetaEdistyminen([&ilmoituksia] (int, int) { ilmoituksia++; });
+
+    bool onnistui = false;
+    QBENCHMARK_ONCE
+    {
+        onnistui = paivittaja.paivita(2);
+    }
+    QVERIFY2( onnistui, qPrintable(paivittaja.virhe()) );
+    QVERIFY( ilmoituksia > 0 );
+    QCOMPARE( versio(), 10);
+
+    QSqlQuery kysely(tietokanta_);
+    QVERIFY( kysely.exec("SELECT COUNT(*), SUM(eraid=id) FROM vienti") && kysely.next() );
+    QCOMPARE( kysely.value(0).toInt(), 1000000);
+    QCOMPARE( kysely.value(1).toInt(), 1000000);
+
+    // Ajan tasalla olevaa tietokantaa ei päivitetä uudelleen
+    QVERIFY( paivittaja.paivita(10) );
+}
+
+int PaivittajaTesti::versio()
+{
+    QSqlQuery kysely("SELECT arvo FROM asetus WHERE avain='KpVersio'", tietokanta_);
+    return kysely.next() ? kysely.value(0).toInt() : -1;
+}
+
+QTEST_MAIN(PaivittajaTesti)
+
+#include "tst_paivittaja.moc"
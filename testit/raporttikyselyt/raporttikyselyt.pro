@@ -0,0 +1,9 @@
+QT += testlib
+QT += sql
+
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+SOURCES +=  tst_raporttikyselyt.cpp
@@ -0,0 +1,213 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QCoreApplication>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QRegularExpression>
+
+/**
+ * @brief Raporttien summakyselyt ennen ja jälkeen koosteindeksien
+ *
+ * Ajetaan komennolla ./raporttikyselyt, tulosteessa kunkin kyselyn kesto
+ * miljoonan viennin kirjanpidossa vanhoilla yhden sarakkeen indekseillä,
+ * koosteindekseillä sekä koosteindekseillä, kun päivämäärät on tallennettu
+ * tekstin sijaan päivänumeroina
+ */
+class RaporttikyselytTesti : public QObject
+{
+    Q_OBJECT
+
+public:
+    RaporttikyselytTesti();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void tulosTesti();
+    void kysely_data();
+    void kysely();
+
+protected:
+    void rakenna(QSqlDatabase& tietokanta, const QStringList& indeksit, bool paivanumerot = false);
+    static QString paivanumeroin(const QString& kysymys);
+
+    QTemporaryDir hakemisto_;
+};
+
+RaporttikyselytTesti::RaporttikyselytTesti()
+{
+
+}
+
+void RaporttikyselytTesti::initTestCase()
+{
+    QVERIFY( hakemisto_.isValid() );
+
+    QSqlDatabase vanha = QSqlDatabase::addDatabase("QSQLITE", "vanha");
+    vanha.setDatabaseName( hakemisto_.filePath("vanha.kitupiikki"));
+    QVERIFY( vanha.open() );
+    rakenna( vanha, QStringList() << "CREATE INDEX vienti_tili_index ON vienti(tili)"
+                                  << "CREATE INDEX vienti_kodennus_index ON vienti(kohdennus)"
+                                  << "CREATE INDEX vienti_taseera_index ON vienti(eraid)");
+
+    QSqlDatabase uusi = QSqlDatabase::addDatabase("QSQLITE", "uusi");
+    uusi.setDatabaseName( hakemisto_.filePath("uusi.kitupiikki"));
+    QVERIFY( uusi.open() );
+    rakenna( uusi, QStringList() << "CREATE INDEX vienti_tili_pvm_index ON vienti(tili,pvm,debetsnt,kreditsnt)"
+                                 << "CREATE INDEX vienti_kohdennus_pvm_index ON vienti(kohdennus,pvm,tili,debetsnt,kreditsnt)"
+                                 << "CREATE INDEX vienti_era_pvm_index ON vienti(eraid,pvm,debetsnt,kreditsnt)");
+
+    QSqlDatabase paivat = QSqlDatabase::addDatabase("QSQLITE", "paivat");
+    paivat.setDatabaseName( hakemisto_.filePath("paivat.kitupiikki"));
+    QVERIFY( paivat.open() );
+    rakenna( paivat, QStringList() << "CREATE INDEX vienti_tili_pvm_index ON vienti(tili,pvm,debetsnt,kreditsnt)"
+                                   << "CREATE INDEX vienti_kohdennus_pvm_index ON vienti(kohdennus,pvm,tili,debetsnt,kreditsnt)"
+                                   << "CREATE INDEX vienti_era_pvm_index ON vienti(eraid,pvm,debetsnt,kreditsnt)",
+             true);
+}
+
+void RaporttikyselytTesti::cleanupTestCase()
+{
+    QSqlDatabase::database("vanha").close();
+    QSqlDatabase::database("uusi").close();
+    QSqlDatabase::database("paivat").close();
+}
+
+void RaporttikyselytTesti::tulosTesti()
+{
+    // Indeksit eivät saa muuttaa tuloksia
+    QSqlQuery vanha( QSqlDatabase::database("vanha") );
+    QSqlQuery uusi( QSqlDatabase::database("uusi") );
+    QString kysymys("SELECT ysiluku, SUM(debetsnt), SUM(kreditsnt) FROM vienti, tili WHERE vienti.tili=tili.id "
+                    "AND pvm BETWEEN '2017-01-01' AND '2017-12-31' GROUP BY nro");
+    QVERIFY( vanha.exec(kysymys) );
+    QVERIFY( uusi.exec(kysymys) );
+    while( vanha.next())
+    {
+        QVERIFY( uusi.next() );
+        for(int i=0; i < 3; i++)
+            QCOMPARE( uusi.value(i).toLongLong(), vanha.value(i).toLongLong());
+    }
+    QVERIFY( !uusi.next() );
+}
+
+void RaporttikyselytTesti::kysely_data()
+{
+    QTest::addColumn<QString>("yhteys");
+    QTest::addColumn<QString>("kysymys");
+
+    QStringList kysymykset;
+    kysymykset << "SELECT ysiluku, SUM(debetsnt), SUM(kreditsnt) FROM vienti, tili WHERE vienti.tili=tili.id "
+                  "AND tili.ysiluku > 300000000 AND pvm BETWEEN '2017-01-01' AND '2017-12-31' GROUP BY nro"
+               << "SELECT ysiluku, tyyppi, SUM(debetsnt), SUM(kreditsnt) FROM vienti, tili WHERE vienti.tili=tili.id "
+                  "AND tili.ysiluku < 300000000 AND pvm < '2018-01-01' GROUP BY nro"
+               << "SELECT ysiluku, SUM(debetsnt), SUM(kreditsnt) FROM vienti, tili WHERE vienti.tili=tili.id "
+                  "AND ysiluku > 300000000 AND pvm BETWEEN '2017-01-01' AND '2017-12-31' AND kohdennus=3 GROUP BY ysiluku"
+               << "SELECT eraid, SUM(debetsnt), SUM(kreditsnt) FROM vienti WHERE eraid IS NOT NULL "
+                  "AND pvm <= '2016-12-31' GROUP BY eraid";
+    QStringList nimet;
+    nimet << "tuloslaskelma" << "tase" << "kohdennus" << "tase-erat";
+
+    for(int i=0; i < kysymykset.count(); i++)
+    {
+        QTest::newRow( qPrintable(nimet.at(i) + " ennen")) << "vanha" << kysymykset.at(i);
+        QTest::newRow( qPrintable(nimet.at(i) + " jalkeen")) << "uusi" << kysymykset.at(i);
+        QTest::newRow( qPrintable(nimet.at(i) + " paivanumerot")) << "paivat" << paivanumeroin( kysymykset.at(i) );
+    }
+}
+
+void RaporttikyselytTesti::kysely()
+{
+    QFETCH(QString, yhteys);
+    QFETCH(QString, kysymys);
+
+    QSqlQuery kysely( QSqlDatabase::database(yhteys) );
+    kysely.setForwardOnly(true);
+    QBENCHMARK
+    {
+        QVERIFY( kysely.exec(kysymys) );
+        while( kysely.next())
+            ;
+    }
+}
+
+QString RaporttikyselytTesti::paivanumeroin(const QString &kysymys)
+{
+    // Päivämääräliteraalit päivänumeroiksi
+    QString tulos = kysymys;
+    QRegularExpression pvmRe("'(\\d{4}-\\d\\d-\\d\\d)'");
+    QRegularExpressionMatch osuma = pvmRe.match(tulos);
+    while( osuma.hasMatch())
+    {
+        tulos.replace( osuma.capturedStart(), osuma.capturedLength(),
+                       QString::number( QDate::fromString(osuma.captured(1), Qt::ISODate).toJulianDay() ));
+        osuma = pvmRe.match(tulos);
+    }
+    return tulos;
+}
+
+void RaporttikyselytTesti::rakenna(QSqlDatabase &tietokanta, const QStringList &indeksit, bool paivanumerot)
+{
+    QSqlQuery kysely(tietokanta);
+    QVERIFY( kysely.exec("CREATE TABLE tili (id INTEGER PRIMARY KEY, nro INTEGER, ysiluku INTEGER, tyyppi VARCHAR(10))") );
+    QVERIFY( kysely.exec(QString("CREATE TABLE vienti (id INTEGER PRIMARY KEY AUTOINCREMENT, tosite INTEGER, "
+                         "vientirivi INTEGER NOT NULL, pvm %1, tili INTEGER, debetsnt BIGINT, kreditsnt BIGINT, "
+                         "selite TEXT, kohdennus INTEGER DEFAULT(0), eraid INTEGER)").arg(paivanumerot ? "INTEGER" : "DATE")) );
+    QVERIFY( kysely.exec("CREATE INDEX vienti_pvm_index ON vienti(pvm)") );
+    for( const QString& indeksi : indeksit)
+        QVERIFY( kysely.exec(indeksi) );
+
+    tietokanta.transaction();
+    kysely.prepare("INSERT INTO tili(id, nro, ysiluku, tyyppi) VALUES (:id, :nro, :ysiluku, :tyyppi)");
+    for(int i=1; i < 200; i++)
+    {
+        kysely.bindValue(":id", i);
+        kysely.bindValue(":nro", 1000 + i * 100);
+        kysely.bindValue(":ysiluku", (1 + i % 9) * 100000000 + i);
+        kysely.bindValue(":tyyppi", i < 100 ? "AS" : "D");
+        kysely.exec();
+    }
+
+    // Viisi vuotta, noin 550 vientiä päivässä
+    kysely.prepare("INSERT INTO vienti(tosite, vientirivi, pvm, tili, debetsnt, kreditsnt, selite, kohdennus, eraid) "
+                   "VALUES (:tosite, :rivi, :pvm, :tili, :debet, :kredit, :selite, :kohdennus, :eraid)");
+    QDate alku(2014,1,1);
+    for(int i=0; i < 1000000; i++)
+    {
+        kysely.bindValue(":tosite", i / 2);
+        kysely.bindValue(":rivi", i % 2);
+        if( paivanumerot )
+            kysely.bindValue(":pvm", alku.addDays( i / 550).toJulianDay());
+        else
+            kysely.bindValue(":pvm", alku.addDays( i / 550));
+        kysely.bindValue(":tili", 1 + (i * 7) % 199);
+        kysely.bindValue(":debet", i % 2 ? QVariant(100) : QVariant());
+        kysely.bindValue(":kredit", i % 2 ? QVariant() : QVariant(100));
+        kysely.bindValue(":selite", "Testivienti");
+        kysely.bindValue(":kohdennus", i % 5);
+        kysely.bindValue(":eraid", i % 10 ? QVariant() : QVariant(i));
+        kysely.exec();
+    }
+    QVERIFY( tietokanta.commit() );
+    QVERIFY( kysely.exec("ANALYZE") );
+}
+
+QTEST_MAIN(RaporttikyselytTesti)
+
+#include "tst_raporttikyselyt.moc"
@@ -0,0 +1,287 @@
+/*
+   Copyright (C) 2019 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QCoreApplication>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QTemporaryDir>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#if __GLIBC_PREREQ(2,33)
+#define MALLINFO2
+#endif
+#endif
+
+#include "db/kirjanpito.h"
+#include "db/kausiosiot.h"
+#include "selaus/selausrivit.h"
+
+// Rivit haetaan ilman osioita, joten Kirjanpidosta tarvitaan vain loki
+// ja tilikauden rakentaja KausiOsiot-luokalle
+
+Kirjanpito *kp() { return nullptr; }
+
+void Kirjanpito::lokiin(const QSqlQuery &kysely)
+{
+    qWarning() << kysely.lastQuery() << kysely.lastError().text();
+}
+
+Tilikausi::Tilikausi(QDate tkalkaa, QDate tkpaattyy, const QByteArray& json) :
+    alkaa_(tkalkaa),
+    paattyy_(tkpaattyy),
+    json_(json)
+{
+
+}
+
+QString Tilikausi::arkistoHakemistoNimi() const
+{
+    return alkaa().toString("yyyy");
+}
+
+/**
+ * @brief SelausModelin rivien lataaminen ja järjestys
+ *
+ * Ajetaan komennolla ./selausrivit. Testi luo 500 000 viennin
+ * kirjanpidon ja lataa sen vuoden viennit SelausModel::lataa():n
+ * kyselyllä ja rivinlukijalla. Tulosteessa on ladattujen rivien
+ * muistinkäyttö, joka mitataan glibc:n mallinfo2():lla varatuista
+ * tavuista ennen ja jälkeen lataamisen.
+ *
+ * Ennen sarakkeittaista tallennusta rivikohtaiset SelausRivi-rakenteet
+ * veivät vastaavalla aineistolla 370 tavua/rivi (AIEMMIN_TAVUA).
+ */
+class SelausRivitTesti : public QObject
+{
+    Q_OBJECT
+
+public:
+    SelausRivitTesti();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void lataus();
+    void jatkuvaHaku();
+    void jarjestys();
+    void tekstit();
+
+protected:
+    static const int RIVEJA = 500000;
+    static const int AIEMMIN_TAVUA = 370;
+
+    static qint64 kaytossa();
+    SelausRivit hae(const QDate& alkaa, const QDate& loppuu, const SelausRivit* jalkeen = nullptr,
+                    int enintaan = 0);
+
+    QTemporaryDir hakemisto_;
+    QSqlDatabase tietokanta_;
+    KausiOsiot osiot_;
+};
+
+SelausRivitTesti::SelausRivitTesti()
+{
+
+}
+
+qint64 SelausRivitTesti::kaytossa()
+{
+#ifdef MALLINFO2
+    struct mallinfo2 tiedot = mallinfo2();
+    return static_cast<qint64>( tiedot.uordblks + tiedot.hblkhd );
+#else
+    return -1;
+#endif
+}
+
+void SelausRivitTesti::initTestCase()
+{
+    QVERIFY( hakemisto_.isValid() );
+
+    tietokanta_ = QSqlDatabase::addDatabase("QSQLITE", "selaus");
+    tietokanta_.setDatabaseName( hakemisto_.filePath("selaus.kitupiikki") );
+    QVERIFY( tietokanta_.open() );
+
+    QSqlQuery kysely(tietokanta_);
+    QVERIFY( kysely.exec("CREATE TABLE tosite (id INTEGER PRIMARY KEY AUTOINCREMENT, pvm DATE, "
+                         "tunniste INTEGER, laji INTEGER)") );
+    QVERIFY( kysely.exec("CREATE TABLE vienti (id INTEGER PRIMARY KEY AUTOINCREMENT, tosite INTEGER, "
+                         "pvm DATE, tili INTEGER, debetsnt BIGINT, kreditsnt BIGINT, selite TEXT, "
+                         "kohdennus INTEGER DEFAULT(0), eraid INTEGER)") );
+    QVERIFY( kysely.exec("CREATE INDEX vienti_pvm_index ON vienti(pvm)") );
+    QVERIFY( kysely.exec("CREATE TABLE era (id INTEGER PRIMARY KEY, tili INTEGER, pvm DATE, tosite INTEGER, "
+                         "debetsnt BIGINT NOT NULL DEFAULT 0, kreditsnt BIGINT NOT NULL DEFAULT 0)") );
+    QVERIFY( kysely.exec("CREATE TABLE kohdennus (id INTEGER PRIMARY KEY, nimi TEXT)") );
+    QVERIFY( kysely.exec("CREATE TABLE merkkaus (id INTEGER PRIMARY KEY AUTOINCREMENT, vienti INTEGER, "
+                         "kohdennus INTEGER)") );
+    QVERIFY( kysely.exec("CREATE INDEX merkkaus_vienti ON merkkaus(vienti)") );
+    QVERIFY( kysely.exec("CREATE TABLE liite (id INTEGER PRIMARY KEY AUTOINCREMENT, tosite INTEGER, "
+                         "otsikko TEXT)") );
+    QVERIFY( kysely.exec("CREATE INDEX liite_tosite ON liite(tosite)") );
+    QVERIFY( kysely.exec("INSERT INTO kohdennus VALUES (0, 'Yleinen'), (1, 'Projekti')") );
+
+    // Kaksi vientiä tositteella, 1500 vientiä päivässä. Joka neljäs vienti
+    // avaa tase-erän, joka kymmenennellä on merkkaus ja joka kolmannella
+    // tositteella liite.
+    tietokanta_.transaction();
+    QVERIFY( kysely.exec(QString("WITH RECURSIVE n(i) AS (SELECT 0 UNION ALL SELECT i+1 FROM n WHERE i < %1) "
+                                 "INSERT INTO vienti(id, tosite, pvm, tili, debetsnt, kreditsnt, selite, eraid) "
+                                 "SELECT i+1, i/2+1, date('2018-01-01', '+' || (i/1500) || ' days'), 1 + i%40, "
+                                 "CASE WHEN i%2 THEN 0 ELSE i END, CASE WHEN i%2 THEN i ELSE 0 END, "
+                                 "'Myyntilasku ' || (i%2000), CASE WHEN i%4 THEN NULL ELSE i+1 END FROM n")
+                         .arg(RIVEJA - 1)) );
+    QVERIFY( kysely.exec("INSERT INTO tosite(id, pvm, tunniste, laji) "
+                         "SELECT tosite, MIN(pvm), tosite, 1 FROM vienti GROUP BY tosite") );
+    QVERIFY( kysely.exec("INSERT INTO era SELECT eraid, tili, pvm, tosite, debetsnt, kreditsnt "
+                         "FROM vienti WHERE eraid=id") );
+    QVERIFY( kysely.exec("INSERT INTO merkkaus(vienti, kohdennus) SELECT id, 1 FROM vienti WHERE id%10=1") );
+    QVERIFY( kysely.exec("INSERT INTO liite(tosite, otsikko) SELECT id, 'Lasku' FROM tosite WHERE id%3=0") );
+    QVERIFY( tietokanta_.commit() );
+}
+
+void SelausRivitTesti::cleanupTestCase()
+{
+    tietokanta_.close();
+}
+
+SelausRivit SelausRivitTesti::hae(const QDate &alkaa, const QDate &loppuu, const SelausRivit *jalkeen, int enintaan)
+{
+    // Kuten SelausModel::haeRivit() ja SelausModel::haeViipale()
+    SelausRivit rivit;
+    QString kysymys = SelausRivit::kysymys(osiot_, alkaa, loppuu, QList<int>(), jalkeen);
+    if( enintaan )
+        kysymys.append( QString(" LIMIT %1").arg(enintaan) );
+
+    QSqlQuery kysely(tietokanta_);
+    kysely.setForwardOnly(true);
+    if( !kysely.exec(kysymys))
+        qWarning() << kysely.lastError().text();
+    while( kysely.next())
+        rivit.lueRivi(kysely);
+    return rivit;
+}
+
+void SelausRivitTesti::lataus()
+{
+    qint64 ennen = kaytossa();
+    SelausRivit rivit = hae( QDate(2018,1,1), QDate(2018,12,31));
+    qint64 jalkeen = kaytossa();
+
+    QCOMPARE( rivit.maara(), RIVEJA);
+    qDebug() << "Laskettu" << rivit.muisti() / RIVEJA << "tavua/rivi";
+    QVERIFY( rivit.muisti() / RIVEJA < 100 );
+
+    if( ennen >= 0)
+    {
+        qint64 ladattu = jalkeen - ennen;
+        qDebug() << "Ennen lataamista" << ennen / 1024 / 1024 << "Mt, jälkeen" << jalkeen / 1024 / 1024 << "Mt";
+        qDebug() << "Ladatut rivit" << ladattu / 1024 / 1024 << "Mt," << ladattu / RIVEJA << "tavua/rivi";
+        QVERIFY( ladattu / RIVEJA * 2 < AIEMMIN_TAVUA );
+    }
+
+    // Ensimmäinen vienti avaa erän, joka on tasan
+    QCOMPARE( rivit.vienti.at(0), 1);
+    QCOMPARE( rivit.era.at(0), 1);
+    QVERIFY( rivit.eraMaksettu(0) );
+    QCOMPARE( rivit.tagit(0), QString("Projekti"));
+    QCOMPARE( rivit.eraPvm(0), QDate(2018,1,1));
+
+    QCOMPARE( rivit.debetSnt.at(4), 4);
+    QCOMPARE( rivit.era.at(4), 5);
+    QVERIFY( !rivit.eraMaksettu(4) );
+    QVERIFY( rivit.liitteita(4) );
+    QCOMPARE( rivit.eraTunniste.at(4), 3);
+
+    QCOMPARE( rivit.selite(2001), QString("Myyntilasku 1"));
+    QCOMPARE( rivit.kreditSnt.at(2001), 2001);
+    QCOMPARE( rivit.era.at(2001), 0);
+    QVERIFY( rivit.tagit(2001).isEmpty() );
+    QCOMPARE( rivit.pvm(RIVEJA - 1), QDate(2018,1,1).addDays( (RIVEJA - 1) / 1500));
+}
+
+void SelausRivitTesti::jatkuvaHaku()
+{
+    // Viipaleittain haettuna saadaan samat rivit kuin yhdellä kyselyllä
+    const QDate alkaa(2018,1,1);
+    const QDate loppuu(2018,1,31);
+    const int viipale = 2000;
+
+    SelausRivit kerralla = hae(alkaa, loppuu);
+    SelausRivit viipaleina;
+    for(;;)
+    {
+        SelausRivit uudet = hae(alkaa, loppuu, viipaleina.maara() ? &viipaleina : nullptr, viipale);
+        viipaleina.lisaa(uudet);
+        if( uudet.maara() < viipale )
+            break;
+    }
+
+    QCOMPARE( viipaleina.maara(), 31 * 1500);
+    QCOMPARE( viipaleina.vienti, kerralla.vienti);
+    QCOMPARE( viipaleina.tagitId.count(), kerralla.maara());
+    QCOMPARE( viipaleina.selite(viipaleina.maara() - 1), kerralla.selite(kerralla.maara() - 1));
+}
+
+void SelausRivitTesti::jarjestys()
+{
+    SelausRivit rivit;
+    rivit.lisaa(1, 1, QDate(2019,1,1), 1, 100, 0, "A", 0, 0, 1, 1, 0, 0, QDate(), QString(), false, false);
+    rivit.lisaa(5, 2, QDate(2019,1,2), 1, 100, 0, "B", 0, 0, 2, 1, 0, 0, QDate(), QString(), false, false);
+    rivit.lisaa(2, 3, QDate(2019,1,3), 1, 100, 0, "C", 0, 0, 3, 1, 0, 0, QDate(), QString(), false, false);
+
+    SelausRivit uudet;
+    uudet.lisaa(6, 4, QDate(2019,1,2), 2, 0, 100, "D", 0, 6, 4, 1, 2, 1, QDate(2019,1,2), "Projekti", true, true);
+
+    int indeksi = rivit.sijoituskohta(uudet, 0);
+    QCOMPARE( indeksi, 2);
+    rivit.lisaa(indeksi, uudet, 0);
+
+    QCOMPARE( rivit.maara(), 4);
+    QCOMPARE( rivit.vienti.at(2), 6);
+    QCOMPARE( rivit.selite(2), QString("D"));
+    QCOMPARE( rivit.tagit(2), QString("Projekti"));
+    QCOMPARE( rivit.eraTunniste.at(2), 2);
+    QCOMPARE( rivit.eraPvm(2), QDate(2019,1,2));
+    QVERIFY( rivit.liitteita(2) );
+    QVERIFY( rivit.eraMaksettu(2) );
+
+    rivit.asetaEraMaksettu(2, false);
+    QVERIFY( !rivit.eraMaksettu(2) );
+    QVERIFY( rivit.liitteita(2) );
+
+    rivit.poista(0);
+    QCOMPARE( rivit.maara(), 3);
+    QCOMPARE( rivit.selite(0), QString("B"));
+    QCOMPARE( rivit.sijoituskohta(uudet, 0), 2);
+}
+
+void SelausRivitTesti::tekstit()
+{
+    SelausRivit rivit;
+    rivit.lisaa(1, 1, QDate(2019,1,1), 1, 100, 0, "Sama", 0, 0, 1, 1, 0, 0, QDate(), QString(), false, false);
+    rivit.lisaa(2, 1, QDate(2019,1,1), 2, 0, 100, "Sama", 0, 0, 1, 1, 0, 0, QDate(), QString(), false, false);
+
+    QCOMPARE( rivit.seliteId.at(0), rivit.seliteId.at(1));
+    QCOMPARE( rivit.tagitId.at(0), 0);
+    QVERIFY( rivit.tagit(0).isEmpty() );
+}
+
+QTEST_MAIN(SelausRivitTesti)
+
+#include "tst_selausrivit.moc"
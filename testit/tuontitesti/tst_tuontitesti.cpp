@@ -19,8 +19,8 @@
 
 // add necessary includes here
 
-#include "../kitupiikki/validator/ibanvalidator.h"
-#include "../kitupiikki/tuonti/tuontiapu.h"
+#include "../../kitupiikki/validator/ibanvalidator.h"
+#include "../../kitupiikki/tuonti/tuontiapu.h"
 
 class TuontiTesti : public QObject
 {